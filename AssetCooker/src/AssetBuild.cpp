@@ -0,0 +1,487 @@
+#include "AssetBuild.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "Asset/ImageDecoder.h"
+#include "Asset/MeshImporter.h"
+#include "Asset/TextureCooker.h"
+#include "Core/AssetPack.h"
+#include "Core/FileSystem.h"
+#include "Core/Hash.h"
+#include "Core/ThreadPool.h"
+#include "Core/Timer.h"
+
+// Bump whenever a rule cooks the same input differently, so caches written
+// by older cookers are never reused.
+static constexpr uint32_t CookerVersion = 1;
+
+enum class CookRule
+{
+  Copy,
+  Texture,
+  Mesh,
+  Shader
+};
+
+struct CookInput
+{
+  // Relative to the source directory, with forward slashes; the name in the pack.
+  std::string Path;
+  std::string DiskPath;
+  uint64_t Size = 0;
+  int64_t WriteTime = 0;
+  uint64_t ContentHash = 0;
+  // Loaded when the input has to be hashed or cooked.
+  std::vector<uint8_t> Data;
+  bool Loaded = false;
+
+  CookRule Rule = CookRule::Copy;
+  // Name of the cooked output in the pack, and its cache entry.
+  std::string OutputPath;
+  uint64_t OutputKey = 0;
+  std::string Error;
+};
+
+struct CookManifest
+{
+  uint64_t PackKey = 0;
+  uint64_t PackSize = 0;
+  // Size, write time and content hash by path.
+  std::unordered_map<std::string, std::tuple<uint64_t, int64_t, uint64_t>> Files;
+};
+
+static uint64_t HashCombine(uint64_t seed, uint64_t value)
+{
+  return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+}
+
+static uint64_t HashString(const std::string& text)
+{
+  return Hazel::HashBytes((const uint8_t*)text.data(), text.size());
+}
+
+static std::string ToHex(uint64_t value)
+{
+  char text[17];
+  snprintf(text, sizeof(text), "%016llx", (unsigned long long)value);
+  return text;
+}
+
+static std::string GetExtension(const std::string& path)
+{
+  std::string extension = std::filesystem::path(path).extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+  return extension;
+}
+
+static std::string ReplaceExtension(const std::string& path, const char* extension)
+{
+  return path.substr(0, path.find_last_of('.')) + extension;
+}
+
+static bool ReadManifest(const std::string& path, CookManifest& manifest)
+{
+  std::ifstream in(path);
+  std::string magic;
+  uint32_t version = 0;
+  if (!(in >> magic >> version >> std::hex >> manifest.PackKey >> std::dec >> manifest.PackSize) || magic != "hazel-cook" || version != CookerVersion)
+    return false;
+
+  uint64_t size, hash;
+  int64_t writeTime;
+  std::string file;
+  while (in >> size >> writeTime >> std::hex >> hash >> std::dec && std::getline(in >> std::ws, file))
+    manifest.Files[file] = { size, writeTime, hash };
+  return true;
+}
+
+static bool WriteManifest(const std::string& path, const CookManifest& manifest, const std::vector<CookInput>& inputs)
+{
+  std::ofstream out(path, std::ios::out | std::ios::trunc);
+  out << "hazel-cook " << CookerVersion << " " << ToHex(manifest.PackKey) << " " << manifest.PackSize << "\n";
+  for (const CookInput& input : inputs)
+    out << input.Size << " " << input.WriteTime << " " << ToHex(input.ContentHash) << " " << input.Path << "\n";
+  return (bool)out;
+}
+
+// GL has no offline program format (binaries belong to one driver), so
+// shaders are baked to checked source: every stage is declared with a known
+// #type and has a #version, and comments and trailing whitespace go. Line
+// breaks stay, so the driver's line numbers still match the source file.
+static bool BakeShader(const std::vector<uint8_t>& source, std::vector<uint8_t>& baked, std::string& error)
+{
+  std::string text(source.begin(), source.end()), stripped;
+  for (size_t i = 0; i < text.size();)
+  {
+    if (text.compare(i, 2, "//") == 0)
+    {
+      i = std::min(text.find('\n', i), text.size());
+    }
+    else if (text.compare(i, 2, "/*") == 0)
+    {
+      size_t end = text.find("*/", i + 2);
+      if (end == std::string::npos)
+      {
+        error = "unterminated comment";
+        return false;
+      }
+      stripped.append(std::count(text.begin() + i, text.begin() + end, '\n'), '\n');
+      i = end + 2;
+    }
+    else
+    {
+      stripped += text[i++];
+    }
+  }
+
+  std::string result;
+  std::istringstream lines(stripped);
+  std::string line;
+  while (std::getline(lines, line))
+  {
+    line.erase(line.find_last_not_of(" \t\r") + 1);
+    result += line;
+    result += '\n';
+  }
+
+  std::vector<std::string> stages;
+  size_t pos = result.find("#type");
+  if (pos == std::string::npos)
+  {
+    error = "no #type stage declarations";
+    return false;
+  }
+  while (pos != std::string::npos)
+  {
+    size_t eol = result.find('\n', pos);
+    size_t begin = std::min(pos + 6, eol);
+    std::string type = result.substr(begin, eol - begin);
+    if (type == "pixel")
+      type = "fragment";
+    if (type != "vertex" && type != "fragment")
+    {
+      error = "unknown shader stage '" + type + "'";
+      return false;
+    }
+    if (std::find(stages.begin(), stages.end(), type) != stages.end())
+    {
+      error = "stage '" + type + "' declared twice";
+      return false;
+    }
+    stages.push_back(type);
+
+    size_t next = result.find("#type", eol);
+    if (result.substr(eol, next == std::string::npos ? std::string::npos : next - eol).find("#version") == std::string::npos)
+    {
+      error = "stage '" + type + "' has no #version";
+      return false;
+    }
+    pos = next;
+  }
+
+  baked.assign(result.begin(), result.end());
+  return true;
+}
+
+static void SetRule(CookInput& input)
+{
+  std::string extension = GetExtension(input.Path);
+  uint64_t ruleHash = HashCombine(CookerVersion, HashString(extension));
+  if (extension == ".png" || extension == ".jpg" || extension == ".jpeg")
+  {
+    input.Rule = CookRule::Texture;
+    input.OutputPath = ReplaceExtension(input.Path, ".ktx2");
+    ruleHash = HashCombine(ruleHash, HashString(Hazel::GuessTextureRole(input.Path)));
+  }
+  else if (Hazel::IsMeshSourceFile(input.Path))
+  {
+    input.Rule = CookRule::Mesh;
+    input.OutputPath = ReplaceExtension(input.Path, ".hzmesh");
+    ruleHash = HashCombine(ruleHash, Hazel::MeshFileVersion);
+  }
+  else if (extension == ".glsl")
+  {
+    input.Rule = CookRule::Shader;
+    input.OutputPath = input.Path;
+  }
+  input.OutputKey = HashCombine(ruleHash, input.ContentHash);
+}
+
+static bool Cook(const CookInput& input, std::vector<uint8_t>& output, std::string& error)
+{
+  switch (input.Rule)
+  {
+    case CookRule::Texture:
+    {
+      thread_local Hazel::ImageDecoder decoder;
+      Hazel::TextureCookSettings settings;
+      Hazel::GetCookSettingsForRole(Hazel::GuessTextureRole(input.Path), settings);
+      Hazel::ImageInfo info;
+      return Hazel::CookTextureFile(decoder, input.Data.data(), input.Data.size(), settings, output, info, error);
+    }
+    case CookRule::Mesh:
+    {
+      Hazel::MeshData mesh;
+      std::string directory = std::filesystem::path(input.DiskPath).parent_path().string();
+      if (!Hazel::ImportMesh(input.Path, input.Data.data(), input.Data.size(), directory, mesh, error))
+        return false;
+      output = Hazel::WriteMeshFile(mesh);
+      return true;
+    }
+    case CookRule::Shader:
+      return BakeShader(input.Data, output, error);
+    default:
+      return false;
+  }
+}
+
+static bool Load(CookInput& input)
+{
+  if (!input.Loaded)
+    input.Loaded = Hazel::ReadFile(input.DiskPath, input.Data);
+  return input.Loaded;
+}
+
+// Folds the content of the files a mesh import reads besides the input, a
+// glTF's external buffers, into its key. Files in the tree are hashed
+// already; others are read here.
+static void AddDependencies(CookInput& input, const std::vector<CookInput>& inputs, const std::unordered_map<std::string, uint32_t>& byPath)
+{
+  std::vector<std::string> files;
+  std::string error;
+  if (!Load(input))
+  {
+    input.Error = "could not read file";
+    return;
+  }
+  // A file that does not parse fails its cook, which reports why.
+  if (!Hazel::GetMeshDependencies(input.Path, input.Data.data(), input.Data.size(), files, error))
+    return;
+
+  for (const std::string& file : files)
+  {
+    std::string path = (std::filesystem::path(input.Path).parent_path() / file).lexically_normal().generic_string();
+    uint64_t hash;
+    auto known = byPath.find(path);
+    if (known != byPath.end())
+    {
+      hash = inputs[known->second].ContentHash;
+    }
+    else
+    {
+      std::vector<uint8_t> data;
+      if (!Hazel::ReadFile((std::filesystem::path(input.DiskPath).parent_path() / file).string(), data))
+      {
+        input.Error = "could not read '" + file + "'";
+        return;
+      }
+      hash = Hazel::HashBytes(data.data(), data.size());
+    }
+    input.OutputKey = HashCombine(HashCombine(input.OutputKey, HashString(path)), hash);
+  }
+}
+
+int BuildAssets(const AssetBuildSettings& settings)
+{
+  Hazel::Timer timer;
+  std::error_code error;
+  if (!std::filesystem::is_directory(settings.SourceDirectory, error))
+  {
+    HZ_ERROR("'{0}' is not a directory", settings.SourceDirectory);
+    return 1;
+  }
+  std::filesystem::create_directories(settings.CacheDirectory, error);
+  std::string manifestPath = settings.CacheDirectory + "/manifest";
+  CookManifest previous;
+  ReadManifest(manifestPath, previous);
+
+  std::vector<CookInput> inputs;
+  for (std::filesystem::recursive_directory_iterator it(settings.SourceDirectory, error), end; !error && it != end; it.increment(error))
+  {
+    if (!it->is_regular_file(error) || it->path().extension() == ".hzpak")
+      continue;
+
+    CookInput input;
+    input.Path = std::filesystem::relative(it->path(), settings.SourceDirectory, error).generic_string();
+    input.DiskPath = it->path().string();
+    input.Size = it->file_size(error);
+    input.WriteTime = (int64_t)it->last_write_time(error).time_since_epoch().count();
+    if (error)
+      break;
+    inputs.push_back(std::move(input));
+  }
+  if (error)
+  {
+    HZ_ERROR("Could not list '{0}': {1}", settings.SourceDirectory, error.message());
+    return 1;
+  }
+  std::sort(inputs.begin(), inputs.end(), [](const CookInput& a, const CookInput& b) { return a.Path < b.Path; });
+
+  // Content hashes: trusted from the manifest while size and time match.
+  std::vector<uint32_t> changed;
+  for (uint32_t i = 0; i < inputs.size(); i++)
+  {
+    auto known = previous.Files.find(inputs[i].Path);
+    if (known != previous.Files.end() && std::get<0>(known->second) == inputs[i].Size && std::get<1>(known->second) == inputs[i].WriteTime)
+      inputs[i].ContentHash = std::get<2>(known->second);
+    else
+      changed.push_back(i);
+  }
+  Hazel::ThreadPool::Get().ParallelFor((uint32_t)changed.size(), 1, [&](uint32_t begin, uint32_t end)
+  {
+    for (uint32_t i = begin; i < end; i++)
+    {
+      CookInput& input = inputs[changed[i]];
+      if (Load(input))
+        input.ContentHash = Hazel::HashBytes(input.Data.data(), input.Data.size());
+      else
+        input.Error = "could not read file";
+    }
+  });
+
+  // Meshes are read every run for the files they depend on.
+  std::unordered_map<std::string, uint32_t> byPath;
+  std::vector<uint32_t> meshes;
+  for (uint32_t i = 0; i < inputs.size(); i++)
+  {
+    SetRule(inputs[i]);
+    byPath[inputs[i].Path] = i;
+    if (inputs[i].Rule == CookRule::Mesh && inputs[i].Error.empty())
+      meshes.push_back(i);
+  }
+  Hazel::ThreadPool::Get().ParallelFor((uint32_t)meshes.size(), 1, [&](uint32_t begin, uint32_t end)
+  {
+    for (uint32_t i = begin; i < end; i++)
+      AddDependencies(inputs[meshes[i]], inputs, byPath);
+  });
+
+  // Cook whatever the cache does not have yet.
+  std::vector<uint32_t> jobs;
+  for (uint32_t i = 0; i < inputs.size(); i++)
+  {
+    bool cached = inputs[i].Rule == CookRule::Copy || std::filesystem::exists(settings.CacheDirectory + "/" + ToHex(inputs[i].OutputKey), error);
+    if (inputs[i].Error.empty() && !cached)
+      jobs.push_back(i);
+  }
+  Hazel::ThreadPool::Get().ParallelFor((uint32_t)jobs.size(), 1, [&](uint32_t begin, uint32_t end)
+  {
+    for (uint32_t i = begin; i < end; i++)
+    {
+      CookInput& input = inputs[jobs[i]];
+      std::vector<uint8_t> output;
+      if (!Load(input))
+        input.Error = "could not read file";
+      else if (Cook(input, output, input.Error))
+      {
+        // Written under a temporary name so an interrupted cook never leaves a partial entry.
+        std::string cachePath = settings.CacheDirectory + "/" + ToHex(input.OutputKey);
+        std::error_code renameError;
+        if (!Hazel::WriteFile(cachePath + ".tmp", output.data(), output.size()))
+          input.Error = "could not write the cache";
+        else
+          std::filesystem::rename(cachePath + ".tmp", cachePath, renameError);
+      }
+    }
+  });
+
+  uint32_t failed = 0;
+  for (const CookInput& input : inputs)
+  {
+    if (!input.Error.empty())
+    {
+      HZ_ERROR("Failed to cook {0}: {1}", input.DiskPath, input.Error);
+      failed++;
+    }
+  }
+  if (failed)
+    return 1;
+
+  // The pack's contents follow from the inputs, their cooked keys and the pack settings.
+  CookManifest manifest;
+  manifest.PackKey = HashCombine(HashCombine(CookerVersion, Hazel::AssetPackVersion), settings.Compress);
+  for (const CookInput& input : inputs)
+    manifest.PackKey = HashCombine(HashCombine(HashCombine(manifest.PackKey, HashString(input.Path)), input.ContentHash), input.OutputKey);
+
+  uint64_t packSize = std::filesystem::file_size(settings.OutputPack, error);
+  bool upToDate = !error && manifest.PackKey == previous.PackKey && packSize == previous.PackSize;
+  size_t packedFiles = 0;
+  if (upToDate)
+  {
+    manifest.PackSize = packSize;
+  }
+  else
+  {
+    // Cooked outputs replace sources of the same name.
+    std::vector<Hazel::AssetPackFile> files;
+    std::unordered_map<std::string, size_t> byPath;
+    auto add = [&](const std::string& path, std::vector<uint8_t> data)
+    {
+      auto [entry, inserted] = byPath.try_emplace(path, files.size());
+      if (inserted)
+        files.push_back({ path, std::move(data) });
+      else
+        files[entry->second].Data = std::move(data);
+    };
+    for (CookInput& input : inputs)
+    {
+      if (input.Rule != CookRule::Shader)
+      {
+        if (!Load(input))
+        {
+          HZ_ERROR("Could not read '{0}'", input.DiskPath);
+          return 1;
+        }
+        add(input.Path, std::move(input.Data));
+      }
+    }
+    for (const CookInput& input : inputs)
+    {
+      std::vector<uint8_t> cooked;
+      if (input.Rule == CookRule::Copy)
+        continue;
+      if (!Hazel::ReadFile(settings.CacheDirectory + "/" + ToHex(input.OutputKey), cooked))
+      {
+        HZ_ERROR("Could not read the cooked {0}", input.OutputPath);
+        return 1;
+      }
+      if (byPath.count(input.OutputPath) && input.OutputPath != input.Path)
+        HZ_WARN("{0} is cooked from {1}; the file of that name is left out", input.OutputPath, input.Path);
+      add(input.OutputPath, std::move(cooked));
+    }
+
+    // Swapped in whole, so a running game that maps the old pack keeps a consistent file.
+    std::vector<uint8_t> pack = Hazel::WriteAssetPack(files, settings.Compress);
+    std::string temporary = settings.OutputPack + ".tmp";
+    bool written = Hazel::WriteFile(temporary, pack.data(), pack.size());
+    if (written)
+      std::filesystem::rename(temporary, settings.OutputPack, error);
+    if (!written || error)
+    {
+      HZ_ERROR("Could not write '{0}'", settings.OutputPack);
+      return 1;
+    }
+    manifest.PackSize = pack.size();
+    packedFiles = files.size();
+  }
+  if (!WriteManifest(manifestPath, manifest, inputs))
+    HZ_ERROR("Could not write '{0}'", manifestPath);
+
+  // Drop cache entries no input refers to any more.
+  std::unordered_set<std::string> keep = { "manifest" };
+  for (const CookInput& input : inputs)
+    keep.insert(ToHex(input.OutputKey));
+  for (std::filesystem::directory_iterator it(settings.CacheDirectory, error), end; !error && it != end; it.increment(error))
+  {
+    std::error_code removeError;
+    if (!keep.count(it->path().filename().string()))
+      std::filesystem::remove(it->path(), removeError);
+  }
+
+  if (upToDate)
+    HZ_INFO("{0}: {1} inputs, {2} hashed, up to date, {3:.1f} ms", settings.OutputPack, inputs.size(), changed.size(), timer.ElapsedMillis());
+  else
+    HZ_INFO("{0}: {1} inputs, {2} hashed, {3} cooked, {4} files, {5:.1f} KiB{6}, {7:.1f} ms", settings.OutputPack, inputs.size(), changed.size(), jobs.size(),
+      packedFiles, manifest.PackSize / 1024.0f, settings.Compress ? " compressed" : "", timer.ElapsedMillis());
+  return 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// Incremental cook of a whole asset tree into one pack, as the asset-cooker
+// build target runs it:
+//
+//   *.png, *.jpg   -> *.ktx2, role guessed from the name, next to the source
+//   *.obj, *.gltf, *.glb -> *.hzmesh, next to the source
+//   *.glsl         -> baked in place (checked, comments stripped)
+//
+// Every other file, and the source images and meshes, go into the pack as
+// they are. Cooked outputs are cached by a hash of their input's content,
+// of the files it pulls in (a .gltf's external buffers) and of the cooker
+// and format versions, so only changed inputs are cooked again; inputs
+// other than meshes whose size and modification time match the last run
+// are not even read, and the pack is left alone when nothing in it would
+// change.
+// Cooking runs on the thread pool, one input per job.
+struct AssetBuildSettings
+{
+  std::string SourceDirectory;
+  std::string OutputPack;
+  // Cooked outputs and the manifest of the last run.
+  std::string CacheDirectory;
+  bool Compress = false;
+};
+
+// Returns the process exit code.
+int BuildAssets(const AssetBuildSettings& settings);
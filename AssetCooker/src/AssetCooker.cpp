@@ -0,0 +1,242 @@
+// AssetCooker.cpp : Offline conversion of source assets into runtime formats.
+//
+// AssetCooker <input.png> <output.ktx2> [--role color|srgb|mask|normal|data] [--format bc1|bc4|bc5|bc7] [--no-mips] [--mip-filter box|kaiser]
+// AssetCooker <input.obj|gltf|glb> <output.hzmesh> [--compress]
+// AssetCooker --pack <directory> <output.hzpak> [--compress]
+// AssetCooker --build <directory> <output.hzpak> [--cache <directory>] [--compress]
+
+#include <filesystem>
+
+#include "AssetBuild.h"
+#include "Asset/ImageDecoder.h"
+#include "Asset/MeshImporter.h"
+#include "Asset/TextureCooker.h"
+#include "Core/AssetPack.h"
+#include "Core/FileSystem.h"
+#include "Core/Timer.h"
+
+static bool ParseFormat(const std::string& name, Hazel::BlockFormat& format)
+{
+  static const std::pair<const char*, Hazel::BlockFormat> Formats[] = {
+    { "bc1", Hazel::BlockFormat::BC1 }, { "bc4", Hazel::BlockFormat::BC4 },
+    { "bc5", Hazel::BlockFormat::BC5 }, { "bc7", Hazel::BlockFormat::BC7 }
+  };
+  for (const auto& [formatName, value] : Formats)
+  {
+    if (name == formatName)
+    {
+      format = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+static int CookMesh(const std::string& input, const std::string& output, bool compress)
+{
+  Hazel::Timer timer;
+  Hazel::MeshData mesh;
+  std::string error;
+  if (!Hazel::ImportMeshFile(input, mesh, error))
+  {
+    HZ_ERROR("Failed to load {0}: {1}", input, error);
+    return 1;
+  }
+  float importMs = timer.ElapsedMillis();
+
+  std::vector<uint8_t> file = Hazel::WriteMeshFile(mesh, compress);
+  if (!Hazel::WriteFile(output, file.data(), file.size()))
+  {
+    HZ_ERROR("Could not write '{0}'", output);
+    return 1;
+  }
+
+  HZ_INFO("{0} -> {1}: {2} vertices, {3} triangles, {4} submeshes, {5:.1f} KiB{6}, import {7:.1f} ms",
+    input, output, mesh.GetVertexCount(), mesh.Indices.size() / 3, mesh.Submeshes.size(), file.size() / 1024.0f,
+    compress ? " compressed" : "", importMs);
+  return 0;
+}
+
+// Every file under directory, named by its path relative to it.
+static int CookPack(const std::string& directory, const std::string& output, bool compress)
+{
+  Hazel::Timer timer;
+  std::error_code error;
+  if (!std::filesystem::is_directory(directory, error))
+  {
+    HZ_ERROR("'{0}' is not a directory", directory);
+    return 1;
+  }
+
+  std::vector<Hazel::AssetPackFile> files;
+  size_t sourceSize = 0;
+  for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+  {
+    // Never packs an earlier pack, e.g. the output itself.
+    if (!it->is_regular_file(error) || it->path().extension() == ".hzpak")
+      continue;
+
+    Hazel::AssetPackFile file;
+    file.Path = std::filesystem::relative(it->path(), directory, error).generic_string();
+    if (error || !Hazel::ReadFile(it->path().string(), file.Data))
+    {
+      HZ_ERROR("Could not read '{0}'", it->path().string());
+      return 1;
+    }
+    sourceSize += file.Data.size();
+    files.push_back(std::move(file));
+  }
+  if (error)
+  {
+    HZ_ERROR("Could not list '{0}': {1}", directory, error.message());
+    return 1;
+  }
+
+  std::vector<uint8_t> pack = Hazel::WriteAssetPack(files, compress);
+  if (!Hazel::WriteFile(output, pack.data(), pack.size()))
+  {
+    HZ_ERROR("Could not write '{0}'", output);
+    return 1;
+  }
+
+  HZ_INFO("{0} -> {1}: {2} files, {3:.1f} KiB -> {4:.1f} KiB{5}, {6:.1f} ms",
+    directory, output, files.size(), sourceSize / 1024.0f, pack.size() / 1024.0f, compress ? " compressed" : "", timer.ElapsedMillis());
+  return 0;
+}
+
+int main(int argc, char** argv)
+{
+  Hazel::Log::Init();
+
+  if (argc < 3)
+  {
+    HZ_ERROR("Usage: AssetCooker <input.png> <output.ktx2> [--role color|srgb|mask|normal|data] [--format bc1|bc4|bc5|bc7] [--no-mips] [--mip-filter box|kaiser]");
+    HZ_ERROR("       AssetCooker <input.obj|gltf|glb> <output.hzmesh> [--compress]");
+    HZ_ERROR("       AssetCooker --pack <directory> <output.hzpak> [--compress]");
+    HZ_ERROR("       AssetCooker --build <directory> <output.hzpak> [--cache <directory>] [--compress]");
+    return 1;
+  }
+
+  if (std::string(argv[1]) == "--build")
+  {
+    if (argc < 4)
+    {
+      HZ_ERROR("Usage: AssetCooker --build <directory> <output.hzpak> [--cache <directory>] [--compress]");
+      return 1;
+    }
+    AssetBuildSettings settings;
+    settings.SourceDirectory = argv[2];
+    settings.OutputPack = argv[3];
+    settings.CacheDirectory = settings.OutputPack + ".cache";
+    for (int i = 4; i < argc; i++)
+    {
+      std::string arg = argv[i];
+      if (arg == "--cache" && i + 1 < argc)
+        settings.CacheDirectory = argv[++i];
+      else if (arg == "--compress")
+        settings.Compress = true;
+      else
+      {
+        HZ_ERROR("Unknown argument '{0}'", arg);
+        return 1;
+      }
+    }
+    return BuildAssets(settings);
+  }
+
+  // Meshes and packs take nothing but --compress.
+  bool pack = std::string(argv[1]) == "--pack";
+  if (pack && argc < 4)
+  {
+    HZ_ERROR("Usage: AssetCooker --pack <directory> <output.hzpak> [--compress]");
+    return 1;
+  }
+  std::string input = argv[pack ? 2 : 1], output = argv[pack ? 3 : 2];
+  if (pack || Hazel::IsMeshSourceFile(input))
+  {
+    bool compress = false;
+    for (int i = pack ? 4 : 3; i < argc; i++)
+    {
+      if (std::string(argv[i]) != "--compress")
+      {
+        HZ_ERROR("Unknown argument '{0}'", argv[i]);
+        return 1;
+      }
+      compress = true;
+    }
+    return pack ? CookPack(input, output, compress) : CookMesh(input, output, compress);
+  }
+
+  std::string role = Hazel::GuessTextureRole(input);
+  std::string formatName;
+  std::string mipFilter = "kaiser";
+  bool mips = true;
+  for (int i = 3; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--role" && i + 1 < argc)
+      role = argv[++i];
+    else if (arg == "--format" && i + 1 < argc)
+      formatName = argv[++i];
+    else if (arg == "--no-mips")
+      mips = false;
+    else if (arg == "--mip-filter" && i + 1 < argc)
+      mipFilter = argv[++i];
+    else
+    {
+      HZ_ERROR("Unknown argument '{0}'", arg);
+      return 1;
+    }
+  }
+
+  Hazel::TextureCookSettings settings;
+  if (!Hazel::GetCookSettingsForRole(role, settings))
+  {
+    HZ_ERROR("Unknown role '{0}'", role);
+    return 1;
+  }
+  if (!formatName.empty() && !ParseFormat(formatName, settings.Format))
+  {
+    HZ_ERROR("Unknown format '{0}'", formatName);
+    return 1;
+  }
+  if (mipFilter != "box" && mipFilter != "kaiser")
+  {
+    HZ_ERROR("Unknown mip filter '{0}'", mipFilter);
+    return 1;
+  }
+  settings.Mips = mips;
+  settings.Filter = mipFilter == "box" ? Hazel::MipFilter::Box : Hazel::MipFilter::Kaiser;
+
+  Hazel::Timer timer;
+  std::vector<uint8_t> data;
+  if (!Hazel::ReadFile(input, data))
+  {
+    HZ_ERROR("Failed to load {0}: could not open file", input);
+    return 1;
+  }
+  float readMs = timer.ElapsedMillis();
+
+  timer.Reset();
+  Hazel::ImageDecoder decoder;
+  Hazel::ImageInfo info;
+  std::vector<uint8_t> ktx2;
+  std::string error;
+  if (!Hazel::CookTextureFile(decoder, data.data(), data.size(), settings, ktx2, info, error))
+  {
+    HZ_ERROR("Failed to load {0}: {1}", input, error);
+    return 1;
+  }
+  float cookMs = timer.ElapsedMillis();
+
+  if (!Hazel::WriteFile(output, ktx2.data(), ktx2.size()))
+  {
+    HZ_ERROR("Could not write '{0}'", output);
+    return 1;
+  }
+
+  HZ_INFO("{0} -> {1}: {2}x{3} {4} ({5}{6}), {7:.1f} KiB, read {8:.1f} ms, decode and encode {9:.1f} ms",
+    input, output, info.Width, info.Height, Hazel::BlockFormatToString(settings.Format), role, mips ? ", mips" : "",
+    ktx2.size() / 1024.0f, readMs, cookMs);
+  return 0;
+}
@@ -0,0 +1,148 @@
+// Deferred Lighting Shader: full-screen pass over the G-buffer using the clustered light lists
+
+#type vertex
+#version 330 core
+
+out vec2 TexCoords;
+
+void main()
+{
+  // One triangle covering the screen, no vertex buffer needed
+  vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  TexCoords = position;
+  gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+
+#type fragment
+#version 330 core
+
+in vec2 TexCoords;
+
+out vec4 color;
+
+uniform sampler2D gAlbedoSpecular;
+uniform sampler2D gNormalShininess;
+uniform sampler2D gDepth;
+
+uniform vec3 viewPos;
+uniform mat4 view;
+uniform mat4 inverseViewProjection;
+
+// Clustered light lists, built on the CPU by ClusteredLighting
+uniform samplerBuffer clusterLights;         // 4 texels per light: position/radius, ambient, diffuse, specular
+uniform usamplerBuffer clusterGrid;          // (offset, count) per cluster
+uniform usamplerBuffer clusterLightIndices;
+uniform vec3 clusterCount;
+uniform vec2 clusterSliceScaleBias;
+uniform vec2 screenSize;
+
+// Key directional light with cascaded shadows, see CascadedShadowMaps
+struct DirectionalLight
+{
+  vec3 direction;
+  vec3 ambient;
+  vec3 diffuse;
+  vec3 specular;
+};
+
+uniform DirectionalLight dirLight;
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 cascadeViewProjection[4];
+uniform vec4 cascadeSplits;                  // far distance of each cascade, all zero without shadows
+
+vec3 DecodeNormal(vec2 f)
+{
+  f = f * 2.0 - 1.0;
+  vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+  float t = clamp(-n.z, 0.0, 1.0);
+  n.x += n.x >= 0.0 ? -t : t;
+  n.y += n.y >= 0.0 ? -t : t;
+  return normalize(n);
+}
+
+float ShadowFactor(vec3 position, vec3 normal, float viewDepth)
+{
+  if (cascadeSplits.w <= 0.0 || viewDepth >= cascadeSplits.w)
+    return 1.0;
+
+  int cascade = 3;
+  for (int i = 2; i >= 0; i--)
+  {
+    if (viewDepth < cascadeSplits[i])
+      cascade = i;
+  }
+
+  // Push the lookup along the normal to keep acne off surfaces facing away from the light
+  vec3 offsetPosition = position + normal * 0.02 * float(cascade + 1);
+  vec4 lightClip = cascadeViewProjection[cascade] * vec4(offsetPosition, 1.0);
+  vec3 coords = lightClip.xyz / lightClip.w * 0.5 + 0.5;
+
+  // 3x3 PCF on top of the hardware 2x2 comparison
+  vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+  float lit = 0.0;
+  for (int y = -1; y <= 1; y++)
+  {
+    for (int x = -1; x <= 1; x++)
+      lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texelSize, float(cascade), coords.z));
+  }
+  return lit / 9.0;
+}
+
+void main()
+{
+  float depth = texture(gDepth, TexCoords).r;
+  if (depth == 1.0)
+    discard;
+
+  vec4 clip = inverseViewProjection * vec4(vec3(TexCoords, depth) * 2.0 - 1.0, 1.0);
+  vec3 fragPos = clip.xyz / clip.w;
+  float viewDepth = -(view * vec4(fragPos, 1.0)).z;
+
+  vec4 albedoSpecular = texture(gAlbedoSpecular, TexCoords);
+  vec4 normalShininess = texture(gNormalShininess, TexCoords);
+  vec3 albedo = albedoSpecular.rgb;
+  vec3 norm = DecodeNormal(normalShininess.xy);
+  float shininess = exp2(normalShininess.z * 8.0);
+  vec3 viewDir = normalize(viewPos - fragPos);
+
+  ivec3 cluster = ivec3(
+    gl_FragCoord.xy / screenSize * clusterCount.xy,
+    log(viewDepth) * clusterSliceScaleBias.x - clusterSliceScaleBias.y);
+  cluster = clamp(cluster, ivec3(0), ivec3(clusterCount) - 1);
+  uvec2 grid = texelFetch(clusterGrid, (cluster.z * int(clusterCount.y) + cluster.y) * int(clusterCount.x) + cluster.x).xy;
+
+  vec3 result = vec3(0.0);
+  for (uint i = 0u; i < grid.y; i++)
+  {
+    int light = int(texelFetch(clusterLightIndices, int(grid.x + i)).r) * 4;
+    vec4 positionRadius = texelFetch(clusterLights, light);
+
+    vec3 toLight = positionRadius.xyz - fragPos;
+    float lightDistance = length(toLight);
+    float falloff = clamp(1.0 - pow(lightDistance / positionRadius.w, 4.0), 0.0, 1.0);
+    float attenuation = falloff * falloff;
+    if (attenuation <= 0.0)
+      continue;
+
+    vec3 ambient = texelFetch(clusterLights, light + 1).rgb * albedo;
+
+    vec3 lightDir = toLight / lightDistance;
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = texelFetch(clusterLights, light + 2).rgb * diff * albedo;
+
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    vec3 specular = texelFetch(clusterLights, light + 3).rgb * spec * albedoSpecular.a;
+
+    result += (ambient + diffuse + specular) * attenuation;
+  }
+
+  vec3 sunDir = normalize(-dirLight.direction);
+  float sunDiff = max(dot(norm, sunDir), 0.0);
+  float sunSpec = pow(max(dot(viewDir, reflect(-sunDir, norm)), 0.0), shininess);
+  float shadow = ShadowFactor(fragPos, norm, viewDepth);
+  result += dirLight.ambient * albedo
+    + (dirLight.diffuse * sunDiff * albedo + dirLight.specular * sunSpec * albedoSpecular.a) * shadow;
+
+  color = vec4(result, 1.0f);
+}
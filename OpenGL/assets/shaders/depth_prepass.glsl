@@ -0,0 +1,24 @@
+// Depth Pre-pass Shader: must transform exactly like lighting.glsl so the main pass can test with GL_EQUAL
+
+#type vertex
+#version 330 core
+
+layout (location = 0) in vec3 position;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+invariant gl_Position;
+
+void main()
+{
+	gl_Position = projection * view * model * vec4(position, 1.0f);
+}
+
+#type fragment
+#version 330 core
+
+void main()
+{
+}
@@ -0,0 +1,85 @@
+// G-buffer Shader
+
+#type vertex
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 texCoords;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform mat3 normalMatrix;
+
+out vec3 Normal;
+out vec2 TexCoords;
+
+void main()
+{
+  gl_Position = projection * view * model * vec4(position, 1.0f);
+  Normal = normalMatrix * normal;
+  TexCoords = texCoords;
+}
+
+#type fragment
+#version 330 core
+
+// TEXTURE_ARRAYS: same material layout as lighting.glsl
+struct Material
+{
+#ifdef TEXTURE_ARRAYS
+  sampler2DArray diffuse;
+  sampler2DArray specular;
+  vec4 diffuseRect;
+  vec4 specularRect;
+  float diffuseLayer;
+  float specularLayer;
+#else
+  sampler2D diffuse;
+  sampler2D specular;
+#endif
+  float shininess;
+};
+
+in vec3 Normal;
+in vec2 TexCoords;
+
+layout (location = 0) out vec4 albedoSpecular;
+layout (location = 1) out vec4 normalShininess;
+
+uniform Material material;
+
+vec2 OctWrap(vec2 v)
+{
+  return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec2 EncodeNormal(vec3 n)
+{
+  n /= abs(n.x) + abs(n.y) + abs(n.z);
+  n.xy = n.z >= 0.0 ? n.xy : OctWrap(n.xy);
+  return n.xy * 0.5 + 0.5;
+}
+
+#ifdef TEXTURE_ARRAYS
+vec4 SampleRegion(sampler2DArray map, vec4 rect, float layer)
+{
+  vec2 uv = rect.xy + fract(TexCoords) * rect.zw;
+  return textureGrad(map, vec3(uv, layer), dFdx(TexCoords) * rect.zw, dFdy(TexCoords) * rect.zw);
+}
+
+vec3 SampleDiffuse() { return vec3(SampleRegion(material.diffuse, material.diffuseRect, material.diffuseLayer)); }
+vec3 SampleSpecular() { return vec3(SampleRegion(material.specular, material.specularRect, material.specularLayer)); }
+#else
+vec3 SampleDiffuse() { return vec3(texture(material.diffuse, TexCoords)); }
+vec3 SampleSpecular() { return vec3(texture(material.specular, TexCoords)); }
+#endif
+
+void main()
+{
+  vec3 specular = SampleSpecular();
+
+  albedoSpecular = vec4(SampleDiffuse(), max(specular.r, max(specular.g, specular.b)));
+  normalShininess = vec4(EncodeNormal(normalize(Normal)), log2(material.shininess) / 8.0, 0.0);
+}
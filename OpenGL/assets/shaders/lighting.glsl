@@ -10,63 +10,172 @@ layout (location = 2) in vec2 texCoords;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+// transpose(inverse(mat3(model))), computed once per object on the CPU
+uniform mat3 normalMatrix;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
+out float ViewDepth;
+
+// Matches depth_prepass.glsl bit for bit
+invariant gl_Position;
 
 void main()
 {
 	gl_Position = projection * view * model * vec4(position, 1.0f);
   FragPos = vec3(model * vec4(position, 1.0f));
-  Normal = mat3(transpose(inverse(model))) * normal;
+  Normal = normalMatrix * normal;
   TexCoords = texCoords;
+  ViewDepth = -(view * vec4(FragPos, 1.0f)).z;
 }
 
 #type fragment
 #version 330 core
 
+// TEXTURE_ARRAYS: the maps are layers (or atlas rects within layers) of
+// texture arrays shared by many materials, see TexturePacker
 struct Material
 {
+#ifdef TEXTURE_ARRAYS
+  sampler2DArray diffuse;
+  sampler2DArray specular;
+  vec4 diffuseRect;                          // offset.xy, scale.zw within the layer
+  vec4 specularRect;
+  float diffuseLayer;
+  float specularLayer;
+#else
   sampler2D diffuse;
   sampler2D specular;
+#endif
   float shininess;
 };
 
-struct Light
-{
-  vec3 position;
-  vec3 ambient;
-  vec3 diffuse;
-  vec3 specular;
-};
-
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
+in float ViewDepth;
 
 out vec4 color;
 
 uniform vec3 viewPos;
 uniform Material material;
-uniform Light light;
 
-void main()
+// Clustered light lists, built on the CPU by ClusteredLighting
+uniform samplerBuffer clusterLights;         // 4 texels per light: position/radius, ambient, diffuse, specular
+uniform usamplerBuffer clusterGrid;          // (offset, count) per cluster
+uniform usamplerBuffer clusterLightIndices;
+uniform vec3 clusterCount;
+uniform vec2 clusterSliceScaleBias;
+uniform vec2 screenSize;
+
+// Key directional light with cascaded shadows, see CascadedShadowMaps
+struct DirectionalLight
 {
-  // 
-  vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
+  vec3 direction;
+  vec3 ambient;
+  vec3 diffuse;
+  vec3 specular;
+};
 
-  // 
-  vec3 norm = normalize(Normal);
-  vec3 lightDir = normalize(light.position - FragPos);
-  float diff = max(dot(norm, lightDir), 0.0);
-  vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
+uniform DirectionalLight dirLight;
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 cascadeViewProjection[4];
+uniform vec4 cascadeSplits;                  // far distance of each cascade, all zero without shadows
+
+#ifdef TEXTURE_ARRAYS
+vec4 SampleRegion(sampler2DArray map, vec4 rect, float layer)
+{
+  // Wrap inside the rect; gradients come from the unwrapped coordinates so
+  // the wrap seam does not pick the smallest mip
+  vec2 uv = rect.xy + fract(TexCoords) * rect.zw;
+  return textureGrad(map, vec3(uv, layer), dFdx(TexCoords) * rect.zw, dFdy(TexCoords) * rect.zw);
+}
+
+vec3 SampleDiffuse() { return vec3(SampleRegion(material.diffuse, material.diffuseRect, material.diffuseLayer)); }
+vec3 SampleSpecular() { return vec3(SampleRegion(material.specular, material.specularRect, material.specularLayer)); }
+#else
+vec3 SampleDiffuse() { return vec3(texture(material.diffuse, TexCoords)); }
+vec3 SampleSpecular() { return vec3(texture(material.specular, TexCoords)); }
+#endif
 
-  // 淴
+float ShadowFactor(vec3 position, vec3 normal, float viewDepth)
+{
+  if (cascadeSplits.w <= 0.0 || viewDepth >= cascadeSplits.w)
+    return 1.0;
+
+  int cascade = 3;
+  for (int i = 2; i >= 0; i--)
+  {
+    if (viewDepth < cascadeSplits[i])
+      cascade = i;
+  }
+
+  // Push the lookup along the normal to keep acne off surfaces facing away from the light
+  vec3 offsetPosition = position + normal * 0.02 * float(cascade + 1);
+  vec4 lightClip = cascadeViewProjection[cascade] * vec4(offsetPosition, 1.0);
+  vec3 coords = lightClip.xyz / lightClip.w * 0.5 + 0.5;
+
+  // 3x3 PCF on top of the hardware 2x2 comparison
+  vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+  float lit = 0.0;
+  for (int y = -1; y <= 1; y++)
+  {
+    for (int x = -1; x <= 1; x++)
+      lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texelSize, float(cascade), coords.z));
+  }
+  return lit / 9.0;
+}
+
+void main()
+{
+  vec3 albedo = SampleDiffuse();
+  vec3 specularMask = SampleSpecular();
+  vec3 norm = normalize(Normal);
   vec3 viewDir = normalize(viewPos - FragPos);
-  vec3 reflectDir = reflect(-lightDir, norm);
-  float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-  vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
 
-	color = vec4(ambient + diffuse + specular, 1.0f);
+  ivec3 cluster = ivec3(
+    gl_FragCoord.xy / screenSize * clusterCount.xy,
+    log(ViewDepth) * clusterSliceScaleBias.x - clusterSliceScaleBias.y);
+  cluster = clamp(cluster, ivec3(0), ivec3(clusterCount) - 1);
+  uvec2 grid = texelFetch(clusterGrid, (cluster.z * int(clusterCount.y) + cluster.y) * int(clusterCount.x) + cluster.x).xy;
+
+  vec3 result = vec3(0.0);
+  for (uint i = 0u; i < grid.y; i++)
+  {
+    int light = int(texelFetch(clusterLightIndices, int(grid.x + i)).r) * 4;
+    vec4 positionRadius = texelFetch(clusterLights, light);
+
+    vec3 toLight = positionRadius.xyz - FragPos;
+    float lightDistance = length(toLight);
+    // Smooth window so the light reaches exactly zero at its cluster radius
+    float falloff = clamp(1.0 - pow(lightDistance / positionRadius.w, 4.0), 0.0, 1.0);
+    float attenuation = falloff * falloff;
+    if (attenuation <= 0.0)
+      continue;
+
+    // 
+    vec3 ambient = texelFetch(clusterLights, light + 1).rgb * albedo;
+
+    // 
+    vec3 lightDir = toLight / lightDistance;
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = texelFetch(clusterLights, light + 2).rgb * diff * albedo;
+
+    // 淴
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    vec3 specular = texelFetch(clusterLights, light + 3).rgb * spec * specularMask;
+
+    result += (ambient + diffuse + specular) * attenuation;
+  }
+
+  vec3 sunDir = normalize(-dirLight.direction);
+  float sunDiff = max(dot(norm, sunDir), 0.0);
+  float sunSpec = pow(max(dot(viewDir, reflect(-sunDir, norm)), 0.0), material.shininess);
+  float shadow = ShadowFactor(FragPos, norm, ViewDepth);
+  result += dirLight.ambient * albedo
+    + (dirLight.diffuse * sunDiff * albedo + dirLight.specular * sunSpec * specularMask) * shadow;
+
+  color = vec4(result, 1.0f);
 }
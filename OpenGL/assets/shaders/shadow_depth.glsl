@@ -0,0 +1,21 @@
+// Shadow Depth Shader
+
+#type vertex
+#version 330 core
+
+layout (location = 0) in vec3 position;
+
+uniform mat4 model;
+uniform mat4 lightViewProjection;
+
+void main()
+{
+	gl_Position = lightViewProjection * model * vec4(position, 1.0f);
+}
+
+#type fragment
+#version 330 core
+
+void main()
+{
+}
@@ -6,16 +6,33 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#include <stb_image.h>
+#include <filesystem>
+#include <random>
 
-#include "Renderer/Shader.h"
 #include "Renderer/Camera.h"
+#include "Renderer/Mesh.h"
+#include "Renderer/ResidencyManager.h"
+#include "Renderer/SceneRenderer.h"
+#include "Renderer/TextureCache.h"
+#include "Renderer/TexturePacker.h"
+#include "Renderer/TextureStreamer.h"
+#include "Renderer/UploadScheduler.h"
+#include "Core/RenderThread.h"
+#include "Core/VirtualFileSystem.h"
+#include "Scene/Scene.h"
+#include "Scene/WorldStreamer.h"
+#include "Benchmark/Benchmark.h"
 
 // Function prototypes
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void do_movement();
+int run(GLFWwindow* window);
+void set_light_count(Hazel::Scene& scene, std::vector<Hazel::Entity>& lights, uint32_t count);
+std::string resolve_texture(const std::string& path);
+std::string resolve_mesh(const std::string& path);
+bool mount_assets(const std::string& path, const std::string& executable);
 
 // Window dimensions
 const GLuint WIDTH = 960, HEIGHT = 600;
@@ -26,15 +43,33 @@ GLfloat lastX = WIDTH / 2.0;
 GLfloat lastY = HEIGHT / 2.0;
 bool    keys[1024];
 
-// Light attributes
-glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
+// Point light stress test, cycled with L
+const uint32_t LIGHT_COUNTS[] = { 0, 16, 256, 1024, 4096 };
+uint32_t lightCountIndex = 0;
+bool    lightCountChanged = false;
+
+// Forward / deferred, toggled with G
+bool    useDeferred = false;
+bool    useDepthPrepass = false;
+// Packed texture arrays instead of per-material 2D maps, toggled with T
+bool    useTextureArrays = false;
 
 // Deltatime
 GLfloat deltaTime = 0.0f;	// Time between current frame and last frame
 GLfloat lastFrame = 0.0f;  	// Time of last frame
 
-int main(void)
+int main(int argc, char** argv)
 {
+  Hazel::Log::Init();
+
+  // Headless CPU benchmarks: OpenGL --bench <name|all>
+  if (argc > 2 && std::string(argv[1]) == "--bench")
+    return Hazel::Benchmark::Run(argv[2]);
+
+  // Asset paths are relative to the mounted pack or directory: OpenGL --assets <pack.hzpak|directory>
+  if (!mount_assets(argc > 2 && std::string(argv[1]) == "--assets" ? argv[2] : "", argv[0]))
+    return -1;
+
   GLFWwindow* window;
 
   /* Initialize the library */
@@ -76,121 +111,130 @@ int main(void)
   // OpenGL options
   glEnable(GL_DEPTH_TEST);
 
-  // Build and compile our shader program
-  Hazel::Ref<Shader> lightingShader = Hazel::CreateRef<Shader>(AssetsDir + "/assets/shaders/lighting.glsl");
-  Hazel::Ref<Shader> lampShader = Hazel::CreateRef<Shader>(AssetsDir + "/assets/shaders/lamp.glsl");
-
-  // Set up vertex data (and buffer(s)) and attribute pointers
-  GLfloat vertices[] = {
-    // Positions          // Normals           // Texture Coords
-    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
-     0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
-     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
-     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
-
-    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
-     0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
-
-    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-    -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
-    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
-    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
-    -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
-    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-
-     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-     0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
-     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
-     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
-     0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-
-    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
-     0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
-     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
-     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
-
-    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
-     0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
-  };
-
-  // First, set the container's VAO (and VBO)
-  GLuint VBO, containerVAO;
-  glGenVertexArrays(1, &containerVAO);
-  glGenBuffers(1, &VBO);
-
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-  glBindVertexArray(containerVAO);
-  // Position attribute
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)0);
-  glEnableVertexAttribArray(0);
-  // Normal attribute
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
-  glEnableVertexAttribArray(2);
-  glBindVertexArray(0);
-
-  // Then, we set the light's VAO (VBO stays the same. After all, the vertices are the same for the light object (also a 3D cube))
-  GLuint lightVAO;
-  glGenVertexArrays(1, &lightVAO);
-  glBindVertexArray(lightVAO);
-  // We only need to bind to the VBO (to link it with glVertexAttribPointer), no need to fill it; the VBO's data already contains all we need.
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  // Set the vertex attributes (only position data for the lamp))
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)0);
-  glEnableVertexAttribArray(0);
-  glBindVertexArray(0);
-
-  // Load textures
-  GLuint diffuseMap, specularMap;
-  glGenTextures(1, &diffuseMap);
-  glGenTextures(1, &specularMap);
-  int width, height, channels;
-  unsigned char* image;
-  // Diffuse map
-  stbi_set_flip_vertically_on_load(1);
-  image = stbi_load((AssetsDir + "/assets/textures/container2.png").c_str(), &width, &height, &channels, 0);
-  HZ_CORE_ASSERT(image, "Failed to load image!");
-
-  glBindTexture(GL_TEXTURE_2D, diffuseMap);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-  glGenerateMipmap(GL_TEXTURE_2D);
-  stbi_image_free(image);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-
-  image = stbi_load((AssetsDir + "/assets/textures/container2_specular.png").c_str(), &width, &height, &channels, 0);
-  glBindTexture(GL_TEXTURE_2D, specularMap);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-  glGenerateMipmap(GL_TEXTURE_2D);
-  stbi_image_free(image);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-
-  glBindTexture(GL_TEXTURE_2D, 0);
-
-  lightingShader->Bind();
-  lightingShader->UploadUniformInt("material.diffuse", 0);
-  lightingShader->UploadUniformInt("material.specular", 1);
+  // Everything holding GL objects is gone by the time run returns
+  int result = run(window);
+  glfwTerminate();
+  return result;
+}
+
+// Loads the scene and runs the main loop, with the window's context current
+int run(GLFWwindow* window)
+{
+  // Texture and buffer uploads, a few MiB per frame at most
+  Hazel::UploadScheduler uploads;
+
+  // Load the cube: one mesh, drawn indexed, for the container, ground and lamp;
+  // imported on a worker while the textures are requested below
+  Hazel::Task<Hazel::Ref<Hazel::Mesh>> cubeLoad = Hazel::Mesh::LoadAsync(resolve_mesh("meshes/cube.obj"), {}, &uploads);
+  cubeLoad.Start();
+
+  // Load textures: decoded on worker threads, placeholders until they arrive
+  Hazel::TextureLoader textureLoader(uploads);
+  Hazel::TextureCache textureCache(textureLoader);
+  // Only coarse mips at first; finer ones follow the camera
+  Hazel::TextureStreamer textureStreamer(textureLoader);
+  uint32_t coarseSize = textureStreamer.GetSettings().CoarseSize;
+  Hazel::Task<Hazel::Ref<Hazel::Texture2D>> diffuseLoad = textureCache.LoadAsync(resolve_texture("textures/container2.png"), Hazel::TextureUsage::Color,
+    glm::vec4(0.5f, 0.5f, 0.5f, 1.0f), coarseSize);
+  Hazel::Task<Hazel::Ref<Hazel::Texture2D>> specularLoad = textureCache.LoadAsync(resolve_texture("textures/container2_specular.png"), Hazel::TextureUsage::Mask,
+    glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), coarseSize);
+  diffuseLoad.Start();
+  specularLoad.Start();
+
+  Hazel::Ref<Hazel::Mesh> cubeMesh = Hazel::RenderThread::Get().Wait(cubeLoad, [&]() { uploads.Update(); });
+  Hazel::Ref<Hazel::Texture2D> diffuseTexture = Hazel::RenderThread::Get().Wait(diffuseLoad, [&]() { uploads.Update(); });
+  Hazel::Ref<Hazel::Texture2D> specularTexture = Hazel::RenderThread::Get().Wait(specularLoad, [&]() { uploads.Update(); });
+  textureStreamer.Register(diffuseTexture);
+  textureStreamer.Register(specularTexture);
+  if (!cubeMesh)
+    return -1;
+
+  // Least recently used textures and buffers go once over the VRAM budget
+  Hazel::ResidencyManager residency(textureLoader);
+  residency.Track(diffuseTexture, true, false, coarseSize);
+  residency.Track(specularTexture, true, false, coarseSize);
+  for (const Hazel::Mesh::Buffer& buffer : cubeMesh->GetBuffers())
+  {
+    residency.TrackBuffer(buffer.ID, buffer.Size, [mesh = cubeMesh.get()](GLuint id) { mesh->Refill(id); },
+      { cubeMesh->GetVertexArray(), cubeMesh->GetDepthVertexArray() });
+  }
+  GLuint diffuseMap = diffuseTexture->GetRendererID();
+  GLuint specularMap = specularTexture->GetRendererID();
+  bool texturesResident = false;
+
+  // The same maps packed into texture arrays, for the T toggle
+  Hazel::TexturePacker texturePacker;
+  uint32_t diffuseRegion = texturePacker.Add("textures/container2.png");
+  uint32_t specularRegion = texturePacker.Add("textures/container2_specular.png", Hazel::TextureUsage::Mask);
+  texturePacker.Build();
+  {
+    const auto& packerStats = texturePacker.GetStats();
+    HZ_INFO("Packed {0} textures into {1} arrays ({2} layers, {3} atlased) in {4:.2f} ms, {5:.2f} MiB",
+      packerStats.Images, packerStats.Arrays, packerStats.Layers, packerStats.AtlasedImages, packerStats.BuildMs,
+      packerStats.MemorySize / (1024.0f * 1024.0f));
+  }
+
+  Hazel::SceneRenderer renderer(WIDTH, HEIGHT);
+  renderer.SetResidencyManager(&residency);
+
+  // Build the scene
+  Hazel::Scene scene;
+  Hazel::Registry& registry = scene.GetRegistry();
+
+  Hazel::MeshRendererComponent containerMesh{ .DiffuseMap = diffuseMap, .SpecularMap = specularMap, .Shininess = 64.0f, .Static = true };
+  cubeMesh->SetGeometry(containerMesh);
+  containerMesh.DiffuseRegion = texturePacker.GetRegion(diffuseRegion);
+  containerMesh.SpecularRegion = texturePacker.GetRegion(specularRegion);
+
+  Hazel::Entity container = scene.CreateEntity(glm::vec3(0.0f));
+  registry.Add(container, containerMesh);
+  registry.Add(container, cubeMesh->GetBounds());
+
+  // A flat slab under the container to receive its shadow
+  Hazel::Entity ground = scene.CreateEntity(glm::vec3(0.0f, -0.6f, 0.0f));
+  scene.GetTransforms().SetLocalScale(scene.GetTransform(ground), glm::vec3(20.0f, 0.1f, 20.0f));
+  Hazel::MeshRendererComponent groundMesh = containerMesh;
+  groundMesh.Shininess = 16.0f;
+  registry.Add(ground, groundMesh);
+  registry.Add(ground, cubeMesh->GetBounds());
+
+  Hazel::Entity sun = registry.Create();
+  registry.Add(sun, Hazel::DirectionalLightComponent{});
+
+  Hazel::Entity lamp = scene.CreateEntity(glm::vec3(1.2f, 1.0f, 2.0f));
+  scene.GetTransforms().SetLocalScale(scene.GetTransform(lamp), glm::vec3(0.2f)); // Make it a smaller cube
+  Hazel::MeshRendererComponent lampMesh{ .Shininess = 0.0f, .Emissive = true };
+  cubeMesh->SetGeometry(lampMesh);
+  registry.Add(lamp, lampMesh);
+  registry.Add(lamp, Hazel::LightComponent{});
+  registry.Add(lamp, cubeMesh->GetBounds());
+
+  // Crates scattered over an endless plane, streamed in and out around the camera
+  const float cellSize = 16.0f;
+  std::string crateMeshPath = resolve_mesh("meshes/cube.obj");
+  std::string crateDiffusePath = resolve_texture("textures/container2.png");
+  std::string crateSpecularPath = resolve_texture("textures/container2_specular.png");
+  Hazel::WorldStreamer world(scene, textureLoader, uploads, [=](Hazel::CellCoord cell, Hazel::CellDesc& desc)
+  {
+    std::mt19937 rng((uint32_t)cell.X * 73856093u ^ (uint32_t)cell.Z * 19349663u);
+    std::uniform_real_distribution<float> offset(1.0f, cellSize - 1.0f), scale(0.5f, 1.5f);
+    for (uint32_t count = rng() % 4; count > 0; count--)
+    {
+      Hazel::CellObject crate;
+      crate.Mesh = crateMeshPath;
+      crate.DiffuseMap = crateDiffusePath;
+      crate.SpecularMap = crateSpecularPath;
+      crate.Scale = glm::vec3(scale(rng));
+      // Standing on the ground, and clear of the container
+      crate.Position = glm::vec3(offset(rng), crate.Scale.y * 0.5f - 0.5f, offset(rng));
+      if (glm::length(glm::vec2(cell.X * cellSize + crate.Position.x, cell.Z * cellSize + crate.Position.z)) > 4.0f)
+        desc.Objects.push_back(crate);
+    }
+  }, &textureStreamer);
+  world.GetSettings().CellSize = cellSize;
+
+  std::vector<Hazel::Entity> extraLights;
+  float statsTimer = 0.0f;
 
   /* Loop until the user closes the window */
   while (!glfwWindowShouldClose(window))
@@ -204,6 +248,30 @@ int main(void)
     glfwPollEvents();
     do_movement();
 
+    if (lightCountChanged)
+    {
+      lightCountChanged = false;
+      set_light_count(scene, extraLights, LIGHT_COUNTS[lightCountIndex]);
+    }
+
+    Hazel::RenderThread::Get().Execute();
+    world.Update(camera.Position, camera.Front);
+    textureLoader.Update();
+    uploads.Update();
+    if (!texturesResident && textureLoader.GetPendingCount() == 0)
+    {
+      texturesResident = true;
+      const auto& textureStats = textureLoader.GetStats();
+      const auto& cacheStats = textureCache.GetStats();
+      HZ_INFO("{0} textures resident after {1:.2f} ms (slowest decode {2:.2f} ms, all decodes {3:.2f} ms of which mips {8:.2f} ms), {4:.2f} MiB ({5:.2f} MiB saved over RGBA8), {6} path hits, {7} content hits",
+        cacheStats.ResidentCount, textureStats.BatchMs, textureStats.DecodeMsMax, textureStats.DecodeMsTotal,
+        cacheStats.ResidentBytes / (1024.0f * 1024.0f), (cacheStats.ResidentBytesAsRGBA8 - std::min(cacheStats.ResidentBytes, cacheStats.ResidentBytesAsRGBA8)) / (1024.0f * 1024.0f),
+        cacheStats.PathHits, cacheStats.ContentHits, textureStats.MipMsTotal);
+    }
+
+    // Only transforms touched since the last frame get their matrices rebuilt
+    scene.OnUpdate();
+
     // Clear the colorbuffer
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -215,81 +283,68 @@ int main(void)
     /*glm::vec3 diffuseColor = lightColor * glm::vec3(0.5f);
     glm::vec3 ambientColor = diffuseColor * glm::vec3(0.2f);*/
 
-    // Use cooresponding shader when setting uniforms/drawing objects
-    lightingShader->Bind();
-    lightingShader->UploadUniformFloat3("light.position", glm::vec3(1.0f, 1.0f, 1.0f));
-    lightingShader->UploadUniformFloat3("viewPos", camera.Position);
-
-    //lightingShader->UploadUniformFloat3("material.specular", glm::vec3(0.5f, 0.5f, 0.5f));
-    lightingShader->UploadUniformFloat("material.shininess", 64.0f);
-
-    lightingShader->UploadUniformFloat3("light.ambient", glm::vec3(0.2f, 0.2f, 0.2f));
-    lightingShader->UploadUniformFloat3("light.diffuse", glm::vec3(0.5f, 0.5f, 0.5f));
-    lightingShader->UploadUniformFloat3("light.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-
-    /*GLint objectColorLoc = glGetUniformLocation(lightingShader.Program, "objectColor");
-    GLint lightColorLoc = glGetUniformLocation(lightingShader.Program, "lightColor");
-    glUniform3f(objectColorLoc, 1.0f, 0.5f, 0.31f);
-    glUniform3f(lightColorLoc, 1.0f, 0.5f, 1.0f);*/
-
     // Create camera transformations
-    glm::mat4 view;
-    view = camera.GetViewMatrix();
-    glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (GLfloat)WIDTH / (GLfloat)HEIGHT, 0.1f, 100.0f);
-    // Get the uniform locations
-    lightingShader->UploadUniformMat4("view", glm::mat4(view));
-    lightingShader->UploadUniformMat4("projection", glm::mat4(projection));
-
-    //GLint modelLoc = glGetUniformLocation(lightingShader.Program, "model");
-    //GLint viewLoc = glGetUniformLocation(lightingShader.Program, "view");
-    //GLint projLoc = glGetUniformLocation(lightingShader.Program, "projection");
-    //// Pass the matrices to the shader
-    //glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    //glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
-    // Bind diffuse map
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, diffuseMap);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, specularMap);
-
-    // Draw the container (using container's vertex attributes)
-    glBindVertexArray(containerVAO);
-    glm::mat4 model(1.0f);
-    //model = glm::rotate(model, glm::radians(20.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-    //model = glm::rotate(model, glm::radians(-20.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    lightingShader->UploadUniformMat4("model", glm::mat4(model));
-    //glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
-
-    // Also draw the lamp object, again binding the appropriate shader
-    lampShader->Bind();
-    // Get location objects for the matrices on the lamp shader (these could be different on a different shader)
-
-    lampShader->UploadUniformMat4("view", glm::mat4(view));
-    lampShader->UploadUniformMat4("projection", glm::mat4(projection));
-    /*modelLoc = glGetUniformLocation(lampShader.Program, "model");
-    viewLoc = glGetUniformLocation(lampShader.Program, "view");
-    projLoc = glGetUniformLocation(lampShader.Program, "projection");*/
-    // Set matrices
-    /*glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));*/
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, lightPos);
-    model = glm::scale(model, glm::vec3(0.2f)); // Make it a smaller cube
-    lampShader->UploadUniformMat4("model", glm::mat4(model));
-    //glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    // Draw the light object (using light's vertex attributes)
-    glBindVertexArray(lightVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
+    Hazel::RenderCamera renderCamera;
+    renderCamera.View = camera.GetViewMatrix();
+    renderCamera.Position = camera.Position;
+    renderCamera.FovY = glm::radians(camera.Zoom);
+    renderCamera.Aspect = (GLfloat)WIDTH / (GLfloat)HEIGHT;
+    renderCamera.Near = 0.1f;
+    renderCamera.Far = 100.0f;
+    renderCamera.Projection = glm::perspective(renderCamera.FovY, renderCamera.Aspect, renderCamera.Near, renderCamera.Far);
+
+    textureStreamer.Update(scene, renderCamera, HEIGHT);
+
+    renderer.SetRenderPath(useDeferred ? Hazel::RenderPath::Deferred : Hazel::RenderPath::Forward);
+    renderer.SetDepthPrepass(useDepthPrepass);
+    renderer.SetTextureArrays(useTextureArrays);
+    renderer.Render(scene, renderCamera);
+    residency.Update();
+
+    statsTimer += deltaTime;
+    if (statsTimer > 2.0f)
+    {
+      statsTimer = 0.0f;
+      const auto& stats = renderer.GetStats();
+      HZ_INFO("{0}{1} | frame {2:.2f} ms | depth pre-pass {3:.2f} ms, geometry pass {4:.2f} ms, lighting pass {5:.2f} ms GPU | {6} lights ({7} visible), cluster build {8:.3f} ms, max {9} lights/cluster | {10} draws, {11} texture binds{12}",
+        stats.Path == Hazel::RenderPath::Deferred ? "deferred" : "forward", stats.DepthPrepass ? " + depth pre-pass" : "",
+        deltaTime * 1000.0f, stats.DepthPrepassGpuMs, stats.GeometryPassGpuMs, stats.LightingPassGpuMs,
+        stats.Lighting.LightCount, stats.Lighting.VisibleLightCount, stats.Lighting.BuildMs, stats.Lighting.MaxClusterLights,
+        stats.DrawCalls, stats.TextureBinds, stats.TextureArrays ? " (texture arrays)" : "");
+      const auto& streamStats = textureStreamer.GetStats();
+      HZ_INFO("  textures: {0:.2f} MiB resident, {1:.2f} MiB requested, {2:.2f} MiB fitted to the {3:.0f} MiB budget | {4} in flight, {5} levels requested, {6} evicted | {7:.3f} ms",
+        streamStats.ResidentBytes / (1024.0f * 1024.0f), streamStats.RequestedBytes / (1024.0f * 1024.0f), streamStats.TargetBytes / (1024.0f * 1024.0f),
+        textureStreamer.GetSettings().BudgetBytes / (1024.0f * 1024.0f), streamStats.RequestsInFlight, streamStats.LevelsRequested, streamStats.LevelsEvicted, streamStats.UpdateMs);
+      const auto& residencyStats = residency.GetStats();
+      HZ_INFO("  residency: {0} textures, {1} buffers, {2} resident ({3:.2f} MiB of {4:.0f} MiB{5}), {6} pinned, {7} used ({8:.2f} MiB) | {9} evicted, {10} reloaded this frame, {11} evicted ({12:.2f} MiB), {13} reloaded in total | {14:.3f} ms",
+        residencyStats.Textures, residencyStats.Buffers, residencyStats.Resident, residencyStats.ResidentBytes / (1024.0f * 1024.0f),
+        residency.GetSettings().BudgetBytes / (1024.0f * 1024.0f), residencyStats.OverBudget ? ", over budget" : "", residencyStats.Pinned,
+        residencyStats.Used, residencyStats.UsedBytes / (1024.0f * 1024.0f), residencyStats.Evictions, residencyStats.Reloads,
+        residencyStats.TotalEvictions, residencyStats.TotalEvictedBytes / (1024.0f * 1024.0f), residencyStats.TotalReloads, residencyStats.UpdateMs);
+      const auto& worldStats = world.GetStats();
+      HZ_INFO("  world: {0} cells resident, {1} loading, {2} queued, {3} entities | {4} loaded, {5} unloaded, {6} cancelled | load {7:.1f} ms last, {8:.1f} ms average, {9:.1f} ms max | {10:.3f} ms",
+        worldStats.ResidentCells, worldStats.LoadingCells, worldStats.QueuedCells, worldStats.Entities, worldStats.Loaded, worldStats.Unloaded, worldStats.Cancelled,
+        worldStats.LoadMsLast, worldStats.LoadMsAverage, worldStats.LoadMsMax, worldStats.UpdateMs);
+      const auto& uploadStats = uploads.GetStats();
+      HZ_INFO("  uploads: {0} queued ({1:.2f} MiB) | last frame {2} pieces, {3:.2f} MiB in {4:.3f} ms, max {5:.3f} ms | {6} done ({7:.2f} MiB), {8} frames at the budget, {9} short of staging",
+        uploadStats.QueueDepth, uploadStats.QueuedBytes / (1024.0f * 1024.0f), uploadStats.FramePieces, uploadStats.FrameBytes / (1024.0f * 1024.0f),
+        uploadStats.FrameMs, uploadStats.MaxFrameMs, uploadStats.Completed, uploadStats.TotalBytes / (1024.0f * 1024.0f),
+        uploadStats.BudgetLimitedFrames, uploadStats.StagingLimitedFrames);
+      if (stats.Shadows)
+      {
+        for (size_t i = 0; i < stats.Cascades.size(); i++)
+        {
+          const auto& cascade = stats.Cascades[i];
+          HZ_INFO("  cascade {0} (to {1:.1f}) | {2} | {3} draws, {4} culled | {5:.3f} ms GPU",
+            i, cascade.SplitFar, cascade.Cached ? "cached" : "rendered", cascade.DrawCalls, cascade.CulledCasters, cascade.GpuMs);
+        }
+      }
+    }
 
     /* Swap front and back buffers */
     glfwSwapBuffers(window);
   }
 
-  glfwTerminate();
   return 0;
 }
 
@@ -298,6 +353,17 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 {
   if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
     glfwSetWindowShouldClose(window, GL_TRUE);
+  if (key == GLFW_KEY_L && action == GLFW_PRESS)
+  {
+    lightCountIndex = (lightCountIndex + 1) % (sizeof(LIGHT_COUNTS) / sizeof(LIGHT_COUNTS[0]));
+    lightCountChanged = true;
+  }
+  if (key == GLFW_KEY_G && action == GLFW_PRESS)
+    useDeferred = !useDeferred;
+  if (key == GLFW_KEY_Z && action == GLFW_PRESS)
+    useDepthPrepass = !useDepthPrepass;
+  if (key == GLFW_KEY_T && action == GLFW_PRESS)
+    useTextureArrays = !useTextureArrays;
   if (key >= 0 && key < 1024)
   {
     if (action == GLFW_PRESS)
@@ -343,3 +409,68 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
   camera.ProcessMouseScroll(yoffset);
 }
+
+// Scatters small random point lights around the container, on top of the lamp
+void set_light_count(Hazel::Scene& scene, std::vector<Hazel::Entity>& lights, uint32_t count)
+{
+  for (Hazel::Entity light : lights)
+    scene.DestroyEntity(light);
+  lights.clear();
+
+  std::mt19937 rng(1337);
+  std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+  std::uniform_real_distribution<float> color(0.0f, 1.0f);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    Hazel::Entity light = scene.CreateEntity(glm::vec3(position(rng), position(rng) * 0.25f, position(rng)));
+    glm::vec3 tint(color(rng), color(rng), color(rng));
+    scene.GetRegistry().Add(light, Hazel::LightComponent{ glm::vec3(0.0f), tint * 0.5f, tint, 2.0f });
+    lights.push_back(light);
+  }
+
+  HZ_INFO("{0} extra point lights", count);
+}
+
+// Prefer a block-compressed copy cooked by AssetCooker next to the source image
+std::string resolve_texture(const std::string& path)
+{
+  std::string cooked = path.substr(0, path.find_last_of('.')) + ".ktx2";
+  return Hazel::VirtualFileSystem::Get().Exists(cooked) ? cooked : path;
+}
+
+// Likewise for meshes: the cooked copy is mapped and uploaded without parsing
+std::string resolve_mesh(const std::string& path)
+{
+  std::string cooked = path.substr(0, path.find_last_of('.')) + ".hzmesh";
+  return Hazel::VirtualFileSystem::Get().Exists(cooked) ? cooked : path;
+}
+
+// Mounts the pack or directory at path; by default assets.hzpak in the working
+// directory or next to the executable, where the asset-cooker target puts it,
+// or the source tree's assets during development
+bool mount_assets(const std::string& path, const std::string& executable)
+{
+  Hazel::VirtualFileSystem& assets = Hazel::VirtualFileSystem::Get();
+  std::string error;
+  if (!path.empty())
+  {
+    if (std::filesystem::is_directory(path) ? assets.MountDirectory(path) : assets.MountPack(path, error))
+      return true;
+    HZ_ERROR("Could not mount '{0}': {1}", path, error.empty() ? "not found" : error);
+    return false;
+  }
+
+  for (const std::filesystem::path& pack : { std::filesystem::path("assets.hzpak"), std::filesystem::path(executable).parent_path() / "assets.hzpak" })
+  {
+    if (!std::filesystem::exists(pack))
+      continue;
+    if (assets.MountPack(pack.string(), error))
+      return true;
+    HZ_ERROR("Could not mount {0}: {1}", pack.string(), error);
+    return false;
+  }
+  if (assets.MountDirectory(AssetsDir + "/assets"))
+    return true;
+  HZ_ERROR("No assets.hzpak and no asset directory at {0}/assets", AssetsDir);
+  return false;
+}
@@ -0,0 +1,535 @@
+#include "BlockCompression.h"
+
+#include <cfloat>
+#include <cmath>
+
+#include "Core/Simd.h"
+#include "Core/ThreadPool.h"
+
+namespace Hazel {
+
+  namespace {
+
+    // One array per channel so four texels fill a SIMD register.
+    struct alignas(16) Block
+    {
+      float Channel[4][16];
+    };
+
+    // Packs fields of up to 32 bits into a 128-bit block, lowest bit first.
+    class BitWriter
+    {
+    public:
+      void Write(uint32_t value, uint32_t bits)
+      {
+        for (uint32_t i = 0; i < bits; i++, m_Position++)
+        {
+          if (value >> i & 1)
+            m_Bytes[m_Position >> 3] |= (uint8_t)(1 << (m_Position & 7));
+        }
+      }
+
+      const uint8_t* GetBytes() const { return m_Bytes; }
+    private:
+      uint8_t m_Bytes[16] = {};
+      uint32_t m_Position = 0;
+    };
+
+  }
+
+  const char* BlockFormatToString(BlockFormat format)
+  {
+    switch (format)
+    {
+      case BlockFormat::BC1: return "BC1";
+      case BlockFormat::BC4: return "BC4";
+      case BlockFormat::BC5: return "BC5";
+      case BlockFormat::BC7: return "BC7";
+    }
+    return "Unknown";
+  }
+
+  uint32_t GetBlockSize(BlockFormat format)
+  {
+    return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+  }
+
+  size_t GetCompressedSize(BlockFormat format, uint32_t width, uint32_t height)
+  {
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+  }
+
+  // Nearest palette entry for every texel; returns the summed squared error.
+  static float FindIndices(const Block& block, uint32_t channels, const float (*palette)[4], uint32_t paletteSize, uint8_t* indices)
+  {
+    float error = 0.0f;
+#if HZ_SIMD_SSE2
+    for (uint32_t t = 0; t < 16; t += 4)
+    {
+      __m128 best = _mm_set1_ps(FLT_MAX);
+      __m128i bestIndex = _mm_setzero_si128();
+      for (uint32_t p = 0; p < paletteSize; p++)
+      {
+        __m128 distance = _mm_setzero_ps();
+        for (uint32_t c = 0; c < channels; c++)
+        {
+          __m128 delta = _mm_sub_ps(_mm_load_ps(&block.Channel[c][t]), _mm_set1_ps(palette[p][c]));
+          distance = _mm_add_ps(distance, _mm_mul_ps(delta, delta));
+        }
+
+        __m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+        bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32((int)p)), _mm_andnot_si128(closer, bestIndex));
+        best = _mm_min_ps(distance, best);
+      }
+
+      alignas(16) int32_t bestIndices[4];
+      alignas(16) float bestErrors[4];
+      _mm_store_si128((__m128i*)bestIndices, bestIndex);
+      _mm_store_ps(bestErrors, best);
+      for (uint32_t i = 0; i < 4; i++)
+      {
+        indices[t + i] = (uint8_t)bestIndices[i];
+        error += bestErrors[i];
+      }
+    }
+#else
+    for (uint32_t t = 0; t < 16; t++)
+    {
+      float best = FLT_MAX;
+      for (uint32_t p = 0; p < paletteSize; p++)
+      {
+        float distance = 0.0f;
+        for (uint32_t c = 0; c < channels; c++)
+        {
+          float delta = block.Channel[c][t] - palette[p][c];
+          distance += delta * delta;
+        }
+
+        if (distance < best)
+        {
+          best = distance;
+          indices[t] = (uint8_t)p;
+        }
+      }
+      error += best;
+    }
+#endif
+    return error;
+  }
+
+  // Extremes of the texels along their principal axis.
+  static void FindEndpoints(const Block& block, uint32_t channels, float* lo, float* hi)
+  {
+    float mean[4] = {};
+    for (uint32_t c = 0; c < channels; c++)
+    {
+      for (uint32_t t = 0; t < 16; t++)
+        mean[c] += block.Channel[c][t];
+      mean[c] /= 16.0f;
+    }
+
+    float covariance[4][4] = {};
+    for (uint32_t t = 0; t < 16; t++)
+    {
+      for (uint32_t i = 0; i < channels; i++)
+      {
+        for (uint32_t j = i; j < channels; j++)
+          covariance[i][j] += (block.Channel[i][t] - mean[i]) * (block.Channel[j][t] - mean[j]);
+      }
+    }
+    for (uint32_t i = 0; i < channels; i++)
+    {
+      for (uint32_t j = 0; j < i; j++)
+        covariance[i][j] = covariance[j][i];
+    }
+
+    // Power iteration, seeded with the diagonal of the bounding box.
+    float axis[4] = {};
+    for (uint32_t c = 0; c < channels; c++)
+    {
+      float minValue = FLT_MAX, maxValue = -FLT_MAX;
+      for (uint32_t t = 0; t < 16; t++)
+      {
+        minValue = std::min(minValue, block.Channel[c][t]);
+        maxValue = std::max(maxValue, block.Channel[c][t]);
+      }
+      axis[c] = maxValue - minValue;
+    }
+
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+      float next[4] = {};
+      float length = 0.0f;
+      for (uint32_t i = 0; i < channels; i++)
+      {
+        for (uint32_t j = 0; j < channels; j++)
+          next[i] += covariance[i][j] * axis[j];
+        length = std::max(length, std::abs(next[i]));
+      }
+      if (length < 1e-6f)
+        break;
+
+      for (uint32_t i = 0; i < channels; i++)
+        axis[i] = next[i] / length;
+    }
+
+    float lengthSquared = 0.0f;
+    for (uint32_t c = 0; c < channels; c++)
+      lengthSquared += axis[c] * axis[c];
+
+    float minT = 0.0f, maxT = 0.0f;
+    if (lengthSquared > 1e-12f)
+    {
+      minT = FLT_MAX;
+      maxT = -FLT_MAX;
+      for (uint32_t t = 0; t < 16; t++)
+      {
+        float projection = 0.0f;
+        for (uint32_t c = 0; c < channels; c++)
+          projection += (block.Channel[c][t] - mean[c]) * axis[c];
+        minT = std::min(minT, projection);
+        maxT = std::max(maxT, projection);
+      }
+      minT /= lengthSquared;
+      maxT /= lengthSquared;
+    }
+
+    for (uint32_t c = 0; c < channels; c++)
+    {
+      lo[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+      hi[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+    }
+  }
+
+  // Least-squares endpoints for fixed interpolation weights (0 = lo, 1 = hi).
+  static bool RefineEndpoints(const Block& block, uint32_t channels, const float* weights, float* lo, float* hi)
+  {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+    for (uint32_t t = 0; t < 16; t++)
+    {
+      float b = weights[t], a = 1.0f - b;
+      aa += a * a;
+      ab += a * b;
+      bb += b * b;
+      for (uint32_t c = 0; c < channels; c++)
+      {
+        ax[c] += a * block.Channel[c][t];
+        bx[c] += b * block.Channel[c][t];
+      }
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) < 1e-6f)
+      return false;
+
+    for (uint32_t c = 0; c < channels; c++)
+    {
+      lo[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+      hi[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+    }
+    return true;
+  }
+
+  static uint16_t To565(const float* color)
+  {
+    uint32_t r = (uint32_t)std::lround(color[0] * 31.0f / 255.0f);
+    uint32_t g = (uint32_t)std::lround(color[1] * 63.0f / 255.0f);
+    uint32_t b = (uint32_t)std::lround(color[2] * 31.0f / 255.0f);
+    return (uint16_t)(r << 11 | g << 5 | b);
+  }
+
+  static void From565(uint16_t value, float* color)
+  {
+    uint32_t r = value >> 11 & 31, g = value >> 5 & 63, b = value & 31;
+    color[0] = (float)(r << 3 | r >> 2);
+    color[1] = (float)(g << 2 | g >> 4);
+    color[2] = (float)(b << 3 | b >> 2);
+    color[3] = 255.0f;
+  }
+
+  // Encodes BC1 endpoints in four-color mode; returns the block error.
+  static float EncodeBC1Endpoints(const Block& block, const float* lo, const float* hi, uint8_t* output, uint8_t* indices)
+  {
+    uint16_t color0 = To565(hi), color1 = To565(lo);
+    if (color0 < color1)
+      std::swap(color0, color1);
+
+    float palette[4][4];
+    From565(color0, palette[0]);
+    From565(color1, palette[1]);
+    for (uint32_t c = 0; c < 3; c++)
+    {
+      palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+      palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+    }
+
+    // With equal endpoints the block is in three-color mode; index 0 is still color0.
+    uint32_t paletteSize = color0 == color1 ? 1 : 4;
+    float error = FindIndices(block, 3, palette, paletteSize, indices);
+
+    uint32_t bits = 0;
+    for (uint32_t t = 0; t < 16; t++)
+      bits |= (uint32_t)indices[t] << (t * 2);
+
+    memcpy(output, &color0, 2);
+    memcpy(output + 2, &color1, 2);
+    memcpy(output + 4, &bits, 4);
+    return error;
+  }
+
+  static void EncodeBC1(const Block& block, uint8_t* output)
+  {
+    float lo[4], hi[4];
+    FindEndpoints(block, 3, lo, hi);
+
+    uint8_t indices[16];
+    float error = EncodeBC1Endpoints(block, lo, hi, output, indices);
+
+    // Weight of color1 for each palette index.
+    static const float Weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    float weights[16];
+    for (uint32_t t = 0; t < 16; t++)
+      weights[t] = Weights[indices[t]];
+
+    // Solved in palette order: color0 comes out first, color1 second.
+    float color0[4], color1[4];
+    if (RefineEndpoints(block, 3, weights, color0, color1))
+    {
+      uint8_t candidate[8];
+      if (EncodeBC1Endpoints(block, color1, color0, candidate, indices) < error)
+        memcpy(output, candidate, 8);
+    }
+  }
+
+  static void EncodeBC4(const float* values, uint8_t* output)
+  {
+    float minValue = 255.0f, maxValue = 0.0f;
+    for (uint32_t t = 0; t < 16; t++)
+    {
+      minValue = std::min(minValue, values[t]);
+      maxValue = std::max(maxValue, values[t]);
+    }
+
+    uint8_t red0 = (uint8_t)std::lround(maxValue), red1 = (uint8_t)std::lround(minValue);
+    output[0] = red0;
+    output[1] = red1;
+    memset(output + 2, 0, 6);
+    if (red0 == red1)
+      return;
+
+    // Eight-value mode: index 0 is red0, 1 is red1, 2-7 step from red0 to red1.
+    float palette[8];
+    palette[0] = red0;
+    palette[1] = red1;
+    for (uint32_t i = 2; i < 8; i++)
+      palette[i] = ((8 - i) * red0 + (i - 1) * red1) / 7.0f;
+
+    uint64_t bits = 0;
+    for (uint32_t t = 0; t < 16; t++)
+    {
+      uint32_t best = 0;
+      float bestDistance = FLT_MAX;
+      for (uint32_t i = 0; i < 8; i++)
+      {
+        float distance = std::abs(values[t] - palette[i]);
+        if (distance < bestDistance)
+        {
+          bestDistance = distance;
+          best = i;
+        }
+      }
+      bits |= (uint64_t)best << (t * 3);
+    }
+
+    for (uint32_t i = 0; i < 6; i++)
+      output[2 + i] = (uint8_t)(bits >> (i * 8));
+  }
+
+  // BC7 mode 6: one subset, RGBA endpoints of 7 bits plus a p-bit each, 4-bit indices.
+  static const int BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+  struct BC7Candidate
+  {
+    uint32_t Endpoints[2][4];
+    uint32_t PBits[2];
+    uint8_t Indices[16];
+    float Error = FLT_MAX;
+  };
+
+  static void TryBC7Endpoints(const Block& block, const float* lo, const float* hi, BC7Candidate& best)
+  {
+    for (uint32_t pbits = 0; pbits < 4; pbits++)
+    {
+      BC7Candidate candidate;
+      candidate.PBits[0] = pbits & 1;
+      candidate.PBits[1] = pbits >> 1;
+
+      int values[2][4];
+      for (uint32_t c = 0; c < 4; c++)
+      {
+        const float* source[2] = { lo, hi };
+        for (uint32_t e = 0; e < 2; e++)
+        {
+          int quantized = (int)std::lround((source[e][c] - candidate.PBits[e]) * 0.5f);
+          candidate.Endpoints[e][c] = (uint32_t)std::clamp(quantized, 0, 127);
+          values[e][c] = (int)(candidate.Endpoints[e][c] << 1 | candidate.PBits[e]);
+        }
+      }
+
+      float palette[16][4];
+      for (uint32_t i = 0; i < 16; i++)
+      {
+        for (uint32_t c = 0; c < 4; c++)
+          palette[i][c] = (float)(((64 - BC7Weights[i]) * values[0][c] + BC7Weights[i] * values[1][c] + 32) >> 6);
+      }
+
+      candidate.Error = FindIndices(block, 4, palette, 16, candidate.Indices);
+      if (candidate.Error < best.Error)
+        best = candidate;
+    }
+  }
+
+  static void EncodeBC7(const Block& block, uint8_t* output)
+  {
+    float lo[4], hi[4];
+    FindEndpoints(block, 4, lo, hi);
+
+    BC7Candidate best;
+    TryBC7Endpoints(block, lo, hi, best);
+
+    float weights[16];
+    for (uint32_t t = 0; t < 16; t++)
+      weights[t] = BC7Weights[best.Indices[t]] / 64.0f;
+    if (RefineEndpoints(block, 4, weights, lo, hi))
+      TryBC7Endpoints(block, lo, hi, best);
+
+    // The anchor texel's index has an implied zero top bit.
+    if (best.Indices[0] & 8)
+    {
+      std::swap(best.Endpoints[0], best.Endpoints[1]);
+      std::swap(best.PBits[0], best.PBits[1]);
+      for (uint8_t& index : best.Indices)
+        index = 15 - index;
+    }
+
+    BitWriter writer;
+    writer.Write(1 << 6, 7);
+    for (uint32_t c = 0; c < 4; c++)
+    {
+      writer.Write(best.Endpoints[0][c], 7);
+      writer.Write(best.Endpoints[1][c], 7);
+    }
+    writer.Write(best.PBits[0], 1);
+    writer.Write(best.PBits[1], 1);
+    writer.Write(best.Indices[0], 3);
+    for (uint32_t t = 1; t < 16; t++)
+      writer.Write(best.Indices[t], 4);
+
+    memcpy(output, writer.GetBytes(), 16);
+  }
+
+  void CompressBlock(BlockFormat format, const uint8_t* texels, uint8_t* output)
+  {
+    Block block;
+    for (uint32_t t = 0; t < 16; t++)
+    {
+      for (uint32_t c = 0; c < 4; c++)
+        block.Channel[c][t] = texels[t * 4 + c];
+    }
+
+    switch (format)
+    {
+      case BlockFormat::BC1:
+        EncodeBC1(block, output);
+        break;
+      case BlockFormat::BC4:
+        EncodeBC4(block.Channel[0], output);
+        break;
+      case BlockFormat::BC5:
+        EncodeBC4(block.Channel[0], output);
+        EncodeBC4(block.Channel[1], output + 8);
+        break;
+      case BlockFormat::BC7:
+        EncodeBC7(block, output);
+        break;
+    }
+  }
+
+  void CompressImage(BlockFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* output)
+  {
+    uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    uint32_t blockSize = GetBlockSize(format);
+
+    ThreadPool::Get().ParallelFor(blocksY, 1, [&](uint32_t begin, uint32_t end)
+    {
+      uint8_t texels[64];
+      for (uint32_t by = begin; by < end; by++)
+      {
+        for (uint32_t bx = 0; bx < blocksX; bx++)
+        {
+          for (uint32_t y = 0; y < 4; y++)
+          {
+            uint32_t sy = std::min(by * 4 + y, height - 1);
+            for (uint32_t x = 0; x < 4; x++)
+            {
+              uint32_t sx = std::min(bx * 4 + x, width - 1);
+              memcpy(&texels[(y * 4 + x) * 4], &rgba[((size_t)sy * width + sx) * 4], 4);
+            }
+          }
+          CompressBlock(format, texels, output + ((size_t)by * blocksX + bx) * blockSize);
+        }
+      }
+    });
+  }
+
+  bool DecompressBC7(const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba)
+  {
+    uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    for (uint32_t by = 0; by < blocksY; by++)
+    {
+      for (uint32_t bx = 0; bx < blocksX; bx++)
+      {
+        const uint8_t* block = blocks + ((size_t)by * blocksX + bx) * 16;
+        if ((block[0] & 0x7F) != 1 << 6)
+          return false;
+
+        uint64_t bits[2];
+        memcpy(bits, block, 16);
+        uint32_t position = 7;
+        auto read = [&](uint32_t count)
+        {
+          uint32_t value = 0;
+          for (uint32_t i = 0; i < count; i++, position++)
+            value |= (uint32_t)(bits[position / 64] >> (position % 64) & 1) << i;
+          return value;
+        };
+
+        int values[2][4];
+        for (uint32_t c = 0; c < 4; c++)
+        {
+          values[0][c] = (int)read(7);
+          values[1][c] = (int)read(7);
+        }
+        for (uint32_t e = 0; e < 2; e++)
+        {
+          uint32_t pbit = read(1);
+          for (uint32_t c = 0; c < 4; c++)
+            values[e][c] = values[e][c] << 1 | (int)pbit;
+        }
+
+        for (uint32_t t = 0; t < 16; t++)
+        {
+          int weight = BC7Weights[read(t == 0 ? 3 : 4)];
+          uint32_t x = bx * 4 + t % 4, y = by * 4 + t / 4;
+          if (x >= width || y >= height)
+            continue;
+          for (uint32_t c = 0; c < 4; c++)
+            rgba[((size_t)y * width + x) * 4 + c] = (uint8_t)(((64 - weight) * values[0][c] + weight * values[1][c] + 32) >> 6);
+        }
+      }
+    }
+    return true;
+  }
+
+}
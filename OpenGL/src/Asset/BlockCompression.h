@@ -0,0 +1,37 @@
+#pragma once
+
+namespace Hazel {
+
+  // 4x4 block-compressed formats the cooker can produce.
+  enum class BlockFormat
+  {
+    // RGB at 4 bits per texel; opaque color.
+    BC1,
+    // One channel at 4 bits per texel; masks.
+    BC4,
+    // Two channels at 8 bits per texel; normal maps and other data.
+    BC5,
+    // RGBA at 8 bits per texel; color with or without alpha.
+    BC7
+  };
+
+  const char* BlockFormatToString(BlockFormat format);
+
+  // Bytes per 4x4 block.
+  uint32_t GetBlockSize(BlockFormat format);
+  size_t GetCompressedSize(BlockFormat format, uint32_t width, uint32_t height);
+
+  // Encodes one block of 16 RGBA8 texels in row order. BC4 reads red, BC5 red
+  // and green, BC1 ignores alpha.
+  void CompressBlock(BlockFormat format, const uint8_t* texels, uint8_t* output);
+
+  // Encodes a tightly packed RGBA8 image, block rows spread over the ThreadPool.
+  // Partial blocks at the right and bottom edges repeat the last texel.
+  void CompressImage(BlockFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* output);
+
+  // Decodes a BC7 image to tightly packed RGBA8, for drivers without BPTC.
+  // Only mode 6 blocks, the ones CompressBlock writes, are read; false if
+  // there is any other.
+  bool DecompressBC7(const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba);
+
+}
@@ -0,0 +1,537 @@
+#include "GltfImporter.h"
+
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Core/Json.h"
+#include "Core/MappedFile.h"
+#include "Core/ThreadPool.h"
+
+namespace Hazel {
+
+  namespace {
+
+    constexpr uint32_t GlbMagic = 0x46546C67; // "glTF"
+    constexpr uint32_t GlbJsonChunk = 0x4E4F534A; // "JSON"
+    constexpr uint32_t GlbBinaryChunk = 0x004E4942; // "BIN\0"
+
+    enum GltfComponentType : uint32_t
+    {
+      GltfByte = 5120,
+      GltfUnsignedByte = 5121,
+      GltfShort = 5122,
+      GltfUnsignedShort = 5123,
+      GltfUnsignedInt = 5125,
+      GltfFloat = 5126
+    };
+
+    constexpr uint32_t GltfTriangles = 4;
+
+    struct GltfBuffer
+    {
+      const uint8_t* Data = nullptr;
+      size_t Size = 0;
+    };
+
+    // An accessor resolved to memory, its range checked.
+    struct GltfAccessor
+    {
+      const uint8_t* Data = nullptr;
+      size_t Stride = 0;
+      uint32_t Count = 0;
+      uint32_t ComponentType = 0;
+      uint32_t Components = 0;
+      bool Normalized = false;
+
+      float ReadFloat(uint32_t element, uint32_t component) const
+      {
+        const uint8_t* p = Data + element * Stride;
+        switch (ComponentType)
+        {
+          case GltfFloat: { float value; memcpy(&value, p + component * 4, 4); return value; }
+          case GltfUnsignedByte: return p[component] / 255.0f;
+          case GltfByte: return std::max((int8_t)p[component] / 127.0f, -1.0f);
+          case GltfUnsignedShort: { uint16_t value; memcpy(&value, p + component * 2, 2); return value / 65535.0f; }
+          case GltfShort: { int16_t value; memcpy(&value, p + component * 2, 2); return std::max(value / 32767.0f, -1.0f); }
+          default: return 0.0f;
+        }
+      }
+
+      uint32_t ReadIndex(uint32_t element) const
+      {
+        const uint8_t* p = Data + element * Stride;
+        switch (ComponentType)
+        {
+          case GltfUnsignedByte: return *p;
+          case GltfUnsignedShort: { uint16_t value; memcpy(&value, p, 2); return value; }
+          default: { uint32_t value; memcpy(&value, p, 4); return value; }
+        }
+      }
+    };
+
+    // One primitive as instanced by a node, with its place in the output.
+    struct GltfDraw
+    {
+      GltfAccessor Positions, Normals, TexCoords, Indices;
+      glm::mat4 Transform;
+      uint32_t FirstVertex = 0;
+      uint32_t FirstIndex = 0;
+      uint32_t IndexCount = 0;
+      uint32_t Material = 0;
+    };
+
+    // An index into a JSON array; out of range for anything but a non-negative number.
+    size_t ToIndex(const JsonValue& value)
+    {
+      return value.IsNumber() && value.GetNumber() >= 0.0 ? (size_t)value.GetNumber() : SIZE_MAX;
+    }
+
+    uint32_t GetComponentSize(uint32_t componentType)
+    {
+      switch (componentType)
+      {
+        case GltfByte: case GltfUnsignedByte: return 1;
+        case GltfShort: case GltfUnsignedShort: return 2;
+        case GltfUnsignedInt: case GltfFloat: return 4;
+        default: return 0;
+      }
+    }
+
+    uint32_t GetTypeComponents(const std::string& type)
+    {
+      if (type == "SCALAR") return 1;
+      if (type == "VEC2") return 2;
+      if (type == "VEC3") return 3;
+      if (type == "VEC4") return 4;
+      return 0;
+    }
+
+    bool DecodeBase64(const std::string& text, size_t begin, std::vector<uint8_t>& out)
+    {
+      static const std::array<int8_t, 256> Table = []()
+      {
+        std::array<int8_t, 256> table;
+        table.fill(-1);
+        const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i = 0; i < 64; i++)
+          table[(uint8_t)alphabet[i]] = (int8_t)i;
+        return table;
+      }();
+
+      out.clear();
+      out.reserve((text.size() - begin) / 4 * 3);
+      uint32_t bits = 0, bitCount = 0;
+      for (size_t i = begin; i < text.size() && text[i] != '='; i++)
+      {
+        int8_t value = Table[(uint8_t)text[i]];
+        if (value < 0)
+          return false;
+        bits = (bits << 6) | (uint32_t)value;
+        bitCount += 6;
+        if (bitCount >= 8)
+        {
+          bitCount -= 8;
+          out.push_back((uint8_t)(bits >> bitCount));
+        }
+      }
+      return true;
+    }
+
+    class GltfReader
+    {
+    public:
+      GltfReader(const JsonValue& json, const std::vector<GltfBuffer>& buffers) : m_Json(json), m_Buffers(buffers) {}
+
+      bool ReadAccessor(const JsonValue& index, GltfAccessor& accessor);
+      bool AddMesh(size_t meshIndex, const glm::mat4& transform, std::vector<GltfDraw>& draws);
+      bool AddNode(size_t nodeIndex, const glm::mat4& parent, std::vector<GltfDraw>& draws, int depth);
+
+      const std::string& GetError() const { return m_Error; }
+    private:
+      bool Fail(std::string message)
+      {
+        m_Error = std::move(message);
+        return false;
+      }
+    private:
+      const JsonValue& m_Json;
+      const std::vector<GltfBuffer>& m_Buffers;
+      std::string m_Error;
+    };
+
+    bool GltfReader::ReadAccessor(const JsonValue& index, GltfAccessor& accessor)
+    {
+      const JsonValue& json = m_Json["accessors"][ToIndex(index)];
+      if (!json.IsObject())
+        return Fail("missing accessor");
+      if (json.Has("sparse"))
+        return Fail("sparse accessors are not supported");
+
+      const JsonValue& view = m_Json["bufferViews"][ToIndex(json["bufferView"])];
+      size_t bufferIndex = ToIndex(view["buffer"]);
+      if (!view.IsObject() || bufferIndex >= m_Buffers.size())
+        return Fail("accessor without buffer data");
+
+      accessor.ComponentType = (uint32_t)json["componentType"].GetNumber();
+      accessor.Components = GetTypeComponents(json["type"].GetString());
+      accessor.Count = (uint32_t)json["count"].GetNumber();
+      accessor.Normalized = json["normalized"].GetBool();
+      size_t elementSize = (size_t)GetComponentSize(accessor.ComponentType) * accessor.Components;
+      if (elementSize == 0)
+        return Fail("bad accessor type");
+
+      size_t viewOffset = (size_t)view["byteOffset"].GetNumber();
+      size_t viewLength = (size_t)view["byteLength"].GetNumber();
+      size_t offset = (size_t)json["byteOffset"].GetNumber();
+      accessor.Stride = (size_t)view["byteStride"].GetNumber((double)elementSize);
+      const GltfBuffer& buffer = m_Buffers[bufferIndex];
+      if (viewOffset > buffer.Size || viewLength > buffer.Size - viewOffset
+        || (accessor.Count > 0 && offset + (accessor.Count - 1) * accessor.Stride + elementSize > viewLength))
+        return Fail("accessor out of range");
+
+      accessor.Data = buffer.Data + viewOffset + offset;
+      return true;
+    }
+
+    bool GltfReader::AddMesh(size_t meshIndex, const glm::mat4& transform, std::vector<GltfDraw>& draws)
+    {
+      const JsonValue& primitives = m_Json["meshes"][meshIndex]["primitives"];
+      for (size_t i = 0; i < primitives.GetSize(); i++)
+      {
+        const JsonValue& primitive = primitives[i];
+        // Points, lines and strips carry nothing we draw.
+        if ((uint32_t)primitive["mode"].GetNumber(GltfTriangles) != GltfTriangles)
+          continue;
+
+        GltfDraw draw;
+        draw.Transform = transform;
+        draw.Material = (uint32_t)primitive["material"].GetNumber();
+        const JsonValue& attributes = primitive["attributes"];
+        if (!ReadAccessor(attributes["POSITION"], draw.Positions))
+          return false;
+        if (draw.Positions.Count == 0)
+          continue;
+        if (draw.Positions.ComponentType != GltfFloat || draw.Positions.Components != 3)
+          return Fail("positions must be float3");
+        if (attributes.Has("NORMAL") && !ReadAccessor(attributes["NORMAL"], draw.Normals))
+          return false;
+        if (attributes.Has("TEXCOORD_0") && !ReadAccessor(attributes["TEXCOORD_0"], draw.TexCoords))
+          return false;
+        if ((draw.Normals.Data && (draw.Normals.Count != draw.Positions.Count || draw.Normals.Components != 3))
+          || (draw.TexCoords.Data && (draw.TexCoords.Count != draw.Positions.Count || draw.TexCoords.Components != 2)))
+          return Fail("attributes differ in length");
+
+        if (primitive.Has("indices"))
+        {
+          if (!ReadAccessor(primitive["indices"], draw.Indices))
+            return false;
+          if (draw.Indices.Components != 1 || (draw.Indices.ComponentType != GltfUnsignedByte && draw.Indices.ComponentType != GltfUnsignedShort
+        && draw.Indices.ComponentType != GltfUnsignedInt))
+            return Fail("bad index accessor");
+          draw.IndexCount = draw.Indices.Count;
+        }
+        else
+        {
+          draw.IndexCount = draw.Positions.Count;
+        }
+        draw.IndexCount -= draw.IndexCount % 3;
+        draws.push_back(draw);
+      }
+      return true;
+    }
+
+    bool GltfReader::AddNode(size_t nodeIndex, const glm::mat4& parent, std::vector<GltfDraw>& draws, int depth)
+    {
+      const JsonValue& node = m_Json["nodes"][nodeIndex];
+      if (!node.IsObject() || depth > 64)
+        return Fail("bad node hierarchy");
+
+      glm::mat4 local(1.0f);
+      const JsonValue& matrix = node["matrix"];
+      if (matrix.GetSize() == 16)
+      {
+        for (int i = 0; i < 16; i++)
+          local[i / 4][i % 4] = (float)matrix[i].GetNumber();
+      }
+      else
+      {
+        const JsonValue& t = node["translation"];
+        const JsonValue& r = node["rotation"];
+        const JsonValue& s = node["scale"];
+        glm::vec3 translation(t[0].GetNumber(), t[1].GetNumber(), t[2].GetNumber());
+        glm::quat rotation((float)r[3].GetNumber(1.0), (float)r[0].GetNumber(), (float)r[1].GetNumber(), (float)r[2].GetNumber());
+        glm::vec3 scale(s[0].GetNumber(1.0), s[1].GetNumber(1.0), s[2].GetNumber(1.0));
+        local = glm::mat4_cast(rotation);
+        for (int i = 0; i < 3; i++)
+          local[i] *= scale[i];
+        local[3] = glm::vec4(translation, 1.0f);
+      }
+
+      glm::mat4 world = parent * local;
+      if (node.Has("mesh") && !AddMesh(ToIndex(node["mesh"]), world, draws))
+        return false;
+
+      const JsonValue& children = node["children"];
+      for (size_t i = 0; i < children.GetSize(); i++)
+      {
+        if (!AddNode(ToIndex(children[i]), world, draws, depth + 1))
+          return false;
+      }
+      return true;
+    }
+
+    // The JSON of a .gltf, or of a .glb and its binary chunk for buffer 0.
+    bool ParseGltfJson(const uint8_t* data, size_t size, JsonValue& json, GltfBuffer& binaryChunk, std::string& error)
+    {
+      // A .glb is a JSON chunk followed by an optional binary chunk for buffer 0.
+      const char* text = (const char*)data;
+      size_t textSize = size;
+      uint32_t header[5];
+      if (size >= sizeof(header) && (memcpy(header, data, sizeof(header)), header[0] == GlbMagic))
+      {
+        if (header[1] != 2 || header[2] > size || header[2] < 20 || header[4] != GlbJsonChunk || header[3] > header[2] - 20)
+        {
+          error = "bad GLB header";
+          return false;
+        }
+        text = (const char*)data + 20;
+        textSize = header[3];
+
+        size_t offset = 20 + ((textSize + 3) & ~(size_t)3);
+        uint32_t chunk[2];
+        if (offset + 8 <= header[2] && (memcpy(chunk, data + offset, 8), chunk[1] == GlbBinaryChunk) && chunk[0] <= header[2] - offset - 8)
+          binaryChunk = { data + offset + 8, chunk[0] };
+      }
+
+      if (!JsonValue::Parse(text, textSize, json, error))
+        return false;
+      if (json["asset"]["version"].GetString().rfind("2", 0) != 0)
+      {
+        error = "not a glTF 2.0 file";
+        return false;
+      }
+      return true;
+    }
+
+    bool IsExternalUri(const std::string& uri)
+    {
+      return !uri.empty() && uri.rfind("data:", 0) != 0;
+    }
+
+    // Vertices [begin, end) of a draw into the streams.
+    void ConvertVertices(const GltfDraw& draw, uint32_t begin, uint32_t end, MeshData& mesh)
+    {
+      std::vector<float>& positions = mesh.Streams[(size_t)VertexSemantic::Position];
+      std::vector<float>& normals = mesh.Streams[(size_t)VertexSemantic::Normal];
+      std::vector<float>& texCoords = mesh.Streams[(size_t)VertexSemantic::TexCoord];
+      glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(draw.Transform)));
+
+      for (uint32_t i = begin; i < end; i++)
+      {
+        size_t vertex = draw.FirstVertex + i;
+        glm::vec4 position = draw.Transform * glm::vec4(draw.Positions.ReadFloat(i, 0), draw.Positions.ReadFloat(i, 1), draw.Positions.ReadFloat(i, 2), 1.0f);
+        for (int c = 0; c < 3; c++)
+          positions[vertex * 3 + c] = position[c];
+
+        if (!normals.empty() && draw.Normals.Data)
+        {
+          glm::vec3 normal = normalMatrix * glm::vec3(draw.Normals.ReadFloat(i, 0), draw.Normals.ReadFloat(i, 1), draw.Normals.ReadFloat(i, 2));
+          float length = glm::length(normal);
+          normal = length > 0.0f ? normal / length : normal;
+          for (int c = 0; c < 3; c++)
+            normals[vertex * 3 + c] = normal[c];
+        }
+        if (!texCoords.empty() && draw.TexCoords.Data)
+        {
+          texCoords[vertex * 2 + 0] = draw.TexCoords.ReadFloat(i, 0);
+          texCoords[vertex * 2 + 1] = 1.0f - draw.TexCoords.ReadFloat(i, 1);
+        }
+      }
+    }
+
+    // Indices [begin, end) of a draw, begin and end on triangle boundaries.
+    void ConvertIndices(const GltfDraw& draw, uint32_t begin, uint32_t end, MeshData& mesh)
+    {
+      // A mirroring transform turns the triangles inside out; swap two corners back.
+      bool mirrored = glm::determinant(glm::mat3(draw.Transform)) < 0.0f;
+      for (uint32_t i = begin; i < end; i++)
+      {
+        uint32_t corner = mirrored ? i - i % 3 + (2 - i % 3) : i;
+        uint32_t index = draw.Indices.Data ? draw.Indices.ReadIndex(corner) : corner;
+        // Out-of-range indices would read past the vertex streams on the GPU.
+        mesh.Indices[draw.FirstIndex + i] = draw.FirstVertex + std::min(index, draw.Positions.Count - 1);
+      }
+    }
+
+  }
+
+  bool ImportGltf(const uint8_t* data, size_t size, const std::string& baseDirectory, MeshData& mesh, std::string& error, const GltfImportSettings& settings)
+  {
+    mesh = MeshData();
+
+    JsonValue json;
+    GltfBuffer binaryChunk;
+    if (!ParseGltfJson(data, size, json, binaryChunk, error))
+      return false;
+
+    // Buffers: the GLB chunk, embedded base64 or mapped external files.
+    const JsonValue& bufferList = json["buffers"];
+    std::vector<GltfBuffer> buffers(bufferList.GetSize());
+    std::vector<std::vector<uint8_t>> decoded(buffers.size());
+    std::vector<MappedFile> files(buffers.size());
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+      const std::string& uri = bufferList[i]["uri"].GetString();
+      size_t length = (size_t)bufferList[i]["byteLength"].GetNumber();
+      if (uri.empty())
+      {
+        buffers[i] = binaryChunk;
+      }
+      else if (!IsExternalUri(uri))
+      {
+        size_t comma = uri.find(',');
+        if (comma == std::string::npos || !DecodeBase64(uri, comma + 1, decoded[i]))
+        {
+          error = "bad data URI in buffer " + std::to_string(i);
+          return false;
+        }
+        buffers[i] = { decoded[i].data(), decoded[i].size() };
+      }
+      else
+      {
+        if (!files[i].Open((std::filesystem::path(baseDirectory) / uri).string()))
+        {
+          error = "could not open buffer '" + uri + "'";
+          return false;
+        }
+        buffers[i] = { files[i].GetData(), files[i].GetSize() };
+      }
+
+      if (buffers[i].Size < length)
+      {
+        error = "buffer " + std::to_string(i) + " is shorter than declared";
+        return false;
+      }
+    }
+
+    // Instance meshes through the scene graph.
+    GltfReader reader(json, buffers);
+    std::vector<GltfDraw> draws;
+    const JsonValue& scenes = json["scenes"];
+    bool ok = true;
+    if (scenes.GetSize() > 0)
+    {
+      const JsonValue& roots = scenes[json.Has("scene") ? ToIndex(json["scene"]) : 0]["nodes"];
+      for (size_t i = 0; ok && i < roots.GetSize(); i++)
+        ok = reader.AddNode(ToIndex(roots[i]), glm::mat4(1.0f), draws, 0);
+    }
+    else
+    {
+      for (size_t i = 0; ok && i < json["meshes"].GetSize(); i++)
+        ok = reader.AddMesh(i, glm::mat4(1.0f), draws);
+    }
+    if (!ok)
+    {
+      error = reader.GetError();
+      return false;
+    }
+
+    // Lay the draws out one after another; a stream any primitive has is
+    // given to all, zero-filled where missing.
+    uint64_t vertexCount = 0, indexCount = 0;
+    bool hasNormals = false, hasTexCoords = false;
+    for (GltfDraw& draw : draws)
+    {
+      draw.FirstVertex = (uint32_t)vertexCount;
+      draw.FirstIndex = (uint32_t)indexCount;
+      vertexCount += draw.Positions.Count;
+      indexCount += draw.IndexCount;
+      hasNormals |= draw.Normals.Data != nullptr;
+      hasTexCoords |= draw.TexCoords.Data != nullptr;
+      mesh.Submeshes.push_back({ draw.FirstIndex, draw.IndexCount, draw.Material, 0, {}, {} });
+    }
+    if (indexCount == 0)
+    {
+      error = "no triangles";
+      return false;
+    }
+    if (vertexCount > 0xFFFFFFFFull || indexCount > 0xFFFFFFFFull)
+    {
+      error = "mesh too large";
+      return false;
+    }
+
+    mesh.Streams[(size_t)VertexSemantic::Position].resize(vertexCount * 3);
+    mesh.Streams[(size_t)VertexSemantic::Normal].resize(hasNormals ? vertexCount * 3 : 0);
+    mesh.Streams[(size_t)VertexSemantic::TexCoord].resize(hasTexCoords ? vertexCount * 2 : 0);
+    mesh.Indices.resize(indexCount);
+
+    // Jobs of a fixed number of elements, so one large primitive is split too.
+    constexpr uint32_t JobSize = 1 << 16;
+    struct ConvertJob
+    {
+      const GltfDraw* Draw;
+      bool Indices;
+      uint32_t Begin, End;
+    };
+    std::vector<ConvertJob> jobs;
+    for (const GltfDraw& draw : draws)
+    {
+      for (uint32_t begin = 0; begin < draw.Positions.Count; begin += JobSize)
+        jobs.push_back({ &draw, false, begin, std::min(begin + JobSize, draw.Positions.Count) });
+      for (uint32_t begin = 0; begin < draw.IndexCount; begin += JobSize * 3)
+        jobs.push_back({ &draw, true, begin, std::min(begin + JobSize * 3, draw.IndexCount) });
+    }
+
+    auto convert = [&jobs, &mesh](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t i = begin; i < end; i++)
+      {
+        const ConvertJob& job = jobs[i];
+        if (job.Indices)
+          ConvertIndices(*job.Draw, job.Begin, job.End, mesh);
+        else
+          ConvertVertices(*job.Draw, job.Begin, job.End, mesh);
+      }
+    };
+    if (settings.Parallel)
+      ThreadPool::Get().ParallelFor((uint32_t)jobs.size(), 1, convert);
+    else
+      convert(0, (uint32_t)jobs.size());
+
+    ComputeBounds(mesh);
+    return true;
+  }
+
+  bool GetGltfExternalFiles(const uint8_t* data, size_t size, std::vector<std::string>& uris, std::string& error)
+  {
+    uris.clear();
+    JsonValue json;
+    GltfBuffer binaryChunk;
+    if (!ParseGltfJson(data, size, json, binaryChunk, error))
+      return false;
+
+    const JsonValue& bufferList = json["buffers"];
+    for (size_t i = 0; i < bufferList.GetSize(); i++)
+    {
+      const std::string& uri = bufferList[i]["uri"].GetString();
+      if (IsExternalUri(uri))
+        uris.push_back(uri);
+    }
+    return true;
+  }
+
+  bool ImportGltfFile(const std::string& path, MeshData& mesh, std::string& error, const GltfImportSettings& settings)
+  {
+    MappedFile file;
+    if (!file.Open(path))
+    {
+      error = "could not open file";
+      return false;
+    }
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    return ImportGltf(file.GetData(), file.GetSize(), directory, mesh, error, settings);
+  }
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "MeshFile.h"
+
+namespace Hazel {
+
+  struct GltfImportSettings
+  {
+    // Off converts primitives on the calling thread, for reference.
+    bool Parallel = true;
+  };
+
+  // glTF 2.0 (.gltf with external or base64 buffers, or binary .glb) to an
+  // indexed MeshData. Every triangle primitive instanced by the scene's
+  // nodes becomes a submesh with its material index and the node transform
+  // baked in; a file without scenes takes each mesh once as it is. POSITION,
+  // NORMAL and TEXCOORD_0 are read, with texcoords flipped to OpenGL's
+  // bottom-left origin. Primitives are converted on the thread pool.
+  //
+  // baseDirectory resolves relative buffer URIs.
+  bool ImportGltf(const uint8_t* data, size_t size, const std::string& baseDirectory, MeshData& mesh, std::string& error,
+    const GltfImportSettings& settings = GltfImportSettings());
+  bool ImportGltfFile(const std::string& path, MeshData& mesh, std::string& error, const GltfImportSettings& settings = GltfImportSettings());
+
+  // The URIs of the external buffers an import reads, as written in the file,
+  // so relative to its directory.
+  bool GetGltfExternalFiles(const uint8_t* data, size_t size, std::vector<std::string>& uris, std::string& error);
+
+}
@@ -0,0 +1,459 @@
+#include "ImageDecoder.h"
+
+#include <stb_image.h>
+
+#include "Core/Simd.h"
+
+namespace Hazel {
+
+  static constexpr uint8_t PngSignature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+  // stb_image's default limit, so both paths reject the same files.
+  static constexpr uint32_t MaxDimension = 1 << 24;
+
+  enum PngColorType : uint8_t
+  {
+    PngGray = 0,
+    PngRGB = 2,
+    PngPalette = 3,
+    PngGrayAlpha = 4,
+    PngRGBA = 6
+  };
+
+  enum PngFilter : uint8_t
+  {
+    PngFilterNone = 0,
+    PngFilterSub = 1,
+    PngFilterUp = 2,
+    PngFilterAverage = 3,
+    PngFilterPaeth = 4
+  };
+
+  static uint32_t ReadBigEndian(const uint8_t* data)
+  {
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+  }
+
+  static uint32_t ChunkType(const char* type)
+  {
+    return ReadBigEndian((const uint8_t*)type);
+  }
+
+  static uint8_t PaethPredictor(int a, int b, int c)
+  {
+    int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+    if (pa <= pb && pa <= pc)
+      return (uint8_t)a;
+    return (uint8_t)(pb <= pc ? b : c);
+  }
+
+  // Reference unfilter. dst may be src; prior is the previous unfiltered row.
+  static void UnfilterRowScalar(uint8_t filter, const uint8_t* src, uint8_t* dst, const uint8_t* prior, size_t length, uint32_t bpp)
+  {
+    switch (filter)
+    {
+      case PngFilterNone:
+        if (dst != src)
+          memcpy(dst, src, length);
+        break;
+      case PngFilterSub:
+        for (size_t i = 0; i < length; i++)
+          dst[i] = (uint8_t)(src[i] + (i >= bpp ? dst[i - bpp] : 0));
+        break;
+      case PngFilterUp:
+        for (size_t i = 0; i < length; i++)
+          dst[i] = (uint8_t)(src[i] + prior[i]);
+        break;
+      case PngFilterAverage:
+        for (size_t i = 0; i < length; i++)
+          dst[i] = (uint8_t)(src[i] + (((i >= bpp ? dst[i - bpp] : 0) + prior[i]) >> 1));
+        break;
+      case PngFilterPaeth:
+        for (size_t i = 0; i < length; i++)
+          dst[i] = (uint8_t)(src[i] + (i >= bpp ? PaethPredictor(dst[i - bpp], prior[i], prior[i - bpp]) : prior[i]));
+        break;
+    }
+  }
+
+#if HZ_SIMD_SSE2
+  // Sub, Average and Paeth depend on the pixel to the left, so only the bytes
+  // of one pixel are processed together; Up has no such chain and goes 16
+  // bytes at a time. Pixels are moved with memcpy of exactly bpp bytes so an
+  // in-place unfilter never overwrites input it has yet to read.
+  template<uint32_t Bpp>
+  static __m128i LoadPixel(const uint8_t* p)
+  {
+    int value = 0;
+    memcpy(&value, p, Bpp);
+    return _mm_cvtsi32_si128(value);
+  }
+
+  template<uint32_t Bpp>
+  static void StorePixel(uint8_t* p, __m128i value)
+  {
+    int bits = _mm_cvtsi128_si32(value);
+    memcpy(p, &bits, Bpp);
+  }
+
+  static __m128i Abs16(__m128i x)
+  {
+    return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+  }
+
+  static __m128i Select(__m128i mask, __m128i a, __m128i b)
+  {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+  }
+
+  template<uint32_t Bpp>
+  static void UnfilterPixelsSse2(uint8_t filter, const uint8_t* src, uint8_t* dst, const uint8_t* prior, size_t length)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    switch (filter)
+    {
+      case PngFilterSub:
+      {
+        __m128i a = zero;
+        for (size_t i = 0; i < length; i += Bpp)
+        {
+          a = _mm_add_epi8(LoadPixel<Bpp>(src + i), a);
+          StorePixel<Bpp>(dst + i, a);
+        }
+        break;
+      }
+      case PngFilterAverage:
+      {
+        // avg_epu8 rounds up; PNG wants the floor.
+        const __m128i one = _mm_set1_epi8(1);
+        __m128i a = zero;
+        for (size_t i = 0; i < length; i += Bpp)
+        {
+          __m128i b = LoadPixel<Bpp>(prior + i);
+          __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+          a = _mm_add_epi8(LoadPixel<Bpp>(src + i), average);
+          StorePixel<Bpp>(dst + i, a);
+        }
+        break;
+      }
+      case PngFilterPaeth:
+      {
+        // In 16-bit lanes: pa = |b - c|, pb = |a - c|, pc = |a + b - 2c|,
+        // ties going to a, then b.
+        __m128i a = zero, c = zero;
+        for (size_t i = 0; i < length; i += Bpp)
+        {
+          __m128i b = _mm_unpacklo_epi8(LoadPixel<Bpp>(prior + i), zero);
+          __m128i x = LoadPixel<Bpp>(src + i);
+
+          __m128i pa = _mm_sub_epi16(b, c);
+          __m128i pb = _mm_sub_epi16(a, c);
+          __m128i pc = Abs16(_mm_add_epi16(pa, pb));
+          pa = Abs16(pa);
+          pb = Abs16(pb);
+          __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+          __m128i predicted = Select(_mm_cmpeq_epi16(smallest, pa), a, Select(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+          __m128i result = _mm_add_epi8(x, _mm_packus_epi16(predicted, predicted));
+          StorePixel<Bpp>(dst + i, result);
+          a = _mm_unpacklo_epi8(result, zero);
+          c = b;
+        }
+        break;
+      }
+    }
+  }
+
+  static void UnfilterRowSse2(uint8_t filter, const uint8_t* src, uint8_t* dst, const uint8_t* prior, size_t length, uint32_t bpp)
+  {
+    if (filter == PngFilterUp)
+    {
+      size_t i = 0;
+      for (; i + 16 <= length; i += 16)
+      {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(prior + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi8(x, b));
+      }
+      for (; i < length; i++)
+        dst[i] = (uint8_t)(src[i] + prior[i]);
+    }
+    else if (filter != PngFilterNone && bpp == 4)
+    {
+      UnfilterPixelsSse2<4>(filter, src, dst, prior, length);
+    }
+    else if (filter != PngFilterNone && bpp == 3)
+    {
+      UnfilterPixelsSse2<3>(filter, src, dst, prior, length);
+    }
+    else
+    {
+      // One and two byte pixels gain nothing from the per-pixel kernels.
+      UnfilterRowScalar(filter, src, dst, prior, length, bpp);
+    }
+  }
+#endif
+
+  static uint8_t ComputeLuma(int r, int g, int b)
+  {
+    // stb_image's weights, so both paths agree.
+    return (uint8_t)((r * 77 + g * 150 + b * 29) >> 8);
+  }
+
+  // One row of 1 to 4 channels to another count, the way stb_image converts.
+  static void ConvertRow(const uint8_t* src, uint32_t srcChannels, uint8_t* dst, uint32_t dstChannels, uint32_t width)
+  {
+    for (uint32_t x = 0; x < width; x++, src += srcChannels, dst += dstChannels)
+    {
+      uint8_t gray, alpha = srcChannels == 2 ? src[1] : srcChannels == 4 ? src[3] : 255;
+      if (srcChannels <= 2)
+        gray = src[0];
+      else
+        gray = ComputeLuma(src[0], src[1], src[2]);
+
+      switch (dstChannels)
+      {
+        case 1:
+          dst[0] = gray;
+          break;
+        case 2:
+          dst[0] = gray;
+          dst[1] = alpha;
+          break;
+        default:
+          if (srcChannels <= 2)
+            dst[0] = dst[1] = dst[2] = gray;
+          else
+            memcpy(dst, src, 3);
+          if (dstChannels == 4)
+            dst[3] = alpha;
+          break;
+      }
+    }
+  }
+
+  bool ImageDecoder::ParsePng(const uint8_t* data, size_t size, PngHeader& header, bool headerOnly)
+  {
+    if (size < 8 + 12 + 13 || memcmp(data, PngSignature, 8) != 0)
+      return false;
+
+    bool hasHeader = false, hasPalette = false;
+    size_t offset = 8;
+    while (offset + 12 <= size)
+    {
+      uint32_t length = ReadBigEndian(data + offset);
+      uint32_t type = ReadBigEndian(data + offset + 4);
+      const uint8_t* chunk = data + offset + 8;
+      if (length > size - offset - 12)
+        return false;
+      offset += (size_t)length + 12;
+
+      if (type == ChunkType("IHDR"))
+      {
+        if (length != 13)
+          return false;
+        header.Width = ReadBigEndian(chunk);
+        header.Height = ReadBigEndian(chunk + 4);
+        header.BitDepth = chunk[8];
+        header.ColorType = chunk[9];
+        header.Interlace = chunk[12];
+        if (header.Width == 0 || header.Height == 0 || header.Width > MaxDimension || header.Height > MaxDimension)
+          return false;
+        // Low and high bit depths and Adam7 are left to stb_image.
+        if (header.BitDepth != 8 || header.Interlace != 0 || chunk[10] != 0 || chunk[11] != 0)
+          return false;
+
+        switch (header.ColorType)
+        {
+          case PngGray: header.SampleChannels = 1; break;
+          case PngGrayAlpha: header.SampleChannels = 2; break;
+          case PngRGB: header.SampleChannels = 3; break;
+          case PngRGBA: header.SampleChannels = 4; break;
+          case PngPalette: header.SampleChannels = 1; break;
+          default: return false;
+        }
+        header.Channels = header.ColorType == PngPalette ? 3 : header.SampleChannels;
+        hasHeader = true;
+        if (headerOnly && header.ColorType != PngPalette)
+          return true;
+      }
+      else if (!hasHeader)
+      {
+        return false;
+      }
+      else if (type == ChunkType("PLTE"))
+      {
+        if (length % 3 != 0 || length > 256 * 3)
+          return false;
+        for (uint32_t i = 0; i < length / 3; i++)
+        {
+          memcpy(&header.Palette[i * 4], chunk + i * 3, 3);
+          header.Palette[i * 4 + 3] = 255;
+        }
+        hasPalette = true;
+      }
+      else if (type == ChunkType("tRNS"))
+      {
+        // Colour keys on gray and RGB images add an alpha channel; stb_image handles those.
+        if (header.ColorType != PngPalette || !hasPalette || length > 256)
+          return false;
+        for (uint32_t i = 0; i < length; i++)
+          header.Palette[i * 4 + 3] = chunk[i];
+        header.HasTransparency = true;
+        header.Channels = 4;
+      }
+      else if (type == ChunkType("IDAT"))
+      {
+        if (header.ColorType == PngPalette && !hasPalette)
+          return false;
+        if (headerOnly)
+          return true;
+        header.Data.push_back({ chunk, length });
+      }
+      else if (type == ChunkType("IEND"))
+      {
+        break;
+      }
+      else if (!(chunk[-4] & 0x20))
+      {
+        // An unknown critical chunk, such as Apple's CgBI.
+        return false;
+      }
+    }
+    return hasHeader && !header.Data.empty();
+  }
+
+  bool ImageDecoder::DecodePng(const PngHeader& header, uint32_t channels, bool flipVertically, uint8_t* output)
+  {
+    const uint32_t width = header.Width, height = header.Height;
+    const uint32_t bpp = header.SampleChannels;
+    const size_t stride = (size_t)width * bpp;
+
+    // A single IDAT inflates straight from the file.
+    const uint8_t* compressed = header.Data[0].first;
+    size_t compressedSize = header.Data[0].second;
+    if (header.Data.size() > 1)
+    {
+      m_Compressed.clear();
+      for (const auto& [chunk, length] : header.Data)
+        m_Compressed.insert(m_Compressed.end(), chunk, chunk + length);
+      compressed = m_Compressed.data();
+      compressedSize = m_Compressed.size();
+    }
+
+    size_t filteredSize = (stride + 1) * height;
+    m_Filtered.resize(filteredSize);
+    int inflated = stbi_zlib_decode_buffer((char*)m_Filtered.data(), (int)filteredSize, (const char*)compressed, (int)compressedSize);
+    if (inflated != (int)filteredSize)
+      return false;
+
+    m_ZeroRow.assign(stride, 0);
+    auto unfilter = UnfilterRowScalar;
+#if HZ_SIMD_SSE2
+    if (m_Settings.Simd)
+      unfilter = UnfilterRowSse2;
+#endif
+
+    // Without conversion rows are unfiltered into the output, the previous
+    // output row serving as the prior one; otherwise in place, then converted.
+    const bool direct = header.ColorType != PngPalette && channels == bpp;
+    const size_t outStride = (size_t)width * channels;
+    const uint8_t* prior = m_ZeroRow.data();
+    if (header.ColorType == PngPalette)
+      m_Expanded.resize((size_t)width * 4);
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+      uint8_t* filtered = &m_Filtered[y * (stride + 1)];
+      uint8_t filter = filtered[0];
+      if (filter > PngFilterPaeth)
+        return false;
+
+      uint8_t* outRow = output + (size_t)(flipVertically ? height - 1 - y : y) * outStride;
+      uint8_t* row = direct ? outRow : filtered + 1;
+      unfilter(filter, filtered + 1, row, prior, stride, bpp);
+      prior = row;
+
+      if (direct)
+        continue;
+
+      if (header.ColorType == PngPalette)
+      {
+        // Expanded to the palette's channels, then converted like any other image.
+        const uint32_t paletteChannels = header.Channels;
+        uint8_t* expanded = channels == paletteChannels ? outRow : m_Expanded.data();
+        for (uint32_t x = 0; x < width; x++)
+          memcpy(expanded + x * paletteChannels, &header.Palette[row[x] * 4], paletteChannels);
+        if (channels != paletteChannels)
+          ConvertRow(expanded, paletteChannels, outRow, channels, width);
+      }
+      else
+      {
+        ConvertRow(row, bpp, outRow, channels, width);
+      }
+    }
+    return true;
+  }
+
+  bool ImageDecoder::DecodeWithStb(const uint8_t* data, size_t size, uint32_t channels, bool flipVertically, uint8_t* output)
+  {
+    int width, height, sourceChannels;
+    stbi_set_flip_vertically_on_load_thread(flipVertically);
+    unsigned char* pixels = stbi_load_from_memory(data, (int)size, &width, &height, &sourceChannels, (int)channels);
+    if (!pixels)
+    {
+      m_Error = stbi_failure_reason();
+      return false;
+    }
+
+    memcpy(output, pixels, (size_t)width * height * (channels ? channels : sourceChannels));
+    stbi_image_free(pixels);
+    return true;
+  }
+
+  bool ImageDecoder::ReadInfo(const uint8_t* data, size_t size, ImageInfo& info)
+  {
+    PngHeader header;
+    if (ParsePng(data, size, header, true))
+    {
+      info.Width = header.Width;
+      info.Height = header.Height;
+      info.Channels = header.Channels;
+      return true;
+    }
+
+    int width, height, channels;
+    if (!stbi_info_from_memory(data, (int)size, &width, &height, &channels))
+    {
+      m_Error = stbi_failure_reason();
+      return false;
+    }
+    info.Width = width;
+    info.Height = height;
+    info.Channels = channels;
+    return true;
+  }
+
+  bool ImageDecoder::Decode(const uint8_t* data, size_t size, uint32_t channels, bool flipVertically, uint8_t* output)
+  {
+    PngHeader header;
+    if (ParsePng(data, size, header, false))
+    {
+      // A stream the fast path cannot take is retried with stb_image, which
+      // also gives the error message if it is really broken.
+      if (DecodePng(header, channels ? channels : header.Channels, flipVertically, output))
+        return true;
+    }
+    return DecodeWithStb(data, size, channels, flipVertically, output);
+  }
+
+  bool ImageDecoder::Decode(const uint8_t* data, size_t size, uint32_t channels, bool flipVertically, std::vector<uint8_t>& output, ImageInfo& info)
+  {
+    if (!ReadInfo(data, size, info))
+      return false;
+
+    if (channels == 0)
+      channels = info.Channels;
+    output.resize((size_t)info.Width * info.Height * channels);
+    return Decode(data, size, channels, flipVertically, output.data());
+  }
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+namespace Hazel {
+
+  struct ImageInfo
+  {
+    uint32_t Width = 0, Height = 0;
+    // As stored in the file, the way stb_image reports it.
+    uint32_t Channels = 0;
+  };
+
+  // Decodes images into memory the caller owns, such as a mapped staging
+  // buffer or a buffer reused across loads. 8-bit non-interlaced PNGs (the
+  // common case for textures) take a path of our own: the IDAT stream is
+  // inflated into scratch memory the decoder keeps between calls and rows are
+  // unfiltered with SSE2, straight into the output when no channel conversion
+  // is needed. Everything else goes through stb_image and is copied out.
+  // Output matches stbi_load_from_memory byte for byte.
+  //
+  // Keeps scratch state: use one decoder per thread, e.g. a thread_local.
+  class ImageDecoder
+  {
+  public:
+    struct Settings
+    {
+      // Off selects the scalar unfilter, for reference.
+      bool Simd = true;
+    };
+
+    // Any format stb_image reads.
+    bool ReadInfo(const uint8_t* data, size_t size, ImageInfo& info);
+    // Writes Width * Height * channels bytes to output; channels 0 keeps the
+    // stored count. The first row written is the bottom one when flipping.
+    bool Decode(const uint8_t* data, size_t size, uint32_t channels, bool flipVertically, uint8_t* output);
+    // Resizes output to fit and fills it; keeps its capacity for the next image.
+    bool Decode(const uint8_t* data, size_t size, uint32_t channels, bool flipVertically, std::vector<uint8_t>& output, ImageInfo& info);
+
+    // Set when a call returns false.
+    const std::string& GetError() const { return m_Error; }
+    Settings& GetSettings() { return m_Settings; }
+  private:
+    struct PngHeader
+    {
+      uint32_t Width = 0, Height = 0;
+      uint8_t BitDepth = 0, ColorType = 0, Interlace = 0;
+      // Stored channels: 1 for palette images.
+      uint32_t SampleChannels = 0;
+      // What the image expands to; palette images give 3, or 4 with transparency.
+      uint32_t Channels = 0;
+      bool HasTransparency = false;
+      std::array<uint8_t, 256 * 4> Palette{};
+      // IDAT payloads in file order.
+      std::vector<std::pair<const uint8_t*, size_t>> Data;
+    };
+
+    // False for anything that is not a PNG the fast path takes.
+    bool ParsePng(const uint8_t* data, size_t size, PngHeader& header, bool headerOnly);
+    bool DecodePng(const PngHeader& header, uint32_t channels, bool flipVertically, uint8_t* output);
+    bool DecodeWithStb(const uint8_t* data, size_t size, uint32_t channels, bool flipVertically, uint8_t* output);
+  private:
+    Settings m_Settings;
+    std::vector<uint8_t> m_Compressed;
+    std::vector<uint8_t> m_Filtered;
+    std::vector<uint8_t> m_ZeroRow;
+    // One palette row expanded, before conversion.
+    std::vector<uint8_t> m_Expanded;
+    std::string m_Error;
+  };
+
+}
@@ -0,0 +1,214 @@
+#include "Ktx2.h"
+
+namespace Hazel {
+
+  static const uint8_t Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+  // Identifier, nine header words, then the index (four 32-bit and two 64-bit fields).
+  static constexpr size_t HeaderSize = 12 + 9 * 4;
+  static constexpr size_t IndexSize = 4 * 4 + 2 * 8;
+  static constexpr size_t LevelIndexEntrySize = 3 * 8;
+
+  Ktx2Format GetKtx2Format(BlockFormat format, bool srgb)
+  {
+    switch (format)
+    {
+      case BlockFormat::BC1: return srgb ? Ktx2Format::BC1_RGB_SRGB : Ktx2Format::BC1_RGB_UNORM;
+      case BlockFormat::BC4: return Ktx2Format::BC4_UNORM;
+      case BlockFormat::BC5: return Ktx2Format::BC5_UNORM;
+      case BlockFormat::BC7: return srgb ? Ktx2Format::BC7_SRGB : Ktx2Format::BC7_UNORM;
+    }
+    return Ktx2Format::Undefined;
+  }
+
+  bool GetBlockFormat(Ktx2Format format, BlockFormat& blockFormat, bool& srgb)
+  {
+    srgb = format == Ktx2Format::BC1_RGB_SRGB || format == Ktx2Format::BC7_SRGB;
+    switch (format)
+    {
+      case Ktx2Format::BC1_RGB_UNORM:
+      case Ktx2Format::BC1_RGB_SRGB: blockFormat = BlockFormat::BC1; return true;
+      case Ktx2Format::BC4_UNORM: blockFormat = BlockFormat::BC4; return true;
+      case Ktx2Format::BC5_UNORM: blockFormat = BlockFormat::BC5; return true;
+      case Ktx2Format::BC7_UNORM:
+      case Ktx2Format::BC7_SRGB: blockFormat = BlockFormat::BC7; return true;
+      default: return false;
+    }
+  }
+
+  template<typename T>
+  static T ReadValue(const uint8_t* data)
+  {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+  }
+
+  template<typename T>
+  static void WriteValue(std::vector<uint8_t>& out, size_t offset, T value)
+  {
+    memcpy(&out[offset], &value, sizeof(T));
+  }
+
+  bool IsKtx2(const uint8_t* data, size_t size)
+  {
+    return size >= sizeof(Identifier) && memcmp(data, Identifier, sizeof(Identifier)) == 0;
+  }
+
+  bool ReadKtx2(const uint8_t* data, size_t size, Ktx2Header& header, std::string& error)
+  {
+    if (size < HeaderSize + IndexSize || !IsKtx2(data, size))
+    {
+      error = "not a KTX2 file";
+      return false;
+    }
+
+    const uint8_t* words = data + sizeof(Identifier);
+    header.Format = (Ktx2Format)ReadValue<uint32_t>(words);
+    header.Width = ReadValue<uint32_t>(words + 8);
+    header.Height = ReadValue<uint32_t>(words + 12);
+    uint32_t depth = ReadValue<uint32_t>(words + 16);
+    uint32_t layers = ReadValue<uint32_t>(words + 20);
+    uint32_t faces = ReadValue<uint32_t>(words + 24);
+    uint32_t levelCount = std::max(ReadValue<uint32_t>(words + 28), 1u);
+    uint32_t supercompression = ReadValue<uint32_t>(words + 32);
+
+    BlockFormat blockFormat;
+    bool srgb;
+    if (!GetBlockFormat(header.Format, blockFormat, srgb))
+    {
+      error = "unsupported format " + std::to_string((uint32_t)header.Format);
+      return false;
+    }
+    if (depth > 1 || layers > 1 || faces != 1 || supercompression != 0)
+    {
+      error = "only uncompressed single 2D images are supported";
+      return false;
+    }
+
+    // A full chain ends at 1x1, so there are at most floor(log2(max(width, height))) + 1 levels,
+    // which is 32 at most; the bound keeps the shift below the width of the type.
+    uint32_t maxLevelCount = 1;
+    while (maxLevelCount < 32 && (std::max(header.Width, header.Height) >> maxLevelCount) > 0)
+      maxLevelCount++;
+    if (header.Width == 0 || header.Height == 0 || levelCount > maxLevelCount)
+    {
+      error = "bad image size or level count";
+      return false;
+    }
+
+    size_t levelIndex = HeaderSize + IndexSize;
+    if (size < levelIndex + levelCount * LevelIndexEntrySize)
+    {
+      error = "truncated level index";
+      return false;
+    }
+
+    header.Levels.resize(levelCount);
+    for (uint32_t i = 0; i < levelCount; i++)
+    {
+      const uint8_t* entry = data + levelIndex + i * LevelIndexEntrySize;
+      Ktx2Level& level = header.Levels[i];
+      level.Width = std::max(header.Width >> i, 1u);
+      level.Height = std::max(header.Height >> i, 1u);
+      level.Offset = (size_t)ReadValue<uint64_t>(entry);
+      level.Size = (size_t)ReadValue<uint64_t>(entry + 8);
+
+      if (level.Offset > size || level.Size > size - level.Offset || level.Size != GetCompressedSize(blockFormat, level.Width, level.Height))
+      {
+        error = "bad level " + std::to_string(i);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Basic data format descriptor with a single sample covering the whole block.
+  static std::vector<uint8_t> CreateDataFormatDescriptor(Ktx2Format format)
+  {
+    BlockFormat blockFormat = BlockFormat::BC7;
+    bool srgb = false;
+    GetBlockFormat(format, blockFormat, srgb);
+
+    // KHR_DF_MODEL_BC1A = 128, BC4 = 131, BC5 = 132, BC7 = 134
+    uint8_t colorModel = 0;
+    switch (blockFormat)
+    {
+      case BlockFormat::BC1: colorModel = 128; break;
+      case BlockFormat::BC4: colorModel = 131; break;
+      case BlockFormat::BC5: colorModel = 132; break;
+      case BlockFormat::BC7: colorModel = 134; break;
+    }
+
+    const uint32_t blockBytes = GetBlockSize(blockFormat);
+    const uint32_t descriptorBlockSize = 24 + 16;
+    std::vector<uint8_t> dfd(4 + descriptorBlockSize, 0);
+    WriteValue<uint32_t>(dfd, 0, (uint32_t)dfd.size());
+    // vendorId 0 (Khronos), descriptorType 0 (basic), versionNumber 2
+    WriteValue<uint32_t>(dfd, 4, 0);
+    WriteValue<uint16_t>(dfd, 8, 2);
+    WriteValue<uint16_t>(dfd, 10, (uint16_t)descriptorBlockSize);
+    dfd[12] = colorModel;
+    dfd[13] = 1;                 // BT.709 primaries
+    dfd[14] = srgb ? 2 : 1;      // sRGB or linear transfer
+    dfd[15] = 0;                 // straight alpha
+    dfd[16] = 3;                 // 4x4 texel blocks, stored minus one
+    dfd[17] = 3;
+    dfd[20] = (uint8_t)blockBytes;
+
+    // One sample: every bit of the block, channel 0 (color)
+    WriteValue<uint16_t>(dfd, 28, 0);
+    dfd[30] = (uint8_t)(blockBytes * 8 - 1);
+    dfd[31] = 0;
+    WriteValue<uint32_t>(dfd, 40, 0xFFFFFFFF);
+    return dfd;
+  }
+
+  std::vector<uint8_t> WriteKtx2(Ktx2Format format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& levels)
+  {
+    std::vector<uint8_t> dfd = CreateDataFormatDescriptor(format);
+    uint32_t levelCount = (uint32_t)levels.size();
+
+    size_t dfdOffset = HeaderSize + IndexSize + levelCount * LevelIndexEntrySize;
+    size_t dataOffset = dfdOffset + dfd.size();
+
+    // Smallest level first, as the spec recommends for streaming; each aligned to 16 bytes.
+    std::vector<size_t> offsets(levelCount);
+    for (uint32_t i = levelCount; i-- > 0;)
+    {
+      dataOffset = (dataOffset + 15) & ~(size_t)15;
+      offsets[i] = dataOffset;
+      dataOffset += levels[i].size();
+    }
+
+    std::vector<uint8_t> out(dataOffset, 0);
+    memcpy(out.data(), Identifier, sizeof(Identifier));
+
+    size_t words = sizeof(Identifier);
+    WriteValue<uint32_t>(out, words, (uint32_t)format);
+    WriteValue<uint32_t>(out, words + 4, 1);      // typeSize
+    WriteValue<uint32_t>(out, words + 8, width);
+    WriteValue<uint32_t>(out, words + 12, height);
+    WriteValue<uint32_t>(out, words + 16, 0);     // pixelDepth
+    WriteValue<uint32_t>(out, words + 20, 0);     // layerCount
+    WriteValue<uint32_t>(out, words + 24, 1);     // faceCount
+    WriteValue<uint32_t>(out, words + 28, levelCount);
+    WriteValue<uint32_t>(out, words + 32, 0);     // supercompressionScheme
+
+    WriteValue<uint32_t>(out, HeaderSize, (uint32_t)dfdOffset);
+    WriteValue<uint32_t>(out, HeaderSize + 4, (uint32_t)dfd.size());
+
+    for (uint32_t i = 0; i < levelCount; i++)
+    {
+      size_t entry = HeaderSize + IndexSize + i * LevelIndexEntrySize;
+      WriteValue<uint64_t>(out, entry, offsets[i]);
+      WriteValue<uint64_t>(out, entry + 8, levels[i].size());
+      WriteValue<uint64_t>(out, entry + 16, levels[i].size());
+      memcpy(&out[offsets[i]], levels[i].data(), levels[i].size());
+    }
+
+    memcpy(&out[dfdOffset], dfd.data(), dfd.size());
+    return out;
+  }
+
+}
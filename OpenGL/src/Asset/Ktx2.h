@@ -0,0 +1,47 @@
+#pragma once
+
+#include "BlockCompression.h"
+
+namespace Hazel {
+
+  // The subset of VkFormat values the cooker writes.
+  enum class Ktx2Format : uint32_t
+  {
+    Undefined = 0,
+    BC1_RGB_UNORM = 131,
+    BC1_RGB_SRGB = 132,
+    BC4_UNORM = 139,
+    BC5_UNORM = 141,
+    BC7_UNORM = 145,
+    BC7_SRGB = 146
+  };
+
+  Ktx2Format GetKtx2Format(BlockFormat format, bool srgb);
+  // False for formats this reader does not know.
+  bool GetBlockFormat(Ktx2Format format, BlockFormat& blockFormat, bool& srgb);
+
+  struct Ktx2Level
+  {
+    uint32_t Width, Height;
+    // Into the file the header was read from.
+    size_t Offset, Size;
+  };
+
+  struct Ktx2Header
+  {
+    Ktx2Format Format = Ktx2Format::Undefined;
+    uint32_t Width = 0, Height = 0;
+    // Level 0 is the full-size image.
+    std::vector<Ktx2Level> Levels;
+  };
+
+  bool IsKtx2(const uint8_t* data, size_t size);
+
+  // Parses a KTX2 file holding one 2D image with no supercompression. Only the
+  // header and level index are read; level data stays in place for upload.
+  bool ReadKtx2(const uint8_t* data, size_t size, Ktx2Header& header, std::string& error);
+
+  // levels[0] is the full-size image; each level must be already encoded.
+  std::vector<uint8_t> WriteKtx2(Ktx2Format format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& levels);
+
+}
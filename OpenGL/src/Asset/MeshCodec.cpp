@@ -0,0 +1,251 @@
+#include "MeshCodec.h"
+
+#include "Core/Simd.h"
+
+namespace Hazel {
+
+  // Elements per block; every plane of a block holds BlockSize bytes.
+  static constexpr size_t BlockSize = 256;
+  static constexpr size_t GroupSize = 16;
+
+  enum GroupBits : uint8_t
+  {
+    GroupZero = 0,
+    Group2Bit = 1,
+    Group4Bit = 2,
+    Group8Bit = 3
+  };
+
+  static constexpr size_t PayloadSizes[4] = { 0, 4, 8, 16 };
+
+  static uint32_t ZigZag(uint32_t delta)
+  {
+    return (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+  }
+
+  static uint32_t UnZigZag(uint32_t value)
+  {
+    return (value >> 1) ^ (0u - (value & 1));
+  }
+
+  static size_t GetHeaderSize(size_t groups)
+  {
+    return (groups + 3) / 4;
+  }
+
+  static void EncodePlane(const uint8_t* plane, size_t groups, std::vector<uint8_t>& out)
+  {
+    size_t header = out.size();
+    out.resize(out.size() + GetHeaderSize(groups), 0);
+    for (size_t g = 0; g < groups; g++)
+    {
+      const uint8_t* group = plane + g * GroupSize;
+      uint8_t max = *std::max_element(group, group + GroupSize);
+      GroupBits bits = max == 0 ? GroupZero : max < 4 ? Group2Bit : max < 16 ? Group4Bit : Group8Bit;
+      out[header + g / 4] |= (uint8_t)(bits << (g % 4 * 2));
+
+      switch (bits)
+      {
+        case GroupZero:
+          break;
+        case Group2Bit:
+          for (size_t i = 0; i < GroupSize; i += 4)
+            out.push_back((uint8_t)(group[i] | group[i + 1] << 2 | group[i + 2] << 4 | group[i + 3] << 6));
+          break;
+        case Group4Bit:
+          for (size_t i = 0; i < GroupSize; i += 2)
+            out.push_back((uint8_t)(group[i] | group[i + 1] << 4));
+          break;
+        case Group8Bit:
+          out.insert(out.end(), group, group + GroupSize);
+          break;
+      }
+    }
+  }
+
+  void EncodeStream(const uint32_t* values, size_t count, uint32_t components, std::vector<uint8_t>& out)
+  {
+    std::array<uint8_t, 4 * BlockSize> planes;
+    std::vector<uint32_t> previous(components, 0);
+    for (size_t block = 0; block < count; block += BlockSize)
+    {
+      size_t elements = std::min(BlockSize, count - block);
+      size_t groups = (elements + GroupSize - 1) / GroupSize;
+      for (uint32_t c = 0; c < components; c++)
+      {
+        planes.fill(0);
+        for (size_t i = 0; i < elements; i++)
+        {
+          uint32_t value = values[(block + i) * components + c];
+          uint32_t encoded = ZigZag(value - previous[c]);
+          previous[c] = value;
+          for (int p = 0; p < 4; p++)
+            planes[p * BlockSize + i] = (uint8_t)(encoded >> (p * 8));
+        }
+        for (int p = 0; p < 4; p++)
+          EncodePlane(&planes[p * BlockSize], groups, out);
+      }
+    }
+  }
+
+  // Unpacks one plane into BlockSize bytes (groups * GroupSize of them valid).
+  static bool DecodePlane(const uint8_t*& data, const uint8_t* end, size_t groups, uint8_t* plane, bool simd)
+  {
+    const uint8_t* header = data;
+    size_t headerSize = GetHeaderSize(groups);
+    if ((size_t)(end - data) < headerSize)
+      return false;
+    data += headerSize;
+
+    for (size_t g = 0; g < groups; g++)
+    {
+      uint8_t bits = (header[g / 4] >> (g % 4 * 2)) & 3;
+      if ((size_t)(end - data) < PayloadSizes[bits])
+        return false;
+
+      uint8_t* group = plane + g * GroupSize;
+#if HZ_SIMD_SSE2
+      if (simd)
+      {
+        const __m128i mask2 = _mm_set1_epi8(3), mask4 = _mm_set1_epi8(15);
+        __m128i result;
+        switch (bits)
+        {
+          case GroupZero:
+            result = _mm_setzero_si128();
+            break;
+          case Group2Bit:
+          {
+            int packed;
+            memcpy(&packed, data, 4);
+            __m128i x = _mm_cvtsi32_si128(packed);
+            // Shifting 16-bit lanes is fine: the mask drops what crosses bytes.
+            __m128i a0 = _mm_and_si128(x, mask2);
+            __m128i a1 = _mm_and_si128(_mm_srli_epi16(x, 2), mask2);
+            __m128i a2 = _mm_and_si128(_mm_srli_epi16(x, 4), mask2);
+            __m128i a3 = _mm_and_si128(_mm_srli_epi16(x, 6), mask2);
+            result = _mm_unpacklo_epi16(_mm_unpacklo_epi8(a0, a1), _mm_unpacklo_epi8(a2, a3));
+            break;
+          }
+          case Group4Bit:
+          {
+            __m128i x = _mm_loadl_epi64((const __m128i*)data);
+            result = _mm_unpacklo_epi8(_mm_and_si128(x, mask4), _mm_and_si128(_mm_srli_epi16(x, 4), mask4));
+            break;
+          }
+          default:
+            result = _mm_loadu_si128((const __m128i*)data);
+            break;
+        }
+        _mm_storeu_si128((__m128i*)group, result);
+        data += PayloadSizes[bits];
+        continue;
+      }
+#endif
+      switch (bits)
+      {
+        case GroupZero:
+          memset(group, 0, GroupSize);
+          break;
+        case Group2Bit:
+          for (size_t i = 0; i < GroupSize; i++)
+            group[i] = (data[i / 4] >> (i % 4 * 2)) & 3;
+          break;
+        case Group4Bit:
+          for (size_t i = 0; i < GroupSize; i++)
+            group[i] = (data[i / 2] >> (i % 2 * 4)) & 15;
+          break;
+        default:
+          memcpy(group, data, GroupSize);
+          break;
+      }
+      data += PayloadSizes[bits];
+    }
+    return true;
+  }
+
+  // Planes back to values, undoing zigzag and delta; carry is the last value.
+  static void ReconstructValues(const uint8_t* planes, size_t groups, uint32_t& carry, uint32_t* values, bool simd)
+  {
+#if HZ_SIMD_SSE2
+    if (simd)
+    {
+      const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi32(1);
+      __m128i last = _mm_set1_epi32((int)carry);
+      for (size_t i = 0; i < groups * GroupSize; i += GroupSize)
+      {
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(planes + i));
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(planes + BlockSize + i));
+        __m128i b2 = _mm_loadu_si128((const __m128i*)(planes + 2 * BlockSize + i));
+        __m128i b3 = _mm_loadu_si128((const __m128i*)(planes + 3 * BlockSize + i));
+        __m128i low01 = _mm_unpacklo_epi8(b0, b1), high01 = _mm_unpackhi_epi8(b0, b1);
+        __m128i low23 = _mm_unpacklo_epi8(b2, b3), high23 = _mm_unpackhi_epi8(b2, b3);
+        __m128i quads[4] = {
+          _mm_unpacklo_epi16(low01, low23), _mm_unpackhi_epi16(low01, low23),
+          _mm_unpacklo_epi16(high01, high23), _mm_unpackhi_epi16(high01, high23)
+        };
+
+        for (int q = 0; q < 4; q++)
+        {
+          __m128i z = quads[q];
+          __m128i x = _mm_xor_si128(_mm_srli_epi32(z, 1), _mm_sub_epi32(zero, _mm_and_si128(z, one)));
+          // Inclusive prefix sum of four lanes, on top of the previous value.
+          x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+          x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+          x = _mm_add_epi32(x, last);
+          last = _mm_shuffle_epi32(x, 0xFF);
+          _mm_storeu_si128((__m128i*)(values + i + q * 4), x);
+        }
+      }
+      carry = (uint32_t)_mm_cvtsi128_si32(last);
+      return;
+    }
+#endif
+    for (size_t i = 0; i < groups * GroupSize; i++)
+    {
+      uint32_t z = planes[i] | planes[BlockSize + i] << 8 | planes[2 * BlockSize + i] << 16 | (uint32_t)planes[3 * BlockSize + i] << 24;
+      carry += UnZigZag(z);
+      values[i] = carry;
+    }
+  }
+
+  bool DecodeStream(const uint8_t* data, size_t size, size_t count, uint32_t components, uint32_t* values, bool simd)
+  {
+    const uint8_t* end = data + size;
+    std::array<uint8_t, 4 * BlockSize> planes;
+    std::array<uint32_t, BlockSize> decoded;
+    std::vector<uint32_t> carries(components, 0);
+    for (size_t block = 0; block < count; block += BlockSize)
+    {
+      size_t elements = std::min(BlockSize, count - block);
+      size_t groups = (elements + GroupSize - 1) / GroupSize;
+      for (uint32_t c = 0; c < components; c++)
+      {
+        for (int p = 0; p < 4; p++)
+        {
+          if (!DecodePlane(data, end, groups, &planes[p * BlockSize], simd))
+            return false;
+        }
+
+        // Whole groups are reconstructed; the padding past the last element
+        // only moves the carry, which the next block never sees.
+        uint32_t carry = carries[c];
+        ReconstructValues(planes.data(), groups, carry, decoded.data(), simd);
+        carries[c] = decoded[elements - 1];
+
+        if (components == 1)
+        {
+          memcpy(values + block, decoded.data(), elements * sizeof(uint32_t));
+        }
+        else
+        {
+          uint32_t* out = values + block * components + c;
+          for (size_t i = 0; i < elements; i++)
+            out[i * components] = decoded[i];
+        }
+      }
+    }
+    return data == end;
+  }
+
+}
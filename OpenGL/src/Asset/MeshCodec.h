@@ -0,0 +1,23 @@
+#pragma once
+
+namespace Hazel {
+
+  // Lossless codec for mesh streams of 32-bit values: vertex attributes (as
+  // float bit patterns) and indices. Each value is stored as the difference
+  // from the same component of the previous element, zigzagged so small
+  // steps either way stay small, and split into byte planes per block of
+  // elements. Planes go in groups of 16 bytes packed at 0, 2, 4 or 8 bits a
+  // byte, which is where the space is saved: the high bytes of neighbouring
+  // positions and of index steps are mostly zero.
+  //
+  // Decoding unpacks groups, transposes planes back into values and
+  // reverses the deltas 16 values at a time with SSE2.
+
+  // Appends the encoding of count elements of components values each.
+  void EncodeStream(const uint32_t* values, size_t count, uint32_t components, std::vector<uint8_t>& out);
+
+  // Writes count * components values; false if the data is malformed or
+  // ends early. Off for simd selects the scalar path, for reference.
+  bool DecodeStream(const uint8_t* data, size_t size, size_t count, uint32_t components, uint32_t* values, bool simd = true);
+
+}
@@ -0,0 +1,362 @@
+#include "MeshFile.h"
+
+#include <limits>
+
+#include "MeshCodec.h"
+#include "Core/ThreadPool.h"
+
+namespace Hazel {
+
+  uint32_t GetComponentCount(VertexSemantic semantic)
+  {
+    switch (semantic)
+    {
+      case VertexSemantic::Position: return 3;
+      case VertexSemantic::Normal: return 3;
+      case VertexSemantic::TexCoord: return 2;
+      default: return 0;
+    }
+  }
+
+  static void ComputeRangeBounds(const MeshData& mesh, uint32_t firstIndex, uint32_t indexCount, float* min, float* max)
+  {
+    const std::vector<float>& positions = mesh.Streams[(size_t)VertexSemantic::Position];
+    for (int axis = 0; axis < 3; axis++)
+    {
+      min[axis] = std::numeric_limits<float>::max();
+      max[axis] = -std::numeric_limits<float>::max();
+    }
+
+    for (uint32_t i = firstIndex; i < firstIndex + indexCount; i++)
+    {
+      const float* position = &positions[(size_t)mesh.Indices[i] * 3];
+      for (int axis = 0; axis < 3; axis++)
+      {
+        min[axis] = std::min(min[axis], position[axis]);
+        max[axis] = std::max(max[axis], position[axis]);
+      }
+    }
+
+    if (indexCount == 0)
+    {
+      for (int axis = 0; axis < 3; axis++)
+        min[axis] = max[axis] = 0.0f;
+    }
+  }
+
+  void ComputeBounds(MeshData& mesh)
+  {
+    for (MeshSubmesh& submesh : mesh.Submeshes)
+      ComputeRangeBounds(mesh, submesh.FirstIndex, submesh.IndexCount, submesh.BoundsMin, submesh.BoundsMax);
+    ComputeRangeBounds(mesh, 0, (uint32_t)mesh.Indices.size(), mesh.BoundsMin, mesh.BoundsMax);
+  }
+
+  bool IsMeshFile(const uint8_t* data, size_t size)
+  {
+    uint32_t magic;
+    if (size < sizeof(MeshFileHeader))
+      return false;
+    memcpy(&magic, data, sizeof(magic));
+    return magic == MeshFileMagic;
+  }
+
+  static bool IsRangeInside(uint64_t offset, uint64_t size, uint64_t fileSize)
+  {
+    return offset <= fileSize && size <= fileSize - offset;
+  }
+
+  bool ReadMeshFile(const uint8_t* data, size_t size, MeshView& view, std::string& error)
+  {
+    if (!IsMeshFile(data, size))
+    {
+      error = "not a mesh file";
+      return false;
+    }
+
+    // The header is read in place too; mappings and vector storage are aligned enough.
+    const MeshFileHeader& header = *(const MeshFileHeader*)data;
+    if (header.Version != MeshFileVersion)
+    {
+      error = "unsupported mesh file version " + std::to_string(header.Version);
+      return false;
+    }
+    if (header.FileSize != size)
+    {
+      error = "truncated mesh file";
+      return false;
+    }
+    if (header.IndexSize != 2 && header.IndexSize != 4)
+    {
+      error = "bad index size";
+      return false;
+    }
+
+    uint64_t tables = sizeof(MeshFileHeader) + (uint64_t)header.StreamCount * sizeof(MeshFileStream)
+      + (uint64_t)header.SubmeshCount * sizeof(MeshSubmesh) + (uint64_t)header.LodCount * sizeof(MeshLod);
+    if (tables > size || !IsRangeInside(header.IndexOffset, header.IndexDataSize, size))
+    {
+      error = "mesh file sections out of range";
+      return false;
+    }
+    bool indicesValid = header.IndexEncoding == MeshEncoding::None ? header.IndexDataSize == (uint64_t)header.IndexCount * header.IndexSize
+      : header.IndexEncoding == MeshEncoding::Packed && header.IndexCount % 3 == 0;
+    if (!indicesValid)
+    {
+      error = "bad index section";
+      return false;
+    }
+
+    view = MeshView();
+    view.VertexCount = header.VertexCount;
+    view.IndexCount = header.IndexCount;
+    view.IndexSize = header.IndexSize;
+    // Unindexed meshes have no index section to upload or decode.
+    if (header.IndexCount > 0)
+    {
+      view.Indices = data + header.IndexOffset;
+      view.IndexDataSize = (size_t)header.IndexDataSize;
+      view.IndexEncoding = header.IndexEncoding;
+    }
+    memcpy(view.BoundsMin, header.BoundsMin, sizeof(view.BoundsMin));
+    memcpy(view.BoundsMax, header.BoundsMax, sizeof(view.BoundsMax));
+
+    const MeshFileStream* streams = (const MeshFileStream*)(data + sizeof(MeshFileHeader));
+    for (uint32_t i = 0; i < header.StreamCount; i++)
+    {
+      const MeshFileStream& stream = streams[i];
+      // Streams of semantics added later are skipped.
+      if (stream.Semantic >= VertexSemantic::Count)
+        continue;
+
+      uint64_t expected = (uint64_t)header.VertexCount * GetComponentCount(stream.Semantic) * sizeof(float);
+      bool sizeValid = stream.Encoding == MeshEncoding::None ? stream.Size == expected : stream.Encoding == MeshEncoding::Packed;
+      if (stream.Components != GetComponentCount(stream.Semantic) || !sizeValid || !IsRangeInside(stream.Offset, stream.Size, size))
+      {
+        error = "bad vertex stream";
+        return false;
+      }
+      view.Streams[(size_t)stream.Semantic] = data + stream.Offset;
+      view.StreamSizes[(size_t)stream.Semantic] = (size_t)expected;
+      view.StreamDataSizes[(size_t)stream.Semantic] = (size_t)stream.Size;
+      view.StreamEncodings[(size_t)stream.Semantic] = stream.Encoding;
+    }
+    if (!view.Streams[(size_t)VertexSemantic::Position])
+    {
+      error = "mesh file has no positions";
+      return false;
+    }
+
+    view.Submeshes = (const MeshSubmesh*)(streams + header.StreamCount);
+    view.SubmeshCount = header.SubmeshCount;
+    for (uint32_t i = 0; i < view.SubmeshCount; i++)
+    {
+      const MeshSubmesh& submesh = view.Submeshes[i];
+      if (submesh.FirstIndex > header.IndexCount || submesh.IndexCount > header.IndexCount - submesh.FirstIndex)
+      {
+        error = "submesh out of range";
+        return false;
+      }
+    }
+
+    view.Lods = (const MeshLod*)(view.Submeshes + header.SubmeshCount);
+    view.LodCount = header.LodCount;
+    for (uint32_t i = 0; i < view.LodCount; i++)
+    {
+      const MeshLod& lod = view.Lods[i];
+      if (lod.FirstSubmesh > header.SubmeshCount || lod.SubmeshCount > header.SubmeshCount - lod.FirstSubmesh)
+      {
+        error = "LOD out of range";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static size_t AlignUp(size_t value)
+  {
+    return (value + MeshFileAlignment - 1) / MeshFileAlignment * MeshFileAlignment;
+  }
+
+  bool MeshView::IsEncoded() const
+  {
+    return IndexEncoding != MeshEncoding::None
+      || std::any_of(StreamEncodings.begin(), StreamEncodings.end(), [](MeshEncoding encoding) { return encoding != MeshEncoding::None; });
+  }
+
+  bool DecodeMeshView(const MeshView& view, std::vector<uint8_t>& storage, MeshView& decoded, std::string& error, bool parallel)
+  {
+    struct DecodeJob
+    {
+      const uint8_t* Data;
+      size_t Size;
+      size_t Count;
+      uint32_t Components;
+      size_t Offset;
+      // Indices are decoded to 32 bits and narrowed to this afterwards.
+      uint32_t OutputSize;
+      bool Decoded;
+    };
+
+    decoded = view;
+    std::vector<DecodeJob> jobs;
+    size_t size = 0;
+    for (size_t i = 0; i < view.Streams.size(); i++)
+    {
+      if (!view.Streams[i] || view.StreamEncodings[i] == MeshEncoding::None)
+        continue;
+      jobs.push_back({ (const uint8_t*)view.Streams[i], view.StreamDataSizes[i], view.VertexCount, GetComponentCount((VertexSemantic)i), size, 4, false });
+      size += AlignUp(view.StreamSizes[i]);
+    }
+    if (view.IndexEncoding != MeshEncoding::None)
+      jobs.push_back({ (const uint8_t*)view.Indices, view.IndexDataSize, view.IndexCount / 3, 3, size, view.IndexSize, false });
+    if (jobs.empty())
+      return true;
+
+    storage.resize(size + (view.IndexEncoding != MeshEncoding::None ? (size_t)view.IndexCount * 4 : 0));
+    auto decode = [&jobs, &storage](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t i = begin; i < end; i++)
+      {
+        DecodeJob& job = jobs[i];
+        uint32_t* values = (uint32_t*)&storage[job.Offset];
+        job.Decoded = DecodeStream(job.Data, job.Size, job.Count, job.Components, values);
+        if (job.Decoded && job.OutputSize == 2)
+        {
+          // In place: each 16-bit slot lies at or before the value it is read from.
+          uint8_t* bytes = &storage[job.Offset];
+          for (size_t j = 0; j < job.Count * job.Components; j++)
+          {
+            uint32_t value;
+            memcpy(&value, bytes + j * 4, 4);
+            uint16_t narrow = (uint16_t)value;
+            memcpy(bytes + j * 2, &narrow, 2);
+          }
+        }
+      }
+    };
+    if (parallel)
+      ThreadPool::Get().ParallelFor((uint32_t)jobs.size(), 1, decode);
+    else
+      decode(0, (uint32_t)jobs.size());
+
+    size_t job = 0;
+    for (size_t i = 0; i < view.Streams.size(); i++)
+    {
+      if (!view.Streams[i] || view.StreamEncodings[i] == MeshEncoding::None)
+        continue;
+      decoded.Streams[i] = &storage[jobs[job++].Offset];
+      decoded.StreamDataSizes[i] = view.StreamSizes[i];
+      decoded.StreamEncodings[i] = MeshEncoding::None;
+    }
+    if (view.IndexEncoding != MeshEncoding::None)
+    {
+      decoded.Indices = &storage[jobs[job].Offset];
+      decoded.IndexDataSize = (size_t)view.IndexCount * view.IndexSize;
+      decoded.IndexEncoding = MeshEncoding::None;
+    }
+
+    if (!std::all_of(jobs.begin(), jobs.end(), [](const DecodeJob& job) { return job.Decoded; }))
+    {
+      error = "corrupt mesh section";
+      return false;
+    }
+    return true;
+  }
+
+  std::vector<uint8_t> WriteMeshFile(const MeshData& mesh, bool compress)
+  {
+    const uint32_t vertexCount = mesh.GetVertexCount();
+    const MeshEncoding encoding = compress ? MeshEncoding::Packed : MeshEncoding::None;
+
+    // Section contents, encoded up front when compressing.
+    std::vector<MeshFileStream> streams;
+    std::vector<std::vector<uint8_t>> encodedStreams;
+    for (uint32_t i = 0; i < (uint32_t)VertexSemantic::Count; i++)
+    {
+      VertexSemantic semantic = (VertexSemantic)i;
+      if (mesh.Streams[i].empty())
+        continue;
+
+      HZ_CORE_ASSERT(mesh.Streams[i].size() == (size_t)vertexCount * GetComponentCount(semantic), "Vertex streams differ in length!");
+      encodedStreams.emplace_back();
+      if (compress)
+        EncodeStream((const uint32_t*)mesh.Streams[i].data(), vertexCount, GetComponentCount(semantic), encodedStreams.back());
+      uint64_t size = compress ? encodedStreams.back().size() : mesh.Streams[i].size() * sizeof(float);
+      streams.push_back({ semantic, GetComponentCount(semantic), encoding, 0, 0, size });
+    }
+
+    std::vector<MeshLod> lods = mesh.Lods;
+    if (lods.empty())
+      lods.push_back({ 0, (uint32_t)mesh.Submeshes.size(), 0.0f, 0 });
+
+    MeshFileHeader header = {};
+    header.Magic = MeshFileMagic;
+    header.Version = MeshFileVersion;
+    header.VertexCount = vertexCount;
+    header.IndexCount = (uint32_t)mesh.Indices.size();
+    header.IndexSize = vertexCount <= 0x10000 ? 2 : 4;
+    header.StreamCount = (uint32_t)streams.size();
+    header.SubmeshCount = (uint32_t)mesh.Submeshes.size();
+    header.LodCount = (uint32_t)lods.size();
+    header.IndexEncoding = encoding;
+    memcpy(header.BoundsMin, mesh.BoundsMin, sizeof(header.BoundsMin));
+    memcpy(header.BoundsMax, mesh.BoundsMax, sizeof(header.BoundsMax));
+
+    std::vector<uint8_t> encodedIndices;
+    if (compress)
+    {
+      HZ_CORE_ASSERT(mesh.Indices.size() % 3 == 0, "Indices must form triangles!");
+      EncodeStream(mesh.Indices.data(), mesh.Indices.size() / 3, 3, encodedIndices);
+      header.IndexDataSize = encodedIndices.size();
+    }
+    else
+    {
+      header.IndexDataSize = (uint64_t)header.IndexCount * header.IndexSize;
+    }
+
+    // Tables first, then every data section on its own alignment boundary.
+    size_t offset = sizeof(MeshFileHeader) + streams.size() * sizeof(MeshFileStream)
+      + mesh.Submeshes.size() * sizeof(MeshSubmesh) + lods.size() * sizeof(MeshLod);
+    for (MeshFileStream& stream : streams)
+    {
+      stream.Offset = offset = AlignUp(offset);
+      offset += stream.Size;
+    }
+    header.IndexOffset = offset = AlignUp(offset);
+    offset += header.IndexDataSize;
+    header.FileSize = offset;
+
+    std::vector<uint8_t> file(offset, 0);
+    uint8_t* out = file.data();
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    memcpy(out, streams.data(), streams.size() * sizeof(MeshFileStream));
+    out += streams.size() * sizeof(MeshFileStream);
+    memcpy(out, mesh.Submeshes.data(), mesh.Submeshes.size() * sizeof(MeshSubmesh));
+    out += mesh.Submeshes.size() * sizeof(MeshSubmesh);
+    memcpy(out, lods.data(), lods.size() * sizeof(MeshLod));
+
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+      const void* data = compress ? (const void*)encodedStreams[i].data() : (const void*)mesh.Streams[(size_t)streams[i].Semantic].data();
+      memcpy(&file[streams[i].Offset], data, streams[i].Size);
+    }
+
+    if (compress)
+    {
+      memcpy(&file[header.IndexOffset], encodedIndices.data(), encodedIndices.size());
+    }
+    else if (header.IndexSize == 2)
+    {
+      uint16_t* indices = (uint16_t*)&file[header.IndexOffset];
+      for (size_t i = 0; i < mesh.Indices.size(); i++)
+        indices[i] = (uint16_t)mesh.Indices[i];
+    }
+    else
+    {
+      memcpy(&file[header.IndexOffset], mesh.Indices.data(), mesh.Indices.size() * sizeof(uint32_t));
+    }
+    return file;
+  }
+
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+namespace Hazel {
+
+  // Hazel's cooked mesh container (.hzmesh): a fixed header, then tables of
+  // vertex streams, submeshes and LOD ranges, then the stream and index data,
+  // each section aligned to MeshFileAlignment. Everything is stored exactly as
+  // the GPU consumes it, little-endian, so a memory-mapped file is validated
+  // and its sections passed straight to glBufferData without parsing or copies.
+  //
+  // Streams are kept apart rather than interleaved: depth-only passes bind the
+  // position stream alone.
+  //
+  // Any section may instead be stored compressed (see MeshCodec), trading the
+  // zero-copy path for a decode into memory; worth it when the file has to
+  // come off a disk rather than out of the page cache.
+
+  constexpr uint32_t MeshFileMagic = 0x534D5A48; // "HZMS"
+  // 2 added section encodings.
+  constexpr uint32_t MeshFileVersion = 2;
+  constexpr uint32_t MeshFileAlignment = 64;
+
+  enum class MeshEncoding : uint32_t
+  {
+    // As the GPU takes it.
+    None = 0,
+    // EncodeStream of the 32-bit values: one component per attribute
+    // component, or one per triangle corner for indices.
+    Packed = 1
+  };
+
+  enum class VertexSemantic : uint32_t
+  {
+    // float3
+    Position = 0,
+    // float3
+    Normal = 1,
+    // float2
+    TexCoord = 2,
+    Count
+  };
+
+  uint32_t GetComponentCount(VertexSemantic semantic);
+
+  struct MeshFileHeader
+  {
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t VertexCount;
+    uint32_t IndexCount;
+    // 2 or 4 bytes per index.
+    uint32_t IndexSize;
+    uint32_t StreamCount;
+    uint32_t SubmeshCount;
+    uint32_t LodCount;
+    float BoundsMin[3];
+    float BoundsMax[3];
+    uint64_t IndexOffset;
+    // Bytes in the file, which differ from IndexCount * IndexSize when encoded.
+    uint64_t IndexDataSize;
+    MeshEncoding IndexEncoding;
+    uint32_t Reserved;
+    // Of the whole file, to catch truncation.
+    uint64_t FileSize;
+  };
+
+  struct MeshFileStream
+  {
+    VertexSemantic Semantic;
+    uint32_t Components;
+    MeshEncoding Encoding;
+    uint32_t Reserved;
+    // Byte range in the file.
+    uint64_t Offset;
+    uint64_t Size;
+  };
+
+  struct MeshSubmesh
+  {
+    // Range of the index buffer.
+    uint32_t FirstIndex;
+    uint32_t IndexCount;
+    uint32_t MaterialIndex;
+    uint32_t Reserved;
+    float BoundsMin[3];
+    float BoundsMax[3];
+  };
+
+  // One level of detail: a run of submeshes, drawn while the mesh covers at
+  // least ScreenSize of the viewport height. Level 0 is the finest.
+  struct MeshLod
+  {
+    uint32_t FirstSubmesh;
+    uint32_t SubmeshCount;
+    float ScreenSize;
+    uint32_t Reserved;
+  };
+
+  static_assert(sizeof(MeshFileHeader) == 88 && sizeof(MeshFileStream) == 32 && sizeof(MeshSubmesh) == 40 && sizeof(MeshLod) == 16,
+    "Mesh file structures must match the on-disk layout!");
+
+  // A mesh on the CPU side, as importers build it and the writer takes it.
+  struct MeshData
+  {
+    // One entry per vertex and semantic, components interleaved (xyz, xyz, ...); empty when absent.
+    std::array<std::vector<float>, (size_t)VertexSemantic::Count> Streams;
+    std::vector<uint32_t> Indices;
+    std::vector<MeshSubmesh> Submeshes;
+    // Empty writes one level holding every submesh.
+    std::vector<MeshLod> Lods;
+    float BoundsMin[3] = { 0.0f, 0.0f, 0.0f };
+    float BoundsMax[3] = { 0.0f, 0.0f, 0.0f };
+
+    uint32_t GetVertexCount() const { return (uint32_t)(Streams[(size_t)VertexSemantic::Position].size() / 3); }
+  };
+
+  // Bounds of the whole mesh and of every submesh, from the positions.
+  void ComputeBounds(MeshData& mesh);
+
+  // Sections of a mesh file in place; valid while the file's memory is.
+  struct MeshView
+  {
+    uint32_t VertexCount = 0;
+    uint32_t IndexCount = 0;
+    uint32_t IndexSize = 0;
+    // Null for streams the file does not have.
+    std::array<const void*, (size_t)VertexSemantic::Count> Streams{};
+    // Decoded, as uploaded.
+    std::array<size_t, (size_t)VertexSemantic::Count> StreamSizes{};
+    // Bytes the sections take in the file.
+    std::array<size_t, (size_t)VertexSemantic::Count> StreamDataSizes{};
+    std::array<MeshEncoding, (size_t)VertexSemantic::Count> StreamEncodings{};
+    // Null for meshes drawn without indices.
+    const void* Indices = nullptr;
+    size_t IndexDataSize = 0;
+    MeshEncoding IndexEncoding = MeshEncoding::None;
+    const MeshSubmesh* Submeshes = nullptr;
+    uint32_t SubmeshCount = 0;
+    const MeshLod* Lods = nullptr;
+    uint32_t LodCount = 0;
+    float BoundsMin[3];
+    float BoundsMax[3];
+
+    bool IsEncoded() const;
+  };
+
+  bool IsMeshFile(const uint8_t* data, size_t size);
+
+  // Checks the header and that every section lies inside the file; no data is
+  // read or copied. Index values are trusted, as the cooker wrote them.
+  bool ReadMeshFile(const uint8_t* data, size_t size, MeshView& view, std::string& error);
+
+  // Decodes the encoded sections of view into storage, one job per section on
+  // the thread pool, and points decoded at the results; sections stored
+  // as they are keep pointing into the file.
+  bool DecodeMeshView(const MeshView& view, std::vector<uint8_t>& storage, MeshView& decoded, std::string& error, bool parallel = true);
+
+  // Picks 16-bit indices when every vertex can be addressed with them;
+  // compress stores every section Packed.
+  std::vector<uint8_t> WriteMeshFile(const MeshData& mesh, bool compress = false);
+
+}
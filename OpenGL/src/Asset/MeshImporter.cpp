@@ -0,0 +1,56 @@
+#include "MeshImporter.h"
+
+#include <filesystem>
+
+#include "GltfImporter.h"
+#include "ObjImporter.h"
+
+namespace Hazel {
+
+  static std::string GetExtension(const std::string& path)
+  {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+    return extension;
+  }
+
+  bool IsMeshSourceFile(const std::string& path)
+  {
+    std::string extension = GetExtension(path);
+    return extension == ".obj" || extension == ".gltf" || extension == ".glb";
+  }
+
+  bool ImportMeshFile(const std::string& path, MeshData& mesh, std::string& error)
+  {
+    std::string extension = GetExtension(path);
+    if (extension == ".obj")
+      return ImportObjFile(path, mesh, error);
+    if (extension == ".gltf" || extension == ".glb")
+      return ImportGltfFile(path, mesh, error);
+
+    error = "unknown mesh format '" + extension + "'";
+    return false;
+  }
+
+  bool ImportMesh(const std::string& path, const uint8_t* data, size_t size, const std::string& baseDirectory, MeshData& mesh, std::string& error)
+  {
+    std::string extension = GetExtension(path);
+    if (extension == ".obj")
+      return ImportObj((const char*)data, size, mesh, error);
+    if (extension == ".gltf" || extension == ".glb")
+      return ImportGltf(data, size, baseDirectory, mesh, error);
+
+    error = "unknown mesh format '" + extension + "'";
+    return false;
+  }
+
+  bool GetMeshDependencies(const std::string& path, const uint8_t* data, size_t size, std::vector<std::string>& files, std::string& error)
+  {
+    files.clear();
+    std::string extension = GetExtension(path);
+    if (extension == ".gltf" || extension == ".glb")
+      return GetGltfExternalFiles(data, size, files, error);
+    return true;
+  }
+
+}
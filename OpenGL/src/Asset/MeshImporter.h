@@ -0,0 +1,18 @@
+#pragma once
+
+#include "MeshFile.h"
+
+namespace Hazel {
+
+  // Source formats the importers read, by extension: .obj, .gltf and .glb.
+  bool IsMeshSourceFile(const std::string& path);
+  // Imports with the default settings of the format's importer.
+  bool ImportMeshFile(const std::string& path, MeshData& mesh, std::string& error);
+  // The same for a file already in memory, in the format path names;
+  // baseDirectory resolves glTF's external buffers.
+  bool ImportMesh(const std::string& path, const uint8_t* data, size_t size, const std::string& baseDirectory, MeshData& mesh, std::string& error);
+  // The other files ImportMesh reads for it, relative to baseDirectory: a
+  // glTF's external buffers. OBJ materials are not read, so none for OBJ.
+  bool GetMeshDependencies(const std::string& path, const uint8_t* data, size_t size, std::vector<std::string>& files, std::string& error);
+
+}
@@ -0,0 +1,416 @@
+#include "MipGenerator.h"
+
+#include <cmath>
+
+#include "Core/Simd.h"
+#include "Core/ThreadPool.h"
+
+namespace Hazel {
+
+  namespace {
+
+    // Levels are filtered as four floats per texel whatever the channel count,
+    // so every kernel works on whole SIMD registers.
+    struct FloatImage
+    {
+      uint32_t Width = 0, Height = 0;
+      std::vector<float> Pixels;
+
+      void Resize(uint32_t width, uint32_t height)
+      {
+        Width = width;
+        Height = height;
+        Pixels.resize((size_t)width * height * 4);
+      }
+
+      float* Row(uint32_t y) { return &Pixels[(size_t)y * Width * 4]; }
+      const float* Row(uint32_t y) const { return &Pixels[(size_t)y * Width * 4]; }
+    };
+
+    constexpr uint32_t KaiserTaps = 6;
+    // Source offset of the first tap relative to 2 * x.
+    constexpr int KaiserFirstTap = -2;
+    constexpr uint32_t LinearToSrgbTableSize = 1 << 14;
+
+  }
+
+  static float SrgbToLinear(float value)
+  {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+  }
+
+  static float LinearToSrgb(float value)
+  {
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+  }
+
+  static uint8_t ToByte(float value)
+  {
+    return (uint8_t)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+  }
+
+  static const std::array<float, 256>& GetUnormTable()
+  {
+    static const std::array<float, 256> table = []()
+    {
+      std::array<float, 256> result;
+      for (uint32_t i = 0; i < 256; i++)
+        result[i] = i / 255.0f;
+      return result;
+    }();
+    return table;
+  }
+
+  static const std::array<float, 256>& GetSrgbToLinearTable()
+  {
+    static const std::array<float, 256> table = []()
+    {
+      std::array<float, 256> result;
+      for (uint32_t i = 0; i < 256; i++)
+        result[i] = SrgbToLinear(i / 255.0f);
+      return result;
+    }();
+    return table;
+  }
+
+  // Fine enough that the darkest codes, where the curve is steepest, still round correctly.
+  static const std::vector<uint8_t>& GetLinearToSrgbTable()
+  {
+    static const std::vector<uint8_t> table = []()
+    {
+      std::vector<uint8_t> result(LinearToSrgbTableSize);
+      for (uint32_t i = 0; i < LinearToSrgbTableSize; i++)
+        result[i] = ToByte(LinearToSrgb((float)i / (LinearToSrgbTableSize - 1)));
+      return result;
+    }();
+    return table;
+  }
+
+  static double BesselI0(double x)
+  {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++)
+    {
+      term *= (x / (2.0 * k)) * (x / (2.0 * k));
+      sum += term;
+    }
+    return sum;
+  }
+
+  // Sinc windowed by Kaiser (alpha 4) over 1.5 destination texels either side,
+  // sampled at the six source texels around each destination texel.
+  static const std::array<float, KaiserTaps>& GetKaiserWeights()
+  {
+    static const std::array<float, KaiserTaps> weights = []()
+    {
+      const double pi = 3.14159265358979323846, alpha = 4.0, radius = 1.5;
+      std::array<double, KaiserTaps> raw;
+      double sum = 0.0;
+      for (uint32_t i = 0; i < KaiserTaps; i++)
+      {
+        double d = ((int)i + KaiserFirstTap - 0.5) / 2.0;
+        double sinc = std::sin(pi * d) / (pi * d);
+        double t = d / radius;
+        raw[i] = sinc * BesselI0(alpha * std::sqrt(1.0 - t * t)) / BesselI0(alpha);
+        sum += raw[i];
+      }
+
+      std::array<float, KaiserTaps> result;
+      for (uint32_t i = 0; i < KaiserTaps; i++)
+        result[i] = (float)(raw[i] / sum);
+      return result;
+    }();
+    return weights;
+  }
+
+  static int GetAlphaChannel(uint32_t channels)
+  {
+    return channels == 2 ? 1 : channels == 4 ? 3 : -1;
+  }
+
+  // Rows per ParallelFor chunk so each chunk covers a useful amount of work.
+  static uint32_t GetRowChunk(uint32_t width)
+  {
+    return std::max(16384u / std::max(width, 1u), 1u);
+  }
+
+  uint32_t GetMipLevelCount(uint32_t width, uint32_t height)
+  {
+    uint32_t levels = 1;
+    while (width > 1 || height > 1)
+    {
+      width = std::max(width / 2, 1u);
+      height = std::max(height / 2, 1u);
+      levels++;
+    }
+    return levels;
+  }
+
+  static void ToFloat(const uint8_t* pixels, uint32_t channels, const MipSettings& settings, FloatImage& image)
+  {
+    // One lookup table per channel keeps the fast path free of branches.
+    int alpha = GetAlphaChannel(channels);
+    const float* tables[4];
+    for (uint32_t c = 0; c < channels; c++)
+      tables[c] = settings.GammaCorrect && (int)c != alpha ? GetSrgbToLinearTable().data() : GetUnormTable().data();
+
+    ThreadPool::Get().ParallelFor(image.Height, GetRowChunk(image.Width), [&](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t y = begin; y < end; y++)
+      {
+        const uint8_t* source = pixels + (size_t)y * image.Width * channels;
+        float* row = image.Row(y);
+        for (uint32_t x = 0; x < image.Width; x++, source += channels, row += 4)
+        {
+          for (uint32_t c = 0; c < 4; c++)
+          {
+            if (c >= channels)
+              row[c] = 0.0f;
+            else if (settings.Simd)
+              row[c] = tables[c][source[c]];
+            else
+              row[c] = settings.GammaCorrect && (int)c != alpha ? SrgbToLinear(source[c] / 255.0f) : source[c] / 255.0f;
+          }
+        }
+      }
+    });
+  }
+
+  static void ToBytes(const FloatImage& image, uint32_t channels, const MipSettings& settings, uint8_t* pixels)
+  {
+    const std::vector<uint8_t>& srgbTable = GetLinearToSrgbTable();
+    int alpha = GetAlphaChannel(channels);
+    ThreadPool::Get().ParallelFor(image.Height, GetRowChunk(image.Width), [&](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t y = begin; y < end; y++)
+      {
+        const float* row = image.Row(y);
+        uint8_t* target = pixels + (size_t)y * image.Width * channels;
+        for (uint32_t x = 0; x < image.Width; x++, row += 4, target += channels)
+        {
+          if (!settings.Simd)
+          {
+            for (uint32_t c = 0; c < channels; c++)
+            {
+              bool linear = !settings.GammaCorrect || (int)c == alpha;
+              target[c] = linear ? ToByte(row[c]) : ToByte(LinearToSrgb(std::min(std::max(row[c], 0.0f), 1.0f)));
+            }
+            continue;
+          }
+
+          // Both encodings for all four channels at once, then pick per channel.
+          alignas(16) int32_t bytes[4], indices[4];
+#if HZ_SIMD_SSE2
+          __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(row), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+          _mm_store_si128((__m128i*)bytes, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f))));
+          _mm_store_si128((__m128i*)indices, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(LinearToSrgbTableSize - 1.0f)), _mm_set1_ps(0.5f))));
+#else
+          for (uint32_t c = 0; c < 4; c++)
+          {
+            float value = std::min(std::max(row[c], 0.0f), 1.0f);
+            bytes[c] = (int32_t)(value * 255.0f + 0.5f);
+            indices[c] = (int32_t)(value * (LinearToSrgbTableSize - 1) + 0.5f);
+          }
+#endif
+          for (uint32_t c = 0; c < channels; c++)
+            target[c] = !settings.GammaCorrect || (int)c == alpha ? (uint8_t)bytes[c] : srgbTable[indices[c]];
+        }
+      }
+    });
+  }
+
+  // 2x2 average; odd edges reuse the last row or column.
+  static void DownsampleBox(const FloatImage& source, FloatImage& target, bool simd)
+  {
+    ThreadPool::Get().ParallelFor(target.Height, GetRowChunk(target.Width), [&](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t y = begin; y < end; y++)
+      {
+        const float* row0 = source.Row(std::min(y * 2, source.Height - 1));
+        const float* row1 = source.Row(std::min(y * 2 + 1, source.Height - 1));
+        float* out = target.Row(y);
+
+        uint32_t x = 0;
+        if (simd)
+        {
+#if HZ_SIMD_AVX2
+          // Two output texels per iteration: deinterleave even and odd source texels.
+          for (; x + 1 < target.Width && x * 2 + 3 < source.Width; x += 2)
+          {
+            __m256 a0 = _mm256_loadu_ps(row0 + x * 8), a1 = _mm256_loadu_ps(row0 + x * 8 + 8);
+            __m256 b0 = _mm256_loadu_ps(row1 + x * 8), b1 = _mm256_loadu_ps(row1 + x * 8 + 8);
+            __m256 top = _mm256_add_ps(_mm256_permute2f128_ps(a0, a1, 0x20), _mm256_permute2f128_ps(a0, a1, 0x31));
+            __m256 bottom = _mm256_add_ps(_mm256_permute2f128_ps(b0, b1, 0x20), _mm256_permute2f128_ps(b0, b1, 0x31));
+            _mm256_storeu_ps(out + x * 4, _mm256_mul_ps(_mm256_add_ps(top, bottom), _mm256_set1_ps(0.25f)));
+          }
+#endif
+#if HZ_SIMD_SSE2
+          for (; x < target.Width; x++)
+          {
+            uint32_t x0 = std::min(x * 2, source.Width - 1), x1 = std::min(x * 2 + 1, source.Width - 1);
+            __m128 top = _mm_add_ps(_mm_loadu_ps(row0 + x0 * 4), _mm_loadu_ps(row0 + x1 * 4));
+            __m128 bottom = _mm_add_ps(_mm_loadu_ps(row1 + x0 * 4), _mm_loadu_ps(row1 + x1 * 4));
+            _mm_storeu_ps(out + x * 4, _mm_mul_ps(_mm_add_ps(top, bottom), _mm_set1_ps(0.25f)));
+          }
+#endif
+        }
+
+        for (; x < target.Width; x++)
+        {
+          uint32_t x0 = std::min(x * 2, source.Width - 1), x1 = std::min(x * 2 + 1, source.Width - 1);
+          for (uint32_t c = 0; c < 4; c++)
+            out[x * 4 + c] = (row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c]) * 0.25f;
+        }
+      }
+    });
+  }
+
+  // Separable: a horizontal pass into scratch (half width, full height), then a vertical one.
+  static void DownsampleKaiser(const FloatImage& source, FloatImage& scratch, FloatImage& target, bool simd)
+  {
+    const std::array<float, KaiserTaps>& weights = GetKaiserWeights();
+    scratch.Resize(target.Width, source.Height);
+
+    // Clamped source columns for every output column, shared by all rows.
+    std::vector<uint32_t> columns((size_t)target.Width * KaiserTaps);
+    for (uint32_t x = 0; x < target.Width; x++)
+    {
+      for (uint32_t i = 0; i < KaiserTaps; i++)
+        columns[x * KaiserTaps + i] = (uint32_t)std::min(std::max((int)(x * 2) + KaiserFirstTap + (int)i, 0), (int)source.Width - 1) * 4;
+    }
+
+    ThreadPool::Get().ParallelFor(source.Height, GetRowChunk(target.Width), [&](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t y = begin; y < end; y++)
+      {
+        const float* row = source.Row(y);
+        float* out = scratch.Row(y);
+
+        uint32_t x = 0;
+        if (simd)
+        {
+#if HZ_SIMD_AVX2
+          for (; x + 1 < target.Width; x += 2)
+          {
+            const uint32_t* first = &columns[x * KaiserTaps];
+            const uint32_t* second = first + KaiserTaps;
+            __m256 sum = _mm256_setzero_ps();
+            for (uint32_t i = 0; i < KaiserTaps; i++)
+            {
+              __m256 texels = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(row + first[i])), _mm_loadu_ps(row + second[i]), 1);
+              sum = _mm256_add_ps(sum, _mm256_mul_ps(texels, _mm256_set1_ps(weights[i])));
+            }
+            _mm256_storeu_ps(out + x * 4, sum);
+          }
+#endif
+#if HZ_SIMD_SSE2
+          for (; x < target.Width; x++)
+          {
+            const uint32_t* taps = &columns[x * KaiserTaps];
+            __m128 sum = _mm_setzero_ps();
+            for (uint32_t i = 0; i < KaiserTaps; i++)
+              sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(row + taps[i]), _mm_set1_ps(weights[i])));
+            _mm_storeu_ps(out + x * 4, sum);
+          }
+#endif
+        }
+
+        for (; x < target.Width; x++)
+        {
+          const uint32_t* taps = &columns[x * KaiserTaps];
+          for (uint32_t c = 0; c < 4; c++)
+          {
+            float sum = 0.0f;
+            for (uint32_t i = 0; i < KaiserTaps; i++)
+              sum += row[taps[i] + c] * weights[i];
+            out[x * 4 + c] = sum;
+          }
+        }
+      }
+    });
+
+    ThreadPool::Get().ParallelFor(target.Height, GetRowChunk(target.Width), [&](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t y = begin; y < end; y++)
+      {
+        const float* rows[KaiserTaps];
+        for (uint32_t i = 0; i < KaiserTaps; i++)
+          rows[i] = scratch.Row((uint32_t)std::min(std::max((int)(y * 2) + KaiserFirstTap + (int)i, 0), (int)scratch.Height - 1));
+        float* out = target.Row(y);
+
+        // Rows are contiguous, so this pass runs straight along them.
+        uint32_t count = target.Width * 4, j = 0;
+        if (simd)
+        {
+#if HZ_SIMD_AVX2
+          for (; j + 8 <= count; j += 8)
+          {
+            __m256 sum = _mm256_setzero_ps();
+            for (uint32_t i = 0; i < KaiserTaps; i++)
+              sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(rows[i] + j), _mm256_set1_ps(weights[i])));
+            _mm256_storeu_ps(out + j, sum);
+          }
+#endif
+#if HZ_SIMD_SSE2
+          for (; j + 4 <= count; j += 4)
+          {
+            __m128 sum = _mm_setzero_ps();
+            for (uint32_t i = 0; i < KaiserTaps; i++)
+              sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[i] + j), _mm_set1_ps(weights[i])));
+            _mm_storeu_ps(out + j, sum);
+          }
+#endif
+        }
+
+        for (; j < count; j++)
+        {
+          float sum = 0.0f;
+          for (uint32_t i = 0; i < KaiserTaps; i++)
+            sum += rows[i][j] * weights[i];
+          out[j] = sum;
+        }
+      }
+    });
+  }
+
+  void GenerateMipChain(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, const MipSettings& settings, MipChain& chain)
+  {
+    HZ_CORE_ASSERT(channels >= 1 && channels <= 4, "Mip generation supports 1 to 4 channels!");
+
+    chain.Channels = channels;
+    chain.Levels.clear();
+    size_t size = 0;
+    for (uint32_t levelWidth = width, levelHeight = height; ; levelWidth = std::max(levelWidth / 2, 1u), levelHeight = std::max(levelHeight / 2, 1u))
+    {
+      MipLevel level;
+      level.Width = levelWidth;
+      level.Height = levelHeight;
+      level.Offset = size;
+      level.Size = (size_t)levelWidth * levelHeight * channels;
+      chain.Levels.push_back(level);
+      size += level.Size;
+      if (levelWidth == 1 && levelHeight == 1)
+        break;
+    }
+    chain.Data.resize(size);
+    memcpy(chain.Data.data(), pixels, chain.Levels[0].Size);
+
+    // Each level filters the previous one, kept in float so rounding does not accumulate.
+    FloatImage current, next, scratch;
+    current.Resize(width, height);
+    ToFloat(pixels, channels, settings, current);
+    for (size_t i = 1; i < chain.Levels.size(); i++)
+    {
+      const MipLevel& level = chain.Levels[i];
+      next.Resize(level.Width, level.Height);
+      if (settings.Filter == MipFilter::Kaiser)
+        DownsampleKaiser(current, scratch, next, settings.Simd);
+      else
+        DownsampleBox(current, next, settings.Simd);
+
+      ToBytes(next, channels, settings, &chain.Data[level.Offset]);
+      std::swap(current, next);
+    }
+  }
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+namespace Hazel {
+
+  enum class MipFilter
+  {
+    // 2x2 average; cheap, slightly soft.
+    Box,
+    // Separable six tap windowed sinc; keeps distant detail sharper.
+    Kaiser
+  };
+
+  struct MipSettings
+  {
+    MipFilter Filter = MipFilter::Kaiser;
+    // Filter colour channels in linear light; alpha is always linear.
+    // Use for sRGB-encoded colour, never for masks or normal maps.
+    bool GammaCorrect = false;
+    // Off selects the scalar reference kernels and exact transfer functions.
+    bool Simd = true;
+  };
+
+  struct MipLevel
+  {
+    uint32_t Width = 0, Height = 0;
+    // Byte range of the level inside MipChain::Data.
+    size_t Offset = 0, Size = 0;
+  };
+
+  // Tightly packed 8-bit levels, largest first, all in one allocation so the
+  // whole chain can be copied into a staging buffer at once.
+  struct MipChain
+  {
+    uint32_t Channels = 0;
+    std::vector<uint8_t> Data;
+    std::vector<MipLevel> Levels;
+  };
+
+  uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+
+  // Builds the full chain down to 1x1 for an image of 1 to 4 channels; level 0
+  // is a copy of pixels. Rows of each level are split across the ThreadPool, so
+  // this may be called from a job, and from several at once.
+  void GenerateMipChain(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, const MipSettings& settings, MipChain& chain);
+
+}
@@ -0,0 +1,461 @@
+#include "ObjImporter.h"
+
+#include <charconv>
+
+#include "Core/MappedFile.h"
+#include "Core/ThreadPool.h"
+
+namespace Hazel {
+
+  namespace {
+
+    // A face corner as written. Indices are zero-based into the whole file's
+    // lists, -1 when absent; relative ones (negative in the file) are kept
+    // relative to the start of their chunk until the chunks are stitched.
+    struct ObjCorner
+    {
+      int Position, TexCoord, Normal;
+      // Bit per index above that is chunk-relative.
+      uint32_t Relative;
+
+      bool operator==(const ObjCorner& other) const
+      {
+        return Position == other.Position && TexCoord == other.TexCoord && Normal == other.Normal && Relative == other.Relative;
+      }
+    };
+
+    // Distinct corners in order of first use, found through an open-addressed
+    // table of indices into that list. Millions of corners go through here,
+    // where a node-based map spends most of its time allocating.
+    class ObjCornerSet
+    {
+    public:
+      const std::vector<ObjCorner>& GetCorners() const { return m_Corners; }
+
+      void Reserve(size_t count)
+      {
+        m_Corners.reserve(count);
+        if (count * 2 > m_Slots.size())
+          Rehash(count * 2);
+      }
+
+      // Index of the corner in the list, appending it the first time.
+      uint32_t Insert(const ObjCorner& corner)
+      {
+        if ((m_Corners.size() + 1) * 2 > m_Slots.size())
+          Rehash(std::max<size_t>(m_Slots.size() * 2, 1024));
+
+        size_t mask = m_Slots.size() - 1;
+        for (size_t slot = Hash(corner) & mask;; slot = (slot + 1) & mask)
+        {
+          uint32_t index = m_Slots[slot];
+          if (index == Empty)
+          {
+            m_Slots[slot] = (uint32_t)m_Corners.size();
+            m_Corners.push_back(corner);
+            return m_Slots[slot];
+          }
+          if (m_Corners[index] == corner)
+            return index;
+        }
+      }
+    private:
+      static constexpr uint32_t Empty = 0xFFFFFFFF;
+
+      static size_t Hash(const ObjCorner& corner)
+      {
+        uint64_t hash = (uint64_t)(uint32_t)corner.Position * 0x9E3779B97F4A7C15ull;
+        hash ^= ((uint64_t)(uint32_t)corner.TexCoord << 32 | (uint32_t)corner.Normal) * 0xC2B2AE3D27D4EB4Full;
+        hash ^= corner.Relative;
+        return (size_t)(hash ^ (hash >> 29));
+      }
+
+      void Rehash(size_t minimum)
+      {
+        size_t capacity = 1;
+        while (capacity < minimum)
+          capacity *= 2;
+        m_Slots.assign(capacity, Empty);
+        for (uint32_t i = 0; i < m_Corners.size(); i++)
+        {
+          size_t slot = Hash(m_Corners[i]) & (capacity - 1);
+          while (m_Slots[slot] != Empty)
+            slot = (slot + 1) & (capacity - 1);
+          m_Slots[slot] = i;
+        }
+      }
+    private:
+      std::vector<ObjCorner> m_Corners;
+      std::vector<uint32_t> m_Slots;
+    };
+
+    struct ObjChunk
+    {
+      const char* Begin = nullptr;
+      const char* End = nullptr;
+      std::vector<float> Positions, TexCoords, Normals;
+      // Distinct corners, and the triangles as indices into them.
+      ObjCornerSet Corners;
+      std::vector<uint32_t> Indices;
+      // usemtl statements: the chunk's index count at that point and the name.
+      std::vector<std::pair<uint32_t, std::string>> Materials;
+      uint32_t Lines = 0;
+      // Set on the first malformed line, counted from the chunk's start.
+      std::string Error;
+      uint32_t ErrorLine = 0;
+    };
+
+    class ObjParser
+    {
+    public:
+      explicit ObjParser(ObjChunk& chunk) : m_Chunk(chunk), m_Cursor(chunk.Begin), m_End(chunk.End) {}
+
+      void Parse();
+    private:
+      void SkipSpaces()
+      {
+        while (m_Cursor < m_End && (*m_Cursor == ' ' || *m_Cursor == '\t'))
+          m_Cursor++;
+      }
+
+      void SkipLine()
+      {
+        while (m_Cursor < m_End && *m_Cursor != '\n')
+          m_Cursor++;
+        if (m_Cursor < m_End)
+          m_Cursor++;
+      }
+
+      bool AtLineEnd() const
+      {
+        return m_Cursor >= m_End || *m_Cursor == '\n' || *m_Cursor == '\r' || *m_Cursor == '#';
+      }
+
+      std::string_view ReadWord()
+      {
+        SkipSpaces();
+        const char* begin = m_Cursor;
+        while (m_Cursor < m_End && !std::isspace((unsigned char)*m_Cursor))
+          m_Cursor++;
+        return std::string_view(begin, m_Cursor - begin);
+      }
+
+      bool ReadFloats(std::vector<float>& out, int count);
+      bool ReadIndex(long& value);
+      bool ReadCorner(ObjCorner& corner);
+      // To a zero-based index, relative to the chunk if negative; -1 if absent.
+      static int ResolveIndex(long index, size_t count, uint32_t bit, uint32_t& relative);
+    private:
+      ObjChunk& m_Chunk;
+      const char* m_Cursor;
+      const char* m_End;
+      std::vector<ObjCorner> m_Polygon;
+    };
+
+    bool ObjParser::ReadFloats(std::vector<float>& out, int count)
+    {
+      for (int i = 0; i < count; i++)
+      {
+        SkipSpaces();
+        if (AtLineEnd())
+          return false;
+
+        // from_chars is exact and much faster than strtof; it rejects a leading '+'.
+        if (*m_Cursor == '+')
+          m_Cursor++;
+        float value;
+        auto [end, result] = std::from_chars(m_Cursor, m_End, value);
+        if (result != std::errc())
+          return false;
+        out.push_back(value);
+        m_Cursor = end;
+      }
+      return true;
+    }
+
+    bool ObjParser::ReadIndex(long& value)
+    {
+      bool negative = m_Cursor < m_End && *m_Cursor == '-';
+      const char* begin = m_Cursor + negative;
+      const char* cursor = begin;
+      long result = 0;
+      while (cursor < m_End && *cursor >= '0' && *cursor <= '9' && cursor - begin < 9)
+        result = result * 10 + (*cursor++ - '0');
+      if (cursor == begin)
+        return false;
+
+      value = negative ? -result : result;
+      m_Cursor = cursor;
+      return true;
+    }
+
+    int ObjParser::ResolveIndex(long index, size_t count, uint32_t bit, uint32_t& relative)
+    {
+      if (index > 0)
+        return (int)index - 1;
+      if (index == 0)
+        return -1;
+      relative |= bit;
+      return (int)(count + index);
+    }
+
+    bool ObjParser::ReadCorner(ObjCorner& corner)
+    {
+      // v, v/vt, v//vn or v/vt/vn
+      long indices[3] = { 0, 0, 0 };
+      for (int i = 0; i < 3; i++)
+      {
+        if (i > 0)
+        {
+          if (m_Cursor >= m_End || *m_Cursor != '/')
+            break;
+          m_Cursor++;
+        }
+
+        if (!ReadIndex(indices[i]) && i == 0)
+          return false;
+      }
+
+      corner.Relative = 0;
+      corner.Position = ResolveIndex(indices[0], m_Chunk.Positions.size() / 3, 1, corner.Relative);
+      corner.TexCoord = ResolveIndex(indices[1], m_Chunk.TexCoords.size() / 2, 2, corner.Relative);
+      corner.Normal = ResolveIndex(indices[2], m_Chunk.Normals.size() / 3, 4, corner.Relative);
+      return indices[0] != 0;
+    }
+
+    void ObjParser::Parse()
+    {
+      for (; m_Cursor < m_End; m_Chunk.Lines++)
+      {
+        SkipSpaces();
+        if (AtLineEnd())
+        {
+          SkipLine();
+          continue;
+        }
+
+        std::string_view keyword = ReadWord();
+        bool ok = true;
+        if (keyword == "v")
+        {
+          ok = ReadFloats(m_Chunk.Positions, 3);
+        }
+        else if (keyword == "vt")
+        {
+          ok = ReadFloats(m_Chunk.TexCoords, 2);
+        }
+        else if (keyword == "vn")
+        {
+          ok = ReadFloats(m_Chunk.Normals, 3);
+        }
+        else if (keyword == "f")
+        {
+          m_Polygon.clear();
+          ObjCorner corner;
+          for (SkipSpaces(); ok && !AtLineEnd(); SkipSpaces())
+          {
+            ok = ReadCorner(corner);
+            m_Polygon.push_back(corner);
+          }
+          ok = ok && m_Polygon.size() >= 3;
+
+          if (ok)
+          {
+            uint32_t first = m_Chunk.Corners.Insert(m_Polygon[0]);
+            uint32_t previous = m_Chunk.Corners.Insert(m_Polygon[1]);
+            for (size_t i = 2; i < m_Polygon.size(); i++)
+            {
+              uint32_t current = m_Chunk.Corners.Insert(m_Polygon[i]);
+              m_Chunk.Indices.insert(m_Chunk.Indices.end(), { first, previous, current });
+              previous = current;
+            }
+          }
+        }
+        else if (keyword == "usemtl")
+        {
+          m_Chunk.Materials.push_back({ (uint32_t)m_Chunk.Indices.size(), std::string(ReadWord()) });
+        }
+        // o, g, s, mtllib and anything else carry nothing we store.
+
+        if (!ok)
+        {
+          m_Chunk.Error = "malformed '" + std::string(keyword) + "'";
+          m_Chunk.ErrorLine = m_Chunk.Lines;
+          return;
+        }
+        SkipLine();
+      }
+    }
+
+  }
+
+  bool ImportObj(const char* text, size_t size, MeshData& mesh, std::string& error, const ObjImportSettings& settings)
+  {
+    mesh = MeshData();
+    ThreadPool& pool = ThreadPool::Get();
+    auto forEach = [&](uint32_t count, uint32_t chunkSize, const ThreadPool::RangeFn& fn)
+    {
+      if (settings.Parallel)
+        pool.ParallelFor(count, chunkSize, fn);
+      else
+        fn(0, count);
+    };
+
+    // Cut after the line break following every ChunkSize bytes.
+    std::vector<ObjChunk> chunks;
+    const char* end = text + size;
+    for (const char* begin = text; begin < end;)
+    {
+      const char* split = settings.Parallel ? begin + std::min(std::max(settings.ChunkSize, (size_t)1), (size_t)(end - begin)) : end;
+      while (split < end && split[-1] != '\n')
+        split++;
+      ObjChunk& chunk = chunks.emplace_back();
+      chunk.Begin = begin;
+      chunk.End = split;
+      begin = split;
+    }
+
+    forEach((uint32_t)chunks.size(), 1, [&chunks](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t i = begin; i < end; i++)
+        ObjParser(chunks[i]).Parse();
+    });
+
+    // Where each chunk's entries start in the whole file's lists.
+    struct ChunkBase
+    {
+      uint32_t Positions = 0, TexCoords = 0, Normals = 0, Indices = 0, Lines = 0;
+    };
+    std::vector<ChunkBase> bases(chunks.size() + 1);
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+      const ObjChunk& chunk = chunks[i];
+      if (!chunk.Error.empty())
+      {
+        error = chunk.Error + " on line " + std::to_string(bases[i].Lines + chunk.ErrorLine + 1);
+        return false;
+      }
+      bases[i + 1].Positions = bases[i].Positions + (uint32_t)(chunk.Positions.size() / 3);
+      bases[i + 1].TexCoords = bases[i].TexCoords + (uint32_t)(chunk.TexCoords.size() / 2);
+      bases[i + 1].Normals = bases[i].Normals + (uint32_t)(chunk.Normals.size() / 3);
+      bases[i + 1].Indices = bases[i].Indices + (uint32_t)chunk.Indices.size();
+      bases[i + 1].Lines = bases[i].Lines + chunk.Lines;
+    }
+    const ChunkBase& totals = bases.back();
+    if (totals.Indices == 0)
+    {
+      error = "no faces";
+      return false;
+    }
+
+    // Stitch: resolve every chunk's corners against the whole file and merge
+    // the ones chunks share. Serial, but only over distinct corners.
+    ObjCornerSet vertexSet;
+    vertexSet.Reserve(chunks[0].Corners.GetCorners().size() * chunks.size());
+    std::vector<std::vector<uint32_t>> remaps(chunks.size());
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+      const ChunkBase& base = bases[i];
+      const std::vector<ObjCorner>& corners = chunks[i].Corners.GetCorners();
+      remaps[i].resize(corners.size());
+      for (size_t j = 0; j < corners.size(); j++)
+      {
+        ObjCorner corner = corners[j];
+        corner.Position += corner.Relative & 1 ? base.Positions : 0;
+        corner.TexCoord += corner.Relative & 2 ? base.TexCoords : 0;
+        corner.Normal += corner.Relative & 4 ? base.Normals : 0;
+        corner.Relative = 0;
+        if (corner.Position < 0 || corner.Position >= (int)totals.Positions || corner.TexCoord < -1 || corner.TexCoord >= (int)totals.TexCoords
+          || corner.Normal < -1 || corner.Normal >= (int)totals.Normals)
+        {
+          error = "face index out of range";
+          return false;
+        }
+
+        remaps[i][j] = vertexSet.Insert(corner);
+      }
+    }
+    const std::vector<ObjCorner>& vertices = vertexSet.GetCorners();
+
+    // Gather the source lists, then build the streams and indices in parallel.
+    std::vector<float> positions(totals.Positions * 3), texCoords(totals.TexCoords * 2), normals(totals.Normals * 3);
+    mesh.Indices.resize(totals.Indices);
+    forEach((uint32_t)chunks.size(), 1, [&](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t i = begin; i < end; i++)
+      {
+        const ObjChunk& chunk = chunks[i];
+        std::copy(chunk.Positions.begin(), chunk.Positions.end(), positions.begin() + bases[i].Positions * 3);
+        std::copy(chunk.TexCoords.begin(), chunk.TexCoords.end(), texCoords.begin() + bases[i].TexCoords * 2);
+        std::copy(chunk.Normals.begin(), chunk.Normals.end(), normals.begin() + bases[i].Normals * 3);
+        for (size_t j = 0; j < chunk.Indices.size(); j++)
+          mesh.Indices[bases[i].Indices + j] = remaps[i][chunk.Indices[j]];
+      }
+    });
+
+    // Streams the file has no data for are left out of the mesh entirely;
+    // corners without a texcoord or normal get zeros.
+    std::vector<float>& positionStream = mesh.Streams[(size_t)VertexSemantic::Position];
+    std::vector<float>& texCoordStream = mesh.Streams[(size_t)VertexSemantic::TexCoord];
+    std::vector<float>& normalStream = mesh.Streams[(size_t)VertexSemantic::Normal];
+    positionStream.resize(vertices.size() * 3);
+    texCoordStream.resize(totals.TexCoords ? vertices.size() * 2 : 0);
+    normalStream.resize(totals.Normals ? vertices.size() * 3 : 0);
+    forEach((uint32_t)vertices.size(), 1 << 16, [&](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t i = begin; i < end; i++)
+      {
+        const ObjCorner& vertex = vertices[i];
+        for (int c = 0; c < 3; c++)
+          positionStream[i * 3 + c] = positions[vertex.Position * 3 + c];
+        if (totals.TexCoords)
+        {
+          for (int c = 0; c < 2; c++)
+            texCoordStream[i * 2 + c] = vertex.TexCoord >= 0 ? texCoords[vertex.TexCoord * 2 + c] : 0.0f;
+        }
+        if (totals.Normals)
+        {
+          for (int c = 0; c < 3; c++)
+            normalStream[i * 3 + c] = vertex.Normal >= 0 ? normals[vertex.Normal * 3 + c] : 0.0f;
+        }
+      }
+    });
+
+    // Faces before the first usemtl form a submesh of material 0; an empty
+    // submesh is just relabelled by the next usemtl.
+    std::unordered_map<std::string, uint32_t> materials;
+    mesh.Submeshes.push_back({ 0, 0, 0, 0, {}, {} });
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+      for (const auto& [indexCount, name] : chunks[i].Materials)
+      {
+        uint32_t firstIndex = bases[i].Indices + indexCount;
+        uint32_t material = materials.try_emplace(name, (uint32_t)materials.size()).first->second;
+        MeshSubmesh& current = mesh.Submeshes.back();
+        current.IndexCount = firstIndex - current.FirstIndex;
+        if (current.IndexCount > 0)
+          mesh.Submeshes.push_back({ firstIndex, 0, material, 0, {}, {} });
+        else
+          current.MaterialIndex = material;
+      }
+    }
+    mesh.Submeshes.back().IndexCount = totals.Indices - mesh.Submeshes.back().FirstIndex;
+    if (mesh.Submeshes.back().IndexCount == 0)
+      mesh.Submeshes.pop_back();
+
+    ComputeBounds(mesh);
+    return true;
+  }
+
+  bool ImportObjFile(const std::string& path, MeshData& mesh, std::string& error, const ObjImportSettings& settings)
+  {
+    MappedFile file;
+    if (!file.Open(path))
+    {
+      error = "could not open file";
+      return false;
+    }
+    return ImportObj((const char*)file.GetData(), file.GetSize(), mesh, error, settings);
+  }
+
+}
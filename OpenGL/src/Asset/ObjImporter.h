@@ -0,0 +1,27 @@
+#pragma once
+
+#include "MeshFile.h"
+
+namespace Hazel {
+
+  struct ObjImportSettings
+  {
+    // Off parses on the calling thread, for reference.
+    bool Parallel = true;
+    // Text per parse job; chunks are cut at line breaks.
+    size_t ChunkSize = 1 << 20;
+  };
+
+  // Wavefront OBJ to an indexed MeshData. Reads v, vt, vn and f (polygons are
+  // fanned into triangles, negative indices count back from the last entry);
+  // each usemtl starts a submesh with the material's index in order of first
+  // use. Identical position/texcoord/normal triples become one vertex.
+  //
+  // The text is cut into chunks parsed on the thread pool, each deduplicating
+  // its own corners; the chunks are then stitched together in file order, so
+  // the result is the same as a single pass would give.
+  bool ImportObj(const char* text, size_t size, MeshData& mesh, std::string& error, const ObjImportSettings& settings = ObjImportSettings());
+  // Parses the file straight from a read-only mapping.
+  bool ImportObjFile(const std::string& path, MeshData& mesh, std::string& error, const ObjImportSettings& settings = ObjImportSettings());
+
+}
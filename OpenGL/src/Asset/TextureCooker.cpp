@@ -0,0 +1,79 @@
+#include "TextureCooker.h"
+
+#include "Ktx2.h"
+
+namespace Hazel {
+
+  bool GetCookSettingsForRole(const std::string& role, TextureCookSettings& settings)
+  {
+    if (role == "color" || role == "srgb")
+    {
+      settings.Format = BlockFormat::BC7;
+      settings.SRGB = role == "srgb";
+      return true;
+    }
+    if (role == "mask")
+    {
+      settings.Format = BlockFormat::BC4;
+      settings.GammaCorrectMips = false;
+      return true;
+    }
+    if (role == "normal" || role == "data")
+    {
+      settings.Format = BlockFormat::BC5;
+      settings.GammaCorrectMips = false;
+      return true;
+    }
+    return false;
+  }
+
+  std::string GuessTextureRole(const std::string& path)
+  {
+    for (const char* suffix : { "_specular", "_mask", "_roughness", "_ao" })
+    {
+      if (path.find(suffix) != std::string::npos)
+        return "mask";
+    }
+    if (path.find("_normal") != std::string::npos)
+      return "normal";
+    return "color";
+  }
+
+  std::vector<uint8_t> CookTexture(const uint8_t* rgba, uint32_t width, uint32_t height, const TextureCookSettings& settings)
+  {
+    MipSettings mipSettings;
+    mipSettings.Filter = settings.Filter;
+    mipSettings.GammaCorrect = settings.GammaCorrectMips;
+
+    MipChain chain;
+    if (settings.Mips)
+      GenerateMipChain(rgba, width, height, 4, mipSettings, chain);
+    else
+      chain.Levels.push_back({ width, height, 0, (size_t)width * height * 4 });
+
+    std::vector<std::vector<uint8_t>> levels;
+    for (const MipLevel& level : chain.Levels)
+    {
+      const uint8_t* pixels = settings.Mips ? &chain.Data[level.Offset] : rgba;
+      levels.emplace_back(GetCompressedSize(settings.Format, level.Width, level.Height));
+      CompressImage(settings.Format, pixels, level.Width, level.Height, levels.back().data());
+    }
+
+    return WriteKtx2(GetKtx2Format(settings.Format, settings.SRGB), width, height, levels);
+  }
+
+  bool CookTextureFile(ImageDecoder& decoder, const uint8_t* data, size_t size, const TextureCookSettings& settings,
+    std::vector<uint8_t>& ktx2, ImageInfo& info, std::string& error)
+  {
+    // Stored bottom row first, the same orientation the runtime loader gives PNGs.
+    std::vector<uint8_t> image;
+    if (!decoder.Decode(data, size, 4, true, image, info))
+    {
+      error = decoder.GetError();
+      return false;
+    }
+    ktx2 = CookTexture(image.data(), info.Width, info.Height, settings);
+    return true;
+  }
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "BlockCompression.h"
+#include "ImageDecoder.h"
+#include "MipGenerator.h"
+
+namespace Hazel {
+
+  struct TextureCookSettings
+  {
+    BlockFormat Format = BlockFormat::BC7;
+    bool SRGB = false;
+    bool Mips = true;
+    MipFilter Filter = MipFilter::Kaiser;
+    // Colour content is sRGB encoded even when sampled as UNORM, so its mips
+    // are filtered in linear light.
+    bool GammaCorrectMips = true;
+  };
+
+  // Roles: "color" and "srgb" (BC7), "mask" (BC4), "normal" and "data" (BC5).
+  bool GetCookSettingsForRole(const std::string& role, TextureCookSettings& settings);
+  // Guesses the role from suffixes such as _specular or _normal; defaults to color.
+  std::string GuessTextureRole(const std::string& path);
+
+  // Block-compresses a tightly packed RGBA8 image and its mip chain into a KTX2 file.
+  std::vector<uint8_t> CookTexture(const uint8_t* rgba, uint32_t width, uint32_t height, const TextureCookSettings& settings);
+  // Decodes a PNG or JPEG and cooks it; info receives the source dimensions.
+  bool CookTextureFile(ImageDecoder& decoder, const uint8_t* data, size_t size, const TextureCookSettings& settings,
+    std::vector<uint8_t>& ktx2, ImageInfo& info, std::string& error);
+
+}
@@ -0,0 +1,168 @@
+#include "Benchmark.h"
+
+#include <filesystem>
+#include <random>
+
+#include "Core/FileSystem.h"
+#include "Core/Lz.h"
+#include "Core/ThreadPool.h"
+#include "Core/VirtualFileSystem.h"
+
+namespace Hazel {
+
+  static constexpr int Iterations = 3;
+  static constexpr uint32_t TextFiles = 1536;
+  static constexpr uint32_t BinaryFiles = 512;
+
+  // Shader-like text, and noise standing in for PNGs and other data that is
+  // compressed already.
+  static std::vector<AssetPackFile> MakeFiles()
+  {
+    std::mt19937 rng(42);
+    std::vector<AssetPackFile> files;
+    char line[128];
+    for (uint32_t i = 0; i < TextFiles; i++)
+    {
+      AssetPackFile file;
+      file.Path = "shaders/group" + std::to_string(i % 16) + "/shader" + std::to_string(i) + ".glsl";
+      uint32_t lines = 64 + rng() % 384;
+      for (uint32_t l = 0; l < lines; l++)
+      {
+        int length = snprintf(line, sizeof(line), "  vec3 light%u = u_Lights[%u].Color * max(dot(normal, dir%u), 0.0) * %.4f;\n", l, (uint32_t)(rng() % 64), l, (rng() % 10000) / 10000.0f);
+        file.Data.insert(file.Data.end(), line, line + length);
+      }
+      files.push_back(std::move(file));
+    }
+    for (uint32_t i = 0; i < BinaryFiles; i++)
+    {
+      AssetPackFile file;
+      file.Path = "textures/texture" + std::to_string(i) + ".png";
+      file.Data.resize(16384 + rng() % 49152);
+      for (uint8_t& byte : file.Data)
+        byte = (uint8_t)rng();
+      files.push_back(std::move(file));
+    }
+    return files;
+  }
+
+  // Reading every file of a project through the VirtualFileSystem: one open
+  // and read per file from a loose directory, against lookups in a mapped
+  // pack, stored as is or compressed, and opened in place or copied out.
+  // Files come from the page cache after the first pass.
+  HZ_BENCHMARK(assetpack)
+  {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "hazel_assetpack";
+    std::string rawPath = (std::filesystem::temp_directory_path() / "hazel_assets.hzpak").string();
+    std::string compressedPath = (std::filesystem::temp_directory_path() / "hazel_assets_lz.hzpak").string();
+
+    std::vector<AssetPackFile> files = MakeFiles();
+    size_t totalSize = 0, textSize = 0;
+    std::error_code fileError;
+    for (const AssetPackFile& file : files)
+    {
+      std::filesystem::path path = dir / file.Path;
+      std::filesystem::create_directories(path.parent_path(), fileError);
+      if (!WriteFile(path.string(), file.Data.data(), file.Data.size()))
+      {
+        HZ_HAZEL_ERROR("Could not write {0}", path.string());
+        return;
+      }
+      totalSize += file.Data.size();
+      if (file.Path.rfind("shaders/", 0) == 0)
+        textSize += file.Data.size();
+    }
+
+    Timer timer;
+    std::vector<uint8_t> raw = WriteAssetPack(files);
+    float writeMs = timer.ElapsedMillis();
+    timer.Reset();
+    std::vector<uint8_t> compressed = WriteAssetPack(files, true);
+    float writeCompressedMs = timer.ElapsedMillis();
+    if (!WriteFile(rawPath, raw.data(), raw.size()) || !WriteFile(compressedPath, compressed.data(), compressed.size()))
+    {
+      HZ_HAZEL_ERROR("Could not write {0}", rawPath);
+      return;
+    }
+
+    // The text alone through Lz, for the codec's own speed.
+    std::vector<uint8_t> text, lz, restored(textSize);
+    for (const AssetPackFile& file : files)
+    {
+      if (file.Path.rfind("shaders/", 0) == 0)
+        text.insert(text.end(), file.Data.begin(), file.Data.end());
+    }
+    timer.Reset();
+    LzCompress(text.data(), text.size(), lz);
+    float lzMs = timer.ElapsedMillis();
+    timer.Reset();
+    bool lzSame = true;
+    for (int it = 0; it < Iterations; it++)
+      lzSame &= LzDecompress(lz.data(), lz.size(), restored.data(), restored.size());
+    float unlzMs = timer.ElapsedMillis() / Iterations;
+    lzSame &= restored == text;
+
+    auto timeReads = [&](VirtualFileSystem& vfs, bool inPlace)
+    {
+      bool same = true;
+      Timer timer;
+      for (int it = 0; it < Iterations; it++)
+      {
+        for (const AssetPackFile& file : files)
+        {
+          if (inPlace)
+          {
+            VfsFile opened;
+            same &= vfs.Open(file.Path, opened) && opened.GetSize() == file.Data.size() && memcmp(opened.GetData(), file.Data.data(), file.Data.size()) == 0;
+          }
+          else
+          {
+            std::vector<uint8_t> data;
+            same &= vfs.Read(file.Path, data) && data == file.Data;
+          }
+        }
+      }
+      return std::make_pair(timer.ElapsedMillis() / Iterations, same);
+    };
+
+    VirtualFileSystem loose, rawPack, compressedPack;
+    std::string error;
+    if (!loose.MountDirectory(dir.string()) || !rawPack.MountPack(rawPath, error) || !compressedPack.MountPack(compressedPath, error))
+    {
+      HZ_HAZEL_ERROR("Could not mount the test assets: {0}", error);
+      return;
+    }
+    auto [looseMs, looseSame] = timeReads(loose, false);
+    auto [rawMs, rawSame] = timeReads(rawPack, false);
+    auto [rawOpenMs, rawOpenSame] = timeReads(rawPack, true);
+    auto [compressedMs, compressedSame] = timeReads(compressedPack, false);
+
+    timer.Reset();
+    uint32_t found = 0;
+    for (int it = 0; it < Iterations; it++)
+    {
+      for (const AssetPackFile& file : files)
+        found += rawPack.Exists(file.Path);
+    }
+    float lookupMs = timer.ElapsedMillis() / Iterations;
+
+    HZ_HAZEL_INFO("{0} files, {1:.1f} MB ({2:.1f} MB text) | pack {3:.1f} MB in {4:.1f} ms, compressed {5:.1f} MB in {6:.1f} ms | {7} threads",
+      files.size(), totalSize / 1e6f, textSize / 1e6f, raw.size() / 1e6f, writeMs, compressed.size() / 1e6f, writeCompressedMs, ThreadPool::Get().GetThreadCount());
+    HZ_HAZEL_INFO("  lz text {0:.1f}% | compress {1:.1f} MB/s, decompress {2:.1f} MB/s{3}",
+      100.0f * lz.size() / text.size(), Benchmark::ToMBps(text.size(), lzMs), Benchmark::ToMBps(text.size(), unlzMs), lzSame ? "" : " | RESULT DIFFERS");
+    auto report = [&](const char* name, float ms, bool same)
+    {
+      HZ_HAZEL_INFO("  {0:<18} {1:8.2f} ms {2:8.1f} MB/s {3:8.2f} us/file{4}", name, ms, Benchmark::ToMBps(totalSize, ms), ms * 1000.0f / files.size(), same ? "" : " | RESULT DIFFERS");
+    };
+    report("loose read", looseMs, looseSame);
+    report("pack read", rawMs, rawSame);
+    report("pack open", rawOpenMs, rawOpenSame);
+    report("pack lz read", compressedMs, compressedSame);
+    HZ_HAZEL_INFO("  {0:<18} {1:8.2f} ms {2:8.2f} us/file{3}", "pack lookup", lookupMs, lookupMs * 1000.0f / files.size(),
+      found == files.size() * Iterations ? "" : " | RESULT DIFFERS");
+
+    std::filesystem::remove_all(dir, fileError);
+    std::filesystem::remove(rawPath, fileError);
+    std::filesystem::remove(compressedPath, fileError);
+  }
+
+}
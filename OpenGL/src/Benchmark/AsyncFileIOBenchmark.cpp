@@ -0,0 +1,165 @@
+#include "Benchmark.h"
+
+#include <filesystem>
+#include <random>
+
+#include "Core/AsyncFileIO.h"
+#include "Core/FileSystem.h"
+#include "Core/ThreadPool.h"
+
+#ifdef __linux__
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+namespace Hazel {
+
+  static constexpr uint32_t FileCount = 384;
+
+  // Drops the files from the page cache so the next pass goes to storage.
+  // Only clean pages are dropped, which is all of them once written back.
+  static bool EvictFiles(const std::vector<std::string>& paths)
+  {
+#ifdef __linux__
+    bool evicted = true;
+    for (const std::string& path : paths)
+    {
+      int file = open(path.c_str(), O_RDONLY);
+      if (file < 0)
+        return false;
+      evicted &= fdatasync(file) == 0 && posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+      close(file);
+    }
+    return evicted;
+#else
+    return false;
+#endif
+  }
+
+  // Stands in for a decoder: touches every byte of what was read.
+  static uint64_t Checksum(const uint8_t* data, size_t size)
+  {
+    uint64_t sum = 0;
+    for (size_t i = 0; i + 8 <= size; i += 8)
+    {
+      uint64_t word;
+      memcpy(&word, data + i, 8);
+      sum = (sum ^ word) * 0x100000001B3ull;
+    }
+    return sum;
+  }
+
+  // Reading a level's worth of asset files and handing each to a job, the
+  // way TextureLoader does: blocking reads on the workers against
+  // AsyncFileIO's pread fallback and its io_uring backend. Each runs once
+  // from the page cache and once with the files evicted from it.
+  HZ_BENCHMARK(asyncio)
+  {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "hazel_asyncio";
+    std::error_code fileError;
+    std::filesystem::create_directories(dir, fileError);
+
+    // Sizes from small shaders up to a cooked 1k texture.
+    std::mt19937 rng(7);
+    std::vector<std::string> paths;
+    size_t totalSize = 0;
+    for (uint32_t i = 0; i < FileCount; i++)
+    {
+      std::vector<uint8_t> data(4096u << (rng() % 9));
+      for (uint8_t& byte : data)
+        byte = (uint8_t)rng();
+      paths.push_back((dir / ("file" + std::to_string(i) + ".bin")).string());
+      if (!WriteFile(paths.back(), data.data(), data.size()))
+      {
+        HZ_HAZEL_ERROR("Could not write {0}", paths.back());
+        return;
+      }
+      totalSize += data.size();
+    }
+
+    uint64_t expected = 0;
+    for (const std::string& path : paths)
+    {
+      std::vector<uint8_t> data;
+      ReadFile(path, data);
+      expected += Checksum(data.data(), data.size());
+    }
+
+    auto readBlocking = [&]()
+    {
+      std::atomic<uint64_t> sum{ 0 };
+      ThreadPool::Get().ParallelFor((uint32_t)paths.size(), 1, [&](uint32_t begin, uint32_t end)
+      {
+        std::vector<uint8_t> data;
+        for (uint32_t i = begin; i < end; i++)
+        {
+          if (ReadFile(paths[i], data))
+            sum += Checksum(data.data(), data.size());
+        }
+      });
+      return sum.load();
+    };
+
+    auto readAsync = [&](AsyncFileIO& io)
+    {
+      std::atomic<uint64_t> sum{ 0 };
+      std::atomic<uint32_t> remaining{ (uint32_t)paths.size() };
+      for (const std::string& path : paths)
+      {
+        io.ReadFile(path, [&](const FileReadResult& file)
+        {
+          if (file.Error.empty())
+            sum += Checksum(file.Data, file.Size);
+          remaining--;
+        });
+      }
+      while (remaining.load() > 0)
+        std::this_thread::yield();
+      return sum.load();
+    };
+
+    AsyncFileIO fallback(false);
+    AsyncFileIO uring(true);
+    struct Result
+    {
+      const char* Name;
+      float CachedMs, ColdMs;
+      bool Same;
+    };
+    std::vector<Result> results;
+    auto measure = [&](const char* name, const std::function<uint64_t()>& fn)
+    {
+      Result result = { name, 0.0f, 0.0f, true };
+      Timer timer;
+      result.Same &= fn() == expected;
+      result.CachedMs = timer.ElapsedMillis();
+      result.ColdMs = -1.0f;
+      if (EvictFiles(paths))
+      {
+        timer.Reset();
+        result.Same &= fn() == expected;
+        result.ColdMs = timer.ElapsedMillis();
+      }
+      results.push_back(result);
+    };
+
+    measure("blocking workers", readBlocking);
+    measure("async pread", [&]() { return readAsync(fallback); });
+    if (uring.IsUsingUring())
+      measure("async io_uring", [&]() { return readAsync(uring); });
+
+    AsyncFileIO::Stats stats = uring.GetStats();
+    HZ_HAZEL_INFO("{0} files, {1:.1f} MB | {2} threads | io_uring {3}: {4} reads in {5} submits, {6} into registered buffers",
+      paths.size(), totalSize / 1e6f, ThreadPool::Get().GetThreadCount(), uring.IsUsingUring() ? "on" : "off",
+      stats.Reads, stats.Submits, stats.FixedBufferReads);
+    for (const Result& result : results)
+    {
+      HZ_HAZEL_INFO("  {0:<18} cached {1:8.2f} ms {2:8.1f} MB/s | evicted {3:8.2f} ms {4:8.1f} MB/s{5}",
+        result.Name, result.CachedMs, Benchmark::ToMBps(totalSize, result.CachedMs), result.ColdMs, Benchmark::ToMBps(totalSize, result.ColdMs),
+        result.Same ? "" : " | RESULT DIFFERS");
+    }
+
+    std::filesystem::remove_all(dir, fileError);
+  }
+
+}
@@ -0,0 +1,42 @@
+#include "Benchmark.h"
+
+namespace Hazel::Benchmark {
+
+  static std::vector<std::pair<std::string, BenchmarkFn>>& GetBenchmarks()
+  {
+    static std::vector<std::pair<std::string, BenchmarkFn>> s_Benchmarks;
+    return s_Benchmarks;
+  }
+
+  Registration::Registration(const char* name, BenchmarkFn fn)
+  {
+    GetBenchmarks().emplace_back(name, fn);
+  }
+
+  int Run(const std::string& name)
+  {
+    auto& benchmarks = GetBenchmarks();
+    std::sort(benchmarks.begin(), benchmarks.end());
+
+    bool found = false;
+    for (auto& [benchmarkName, fn] : benchmarks)
+    {
+      if (name != "all" && name != benchmarkName)
+        continue;
+
+      found = true;
+      HZ_HAZEL_INFO("=== {0} ===", benchmarkName);
+      fn();
+    }
+
+    if (!found)
+    {
+      HZ_HAZEL_ERROR("Unknown benchmark '{0}'", name);
+      for (auto& [benchmarkName, fn] : benchmarks)
+        HZ_HAZEL_INFO("  {0}", benchmarkName);
+      return -1;
+    }
+    return 0;
+  }
+
+}
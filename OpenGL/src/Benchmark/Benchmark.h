@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Core/Timer.h"
+
+// Headless CPU benchmarks, run with `OpenGL --bench <name|all>`.
+namespace Hazel::Benchmark {
+
+  using BenchmarkFn = void(*)();
+
+  struct Registration
+  {
+    Registration(const char* name, BenchmarkFn fn);
+  };
+
+  // Returns the process exit code.
+  int Run(const std::string& name);
+
+  // Written by DoNotOptimize where there is no inline assembly (MSVC on x64).
+  inline const volatile void* g_Sink = nullptr;
+
+  // Keeps the optimizer from discarding a benchmarked result (pass a checksum).
+  template<typename T>
+  inline void DoNotOptimize(const T& value)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    g_Sink = &value;
+#endif
+  }
+
+  // Megabytes per second for bytes handled in ms milliseconds.
+  inline float ToMBps(size_t bytes, float ms)
+  {
+    return bytes / 1e6f / std::max(ms / 1000.0f, 1e-6f);
+  }
+
+}
+
+#define HZ_BENCHMARK(name) \
+  static void Benchmark_##name(); \
+  static ::Hazel::Benchmark::Registration s_Benchmark_##name##_Registration(#name, Benchmark_##name); \
+  static void Benchmark_##name()
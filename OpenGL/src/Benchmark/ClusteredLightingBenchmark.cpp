@@ -0,0 +1,52 @@
+#include "Benchmark.h"
+
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Renderer/ClusteredLighting.h"
+
+namespace Hazel {
+
+  static constexpr int Iterations = 50;
+
+  HZ_BENCHMARK(clustered)
+  {
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    float fovY = glm::radians(45.0f), aspect = 960.0f / 600.0f;
+
+    ClusteredLighting clustered;
+    for (uint32_t count : { 1u, 16u, 64u, 256u, 1024u, 4096u })
+    {
+      std::mt19937 rng(count);
+      std::uniform_real_distribution<float> position(-40.0f, 40.0f);
+      std::uniform_real_distribution<float> radius(1.0f, 5.0f);
+
+      std::vector<PointLight> lights(count);
+      for (PointLight& light : lights)
+      {
+        light.Position = glm::vec3(position(rng), position(rng) * 0.25f, position(rng) - 40.0f);
+        light.Radius = radius(rng);
+        light.Ambient = glm::vec3(0.0f);
+        light.Diffuse = light.Specular = glm::vec3(1.0f);
+      }
+
+      Timer timer;
+      for (int it = 0; it < Iterations; it++)
+        clustered.Build(lights, view, fovY, aspect, 0.1f, 100.0f);
+      float buildMs = timer.ElapsedMillis() / Iterations;
+
+      uint32_t occupied = 0;
+      for (const glm::uvec2& cluster : clustered.GetClusters())
+        occupied += cluster.y > 0;
+
+      const auto& stats = clustered.GetStats();
+      float averageLights = occupied ? (float)stats.LightIndexCount / occupied : 0.0f;
+      Benchmark::DoNotOptimize(stats.LightIndexCount);
+
+      // A forward shader without clusters would loop over every light per fragment.
+      HZ_HAZEL_INFO("{0:>5} lights: build {1:7.3f} ms | {2:>5} visible | {3:>6} indices | avg {4:6.2f} / max {5:>3} lights per occupied cluster (vs {0} unclustered)",
+        count, buildMs, stats.VisibleLightCount, stats.LightIndexCount, averageLights, stats.MaxClusterLights);
+    }
+  }
+
+}
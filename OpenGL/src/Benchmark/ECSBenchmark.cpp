@@ -0,0 +1,101 @@
+#include "Benchmark.h"
+
+#include <random>
+#include <glm/glm.hpp>
+
+#include "Scene/Registry.h"
+
+namespace Hazel {
+
+  namespace {
+
+    struct Position { glm::vec3 Value; };
+    struct Velocity { glm::vec3 Value; };
+    // Present on some entities only, so the query has to span several archetypes.
+    struct Health { float Value; };
+
+    // Baseline: one heap object per entity, as a classic scene graph would store it.
+    class GameObject
+    {
+    public:
+      virtual ~GameObject() = default;
+      virtual void Update(float dt) { m_Position += m_Velocity * dt; }
+
+      glm::vec3 m_Position{ 0.0f };
+      glm::vec3 m_Velocity{ 1.0f };
+      float m_Health = 100.0f;
+      std::string m_Name = "GameObject";
+    };
+
+  }
+
+  static constexpr int Iterations = 20;
+
+  HZ_BENCHMARK(ecs)
+  {
+    const float dt = 1.0f / 60.0f;
+
+    for (uint32_t count : { 10000u, 100000u, 500000u })
+    {
+      // Object-per-entity baseline, visited in shuffled order like a pointer graph.
+      std::vector<Scope<GameObject>> objects;
+      objects.reserve(count);
+      for (uint32_t i = 0; i < count; i++)
+        objects.push_back(CreateScope<GameObject>());
+      std::shuffle(objects.begin(), objects.end(), std::mt19937(42));
+
+      Timer timer;
+      for (int it = 0; it < Iterations; it++)
+      {
+        for (auto& object : objects)
+          object->Update(dt);
+      }
+      float objectMs = timer.ElapsedMillis() / Iterations;
+      Benchmark::DoNotOptimize(objects.front()->m_Position.x);
+
+      Registry registry;
+      timer.Reset();
+      for (uint32_t i = 0; i < count; i++)
+      {
+        Entity entity = registry.Create(Position{ glm::vec3(0.0f) }, Velocity{ glm::vec3(1.0f) });
+        if (i % 2)
+          registry.Add<Health>(entity, Health{ 100.0f });
+      }
+      float createMs = timer.ElapsedMillis();
+
+      auto query = registry.GetQuery<Position, Velocity>();
+
+      timer.Reset();
+      for (int it = 0; it < Iterations; it++)
+      {
+        query.ForEachChunk([dt](uint32_t n, const Entity*, Position* position, Velocity* velocity)
+        {
+          for (uint32_t i = 0; i < n; i++)
+            position[i].Value += velocity[i].Value * dt;
+        });
+      }
+      float serialMs = timer.ElapsedMillis() / Iterations;
+
+      timer.Reset();
+      for (int it = 0; it < Iterations; it++)
+      {
+        query.ParallelForEach([dt](Position& position, Velocity& velocity)
+        {
+          position.Value += velocity.Value * dt;
+        });
+      }
+      float parallelMs = timer.ElapsedMillis() / Iterations;
+
+      float checksum = 0.0f;
+      query.ForEach([&](Position& position, Velocity&) { checksum += position.Value.x; });
+      Benchmark::DoNotOptimize(checksum);
+
+      HZ_HAZEL_INFO("{0:>7} entities: create {1:7.2f} ms | objects {2:7.3f} ms ({3:5.2f} ns/e) | ecs {4:7.3f} ms ({5:5.2f} ns/e) | ecs x{6} threads {7:7.3f} ms ({8:5.2f} ns/e)",
+        count, createMs,
+        objectMs, objectMs * 1e6f / count,
+        serialMs, serialMs * 1e6f / count,
+        ThreadPool::Get().GetThreadCount() + 1, parallelMs, parallelMs * 1e6f / count);
+    }
+  }
+
+}
@@ -0,0 +1,282 @@
+#include "Benchmark.h"
+
+#include <filesystem>
+
+#include "Asset/GltfImporter.h"
+#include "Asset/MeshCodec.h"
+#include "Asset/MeshFile.h"
+#include "Asset/ObjImporter.h"
+#include "Core/FileSystem.h"
+#include "Core/MappedFile.h"
+#include "Core/ThreadPool.h"
+
+namespace Hazel {
+
+  static constexpr int Iterations = 3;
+  static constexpr uint32_t GridSize = 1024;
+
+  // Reads every page, as the driver would when uploading.
+  static uint32_t TouchPages(const uint8_t* data, size_t size)
+  {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < size; i += 4096)
+      sum += data[i];
+    return sum;
+  }
+
+  // Indices equal, attributes equal up to text round-off.
+  static bool IsSameMesh(const MeshData& a, const MeshData& b)
+  {
+    if (a.Indices != b.Indices)
+      return false;
+    for (size_t i = 0; i < a.Streams.size(); i++)
+    {
+      if (a.Streams[i].size() != b.Streams[i].size())
+        return false;
+      for (size_t j = 0; j < a.Streams[i].size(); j++)
+      {
+        if (std::abs(a.Streams[i][j] - b.Streams[i][j]) > 1e-6f)
+          return false;
+      }
+    }
+    return true;
+  }
+
+  // A GridSize x GridSize quad terrain tile as OBJ text.
+  static std::string MakeGridObj()
+  {
+    std::string text;
+    char line[128];
+    for (uint32_t y = 0; y <= GridSize; y++)
+    {
+      for (uint32_t x = 0; x <= GridSize; x++)
+      {
+        float height = 0.25f * std::sin(x * 0.1f) * std::cos(y * 0.1f);
+        snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\n", x * 0.1f, height, y * 0.1f, (float)x / GridSize, (float)y / GridSize);
+        text += line;
+      }
+    }
+    text += "vn 0 1 0\n";
+    for (uint32_t y = 0; y < GridSize; y++)
+    {
+      for (uint32_t x = 0; x < GridSize; x++)
+      {
+        uint32_t i = y * (GridSize + 1) + x + 1;
+        uint32_t j = i + GridSize + 1;
+        snprintf(line, sizeof(line), "f %u/%u/1 %u/%u/1 %u/%u/1 %u/%u/1\n", i, i, j, j, j + 1, j + 1, i + 1, i + 1);
+        text += line;
+      }
+    }
+    return text;
+  }
+
+  // The same mesh as a .glb: one primitive, float streams and 32-bit indices.
+  static std::vector<uint8_t> MakeGlb(const MeshData& mesh)
+  {
+    std::vector<uint8_t> binary;
+    std::string views, accessors;
+    auto addView = [&](const void* data, size_t size, uint32_t count, uint32_t componentType, const char* type)
+    {
+      size_t index = views.empty() ? 0 : std::count(views.begin(), views.end(), '{');
+      views += std::string(views.empty() ? "" : ",") + "{\"buffer\":0,\"byteOffset\":" + std::to_string(binary.size()) + ",\"byteLength\":" + std::to_string(size) + "}";
+      accessors += std::string(accessors.empty() ? "" : ",") + "{\"bufferView\":" + std::to_string(index) + ",\"componentType\":" + std::to_string(componentType)
+        + ",\"count\":" + std::to_string(count) + ",\"type\":\"" + type + "\"}";
+      binary.insert(binary.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+    };
+    const auto& streams = mesh.Streams;
+    addView(streams[0].data(), streams[0].size() * 4, mesh.GetVertexCount(), 5126, "VEC3");
+    addView(streams[1].data(), streams[1].size() * 4, mesh.GetVertexCount(), 5126, "VEC3");
+    // glTF texcoords start at the top.
+    std::vector<float> texCoords = streams[2];
+    for (size_t i = 1; i < texCoords.size(); i += 2)
+      texCoords[i] = 1.0f - texCoords[i];
+    addView(texCoords.data(), texCoords.size() * 4, mesh.GetVertexCount(), 5126, "VEC2");
+    addView(mesh.Indices.data(), mesh.Indices.size() * 4, (uint32_t)mesh.Indices.size(), 5125, "SCALAR");
+
+    std::string json = "{\"asset\":{\"version\":\"2.0\"},\"buffers\":[{\"byteLength\":" + std::to_string(binary.size()) + "}],\"bufferViews\":[" + views
+      + "],\"accessors\":[" + accessors + "],\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3}]}]}";
+    json.resize((json.size() + 3) & ~(size_t)3, ' ');
+
+    uint32_t header[5] = { 0x46546C67, 2, (uint32_t)(20 + json.size() + 8 + binary.size()), (uint32_t)json.size(), 0x4E4F534A };
+    uint32_t binaryHeader[2] = { (uint32_t)binary.size(), 0x004E4942 };
+    std::vector<uint8_t> glb((const uint8_t*)header, (const uint8_t*)header + sizeof(header));
+    glb.insert(glb.end(), json.begin(), json.end());
+    glb.insert(glb.end(), (const uint8_t*)binaryHeader, (const uint8_t*)binaryHeader + sizeof(binaryHeader));
+    glb.insert(glb.end(), binary.begin(), binary.end());
+    return glb;
+  }
+
+  // Getting a mesh ready for upload: importing OBJ text and a .glb, on one
+  // thread and on the pool, against the cooked .hzmesh, read into memory or
+  // memory-mapped. The mapped file is validated in place and its pages
+  // touched, which is all glBufferData needs from it. Files come from the
+  // page cache after the first pass.
+  HZ_BENCHMARK(meshes)
+  {
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::string objPath = (dir / "hazel_grid.obj").string();
+    std::string glbPath = (dir / "hazel_grid.glb").string();
+    std::string meshPath = (dir / "hazel_grid.hzmesh").string();
+
+    std::string text = MakeGridObj();
+    MeshData mesh;
+    std::string error;
+    if (!WriteFile(objPath, text.data(), text.size()) || !ImportObjFile(objPath, mesh, error))
+    {
+      HZ_HAZEL_ERROR("Could not write or import {0}: {1}", objPath, error);
+      return;
+    }
+    std::vector<uint8_t> glb = MakeGlb(mesh);
+    std::vector<uint8_t> cooked = WriteMeshFile(mesh);
+    if (!WriteFile(glbPath, glb.data(), glb.size()) || !WriteFile(meshPath, cooked.data(), cooked.size()))
+    {
+      HZ_HAZEL_ERROR("Could not write {0}", meshPath);
+      return;
+    }
+    size_t triangles = mesh.Indices.size() / 3;
+
+    // Every import must rebuild the mesh the files were written from.
+    auto timeImport = [&](auto import)
+    {
+      float ms = 0.0f;
+      bool same = true;
+      for (int it = 0; it < Iterations; it++)
+      {
+        MeshData imported;
+        Timer timer;
+        import(imported);
+        ms += timer.ElapsedMillis();
+        same &= IsSameMesh(imported, mesh);
+      }
+      return std::make_pair(ms / Iterations, same);
+    };
+    ObjImportSettings serialObj;
+    serialObj.Parallel = false;
+    GltfImportSettings serialGltf;
+    serialGltf.Parallel = false;
+    auto [objSerialMs, objSerialSame] = timeImport([&](MeshData& out) { ImportObjFile(objPath, out, error, serialObj); });
+    auto [objMs, objSame] = timeImport([&](MeshData& out) { ImportObjFile(objPath, out, error); });
+    auto [glbSerialMs, glbSerialSame] = timeImport([&](MeshData& out) { ImportGltfFile(glbPath, out, error, serialGltf); });
+    auto [glbMs, glbSame] = timeImport([&](MeshData& out) { ImportGltfFile(glbPath, out, error); });
+
+    Timer timer;
+    for (int it = 0; it < Iterations; it++)
+    {
+      std::vector<uint8_t> data;
+      MeshView view;
+      ReadFile(meshPath, data);
+      ReadMeshFile(data.data(), data.size(), view, error);
+      Benchmark::DoNotOptimize(view.IndexCount);
+    }
+    float readMs = timer.ElapsedMillis() / Iterations;
+
+    timer.Reset();
+    for (int it = 0; it < Iterations; it++)
+    {
+      MappedFile file;
+      MeshView view;
+      file.Open(meshPath);
+      ReadMeshFile(file.GetData(), file.GetSize(), view, error);
+      Benchmark::DoNotOptimize(TouchPages(file.GetData(), file.GetSize()));
+    }
+    float mapMs = timer.ElapsedMillis() / Iterations;
+
+    HZ_HAZEL_INFO("{0}x{1} grid: {2} vertices, {3} triangles | obj {4:.1f} MB, glb {5:.1f} MB, hzmesh {6:.1f} MB | {7} threads",
+      GridSize, GridSize, mesh.GetVertexCount(), triangles, text.size() / 1e6f, glb.size() / 1e6f, cooked.size() / 1e6f, ThreadPool::Get().GetThreadCount());
+    auto report = [&](const char* name, size_t bytes, float ms, bool same)
+    {
+      HZ_HAZEL_INFO("  {0:<15} {1:8.2f} ms {2:8.1f} MB/s {3:8.2f} Mtris/s{4}", name, ms, Benchmark::ToMBps(bytes, ms), triangles / 1e3f / ms, same ? "" : " | RESULT DIFFERS");
+    };
+    report("obj serial", text.size(), objSerialMs, objSerialSame);
+    report("obj parallel", text.size(), objMs, objSame);
+    report("glb serial", glb.size(), glbSerialMs, glbSerialSame);
+    report("glb parallel", glb.size(), glbMs, glbSame);
+    report("hzmesh read", cooked.size(), readMs, true);
+    report("hzmesh mapped", cooked.size(), mapMs, true);
+
+    std::error_code removeError;
+    std::filesystem::remove(objPath, removeError);
+    std::filesystem::remove(glbPath, removeError);
+    std::filesystem::remove(meshPath, removeError);
+  }
+
+
+  // The Packed encoding on the same grid: size and decode speed of every
+  // section with the SIMD and the scalar decoder, then whole files read and
+  // decoded, one section per job or all on one thread, against the raw file.
+  HZ_BENCHMARK(meshcodec)
+  {
+    std::string text = MakeGridObj();
+    MeshData mesh;
+    std::string error;
+    if (!ImportObj(text.data(), text.size(), mesh, error))
+    {
+      HZ_HAZEL_ERROR("Could not import the grid: {0}", error);
+      return;
+    }
+
+    HZ_HAZEL_INFO("{0}x{1} grid: {2} vertices, {3} triangles", GridSize, GridSize, mesh.GetVertexCount(), mesh.Indices.size() / 3);
+    auto timeSection = [&](const char* name, const uint32_t* values, size_t count, uint32_t components)
+    {
+      std::vector<uint8_t> encoded;
+      Timer timer;
+      EncodeStream(values, count, components, encoded);
+      float encodeMs = timer.ElapsedMillis();
+
+      size_t bytes = count * components * sizeof(uint32_t);
+      std::vector<uint32_t> decoded(count * components);
+      float decodeMs[2];
+      bool same = true;
+      for (int simd = 0; simd < 2; simd++)
+      {
+        timer.Reset();
+        for (int it = 0; it < Iterations; it++)
+          same &= DecodeStream(encoded.data(), encoded.size(), count, components, decoded.data(), simd != 0);
+        decodeMs[simd] = timer.ElapsedMillis() / Iterations;
+        same &= memcmp(decoded.data(), values, bytes) == 0;
+      }
+      HZ_HAZEL_INFO("  {0:<10} {1:7.2f} MB -> {2:6.2f} MB ({3:5.1f}%) | encode {4:8.1f} MB/s | decode scalar {5:8.1f} MB/s, simd {6:8.1f} MB/s{7}",
+        name, bytes / 1e6f, encoded.size() / 1e6f, 100.0f * encoded.size() / bytes, Benchmark::ToMBps(bytes, encodeMs), Benchmark::ToMBps(bytes, decodeMs[0]), Benchmark::ToMBps(bytes, decodeMs[1]),
+        same ? "" : " | RESULT DIFFERS");
+    };
+    const char* names[] = { "position", "normal", "texcoord" };
+    for (size_t i = 0; i < mesh.Streams.size(); i++)
+    {
+      uint32_t components = GetComponentCount((VertexSemantic)i);
+      timeSection(names[i], (const uint32_t*)mesh.Streams[i].data(), mesh.Streams[i].size() / components, components);
+    }
+    timeSection("indices", mesh.Indices.data(), mesh.Indices.size() / 3, 3);
+
+    std::vector<uint8_t> raw = WriteMeshFile(mesh);
+    std::vector<uint8_t> packed = WriteMeshFile(mesh, true);
+    MeshView rawView;
+    ReadMeshFile(raw.data(), raw.size(), rawView, error);
+    auto timeLoad = [&](const std::vector<uint8_t>& file, bool parallel)
+    {
+      bool same = true;
+      Timer timer;
+      for (int it = 0; it < Iterations; it++)
+      {
+        MeshView view, decoded;
+        std::vector<uint8_t> storage;
+        same &= ReadMeshFile(file.data(), file.size(), view, error) && DecodeMeshView(view, storage, decoded, error, parallel);
+        Benchmark::DoNotOptimize(TouchPages((const uint8_t*)decoded.Indices, decoded.IndexCount * decoded.IndexSize));
+        same &= decoded.IndexSize == rawView.IndexSize && memcmp(decoded.Indices, rawView.Indices, rawView.IndexCount * rawView.IndexSize) == 0;
+      }
+      return std::make_pair(timer.ElapsedMillis() / Iterations, same);
+    };
+    auto [rawMs, rawSame] = timeLoad(raw, true);
+    auto [serialMs, serialSame] = timeLoad(packed, false);
+    auto [parallelMs, parallelSame] = timeLoad(packed, true);
+
+    HZ_HAZEL_INFO("  hzmesh {0:.1f} MB raw, {1:.1f} MB packed | {2} threads", raw.size() / 1e6f, packed.size() / 1e6f, ThreadPool::Get().GetThreadCount());
+    auto report = [&](const char* name, float ms, bool same)
+    {
+      HZ_HAZEL_INFO("  {0:<15} {1:8.2f} ms {2:8.1f} MB/s decoded{3}", name, ms, Benchmark::ToMBps(raw.size(), ms), same ? "" : " | RESULT DIFFERS");
+    };
+    report("raw", rawMs, rawSame);
+    report("packed serial", serialMs, serialSame);
+    report("packed parallel", parallelMs, parallelSame);
+  }
+
+}
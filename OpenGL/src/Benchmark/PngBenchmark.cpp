@@ -0,0 +1,108 @@
+#include "Benchmark.h"
+
+#include <filesystem>
+#include <stb_image.h>
+
+#include "Asset/ImageDecoder.h"
+#include "Core/FileSystem.h"
+#include "Core/Simd.h"
+
+namespace Hazel {
+
+  static constexpr int Iterations = 10;
+
+  struct PngFile
+  {
+    std::string Name;
+    std::vector<uint8_t> Data;
+    ImageInfo Info;
+  };
+
+  // Stock stbi_load_from_memory, a fresh allocation per image, against
+  // ImageDecoder writing into one reused buffer with the scalar and the SSE2
+  // unfilter. Files are read up front so only decoding is timed. Decodes
+  // every PNG in $HAZEL_PNG_DIR, or the bundled textures.
+  HZ_BENCHMARK(png)
+  {
+    const char* dir = std::getenv("HAZEL_PNG_DIR");
+    std::filesystem::path directory = dir ? dir : AssetsDir + "/assets/textures";
+
+    std::vector<PngFile> files;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+    {
+      if (entry.path().extension() != ".png")
+        continue;
+
+      PngFile file;
+      file.Name = entry.path().filename().string();
+      ImageDecoder decoder;
+      if (ReadFile(entry.path().string(), file.Data) && decoder.ReadInfo(file.Data.data(), file.Data.size(), file.Info))
+        files.push_back(std::move(file));
+    }
+    if (files.empty())
+    {
+      HZ_HAZEL_ERROR("No PNGs in {0}", directory.string());
+      return;
+    }
+
+    ImageDecoder scalarDecoder, simdDecoder;
+    scalarDecoder.GetSettings().Simd = false;
+    std::vector<uint8_t> output;
+    float totalStbMs = 0.0f, totalScalarMs = 0.0f, totalSimdMs = 0.0f;
+    size_t totalBytes = 0;
+    for (const PngFile& file : files)
+    {
+      const ImageInfo& info = file.Info;
+      size_t bytes = (size_t)info.Width * info.Height * info.Channels;
+      output.resize(bytes);
+
+      Timer timer;
+      for (int it = 0; it < Iterations; it++)
+      {
+        int width, height, channels;
+        stbi_uc* pixels = stbi_load_from_memory(file.Data.data(), (int)file.Data.size(), &width, &height, &channels, 0);
+        Benchmark::DoNotOptimize(pixels ? pixels[bytes - 1] : 0);
+        stbi_image_free(pixels);
+      }
+      float stbMs = timer.ElapsedMillis() / Iterations;
+
+      auto time = [&](ImageDecoder& decoder)
+      {
+        Timer timer;
+        for (int it = 0; it < Iterations; it++)
+        {
+          decoder.Decode(file.Data.data(), file.Data.size(), 0, false, output.data());
+          Benchmark::DoNotOptimize(output.back());
+        }
+        return timer.ElapsedMillis() / Iterations;
+      };
+      float scalarMs = time(scalarDecoder);
+      float simdMs = time(simdDecoder);
+
+      int width, height, channels;
+      stbi_uc* reference = stbi_load_from_memory(file.Data.data(), (int)file.Data.size(), &width, &height, &channels, 0);
+      bool identical = reference && memcmp(reference, output.data(), bytes) == 0;
+      stbi_image_free(reference);
+
+      HZ_HAZEL_INFO("{0:<32} {1}x{2}x{3} | stb {4:6.2f} ms {5:6.1f} MB/s | scalar {6:6.2f} ms {7:6.1f} MB/s | simd {8:6.2f} ms {9:6.1f} MB/s | {10:4.2f}x{11}",
+        file.Name, info.Width, info.Height, info.Channels, stbMs, Benchmark::ToMBps(bytes, stbMs), scalarMs, Benchmark::ToMBps(bytes, scalarMs),
+        simdMs, Benchmark::ToMBps(bytes, simdMs), stbMs / std::max(simdMs, 1e-3f), identical ? "" : " | OUTPUT DIFFERS FROM STB");
+
+      totalStbMs += stbMs;
+      totalScalarMs += scalarMs;
+      totalSimdMs += simdMs;
+      totalBytes += bytes;
+    }
+
+#if HZ_SIMD_SSE2
+    const char* simdName = "SSE2";
+#else
+    const char* simdName = "none";
+#endif
+    HZ_HAZEL_INFO("{0} files, {1:.1f} MB decoded | stb {2:.1f} MB/s, scalar {3:.1f} MB/s, simd {4:.1f} MB/s ({5}) | {6:.2f}x",
+      files.size(), totalBytes / 1e6f, Benchmark::ToMBps(totalBytes, totalStbMs), Benchmark::ToMBps(totalBytes, totalScalarMs),
+      Benchmark::ToMBps(totalBytes, totalSimdMs), simdName, totalStbMs / std::max(totalSimdMs, 1e-3f));
+  }
+
+}
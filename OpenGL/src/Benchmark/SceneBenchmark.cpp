@@ -0,0 +1,114 @@
+#include "Benchmark.h"
+
+#include <filesystem>
+
+#include "Core/MappedFile.h"
+#include "Scene/SceneSerializer.h"
+
+namespace Hazel {
+
+  static constexpr int Iterations = 3;
+  static constexpr uint32_t EntityCount = 1000000;
+
+  // Sums world positions and component fields in query order, which a load
+  // keeps, so a faithful round trip gives the same value bit for bit.
+  static double GetChecksum(Scene& scene)
+  {
+    scene.OnUpdate();
+    TransformSystem& transforms = scene.GetTransforms();
+    double sum = 0.0;
+    scene.GetRegistry().GetQuery<TransformComponent, MeshRendererComponent, BoundsComponent>().ForEach(
+      [&](TransformComponent& transform, MeshRendererComponent& mesh, BoundsComponent& bounds)
+    {
+      const glm::mat4& world = transforms.GetWorldMatrix(transform.Transform);
+      sum += world[3].x + 2.0 * world[3].y + 3.0 * world[3].z + bounds.Max.x + mesh.VertexArray + mesh.FirstVertex + mesh.Shininess;
+    });
+    return sum;
+  }
+
+  // Getting a large scene into the registry: built entity by entity, as game
+  // code or a text format would, against saving it to a .hzscene and loading
+  // that back from a mapping. Every fourth entity is a root carrying the next
+  // three; a few are lights. The loaded scene must give the same checksum and
+  // save to the same bytes.
+  HZ_BENCHMARK(scene)
+  {
+    std::string path = (std::filesystem::temp_directory_path() / "hazel_scene.hzscene").string();
+
+    Scene scene;
+    Registry& registry = scene.GetRegistry();
+    Timer timer;
+    Entity root;
+    for (uint32_t i = 0; i < EntityCount; i++)
+    {
+      bool isRoot = i % 4 == 0;
+      glm::vec3 position((float)(i % 1000), (float)(i % 7), (float)(i / 1000));
+      Entity entity = scene.CreateEntity(isRoot ? position : glm::vec3(0.0f, 1.0f, 0.0f) * (float)(i % 4), isRoot ? NullEntity : root);
+      if (isRoot)
+        root = entity;
+
+      MeshRendererComponent mesh;
+      mesh.VertexArray = 1 + i % 16;
+      mesh.FirstVertex = i % 36;
+      mesh.VertexCount = 36;
+      mesh.DiffuseMap = 1 + i % 8;
+      mesh.Shininess = (float)(i % 64);
+      registry.Add(entity, mesh);
+      registry.Add(entity, BoundsComponent{ glm::vec3(-0.5f), glm::vec3(0.5f + (i % 3)) });
+      if (i % 1000 == 0)
+        registry.Add(entity, LightComponent());
+    }
+    float buildMs = timer.ElapsedMillis();
+    double checksum = GetChecksum(scene);
+
+    timer.Reset();
+    std::vector<uint8_t> file;
+    for (int it = 0; it < Iterations; it++)
+      file = SceneSerializer(scene).Serialize();
+    float saveMs = timer.ElapsedMillis() / Iterations;
+
+    std::string error;
+    if (!SceneSerializer(scene).Serialize(path, error))
+    {
+      HZ_HAZEL_ERROR("Could not write {0}: {1}", path, error);
+      return;
+    }
+
+    // The file comes from the page cache after the first pass.
+    float loadMs = 0.0f;
+    bool same = true;
+    for (int it = 0; it < Iterations; it++)
+    {
+      Scene loaded;
+      timer.Reset();
+      MappedFile mapped;
+      bool ok = mapped.Open(path) && SceneSerializer(loaded).Deserialize(mapped.GetData(), mapped.GetSize(), error);
+      loadMs += timer.ElapsedMillis();
+      if (!ok)
+      {
+        HZ_HAZEL_ERROR("Could not load {0}: {1}", path, error);
+        return;
+      }
+
+      if (it == 0)
+        same = loaded.GetRegistry().GetEntityCount() == EntityCount && GetChecksum(loaded) == checksum && SceneSerializer(loaded).Serialize() == file;
+    }
+    loadMs /= Iterations;
+
+    HZ_HAZEL_INFO("{0} entities, {1} transforms, {2} archetypes | hzscene {3:.1f} MB", registry.GetEntityCount(), scene.GetTransforms().GetCount(),
+      registry.GetArchetypes().size(), file.size() / 1e6f);
+    auto report = [&](const char* name, float ms)
+    {
+      HZ_HAZEL_INFO("  {0:<15} {1:8.2f} ms {2:8.1f} MB/s {3:8.2f} Mentities/s", name, ms, Benchmark::ToMBps(file.size(), ms), EntityCount / 1e3f / ms);
+    };
+    report("build", buildMs);
+    report("save", saveMs);
+    report("mapped load", loadMs);
+    HZ_HAZEL_INFO("  load {0:.1f}x faster than building{1}", buildMs / std::max(loadMs, 1e-3f), same ? "" : " | RESULT DIFFERS");
+    Benchmark::DoNotOptimize(checksum);
+
+    std::error_code removeError;
+    std::filesystem::remove(path, removeError);
+  }
+
+}
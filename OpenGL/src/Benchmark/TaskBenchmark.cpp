@@ -0,0 +1,149 @@
+#include "Benchmark.h"
+
+#include <filesystem>
+#include <random>
+
+#include "Core/FileSystem.h"
+#include "Core/RenderThread.h"
+#include "Core/ThreadPool.h"
+#include "Core/VirtualFileSystem.h"
+
+namespace Hazel {
+
+  static constexpr uint32_t HopCount = 20000;
+  static constexpr uint32_t LoadCount = 512;
+
+  static uint64_t Checksum(const uint8_t* data, size_t size)
+  {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; i++)
+      sum = (sum ^ data[i]) * 0x100000001B3ull;
+    return sum;
+  }
+
+  static Task<> Hop(std::atomic<uint32_t>& count)
+  {
+    co_await ThreadPool::Get().Schedule();
+    co_await RenderThread::Get().Schedule();
+    count++;
+  }
+
+  // A loader as the engine writes one: read, decode on the worker the read
+  // completed on, finish on the render thread.
+  static Task<uint64_t> Load(const VirtualFileSystem& vfs, std::string path, CancellationToken cancellation)
+  {
+    VfsReadResult file = co_await vfs.ReadAsync(path);
+    if (!file.Error.empty() || cancellation.IsCancelled())
+      co_return 0;
+    uint64_t sum = Checksum(file.Data.data(), file.Data.size());
+    co_await RenderThread::Get().Schedule();
+    co_return sum;
+  }
+
+  // The cost of Tasks over the callbacks they replace: a worker and render
+  // thread round trip each, then files read, decoded and finished on the
+  // render thread, joined with WhenAll, with the render thread pumped by
+  // RenderThread::Wait the way main() waits for a load.
+  HZ_BENCHMARK(tasks)
+  {
+    RenderThread& renderThread = RenderThread::Get();
+
+    std::atomic<uint32_t> hops{ 0 };
+    Timer timer;
+    for (uint32_t i = 0; i < HopCount; i++)
+    {
+      ThreadPool::Get().Enqueue([&]()
+      {
+        renderThread.Post([&]() { hops++; });
+      });
+    }
+    while (hops.load() < HopCount)
+      renderThread.Execute();
+    float callbackHopMs = timer.ElapsedMillis();
+
+    hops = 0;
+    timer.Reset();
+    std::vector<Task<>> hopTasks;
+    for (uint32_t i = 0; i < HopCount; i++)
+      hopTasks.push_back(Hop(hops));
+    Task<> allHops = WhenAll(hopTasks);
+    renderThread.Wait(allHops);
+    float taskHopMs = timer.ElapsedMillis();
+    bool hopsSame = hops.load() == HopCount;
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "hazel_tasks";
+    std::error_code fileError;
+    std::filesystem::create_directories(dir, fileError);
+    std::mt19937 rng(3);
+    uint64_t expected = 0;
+    for (uint32_t i = 0; i < LoadCount; i++)
+    {
+      std::vector<uint8_t> data(1024 + rng() % 16384);
+      for (uint8_t& byte : data)
+        byte = (uint8_t)rng();
+      expected += Checksum(data.data(), data.size());
+      if (!WriteFile((dir / ("file" + std::to_string(i))).string(), data.data(), data.size()))
+      {
+        HZ_HAZEL_ERROR("Could not write the test files to {0}", dir.string());
+        return;
+      }
+    }
+    VirtualFileSystem vfs;
+    vfs.MountDirectory(dir.string());
+
+    std::atomic<uint64_t> callbackSum{ 0 };
+    std::atomic<uint32_t> loaded{ 0 };
+    timer.Reset();
+    for (uint32_t i = 0; i < LoadCount; i++)
+    {
+      vfs.ReadAsync("file" + std::to_string(i), [&](const FileReadResult& file)
+      {
+        uint64_t sum = file.Error.empty() ? Checksum(file.Data, file.Size) : 0;
+        renderThread.Post([&, sum]()
+        {
+          callbackSum += sum;
+          loaded++;
+        });
+      });
+    }
+    while (loaded.load() < LoadCount)
+      renderThread.Execute();
+    float callbackLoadMs = timer.ElapsedMillis();
+
+    timer.Reset();
+    CancellationToken cancellation;
+    std::vector<Task<uint64_t>> loads;
+    for (uint32_t i = 0; i < LoadCount; i++)
+      loads.push_back(Load(vfs, "file" + std::to_string(i), cancellation));
+    Task<> allLoads = WhenAll(loads);
+    renderThread.Wait(allLoads);
+    float taskLoadMs = timer.ElapsedMillis();
+    uint64_t taskSum = 0;
+    for (Task<uint64_t>& load : loads)
+      taskSum += load.GetResult();
+
+    // Cancelled up front: every load stops after its read.
+    timer.Reset();
+    cancellation.Cancel();
+    loads.clear();
+    for (uint32_t i = 0; i < LoadCount; i++)
+      loads.push_back(Load(vfs, "file" + std::to_string(i), cancellation));
+    allLoads = WhenAll(loads);
+    renderThread.Wait(allLoads);
+    float cancelledMs = timer.ElapsedMillis();
+    uint64_t cancelledSum = 0;
+    for (Task<uint64_t>& load : loads)
+      cancelledSum += load.GetResult();
+
+    HZ_HAZEL_INFO("{0} threads", ThreadPool::Get().GetThreadCount());
+    HZ_HAZEL_INFO("  round trips  callbacks {0:8.2f} ms {1:6.2f} us each | tasks {2:8.2f} ms {3:6.2f} us each{4}",
+      callbackHopMs, callbackHopMs * 1000.0f / HopCount, taskHopMs, taskHopMs * 1000.0f / HopCount, hopsSame ? "" : " | RESULT DIFFERS");
+    HZ_HAZEL_INFO("  {0} loads    callbacks {1:8.2f} ms {2:6.2f} us each | tasks {3:8.2f} ms {4:6.2f} us each{5}",
+      LoadCount, callbackLoadMs, callbackLoadMs * 1000.0f / LoadCount, taskLoadMs, taskLoadMs * 1000.0f / LoadCount,
+      callbackSum.load() == expected && taskSum == expected ? "" : " | RESULT DIFFERS");
+    HZ_HAZEL_INFO("  cancelled    {0:8.2f} ms{1}", cancelledMs, cancelledSum == 0 ? "" : " | RESULT DIFFERS");
+
+    std::filesystem::remove_all(dir, fileError);
+  }
+
+}
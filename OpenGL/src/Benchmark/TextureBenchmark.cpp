@@ -0,0 +1,80 @@
+#include "Benchmark.h"
+
+#include <filesystem>
+#include <stb_image.h>
+
+#include "Asset/Ktx2.h"
+#include "Asset/MipGenerator.h"
+#include "Asset/TextureCooker.h"
+#include "Core/FileSystem.h"
+
+namespace Hazel {
+
+  static constexpr int Iterations = 10;
+
+  // CPU side of getting a texture ready for upload: PNG decode plus the mip
+  // chain the loader builds, against reading a cooked KTX2 file.
+  HZ_BENCHMARK(textures)
+  {
+    std::filesystem::path cookedDir = std::filesystem::temp_directory_path();
+
+    for (const char* name : { "container2.png", "container2_specular.png" })
+    {
+      std::string path = AssetsDir + "/assets/textures/" + name;
+      int width = 0, height = 0, channels;
+      if (!stbi_info(path.c_str(), &width, &height, &channels))
+      {
+        HZ_HAZEL_ERROR("Could not open {0}", path);
+        continue;
+      }
+
+      Timer timer;
+      for (int it = 0; it < Iterations; it++)
+      {
+        unsigned char* image = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        MipChain chain;
+        GenerateMipChain(image, width, height, 4, MipSettings(), chain);
+        Benchmark::DoNotOptimize(chain.Data.back());
+        stbi_image_free(image);
+      }
+      float pngMs = timer.ElapsedMillis() / Iterations;
+      size_t rgbaBytes = (size_t)width * height * 4 * 4 / 3;
+
+      // Cook once, outside the timed loop.
+      std::string role = GuessTextureRole(path);
+      TextureCookSettings settings;
+      GetCookSettingsForRole(role, settings);
+
+      unsigned char* image = stbi_load(path.c_str(), &width, &height, &channels, 4);
+      timer.Reset();
+      std::vector<uint8_t> cooked = CookTexture(image, width, height, settings);
+      float cookMs = timer.ElapsedMillis();
+      stbi_image_free(image);
+
+      std::string cookedPath = (cookedDir / (std::string(name) + ".ktx2")).string();
+      WriteFile(cookedPath, cooked.data(), cooked.size());
+
+      timer.Reset();
+      size_t ktxBytes = 0;
+      for (int it = 0; it < Iterations; it++)
+      {
+        std::vector<uint8_t> data;
+        Ktx2Header header;
+        std::string error;
+        ReadFile(cookedPath, data);
+        ReadKtx2(data.data(), data.size(), header, error);
+
+        ktxBytes = 0;
+        for (const Ktx2Level& level : header.Levels)
+          ktxBytes += level.Size;
+      }
+      float ktxMs = timer.ElapsedMillis() / Iterations;
+      std::filesystem::remove(cookedPath);
+
+      HZ_HAZEL_INFO("{0:<24} png+mips {1:6.2f} ms, {2:7.1f} KiB RGBA8 | ktx2 {3} ({4}) {5:6.2f} ms, {6:7.1f} KiB | {7:4.1f}x faster, {8:4.1f}x smaller (cooked in {9:.1f} ms)",
+        name, pngMs, rgbaBytes / 1024.0f, BlockFormatToString(settings.Format), role, ktxMs, ktxBytes / 1024.0f,
+        pngMs / std::max(ktxMs, 1e-3f), (float)rgbaBytes / ktxBytes, cookMs);
+    }
+  }
+
+}
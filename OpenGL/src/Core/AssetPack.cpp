@@ -0,0 +1,223 @@
+#include "AssetPack.h"
+
+#include "Lz.h"
+#include "ThreadPool.h"
+
+namespace Hazel {
+
+  std::string NormalizeAssetPath(const std::string& path)
+  {
+    std::string result;
+    result.reserve(path.size());
+    size_t begin = 0;
+    while (begin <= path.size())
+    {
+      size_t end = path.find_first_of("/\\", begin);
+      if (end == std::string::npos)
+        end = path.size();
+      std::string_view part(path.data() + begin, end - begin);
+      if (part == "..")
+        return {};
+      if (!part.empty() && part != ".")
+      {
+        if (!result.empty())
+          result += '/';
+        result += part;
+      }
+      begin = end + 1;
+    }
+    return result;
+  }
+
+  uint64_t HashAssetPath(std::string_view path)
+  {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : path)
+      hash = (hash ^ (uint8_t)c) * 1099511628211ull;
+    return hash;
+  }
+
+  static bool IsRangeInside(uint64_t offset, uint64_t size, uint64_t fileSize)
+  {
+    return offset <= fileSize && size <= fileSize - offset;
+  }
+
+  static bool IsEntryBefore(const AssetPackEntry& a, std::string_view aName, const AssetPackEntry& b, std::string_view bName)
+  {
+    return a.PathHash != b.PathHash ? a.PathHash < b.PathHash : aName < bName;
+  }
+
+  bool AssetPack::Open(const std::string& path, std::string& error)
+  {
+    m_Entries = nullptr;
+    m_EntryCount = 0;
+    m_Names = nullptr;
+    if (!m_File.Open(path))
+    {
+      error = "could not open file";
+      return false;
+    }
+    m_Path = path;
+
+    const uint8_t* data = m_File.GetData();
+    size_t size = m_File.GetSize();
+    uint32_t magic = 0;
+    if (size >= sizeof(AssetPackHeader))
+      memcpy(&magic, data, sizeof(magic));
+    if (magic != AssetPackMagic)
+    {
+      error = "not an asset pack";
+      return false;
+    }
+
+    const AssetPackHeader& header = *(const AssetPackHeader*)data;
+    if (header.Version != AssetPackVersion)
+    {
+      error = "unsupported asset pack version " + std::to_string(header.Version);
+      return false;
+    }
+    if (header.FileSize != size)
+    {
+      error = "truncated asset pack";
+      return false;
+    }
+    if (!IsRangeInside(header.EntryOffset, (uint64_t)header.EntryCount * sizeof(AssetPackEntry), size)
+      || header.EntryOffset % alignof(AssetPackEntry) != 0 || !IsRangeInside(header.NameOffset, header.NameSize, size))
+    {
+      error = "asset pack sections out of range";
+      return false;
+    }
+
+    // Every entry is checked once here so lookups and reads can trust them.
+    const AssetPackEntry* entries = (const AssetPackEntry*)(data + header.EntryOffset);
+    const char* names = (const char*)(data + header.NameOffset);
+    for (uint32_t i = 0; i < header.EntryCount; i++)
+    {
+      const AssetPackEntry& entry = entries[i];
+      bool valid = IsRangeInside(entry.NameOffset, entry.NameLength, header.NameSize) && IsRangeInside(entry.Offset, entry.StoredSize, size)
+        && (entry.Encoding == AssetPackEncoding::Lz || (entry.Encoding == AssetPackEncoding::None && entry.StoredSize == entry.Size));
+      std::string_view name(names + entry.NameOffset, valid ? entry.NameLength : 0);
+      valid = valid && HashAssetPath(name) == entry.PathHash
+        && (i == 0 || IsEntryBefore(entries[i - 1], { names + entries[i - 1].NameOffset, entries[i - 1].NameLength }, entry, name));
+      if (!valid)
+      {
+        error = "bad asset pack entry " + std::to_string(i);
+        return false;
+      }
+    }
+
+    m_Entries = entries;
+    m_EntryCount = header.EntryCount;
+    m_Names = names;
+    return true;
+  }
+
+  const AssetPackEntry* AssetPack::Find(std::string_view path) const
+  {
+    uint64_t hash = HashAssetPath(path);
+    const AssetPackEntry* end = m_Entries + m_EntryCount;
+    const AssetPackEntry* entry = std::lower_bound(m_Entries, end, hash, [](const AssetPackEntry& entry, uint64_t hash) { return entry.PathHash < hash; });
+    for (; entry != end && entry->PathHash == hash; entry++)
+    {
+      if (GetName(*entry) == path)
+        return entry;
+    }
+    return nullptr;
+  }
+
+  bool AssetPack::Read(const AssetPackEntry& entry, uint8_t* out) const
+  {
+    if (entry.Encoding == AssetPackEncoding::None)
+    {
+      memcpy(out, GetStoredData(entry), (size_t)entry.Size);
+      return true;
+    }
+    return LzDecompress(GetStoredData(entry), (size_t)entry.StoredSize, out, (size_t)entry.Size);
+  }
+
+  static size_t AlignUp(size_t offset)
+  {
+    return (offset + AssetPackAlignment - 1) & ~(size_t)(AssetPackAlignment - 1);
+  }
+
+  std::vector<uint8_t> WriteAssetPack(const std::vector<AssetPackFile>& files, bool compress)
+  {
+    struct Source
+    {
+      const AssetPackFile* File;
+      std::string Name;
+      std::vector<uint8_t> Compressed;
+      AssetPackEntry Entry = {};
+    };
+    std::vector<Source> sources(files.size());
+    for (size_t i = 0; i < files.size(); i++)
+    {
+      Source& source = sources[i];
+      source.File = &files[i];
+      source.Name = NormalizeAssetPath(files[i].Path);
+      HZ_CORE_ASSERT(!source.Name.empty(), "Asset paths must name a file inside the pack!");
+      source.Entry.PathHash = HashAssetPath(source.Name);
+      source.Entry.Size = files[i].Data.size();
+    }
+    std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return IsEntryBefore(a.Entry, a.Name, b.Entry, b.Name); });
+    for (size_t i = 1; i < sources.size(); i++)
+      HZ_CORE_ASSERT(sources[i - 1].Name != sources[i].Name, "Asset paths must be unique!");
+
+    if (compress)
+    {
+      ThreadPool::Get().ParallelFor((uint32_t)sources.size(), 1, [&](uint32_t begin, uint32_t end)
+      {
+        for (uint32_t i = begin; i < end; i++)
+        {
+          Source& source = sources[i];
+          const std::vector<uint8_t>& data = source.File->Data;
+          LzCompress(data.data(), data.size(), source.Compressed);
+          if (source.Compressed.size() > data.size() - data.size() / 8)
+            source.Compressed = {};
+        }
+      });
+    }
+
+    // Header, entries and names, then every file on its own alignment boundary.
+    std::string names;
+    for (Source& source : sources)
+    {
+      source.Entry.NameOffset = (uint32_t)names.size();
+      source.Entry.NameLength = (uint32_t)source.Name.size();
+      names += source.Name;
+    }
+
+    AssetPackHeader header = {};
+    header.Magic = AssetPackMagic;
+    header.Version = AssetPackVersion;
+    header.EntryCount = (uint32_t)sources.size();
+    header.EntryOffset = sizeof(AssetPackHeader);
+    header.NameOffset = header.EntryOffset + sources.size() * sizeof(AssetPackEntry);
+    header.NameSize = names.size();
+    size_t offset = (size_t)(header.NameOffset + header.NameSize);
+    for (Source& source : sources)
+    {
+      bool compressed = !source.Compressed.empty();
+      source.Entry.Encoding = compressed ? AssetPackEncoding::Lz : AssetPackEncoding::None;
+      source.Entry.StoredSize = compressed ? source.Compressed.size() : source.File->Data.size();
+      source.Entry.Offset = offset = AlignUp(offset);
+      offset += (size_t)source.Entry.StoredSize;
+    }
+    header.FileSize = offset;
+
+    std::vector<uint8_t> pack(offset, 0);
+    memcpy(pack.data(), &header, sizeof(header));
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+      const Source& source = sources[i];
+      memcpy(&pack[header.EntryOffset + i * sizeof(AssetPackEntry)], &source.Entry, sizeof(AssetPackEntry));
+      const std::vector<uint8_t>& data = source.Compressed.empty() ? source.File->Data : source.Compressed;
+      if (!data.empty())
+        memcpy(&pack[source.Entry.Offset], data.data(), data.size());
+    }
+    if (!names.empty())
+      memcpy(&pack[header.NameOffset], names.data(), names.size());
+    return pack;
+  }
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string_view>
+
+#include "MappedFile.h"
+
+namespace Hazel {
+
+  // Hazel's asset archive (.hzpak): a fixed header, a table of contents
+  // sorted by path hash, the paths themselves, then every file's data
+  // aligned to AssetPackAlignment. A pack is mapped whole and validated
+  // once; finding a file is a binary search of the table. Files stored
+  // uncompressed are used in place, and keep their alignment so e.g. a cooked
+  // mesh's sections can go straight to glBufferData. Compressed files (see
+  // Lz) are decompressed on read.
+
+  constexpr uint32_t AssetPackMagic = 0x4B505A48; // "HZPK"
+  constexpr uint32_t AssetPackVersion = 1;
+  constexpr uint32_t AssetPackAlignment = 64;
+
+  enum class AssetPackEncoding : uint32_t
+  {
+    None = 0,
+    Lz = 1
+  };
+
+  struct AssetPackHeader
+  {
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t EntryCount;
+    uint32_t Reserved;
+    uint64_t EntryOffset;
+    // Paths, not terminated, referenced by the entries.
+    uint64_t NameOffset;
+    uint64_t NameSize;
+    // Of the whole file, to catch truncation.
+    uint64_t FileSize;
+  };
+
+  struct AssetPackEntry
+  {
+    // HashAssetPath of the name; the table is sorted by it, then by name.
+    uint64_t PathHash;
+    uint64_t Offset;
+    // Bytes in the pack, and once decompressed.
+    uint64_t StoredSize;
+    uint64_t Size;
+    uint32_t NameOffset;
+    uint32_t NameLength;
+    AssetPackEncoding Encoding;
+    uint32_t Reserved;
+  };
+
+  static_assert(sizeof(AssetPackHeader) == 48 && sizeof(AssetPackEntry) == 48, "Asset pack structures must match the on-disk layout!");
+
+  // Forward slashes, no leading "./" or "/", no empty, "." or ".." parts;
+  // empty if the path cannot be made so. Packs and mounts key on this form.
+  std::string NormalizeAssetPath(const std::string& path);
+  // FNV-1a, 64-bit.
+  uint64_t HashAssetPath(std::string_view path);
+
+  class AssetPack
+  {
+  public:
+    AssetPack() = default;
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // Maps the pack and checks the header and that every entry lies inside it.
+    bool Open(const std::string& path, std::string& error);
+
+    // Null if the pack has no such file. Takes a normalized path.
+    const AssetPackEntry* Find(std::string_view path) const;
+    // Decompresses, or copies, the entry into size bytes of out.
+    bool Read(const AssetPackEntry& entry, uint8_t* out) const;
+
+    std::string_view GetName(const AssetPackEntry& entry) const { return { m_Names + entry.NameOffset, entry.NameLength }; }
+    // The bytes as stored, in the mapping.
+    const uint8_t* GetStoredData(const AssetPackEntry& entry) const { return m_File.GetData() + entry.Offset; }
+
+    const AssetPackEntry* GetEntries() const { return m_Entries; }
+    uint32_t GetEntryCount() const { return m_EntryCount; }
+    const std::string& GetPath() const { return m_Path; }
+  private:
+    MappedFile m_File;
+    std::string m_Path;
+    const AssetPackEntry* m_Entries = nullptr;
+    uint32_t m_EntryCount = 0;
+    const char* m_Names = nullptr;
+  };
+
+  struct AssetPackFile
+  {
+    std::string Path;
+    std::vector<uint8_t> Data;
+  };
+
+  // Paths are normalized and must be unique. With compress every file is
+  // tried with Lz on the thread pool and stored compressed where that saves
+  // at least an eighth.
+  std::vector<uint8_t> WriteAssetPack(const std::vector<AssetPackFile>& files, bool compress = false);
+
+}
@@ -0,0 +1,494 @@
+#include "AsyncFileIO.h"
+
+#include "ThreadPool.h"
+
+#ifdef _WIN32
+  #include <fstream>
+#else
+  #include <cerrno>
+  #include <cstring>
+  #include <fcntl.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#ifdef __linux__
+  #include <linux/io_uring.h>
+  #include <poll.h>
+  #include <sys/eventfd.h>
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <sys/uio.h>
+#endif
+
+namespace Hazel {
+
+  static constexpr size_t WholeFile = ~(size_t)0;
+
+  // The fallback, and the only path on platforms without io_uring.
+  static bool ReadRange(const std::string& path, uint64_t offset, size_t size, std::vector<uint8_t>& data, std::string& error)
+  {
+#ifdef _WIN32
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in)
+    {
+      error = "could not open file";
+      return false;
+    }
+    if (size == WholeFile)
+    {
+      in.seekg(0, std::ios::end);
+      size = (size_t)in.tellg();
+    }
+    data.resize(size);
+    in.seekg(offset, std::ios::beg);
+    in.read((char*)data.data(), size);
+    if (!in)
+    {
+      error = "unexpected end of file";
+      return false;
+    }
+    return true;
+#else
+    int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+    {
+      error = "could not open file";
+      return false;
+    }
+    struct stat info;
+    if (size == WholeFile)
+      size = fstat(file, &info) == 0 ? (size_t)info.st_size : 0;
+
+    data.resize(size);
+    size_t done = 0;
+    while (done < size)
+    {
+      ssize_t result = pread(file, data.data() + done, size - done, (off_t)(offset + done));
+      if (result < 0 && errno == EINTR)
+        continue;
+      if (result <= 0)
+      {
+        error = result < 0 ? strerror(errno) : "unexpected end of file";
+        break;
+      }
+      done += (size_t)result;
+    }
+    close(file);
+    return done == size;
+#endif
+  }
+
+#ifdef __linux__
+  // The raw system call interface; liburing is not a dependency. The ring
+  // layout and the memory ordering on its indices follow io_uring(7).
+  struct AsyncFileIO::Ring
+  {
+    int Fd = -1;
+    // Written to wake the I/O thread; a poll on it is always in the ring.
+    int WakeFd = -1;
+
+    void* SqMap = MAP_FAILED;
+    void* CqMap = MAP_FAILED;
+    size_t SqMapSize = 0, CqMapSize = 0;
+    io_uring_sqe* Sqes = (io_uring_sqe*)MAP_FAILED;
+    size_t SqesSize = 0;
+
+    uint32_t* SqHead = nullptr;
+    uint32_t* SqTail = nullptr;
+    uint32_t* SqArray = nullptr;
+    uint32_t SqMask = 0;
+    uint32_t* CqHead = nullptr;
+    uint32_t* CqTail = nullptr;
+    uint32_t CqMask = 0;
+    io_uring_cqe* Cqes = nullptr;
+
+    // Entries written since the last io_uring_enter took them.
+    uint32_t LocalTail = 0;
+    uint32_t Unsubmitted = 0;
+
+    // FixedBufferCount slots of FixedBufferSize, registered with the kernel.
+    uint8_t* Buffers = (uint8_t*)MAP_FAILED;
+    std::vector<int> FreeSlots;
+    std::mutex SlotMutex;
+
+    static Ring* Create(std::string& error);
+    io_uring_sqe* NextSqe();
+
+    ~Ring()
+    {
+      if (Buffers != MAP_FAILED)
+        munmap(Buffers, FixedBufferCount * FixedBufferSize);
+      if (Sqes != MAP_FAILED)
+        munmap(Sqes, SqesSize);
+      if (CqMap != MAP_FAILED && CqMap != SqMap)
+        munmap(CqMap, CqMapSize);
+      if (SqMap != MAP_FAILED)
+        munmap(SqMap, SqMapSize);
+      if (WakeFd >= 0)
+        close(WakeFd);
+      if (Fd >= 0)
+        close(Fd);
+    }
+  };
+
+  static constexpr uint32_t RingEntries = 64;
+  static constexpr uint64_t WakeTag = 0;
+  // A completion's result is an int, so longer reads go in pieces.
+  static constexpr size_t MaxReadSize = 1 << 30;
+
+  AsyncFileIO::Ring* AsyncFileIO::Ring::Create(std::string& error)
+  {
+    io_uring_params params = {};
+    std::unique_ptr<Ring> ring = std::make_unique<Ring>();
+    ring->Fd = (int)syscall(__NR_io_uring_setup, RingEntries, &params);
+    if (ring->Fd < 0)
+    {
+      error = strerror(errno);
+      return nullptr;
+    }
+    // Plain IORING_OP_READ arrived in 5.6, the same release as this feature bit.
+    if (!(params.features & IORING_FEAT_RW_CUR_POS))
+    {
+      error = "kernel too old";
+      return nullptr;
+    }
+
+    ring->SqMapSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring->CqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap)
+      ring->SqMapSize = ring->CqMapSize = std::max(ring->SqMapSize, ring->CqMapSize);
+    ring->SqMap = mmap(nullptr, ring->SqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->Fd, IORING_OFF_SQ_RING);
+    ring->CqMap = singleMap ? ring->SqMap : mmap(nullptr, ring->CqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->Fd, IORING_OFF_CQ_RING);
+    ring->SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    ring->Sqes = (io_uring_sqe*)mmap(nullptr, ring->SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->Fd, IORING_OFF_SQES);
+    if (ring->SqMap == MAP_FAILED || ring->CqMap == MAP_FAILED || ring->Sqes == MAP_FAILED)
+    {
+      error = "could not map the ring";
+      return nullptr;
+    }
+
+    uint8_t* sq = (uint8_t*)ring->SqMap;
+    ring->SqHead = (uint32_t*)(sq + params.sq_off.head);
+    ring->SqTail = (uint32_t*)(sq + params.sq_off.tail);
+    ring->SqArray = (uint32_t*)(sq + params.sq_off.array);
+    ring->SqMask = *(uint32_t*)(sq + params.sq_off.ring_mask);
+    uint8_t* cq = (uint8_t*)ring->CqMap;
+    ring->CqHead = (uint32_t*)(cq + params.cq_off.head);
+    ring->CqTail = (uint32_t*)(cq + params.cq_off.tail);
+    ring->CqMask = *(uint32_t*)(cq + params.cq_off.ring_mask);
+    ring->Cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+    ring->LocalTail = *ring->SqTail;
+
+    ring->WakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (ring->WakeFd < 0)
+    {
+      error = strerror(errno);
+      return nullptr;
+    }
+
+    // Pinned once, so fixed reads skip mapping the pages on every request.
+    // Without them, e.g. over the memlock limit, every read gets its own buffer.
+    ring->Buffers = (uint8_t*)mmap(nullptr, FixedBufferCount * FixedBufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring->Buffers != MAP_FAILED)
+    {
+      std::vector<iovec> buffers(FixedBufferCount);
+      for (uint32_t i = 0; i < FixedBufferCount; i++)
+        buffers[i] = { ring->Buffers + i * FixedBufferSize, FixedBufferSize };
+      if (syscall(__NR_io_uring_register, ring->Fd, IORING_REGISTER_BUFFERS, buffers.data(), FixedBufferCount) == 0)
+      {
+        for (int i = (int)FixedBufferCount - 1; i >= 0; i--)
+          ring->FreeSlots.push_back(i);
+      }
+      else
+      {
+        HZ_HAZEL_WARN("Could not register io_uring buffers: {0}", strerror(errno));
+        munmap(ring->Buffers, FixedBufferCount * FixedBufferSize);
+        ring->Buffers = (uint8_t*)MAP_FAILED;
+      }
+    }
+    return ring.release();
+  }
+
+  io_uring_sqe* AsyncFileIO::Ring::NextSqe()
+  {
+    uint32_t index = LocalTail & SqMask;
+    io_uring_sqe* sqe = &Sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    SqArray[index] = index;
+    LocalTail++;
+    Unsubmitted++;
+    return sqe;
+  }
+#else
+  struct AsyncFileIO::Ring {};
+#endif
+
+  AsyncFileIO::AsyncFileIO(bool useUring)
+  {
+    // Created first so it is destroyed after this, with no completions left.
+    ThreadPool::Get();
+
+#ifdef __linux__
+    if (useUring)
+    {
+      std::string error;
+      m_Ring = Ring::Create(error);
+      if (m_Ring)
+        m_Thread = std::thread(&AsyncFileIO::RingLoop, this);
+      else
+        HZ_HAZEL_WARN("io_uring is not available ({0}); reading files on the thread pool", error);
+    }
+#endif
+  }
+
+  AsyncFileIO::~AsyncFileIO()
+  {
+    if (m_Ring)
+    {
+      m_Stopping.store(true);
+#ifdef __linux__
+      uint64_t one = 1;
+      (void)!write(m_Ring->WakeFd, &one, sizeof(one));
+#endif
+      m_Thread.join();
+    }
+
+    // Callbacks on the workers still hold a pointer to this, and return their buffers to the ring.
+    while (m_CallbacksInFlight.load(std::memory_order_acquire) > 0)
+      std::this_thread::yield();
+    delete m_Ring;
+  }
+
+  void AsyncFileIO::Read(const std::string& path, uint64_t offset, size_t size, Completion done)
+  {
+    Request* request = new Request();
+    request->Path = path;
+    request->Offset = offset;
+    request->Size = size;
+    request->Done = std::move(done);
+    Queue(request);
+  }
+
+  void AsyncFileIO::ReadFile(const std::string& path, Completion done)
+  {
+    Read(path, 0, WholeFile, std::move(done));
+  }
+
+  void AsyncFileIO::Queue(Request* request)
+  {
+    m_Reads.fetch_add(1, std::memory_order_relaxed);
+    m_CallbacksInFlight.fetch_add(1, std::memory_order_relaxed);
+
+    if (!m_Ring)
+    {
+      ThreadPool::Get().Enqueue([this, request]()
+      {
+        ReadRange(request->Path, request->Offset, request->Size, request->Buffer, request->Error);
+        request->Data = request->Buffer.data();
+        request->Size = request->Completed = request->Buffer.size();
+        Complete(request);
+      });
+      return;
+    }
+
+#ifdef __linux__
+    // Opening is left to the caller: the I/O thread only ever waits on the ring.
+    request->File = open(request->Path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (request->File < 0 || (request->Size == WholeFile && fstat(request->File, &info) != 0))
+    {
+      request->Error = "could not open file";
+      ThreadPool::Get().Enqueue([this, request]() { Complete(request); });
+      return;
+    }
+    if (request->Size == WholeFile)
+      request->Size = (size_t)info.st_size;
+
+    // The write comes after the push, so the woken thread always finds the request.
+    m_Incoming.Push(request);
+    uint64_t one = 1;
+    (void)!write(m_Ring->WakeFd, &one, sizeof(one));
+#endif
+  }
+
+  void AsyncFileIO::Complete(Request* request)
+  {
+    FileReadResult result;
+    if (request->Error.empty())
+    {
+      result.Data = request->Data;
+      result.Size = request->Size;
+      m_Bytes.fetch_add(request->Size, std::memory_order_relaxed);
+    }
+    else
+    {
+      result.Error = std::move(request->Error);
+      m_Failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    request->Done(result);
+
+#ifdef __linux__
+    if (request->File >= 0)
+      close(request->File);
+    if (request->Slot >= 0)
+    {
+      std::lock_guard lock(m_Ring->SlotMutex);
+      m_Ring->FreeSlots.push_back(request->Slot);
+    }
+#endif
+    delete request;
+    m_CallbacksInFlight.fetch_sub(1, std::memory_order_release);
+  }
+
+  void AsyncFileIO::RingLoop()
+  {
+#ifdef __linux__
+    Ring& ring = *m_Ring;
+    // Queued, and partly read ones waiting for the rest.
+    std::deque<Request*> waiting;
+    uint32_t inFlight = 0;
+    bool wakeArmed = false;
+
+    auto finish = [this](Request* request)
+    {
+      ThreadPool::Get().Enqueue([this, request]() { Complete(request); });
+    };
+
+    for (;;)
+    {
+      if (!wakeArmed)
+      {
+        io_uring_sqe* sqe = ring.NextSqe();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = ring.WakeFd;
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = WakeTag;
+        wakeArmed = true;
+      }
+
+      Request* incoming;
+      while (m_Incoming.Pop(incoming))
+        waiting.push_back(incoming);
+
+      uint32_t reads = 0;
+      while (!waiting.empty() && inFlight < MaxReadsInFlight)
+      {
+        Request* request = waiting.front();
+        waiting.pop_front();
+        if (request->Size == 0)
+        {
+          finish(request);
+          continue;
+        }
+
+        // A registered buffer where one is free and big enough, else its own.
+        if (!request->Data)
+        {
+          if (request->Size <= FixedBufferSize)
+          {
+            std::lock_guard lock(ring.SlotMutex);
+            if (!ring.FreeSlots.empty())
+            {
+              request->Slot = ring.FreeSlots.back();
+              ring.FreeSlots.pop_back();
+            }
+          }
+          if (request->Slot >= 0)
+          {
+            request->Data = ring.Buffers + request->Slot * FixedBufferSize;
+            m_FixedBufferReads.fetch_add(1, std::memory_order_relaxed);
+          }
+          else
+          {
+            request->Buffer.resize(request->Size);
+            request->Data = request->Buffer.data();
+          }
+        }
+
+        io_uring_sqe* sqe = ring.NextSqe();
+        sqe->opcode = request->Slot >= 0 ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe->fd = request->File;
+        sqe->off = request->Offset + request->Completed;
+        sqe->addr = (uint64_t)(uintptr_t)(request->Data + request->Completed);
+        sqe->len = (uint32_t)std::min(request->Size - request->Completed, MaxReadSize);
+        sqe->buf_index = (uint16_t)std::max(request->Slot, 0);
+        sqe->user_data = (uint64_t)(uintptr_t)request;
+        inFlight++;
+        reads++;
+      }
+
+      if (m_Stopping.load() && inFlight == 0 && waiting.empty())
+        break;
+
+      // Submits everything above and sleeps until at least one completion,
+      // which may be the wake-up poll.
+      __atomic_store_n(ring.SqTail, ring.LocalTail, __ATOMIC_RELEASE);
+      int submitted = (int)syscall(__NR_io_uring_enter, ring.Fd, ring.Unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (submitted < 0)
+      {
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+          HZ_HAZEL_ERROR("io_uring_enter failed: {0}", strerror(errno));
+        continue;
+      }
+      ring.Unsubmitted -= std::min((uint32_t)submitted, ring.Unsubmitted);
+      if (reads > 0)
+        m_Submits.fetch_add(1, std::memory_order_relaxed);
+
+      uint32_t head = *ring.CqHead;
+      uint32_t tail = __atomic_load_n(ring.CqTail, __ATOMIC_ACQUIRE);
+      for (; head != tail; head++)
+      {
+        const io_uring_cqe& cqe = ring.Cqes[head & ring.CqMask];
+        if (cqe.user_data == WakeTag)
+        {
+          uint64_t count;
+          (void)!read(ring.WakeFd, &count, sizeof(count));
+          wakeArmed = false;
+          continue;
+        }
+
+        Request* request = (Request*)(uintptr_t)cqe.user_data;
+        inFlight--;
+        if (cqe.res == -EINTR || cqe.res == -EAGAIN)
+        {
+          waiting.push_front(request);
+          continue;
+        }
+        if (cqe.res <= 0)
+        {
+          request->Error = cqe.res < 0 ? strerror(-cqe.res) : "unexpected end of file";
+          finish(request);
+          continue;
+        }
+
+        request->Completed += (size_t)cqe.res;
+        if (request->Completed < request->Size)
+          waiting.push_front(request);
+        else
+          finish(request);
+      }
+      __atomic_store_n(ring.CqHead, head, __ATOMIC_RELEASE);
+    }
+#endif
+  }
+
+  AsyncFileIO::Stats AsyncFileIO::GetStats() const
+  {
+    Stats stats;
+    stats.Reads = m_Reads.load(std::memory_order_relaxed);
+    stats.Failed = m_Failed.load(std::memory_order_relaxed);
+    stats.Bytes = m_Bytes.load(std::memory_order_relaxed);
+    stats.Submits = m_Submits.load(std::memory_order_relaxed);
+    stats.FixedBufferReads = m_FixedBufferReads.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  AsyncFileIO& AsyncFileIO::Get()
+  {
+    static AsyncFileIO s_Instance;
+    return s_Instance;
+  }
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "MPSCQueue.h"
+
+namespace Hazel {
+
+  struct FileReadResult
+  {
+    // Owned by AsyncFileIO and valid only until the callback returns.
+    const uint8_t* Data = nullptr;
+    size_t Size = 0;
+    // Empty on success.
+    std::string Error;
+  };
+
+  // Asynchronous file reads for asset streaming. On Linux the reads go to an
+  // io_uring run by one I/O thread: everything queued since it last woke is
+  // submitted with a single system call, up to MaxReadsInFlight at once, into
+  // buffers registered with the kernel where one is free, so the storage
+  // queue stays full and no worker blocks on the disk. Where io_uring is not
+  // available (other platforms, old kernels, sandboxes that forbid it) each
+  // read is a pread on the ThreadPool instead. Either way the completion runs
+  // as a ThreadPool job, so decoding starts as soon as the data is in.
+  class AsyncFileIO
+  {
+  public:
+    using Completion = std::function<void(const FileReadResult&)>;
+
+    struct Stats
+    {
+      uint64_t Reads = 0;
+      uint64_t Failed = 0;
+      uint64_t Bytes = 0;
+      // System calls that submitted reads, and reads into registered buffers.
+      uint64_t Submits = 0;
+      uint64_t FixedBufferReads = 0;
+    };
+
+    // Without useUring every read takes the pread fallback.
+    explicit AsyncFileIO(bool useUring = true);
+    // Waits for outstanding reads and their callbacks.
+    ~AsyncFileIO();
+
+    AsyncFileIO(const AsyncFileIO&) = delete;
+    AsyncFileIO& operator=(const AsyncFileIO&) = delete;
+
+    // size bytes from offset; fewer, up to the end of the file, are an error.
+    void Read(const std::string& path, uint64_t offset, size_t size, Completion done);
+    void ReadFile(const std::string& path, Completion done);
+
+    bool IsUsingUring() const { return m_Ring != nullptr; }
+    Stats GetStats() const;
+
+    static AsyncFileIO& Get();
+  private:
+    struct Request
+    {
+      std::string Path;
+      int File = -1;
+      uint64_t Offset = 0;
+      size_t Size = 0;
+      // Read so far; short reads are resubmitted for the rest.
+      size_t Completed = 0;
+      // A registered buffer's memory, or Buffer's.
+      uint8_t* Data = nullptr;
+      int Slot = -1;
+      std::vector<uint8_t> Buffer;
+      std::string Error;
+      Completion Done;
+    };
+
+    struct Ring;
+
+    static constexpr uint32_t MaxReadsInFlight = 32;
+    static constexpr uint32_t FixedBufferCount = 8;
+    static constexpr size_t FixedBufferSize = 1 << 20;
+
+    void Queue(Request* request);
+    void Complete(Request* request);
+    void RingLoop();
+  private:
+    Ring* m_Ring = nullptr;
+    std::thread m_Thread;
+    MPSCQueue<Request*> m_Incoming;
+    std::atomic<bool> m_Stopping{ false };
+    std::atomic<uint32_t> m_CallbacksInFlight{ 0 };
+
+    std::atomic<uint64_t> m_Reads{ 0 }, m_Failed{ 0 }, m_Bytes{ 0 }, m_Submits{ 0 }, m_FixedBufferReads{ 0 };
+  };
+
+}
@@ -0,0 +1,30 @@
+#include "FileSystem.h"
+
+#include <fstream>
+
+namespace Hazel {
+
+  bool ReadFile(const std::string& path, std::vector<uint8_t>& data)
+  {
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in)
+      return false;
+
+    in.seekg(0, std::ios::end);
+    data.resize((size_t)in.tellg());
+    in.seekg(0, std::ios::beg);
+    in.read((char*)data.data(), data.size());
+    return (bool)in;
+  }
+
+  bool WriteFile(const std::string& path, const void* data, size_t size)
+  {
+    std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out)
+      return false;
+
+    out.write((const char*)data, size);
+    return (bool)out;
+  }
+
+}
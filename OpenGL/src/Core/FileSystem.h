@@ -0,0 +1,9 @@
+#pragma once
+
+namespace Hazel {
+
+  // Whole-file binary reads and writes. False if the file could not be opened.
+  bool ReadFile(const std::string& path, std::vector<uint8_t>& data);
+  bool WriteFile(const std::string& path, const void* data, size_t size);
+
+}
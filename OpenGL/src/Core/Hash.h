@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace Hazel {
+
+  // FNV-1a over 8-byte words, seeded with the size. Fast enough to key
+  // caches on file contents; not meant to resist collisions on purpose.
+  inline uint64_t HashBytes(const uint8_t* data, size_t size)
+  {
+    uint64_t hash = 14695981039346656037ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+      uint64_t word;
+      memcpy(&word, data + i, 8);
+      hash = (hash ^ word) * 1099511628211ull;
+    }
+    for (; i < size; i++)
+      hash = (hash ^ data[i]) * 1099511628211ull;
+    return hash;
+  }
+
+}
@@ -0,0 +1,242 @@
+#include "Json.h"
+
+#include <charconv>
+
+namespace Hazel {
+
+  const JsonValue JsonValue::s_Null;
+
+  const JsonValue& JsonValue::operator[](size_t index) const
+  {
+    return m_Type == Type::Array && index < m_Array.size() ? m_Array[index] : s_Null;
+  }
+
+  const JsonValue& JsonValue::operator[](const std::string& key) const
+  {
+    for (const auto& [name, value] : m_Members)
+    {
+      if (name == key)
+        return value;
+    }
+    return s_Null;
+  }
+
+  class JsonParser
+  {
+  public:
+    JsonParser(const char* text, size_t size) : m_Cursor(text), m_Begin(text), m_End(text + size) {}
+
+    bool ParseDocument(JsonValue& value, std::string& error)
+    {
+      bool ok = ParseValue(value, 0);
+      SkipSpaces();
+      if (ok && m_Cursor != m_End)
+        ok = Fail("trailing characters");
+      if (!ok)
+        error = m_Error + " at offset " + std::to_string(m_Cursor - m_Begin);
+      return ok;
+    }
+  private:
+    static constexpr int MaxDepth = 256;
+
+    bool Fail(const char* message)
+    {
+      if (m_Error.empty())
+        m_Error = message;
+      return false;
+    }
+
+    void SkipSpaces()
+    {
+      while (m_Cursor < m_End && (*m_Cursor == ' ' || *m_Cursor == '\t' || *m_Cursor == '\n' || *m_Cursor == '\r'))
+        m_Cursor++;
+    }
+
+    bool Consume(char c)
+    {
+      SkipSpaces();
+      if (m_Cursor < m_End && *m_Cursor == c)
+      {
+        m_Cursor++;
+        return true;
+      }
+      return false;
+    }
+
+    bool ConsumeWord(const char* word)
+    {
+      size_t length = strlen(word);
+      if ((size_t)(m_End - m_Cursor) < length || memcmp(m_Cursor, word, length) != 0)
+        return false;
+      m_Cursor += length;
+      return true;
+    }
+
+    static void AppendUtf8(std::string& out, uint32_t codepoint)
+    {
+      if (codepoint < 0x80)
+        out += (char)codepoint;
+      else if (codepoint < 0x800)
+      {
+        out += (char)(0xC0 | (codepoint >> 6));
+        out += (char)(0x80 | (codepoint & 0x3F));
+      }
+      else if (codepoint < 0x10000)
+      {
+        out += (char)(0xE0 | (codepoint >> 12));
+        out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out += (char)(0x80 | (codepoint & 0x3F));
+      }
+      else
+      {
+        out += (char)(0xF0 | (codepoint >> 18));
+        out += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+        out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out += (char)(0x80 | (codepoint & 0x3F));
+      }
+    }
+
+    bool ParseHex4(uint32_t& value)
+    {
+      if (m_End - m_Cursor < 4)
+        return false;
+      auto [end, result] = std::from_chars(m_Cursor, m_Cursor + 4, value, 16);
+      if (result != std::errc() || end != m_Cursor + 4)
+        return false;
+      m_Cursor = end;
+      return true;
+    }
+
+    bool ParseString(std::string& out)
+    {
+      if (!Consume('"'))
+        return Fail("expected string");
+
+      out.clear();
+      while (m_Cursor < m_End && *m_Cursor != '"')
+      {
+        char c = *m_Cursor++;
+        if (c != '\\')
+        {
+          out += c;
+          continue;
+        }
+
+        if (m_Cursor == m_End)
+          break;
+        switch (char escape = *m_Cursor++)
+        {
+          case '"': case '\\': case '/': out += escape; break;
+          case 'b': out += '\b'; break;
+          case 'f': out += '\f'; break;
+          case 'n': out += '\n'; break;
+          case 'r': out += '\r'; break;
+          case 't': out += '\t'; break;
+          case 'u':
+          {
+            uint32_t codepoint;
+            if (!ParseHex4(codepoint))
+              return Fail("bad unicode escape");
+            // Surrogate pairs come as two escapes; a half on its own is not a character.
+            if (codepoint >= 0xD800 && codepoint < 0xDC00)
+            {
+              uint32_t low;
+              if (!ConsumeWord("\\u") || !ParseHex4(low) || low < 0xDC00 || low > 0xDFFF)
+                return Fail("bad surrogate pair");
+              codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+            }
+            else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF)
+              return Fail("bad surrogate pair");
+            AppendUtf8(out, codepoint);
+            break;
+          }
+          default:
+            return Fail("bad escape");
+        }
+      }
+
+      if (m_Cursor == m_End)
+        return Fail("unterminated string");
+      m_Cursor++;
+      return true;
+    }
+
+    bool ParseValue(JsonValue& value, int depth)
+    {
+      if (depth > MaxDepth)
+        return Fail("nested too deeply");
+
+      SkipSpaces();
+      if (m_Cursor == m_End)
+        return Fail("unexpected end");
+
+      value = JsonValue();
+      char c = *m_Cursor;
+      if (c == '{')
+      {
+        m_Cursor++;
+        value.m_Type = JsonValue::Type::Object;
+        if (Consume('}'))
+          return true;
+        do
+        {
+          std::string key;
+          JsonValue member;
+          if (!ParseString(key) || !Consume(':'))
+            return Fail("expected member");
+          if (!ParseValue(member, depth + 1))
+            return false;
+          value.m_Members.emplace_back(std::move(key), std::move(member));
+        } while (Consume(','));
+        return Consume('}') || Fail("expected '}'");
+      }
+      if (c == '[')
+      {
+        m_Cursor++;
+        value.m_Type = JsonValue::Type::Array;
+        if (Consume(']'))
+          return true;
+        do
+        {
+          value.m_Array.emplace_back();
+          if (!ParseValue(value.m_Array.back(), depth + 1))
+            return false;
+        } while (Consume(','));
+        return Consume(']') || Fail("expected ']'");
+      }
+      if (c == '"')
+      {
+        value.m_Type = JsonValue::Type::String;
+        return ParseString(value.m_String);
+      }
+      if (ConsumeWord("true") || ConsumeWord("false"))
+      {
+        value.m_Type = JsonValue::Type::Bool;
+        value.m_Bool = m_Cursor[-1] == 'e' && m_Cursor[-2] == 'u';
+        return true;
+      }
+      if (ConsumeWord("null"))
+        return true;
+
+      // from_chars takes no leading '+', which JSON does not allow either.
+      auto [end, result] = std::from_chars(m_Cursor, m_End, value.m_Number);
+      if (result != std::errc() || end == m_Cursor)
+        return Fail("unexpected character");
+      value.m_Type = JsonValue::Type::Number;
+      m_Cursor = end;
+      return true;
+    }
+  private:
+    const char* m_Cursor;
+    const char* m_Begin;
+    const char* m_End;
+    std::string m_Error;
+  };
+
+  bool JsonValue::Parse(const char* text, size_t size, JsonValue& value, std::string& error)
+  {
+    JsonParser parser(text, size);
+    return parser.ParseDocument(value, error);
+  }
+
+}
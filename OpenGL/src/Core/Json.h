@@ -0,0 +1,47 @@
+#pragma once
+
+namespace Hazel {
+
+  // Minimal JSON document, enough for asset manifests such as glTF. Lookups
+  // of missing members or elements return a shared null value, so chains
+  // like json["meshes"][0]["name"] need no checks in between.
+  class JsonValue
+  {
+  public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    // False, with error set, on malformed input.
+    static bool Parse(const char* text, size_t size, JsonValue& value, std::string& error);
+
+    Type GetType() const { return m_Type; }
+    bool IsNull() const { return m_Type == Type::Null; }
+    bool IsNumber() const { return m_Type == Type::Number; }
+    bool IsString() const { return m_Type == Type::String; }
+    bool IsArray() const { return m_Type == Type::Array; }
+    bool IsObject() const { return m_Type == Type::Object; }
+
+    bool GetBool(bool fallback = false) const { return m_Type == Type::Bool ? m_Bool : fallback; }
+    double GetNumber(double fallback = 0.0) const { return m_Type == Type::Number ? m_Number : fallback; }
+    // Empty for non-strings.
+    const std::string& GetString() const { return m_String; }
+
+    // Elements of an array or members of an object; 0 otherwise.
+    size_t GetSize() const { return m_Type == Type::Array ? m_Array.size() : m_Members.size(); }
+    const JsonValue& operator[](size_t index) const;
+    const JsonValue& operator[](const std::string& key) const;
+    bool Has(const std::string& key) const { return &(*this)[key] != &s_Null; }
+    const std::vector<std::pair<std::string, JsonValue>>& GetMembers() const { return m_Members; }
+  private:
+    friend class JsonParser;
+
+    Type m_Type = Type::Null;
+    bool m_Bool = false;
+    double m_Number = 0.0;
+    std::string m_String;
+    std::vector<JsonValue> m_Array;
+    std::vector<std::pair<std::string, JsonValue>> m_Members;
+
+    static const JsonValue s_Null;
+  };
+
+}
@@ -0,0 +1,146 @@
+#include "Lz.h"
+
+namespace Hazel {
+
+  static constexpr size_t MinMatch = 4;
+  static constexpr size_t MaxOffset = 65535;
+  static constexpr uint32_t HashBits = 16;
+
+  static uint32_t Load32(const uint8_t* data)
+  {
+    uint32_t value;
+    memcpy(&value, data, 4);
+    return value;
+  }
+
+  static uint32_t Hash(uint32_t sequence)
+  {
+    return (sequence * 2654435761u) >> (32 - HashBits);
+  }
+
+  static void WriteLength(size_t length, std::vector<uint8_t>& out)
+  {
+    for (; length >= 255; length -= 255)
+      out.push_back(255);
+    out.push_back((uint8_t)length);
+  }
+
+  static void WriteSequence(const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength, std::vector<uint8_t>& out)
+  {
+    size_t matchCode = matchLength ? matchLength - MinMatch : 0;
+    out.push_back((uint8_t)((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+    if (literalCount >= 15)
+      WriteLength(literalCount - 15, out);
+    out.insert(out.end(), literals, literals + literalCount);
+    if (!matchLength)
+      return;
+
+    out.push_back((uint8_t)offset);
+    out.push_back((uint8_t)(offset >> 8));
+    if (matchCode >= 15)
+      WriteLength(matchCode - 15, out);
+  }
+
+  void LzCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+  {
+    // Most recent position of each hashed 4-byte sequence; greedy matching.
+    std::vector<uint32_t> table((size_t)1 << HashBits, 0);
+    size_t anchor = 0, pos = 0;
+    while (pos + MinMatch <= size)
+    {
+      uint32_t sequence = Load32(data + pos);
+      uint32_t& slot = table[Hash(sequence)];
+      size_t candidate = slot;
+      slot = (uint32_t)pos;
+      if (candidate >= pos || pos - candidate > MaxOffset || Load32(data + candidate) != sequence)
+      {
+        // Stride grows through incompressible stretches.
+        pos += 1 + ((pos - anchor) >> 6);
+        continue;
+      }
+
+      size_t length = MinMatch;
+      while (pos + length + 8 <= size)
+      {
+        uint64_t a, b;
+        memcpy(&a, data + candidate + length, 8);
+        memcpy(&b, data + pos + length, 8);
+        if (a != b)
+          break;
+        length += 8;
+      }
+      while (pos + length < size && data[candidate + length] == data[pos + length])
+        length++;
+
+      WriteSequence(data + anchor, pos - anchor, pos - candidate, length, out);
+      pos += length;
+      anchor = pos;
+      // Also index the match's tail, which the next repeat tends to start from.
+      if (pos + 2 <= size)
+        table[Hash(Load32(data + pos - 2))] = (uint32_t)(pos - 2);
+    }
+    WriteSequence(data + anchor, size - anchor, 0, 0, out);
+  }
+
+  static bool ReadLength(const uint8_t*& in, const uint8_t* end, size_t& length)
+  {
+    uint8_t byte;
+    do
+    {
+      if (in == end)
+        return false;
+      byte = *in++;
+      length += byte;
+    } while (byte == 255);
+    return true;
+  }
+
+  bool LzDecompress(const uint8_t* data, size_t size, uint8_t* out, size_t outSize)
+  {
+    const uint8_t* in = data;
+    const uint8_t* end = data + size;
+    uint8_t* op = out;
+    uint8_t* outEnd = out + outSize;
+    while (in < end)
+    {
+      uint8_t token = *in++;
+      size_t literalCount = token >> 4;
+      if (literalCount == 15 && !ReadLength(in, end, literalCount))
+        return false;
+      if (literalCount > (size_t)(end - in) || literalCount > (size_t)(outEnd - op))
+        return false;
+      memcpy(op, in, literalCount);
+      op += literalCount;
+      in += literalCount;
+      if (in == end)
+        break;
+
+      if (end - in < 2)
+        return false;
+      size_t offset = in[0] | ((size_t)in[1] << 8);
+      in += 2;
+      size_t length = token & 15;
+      if (length == 15 && !ReadLength(in, end, length))
+        return false;
+      length += MinMatch;
+      if (offset == 0 || offset > (size_t)(op - out) || length > (size_t)(outEnd - op))
+        return false;
+
+      // Matches may overlap what they write: a short offset repeats a pattern.
+      const uint8_t* match = op - offset;
+      if (offset >= 8 && (size_t)(outEnd - op) >= length + 8)
+      {
+        for (size_t i = 0; i < length; i += 8)
+          memcpy(op + i, match + i, 8);
+      }
+      else
+      {
+        for (size_t i = 0; i < length; i++)
+          op[i] = match[i];
+      }
+      op += length;
+    }
+    return op == outEnd;
+  }
+
+}
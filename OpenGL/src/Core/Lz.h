@@ -0,0 +1,23 @@
+#pragma once
+
+namespace Hazel {
+
+  // Byte-oriented LZ77 compression for asset files, in the LZ4 mould: runs
+  // of literals and back-references of at least four bytes up to 64 KiB
+  // back, with no entropy coding, so decompression is little more than
+  // memcpy. Text such as shaders and OBJ halves; already compressed data
+  // (PNG, block-compressed KTX2) barely changes and is best stored as is.
+  //
+  // A sequence is a token byte (literal count in the high nibble, match
+  // length minus four in the low one, 15 meaning more length bytes follow,
+  // each adding up to 255), the literals, then a little-endian 16-bit match
+  // offset. The last sequence has literals only.
+
+  // Appends the compressed form of data.
+  void LzCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+  // Fills exactly outSize bytes of out; false if the data is malformed, ends
+  // early or decompresses to any other size.
+  bool LzDecompress(const uint8_t* data, size_t size, uint8_t* out, size_t outSize);
+
+}
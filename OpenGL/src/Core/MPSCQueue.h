@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+
+namespace Hazel {
+
+  // Unbounded lock-free queue for many producers and a single consumer
+  // (Vyukov's intrusive MPSC list). Push never blocks; Pop must only be
+  // called from one thread at a time.
+  template<typename T>
+  class MPSCQueue
+  {
+  public:
+    MPSCQueue()
+    {
+      m_Tail = new Node();
+      m_Head.store(m_Tail, std::memory_order_relaxed);
+    }
+
+    ~MPSCQueue()
+    {
+      T value;
+      while (Pop(value))
+        ;
+      delete m_Tail;
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    void Push(T value)
+    {
+      Node* node = new Node();
+      node->Value = std::move(value);
+      Node* previous = m_Head.exchange(node, std::memory_order_acq_rel);
+      // Between the exchange and this store the list is briefly cut; Pop then
+      // sees an empty queue and the item shows up on the next call.
+      previous->Next.store(node, std::memory_order_release);
+    }
+
+    bool Pop(T& value)
+    {
+      Node* next = m_Tail->Next.load(std::memory_order_acquire);
+      if (!next)
+        return false;
+
+      // The popped node becomes the new stub.
+      value = std::move(next->Value);
+      delete m_Tail;
+      m_Tail = next;
+      return true;
+    }
+  private:
+    struct Node
+    {
+      std::atomic<Node*> Next{ nullptr };
+      T Value{};
+    };
+
+    // Producers append at the head, the consumer takes from the tail.
+    alignas(64) std::atomic<Node*> m_Head;
+    alignas(64) Node* m_Tail;
+  };
+
+}
@@ -0,0 +1,132 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace Hazel {
+
+  MappedFile::~MappedFile()
+  {
+    Close();
+  }
+
+  MappedFile::MappedFile(MappedFile&& other) noexcept
+  {
+    *this = std::move(other);
+  }
+
+  MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+  {
+    if (this != &other)
+    {
+      Close();
+      std::swap(m_Data, other.m_Data);
+      std::swap(m_Size, other.m_Size);
+      std::swap(m_Open, other.m_Open);
+#ifdef _WIN32
+      std::swap(m_File, other.m_File);
+      std::swap(m_Mapping, other.m_Mapping);
+#endif
+    }
+    return *this;
+  }
+
+#ifdef _WIN32
+  bool MappedFile::Open(const std::string& path)
+  {
+    Close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+      return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+      CloseHandle(file);
+      return false;
+    }
+
+    m_File = file;
+    m_Size = (size_t)size.QuadPart;
+    m_Open = true;
+    if (m_Size == 0)
+      return true;
+
+    m_Mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_Mapping)
+      m_Data = (const uint8_t*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m_Data)
+    {
+      Close();
+      return false;
+    }
+    return true;
+  }
+
+  void MappedFile::Close()
+  {
+    if (m_Data)
+      UnmapViewOfFile(m_Data);
+    if (m_Mapping)
+      CloseHandle(m_Mapping);
+    if (m_File)
+      CloseHandle(m_File);
+    m_Data = nullptr;
+    m_Mapping = m_File = nullptr;
+    m_Size = 0;
+    m_Open = false;
+  }
+#else
+  bool MappedFile::Open(const std::string& path)
+  {
+    Close();
+
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+      return false;
+
+    struct stat info;
+    if (fstat(file, &info) != 0)
+    {
+      close(file);
+      return false;
+    }
+
+    m_Size = (size_t)info.st_size;
+    if (m_Size > 0)
+    {
+      void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+      if (data == MAP_FAILED)
+      {
+        close(file);
+        m_Size = 0;
+        return false;
+      }
+      m_Data = (const uint8_t*)data;
+    }
+    // The mapping keeps the file alive.
+    close(file);
+    m_Open = true;
+    return true;
+  }
+
+  void MappedFile::Close()
+  {
+    if (m_Data)
+      munmap((void*)m_Data, m_Size);
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Open = false;
+  }
+#endif
+
+}
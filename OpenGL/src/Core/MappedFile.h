@@ -0,0 +1,36 @@
+#pragma once
+
+namespace Hazel {
+
+  // A whole file mapped read-only into the address space. Pages are faulted
+  // in on first touch, so nothing is read until the data is used, and the
+  // mapping can be handed to e.g. glBufferData without an intermediate copy.
+  class MappedFile
+  {
+  public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // False if the file could not be opened or mapped. Empty files map to nothing and succeed.
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return m_Open; }
+    const uint8_t* GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+  private:
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+    bool m_Open = false;
+#ifdef _WIN32
+    void* m_File = nullptr;
+    void* m_Mapping = nullptr;
+#endif
+  };
+
+}
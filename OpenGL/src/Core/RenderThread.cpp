@@ -0,0 +1,23 @@
+#include "RenderThread.h"
+
+namespace Hazel {
+
+  uint32_t RenderThread::Execute()
+  {
+    uint32_t count = 0;
+    Job job;
+    while (m_Jobs.Pop(job))
+    {
+      job();
+      count++;
+    }
+    return count;
+  }
+
+  RenderThread& RenderThread::Get()
+  {
+    static RenderThread s_Instance;
+    return s_Instance;
+  }
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+
+#include "MPSCQueue.h"
+#include "Task.h"
+
+namespace Hazel {
+
+  // Work handed to the thread that owns the GL context: anything may Post,
+  // and the main loop runs what was posted with Execute() once per frame.
+  // Tasks get there with co_await RenderThread::Get().Schedule().
+  class RenderThread
+  {
+  public:
+    using Job = std::function<void()>;
+
+    RenderThread() = default;
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    void Post(Job job) { m_Jobs.Push(std::move(job)); }
+
+    // Render thread only. Runs everything posted so far, and whatever that
+    // posts in turn; returns how many jobs ran.
+    uint32_t Execute();
+
+    auto Schedule()
+    {
+      struct Awaiter
+      {
+        RenderThread& Thread;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { Thread.Post([handle]() { handle.resume(); }); }
+        void await_resume() const noexcept {}
+      };
+      return Awaiter{ *this };
+    }
+
+    // Render thread only, for loads the next step cannot go without. Starts
+    // the task if needed and runs posted jobs, and pump if given, e.g. an
+    // UploadScheduler's Update, until it finishes.
+    template<typename T>
+    decltype(auto) Wait(Task<T>& task, const std::function<void()>& pump = {})
+    {
+      if (!task.IsStarted())
+        task.Start();
+      while (!task.IsReady())
+      {
+        if (pump)
+          pump();
+        if (Execute() == 0)
+          std::this_thread::yield();
+      }
+      if constexpr (!std::is_void_v<T>)
+        return task.GetResult();
+    }
+
+    static RenderThread& Get();
+  private:
+    MPSCQueue<Job> m_Jobs;
+  };
+
+}
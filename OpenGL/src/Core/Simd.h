@@ -0,0 +1,12 @@
+#pragma once
+
+// Compile-time SIMD levels. Code keeps a scalar path for everything else.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define HZ_SIMD_SSE2 1
+  #include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+  #define HZ_SIMD_AVX2 1
+  #include <immintrin.h>
+#endif
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <optional>
+
+namespace Hazel {
+
+  // Shared between a load and whoever may call it off; the load checks it
+  // after each co_await and gives up early. Copies share the flag.
+  class CancellationToken
+  {
+  public:
+    CancellationToken() : m_Cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void Cancel() { m_Cancelled->store(true, std::memory_order_relaxed); }
+    bool IsCancelled() const { return m_Cancelled->load(std::memory_order_relaxed); }
+  private:
+    std::shared_ptr<std::atomic<bool>> m_Cancelled;
+  };
+
+  template<typename T = void>
+  class Task;
+
+  namespace Detail {
+
+    class TaskPromiseBase
+    {
+    public:
+      // Finished; any other non-null state is the coroutine awaiting the task.
+      static void* Done() { static char s_Done; return &s_Done; }
+
+      struct FinalAwaiter
+      {
+        bool await_ready() const noexcept { return false; }
+
+        template<typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept
+        {
+          // The owner may destroy the frame as soon as it sees Done, so
+          // nothing in it is touched after the exchange.
+          void* awaiting = handle.promise().m_State.exchange(Done(), std::memory_order_acq_rel);
+          return awaiting ? std::coroutine_handle<>::from_address(awaiting) : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+      };
+
+      std::suspend_always initial_suspend() const noexcept { return {}; }
+      FinalAwaiter final_suspend() const noexcept { return {}; }
+      // The engine does not use exceptions; one escaping a task is a bug.
+      void unhandled_exception() const noexcept { std::terminate(); }
+
+      std::atomic<void*> m_State{ nullptr };
+    };
+
+    template<typename T>
+    class TaskPromise : public TaskPromiseBase
+    {
+    public:
+      Task<T> get_return_object();
+      template<typename U>
+      void return_value(U&& value) { m_Value.emplace(std::forward<U>(value)); }
+
+      std::optional<T> m_Value;
+    };
+
+    template<>
+    class TaskPromise<void> : public TaskPromiseBase
+    {
+    public:
+      Task<void> get_return_object();
+      void return_void() const noexcept {}
+    };
+
+  }
+
+  // A coroutine that returns T. Tasks start lazily and run on whichever
+  // thread resumes them, moving between threads with
+  //   co_await ThreadPool::Get().Schedule();
+  //   co_await RenderThread::Get().Schedule();
+  // A task is either awaited by another task, which then continues where the
+  // task finishes, or started by its owner and polled with IsReady, e.g.
+  // through RenderThread::Wait. Starting a task runs it on the calling
+  // thread up to its first suspension. A started task must finish before it
+  // is destroyed.
+  template<typename T>
+  class [[nodiscard]] Task
+  {
+  public:
+    using promise_type = Detail::TaskPromise<T>;
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_Handle(handle) {}
+    ~Task() { Destroy(); }
+
+    Task(Task&& other) noexcept
+      : m_Handle(std::exchange(other.m_Handle, nullptr)), m_Started(other.m_Started) {}
+    Task& operator=(Task&& other) noexcept
+    {
+      if (this != &other)
+      {
+        Destroy();
+        m_Handle = std::exchange(other.m_Handle, nullptr);
+        m_Started = other.m_Started;
+      }
+      return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    void Start()
+    {
+      HZ_CORE_ASSERT(m_Handle && !m_Started, "Task started twice!");
+      m_Started = true;
+      m_Handle.resume();
+    }
+
+    bool IsValid() const { return (bool)m_Handle; }
+    bool IsStarted() const { return m_Started; }
+    bool IsReady() const { return m_Handle && m_Handle.promise().m_State.load(std::memory_order_acquire) == promise_type::Done(); }
+
+    // Once ready.
+    template<typename U = T, typename = std::enable_if_t<!std::is_void_v<U>>>
+    U& GetResult()
+    {
+      HZ_CORE_ASSERT(IsReady(), "Task is not finished!");
+      return *m_Handle.promise().m_Value;
+    }
+
+    // Awaiting a task gives a reference to its result, or the result itself
+    // when the task is a temporary.
+    auto operator co_await() & noexcept { return Awaiter<false>{ *this }; }
+    auto operator co_await() && noexcept { return Awaiter<true>{ *this }; }
+  private:
+    template<bool Move>
+    struct Awaiter
+    {
+      Task& Awaited;
+
+      bool await_ready() const noexcept { return Awaited.IsReady(); }
+
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+      {
+        std::atomic<void*>& state = Awaited.m_Handle.promise().m_State;
+        if (!Awaited.m_Started)
+        {
+          // Runs the task right here; it resumes us when it finishes.
+          Awaited.m_Started = true;
+          state.store(awaiting.address(), std::memory_order_relaxed);
+          return Awaited.m_Handle;
+        }
+
+        // Started elsewhere: wait unless it finished in the meantime.
+        void* running = nullptr;
+        if (state.compare_exchange_strong(running, awaiting.address(), std::memory_order_acq_rel))
+          return std::noop_coroutine();
+        return awaiting;
+      }
+
+      decltype(auto) await_resume() const noexcept
+      {
+        if constexpr (std::is_void_v<T>)
+          return;
+        else if constexpr (Move)
+          return std::move(*Awaited.m_Handle.promise().m_Value);
+        else
+          return *Awaited.m_Handle.promise().m_Value;
+      }
+    };
+
+    void Destroy()
+    {
+      if (!m_Handle)
+        return;
+      HZ_CORE_ASSERT(!m_Started || IsReady(), "Task destroyed while running!");
+      m_Handle.destroy();
+      m_Handle = nullptr;
+    }
+  private:
+    std::coroutine_handle<promise_type> m_Handle;
+    bool m_Started = false;
+  };
+
+  namespace Detail {
+
+    template<typename T>
+    inline Task<T> TaskPromise<T>::get_return_object()
+    {
+      return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+    }
+
+    inline Task<void> TaskPromise<void>::get_return_object()
+    {
+      return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+    }
+
+  }
+
+  // Starts every task, so they run side by side, and finishes once the last
+  // of them has. Results stay in the tasks.
+  template<typename T>
+  Task<> WhenAll(std::vector<Task<T>>& tasks)
+  {
+    for (Task<T>& task : tasks)
+    {
+      if (!task.IsStarted())
+        task.Start();
+    }
+    for (Task<T>& task : tasks)
+      co_await task;
+  }
+
+  template<typename... T>
+  Task<> WhenAll(Task<T>&... tasks)
+  {
+    ((tasks.IsStarted() ? void() : tasks.Start()), ...);
+    (co_await tasks, ...);
+  }
+
+}
@@ -0,0 +1,115 @@
+#include "ThreadPool.h"
+
+namespace Hazel {
+
+  ThreadPool::ThreadPool(uint32_t threadCount)
+  {
+    if (threadCount == 0)
+    {
+      // Leave one core for the main (GL) thread.
+      uint32_t hardware = std::thread::hardware_concurrency();
+      threadCount = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    m_Workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+      m_Workers.emplace_back([this]() { WorkerLoop(); });
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Stopping = true;
+    }
+    m_Condition.notify_all();
+
+    for (auto& worker : m_Workers)
+      worker.join();
+  }
+
+  void ThreadPool::Enqueue(Job job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Jobs.push_back(std::move(job));
+    }
+    m_Condition.notify_one();
+  }
+
+  void ThreadPool::ParallelFor(uint32_t count, uint32_t chunkSize, const RangeFn& fn)
+  {
+    if (count == 0)
+      return;
+
+    chunkSize = std::max(chunkSize, 1u);
+    uint32_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    if (chunkCount == 1)
+    {
+      fn(0, count);
+      return;
+    }
+
+    // Shared with the helper jobs, which may still be queued after we return.
+    struct State
+    {
+      std::atomic<uint32_t> NextChunk{ 0 };
+      std::atomic<uint32_t> DoneChunks{ 0 };
+      std::mutex Mutex;
+      std::condition_variable Done;
+    };
+    auto state = std::make_shared<State>();
+
+    auto drain = [state, count, chunkSize, chunkCount, &fn]()
+    {
+      uint32_t chunk;
+      while ((chunk = state->NextChunk.fetch_add(1)) < chunkCount)
+      {
+        uint32_t begin = chunk * chunkSize;
+        fn(begin, std::min(begin + chunkSize, count));
+        if (state->DoneChunks.fetch_add(1) + 1 == chunkCount)
+        {
+          std::lock_guard<std::mutex> lock(state->Mutex);
+          state->Done.notify_all();
+        }
+      }
+    };
+
+    uint32_t helpers = std::min(chunkCount - 1, GetThreadCount());
+    for (uint32_t i = 0; i < helpers; i++)
+    {
+      // Helpers only touch fn while chunks remain, i.e. before we return.
+      Enqueue(drain);
+    }
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(state->Mutex);
+    state->Done.wait(lock, [&]() { return state->DoneChunks.load() == chunkCount; });
+  }
+
+  ThreadPool& ThreadPool::Get()
+  {
+    static ThreadPool s_Instance;
+    return s_Instance;
+  }
+
+  void ThreadPool::WorkerLoop()
+  {
+    for (;;)
+    {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+        if (m_Stopping && m_Jobs.empty())
+          return;
+
+        job = std::move(m_Jobs.front());
+        m_Jobs.pop_front();
+      }
+      job();
+    }
+  }
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace Hazel {
+
+  // Fixed-size pool of worker threads shared by the engine's CPU-side systems.
+  class ThreadPool
+  {
+  public:
+    using Job = std::function<void()>;
+    // Called with a half-open [begin, end) range of items.
+    using RangeFn = std::function<void(uint32_t, uint32_t)>;
+
+    explicit ThreadPool(uint32_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Enqueue(Job job);
+
+    template<typename F>
+    auto Submit(F&& fn) -> std::future<decltype(fn())>
+    {
+      using R = decltype(fn());
+      auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+      std::future<R> result = task->get_future();
+      Enqueue([task]() { (*task)(); });
+      return result;
+    }
+
+    // Splits [0, count) into chunks of chunkSize and runs them on the workers.
+    // The calling thread takes chunks too, so this is safe to call from a job.
+    void ParallelFor(uint32_t count, uint32_t chunkSize, const RangeFn& fn);
+
+    // co_await ThreadPool::Get().Schedule() continues a Task on a worker.
+    auto Schedule()
+    {
+      struct Awaiter
+      {
+        ThreadPool& Pool;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { Pool.Enqueue([handle]() { handle.resume(); }); }
+        void await_resume() const noexcept {}
+      };
+      return Awaiter{ *this };
+    }
+
+    uint32_t GetThreadCount() const { return (uint32_t)m_Workers.size(); }
+
+    static ThreadPool& Get();
+  private:
+    void WorkerLoop();
+  private:
+    std::vector<std::thread> m_Workers;
+    std::deque<Job> m_Jobs;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    bool m_Stopping = false;
+  };
+
+}
@@ -0,0 +1,203 @@
+#include "VirtualFileSystem.h"
+
+#include <filesystem>
+
+#include "FileSystem.h"
+#include "Lz.h"
+#include "ThreadPool.h"
+
+namespace Hazel {
+
+  bool VirtualFileSystem::MountDirectory(const std::string& directory)
+  {
+    std::error_code error;
+    if (!std::filesystem::is_directory(directory, error))
+      return false;
+
+    std::unique_lock lock(m_Mutex);
+    m_Mounts.push_back({ directory, nullptr });
+    return true;
+  }
+
+  bool VirtualFileSystem::MountPack(const std::string& path, std::string& error)
+  {
+    Ref<AssetPack> pack = CreateRef<AssetPack>();
+    if (!pack->Open(path, error))
+      return false;
+
+    std::unique_lock lock(m_Mutex);
+    m_Mounts.push_back({ {}, pack });
+    return true;
+  }
+
+  void VirtualFileSystem::UnmountAll()
+  {
+    std::unique_lock lock(m_Mutex);
+    m_Mounts.clear();
+  }
+
+  bool VirtualFileSystem::Exists(const std::string& path) const
+  {
+    std::string name = NormalizeAssetPath(path);
+    if (name.empty())
+      return false;
+
+    std::shared_lock lock(m_Mutex);
+    for (auto mount = m_Mounts.rbegin(); mount != m_Mounts.rend(); mount++)
+    {
+      std::error_code error;
+      if (mount->Pack ? mount->Pack->Find(name) != nullptr : std::filesystem::is_regular_file(mount->Directory + "/" + name, error))
+        return true;
+    }
+    return false;
+  }
+
+  bool VirtualFileSystem::Open(const std::string& path, VfsFile& file) const
+  {
+    file = VfsFile();
+    std::string name = NormalizeAssetPath(path);
+    if (name.empty())
+      return false;
+
+    std::shared_lock lock(m_Mutex);
+    for (auto mount = m_Mounts.rbegin(); mount != m_Mounts.rend(); mount++)
+    {
+      if (!mount->Pack)
+      {
+        std::string diskPath = mount->Directory + "/" + name;
+        if (!file.m_File.Open(diskPath))
+          continue;
+        file.m_DiskPath = std::move(diskPath);
+        file.m_Data = file.m_File.GetData();
+        file.m_Size = file.m_File.GetSize();
+        file.m_Open = true;
+        return true;
+      }
+
+      const AssetPackEntry* entry = mount->Pack->Find(name);
+      if (!entry)
+        continue;
+      if (entry->Encoding == AssetPackEncoding::None)
+      {
+        file.m_Pack = mount->Pack;
+        file.m_Data = mount->Pack->GetStoredData(*entry);
+      }
+      else
+      {
+        file.m_Buffer.resize((size_t)entry->Size);
+        if (!mount->Pack->Read(*entry, file.m_Buffer.data()))
+        {
+          HZ_HAZEL_ERROR("Corrupt entry '{0}' in {1}", name, mount->Pack->GetPath());
+          return false;
+        }
+        file.m_Data = file.m_Buffer.data();
+      }
+      file.m_Size = (size_t)entry->Size;
+      file.m_Open = true;
+      return true;
+    }
+    return false;
+  }
+
+  bool VirtualFileSystem::Read(const std::string& path, std::vector<uint8_t>& data) const
+  {
+    std::string name = NormalizeAssetPath(path);
+    if (name.empty())
+      return false;
+
+    std::shared_lock lock(m_Mutex);
+    for (auto mount = m_Mounts.rbegin(); mount != m_Mounts.rend(); mount++)
+    {
+      if (!mount->Pack)
+      {
+        // Small files read faster than they map.
+        if (ReadFile(mount->Directory + "/" + name, data))
+          return true;
+        continue;
+      }
+
+      const AssetPackEntry* entry = mount->Pack->Find(name);
+      if (!entry)
+        continue;
+      data.resize((size_t)entry->Size);
+      if (!mount->Pack->Read(*entry, data.data()))
+      {
+        HZ_HAZEL_ERROR("Corrupt entry '{0}' in {1}", name, mount->Pack->GetPath());
+        return false;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  void VirtualFileSystem::ReadAsync(const std::string& path, AsyncFileIO::Completion done, AsyncFileIO& io) const
+  {
+    std::string name = NormalizeAssetPath(path);
+    if (!name.empty())
+    {
+      std::shared_lock lock(m_Mutex);
+      for (auto mount = m_Mounts.rbegin(); mount != m_Mounts.rend(); mount++)
+      {
+        if (!mount->Pack)
+        {
+          std::string diskPath = mount->Directory + "/" + name;
+          std::error_code error;
+          if (!std::filesystem::is_regular_file(diskPath, error))
+            continue;
+          io.ReadFile(diskPath, std::move(done));
+          return;
+        }
+
+        const AssetPackEntry* entry = mount->Pack->Find(name);
+        if (!entry)
+          continue;
+        // Read from the file rather than faulted in from the pack's mapping,
+        // which would block the worker that touches it.
+        if (entry->Encoding == AssetPackEncoding::None)
+        {
+          io.Read(mount->Pack->GetPath(), entry->Offset, (size_t)entry->Size, std::move(done));
+          return;
+        }
+        io.Read(mount->Pack->GetPath(), entry->Offset, (size_t)entry->StoredSize,
+          [pack = mount->Pack, entry = *entry, done = std::move(done)](const FileReadResult& stored)
+        {
+          thread_local std::vector<uint8_t> data;
+          FileReadResult result;
+          if (stored.Error.empty())
+          {
+            data.resize((size_t)entry.Size);
+            if (LzDecompress(stored.Data, stored.Size, data.data(), data.size()))
+            {
+              result.Data = data.data();
+              result.Size = data.size();
+            }
+            else
+            {
+              result.Error = "corrupt entry in " + pack->GetPath();
+            }
+          }
+          else
+          {
+            result.Error = stored.Error;
+          }
+          done(result);
+        });
+        return;
+      }
+    }
+
+    ThreadPool::Get().Enqueue([done = std::move(done)]()
+    {
+      FileReadResult result;
+      result.Error = "could not open file";
+      done(result);
+    });
+  }
+
+  VirtualFileSystem& VirtualFileSystem::Get()
+  {
+    static VirtualFileSystem s_Instance;
+    return s_Instance;
+  }
+
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <coroutine>
+#include <shared_mutex>
+
+#include "AssetPack.h"
+#include "AsyncFileIO.h"
+
+namespace Hazel {
+
+  // A file opened through the VirtualFileSystem. Loose files and pack
+  // entries stored uncompressed are mapped and used in place; compressed
+  // entries are decompressed into memory the file owns.
+  class VfsFile
+  {
+  public:
+    bool IsOpen() const { return m_Open; }
+    const uint8_t* GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+    // Where a loose file lives on disk; empty for files in a pack.
+    const std::string& GetDiskPath() const { return m_DiskPath; }
+  private:
+    // Keeps the pack's mapping alive.
+    Ref<AssetPack> m_Pack;
+    MappedFile m_File;
+    std::vector<uint8_t> m_Buffer;
+    std::string m_DiskPath;
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+    bool m_Open = false;
+
+    friend class VirtualFileSystem;
+  };
+
+  // What co_await VirtualFileSystem::ReadAsync(path) gives.
+  struct VfsReadResult
+  {
+    std::vector<uint8_t> Data;
+    // Empty on success.
+    std::string Error;
+  };
+
+  // Resolves asset paths such as "shaders/lighting.glsl" against mounted
+  // packs and directories, the most recently mounted first. A shipped build
+  // mounts one pack, mapped once, instead of opening every file; development
+  // builds mount the source tree's asset directory. Mounts are meant to be
+  // made up front, and lookups may come from any thread.
+  class VirtualFileSystem
+  {
+  public:
+    VirtualFileSystem() = default;
+
+    VirtualFileSystem(const VirtualFileSystem&) = delete;
+    VirtualFileSystem& operator=(const VirtualFileSystem&) = delete;
+
+    // False if the directory does not exist.
+    bool MountDirectory(const std::string& directory);
+    bool MountPack(const std::string& path, std::string& error);
+    void UnmountAll();
+
+    bool Exists(const std::string& path) const;
+    // Without a copy where the mount allows it.
+    bool Open(const std::string& path, VfsFile& file) const;
+    bool Read(const std::string& path, std::vector<uint8_t>& data) const;
+    // Resolves the path here and reads through io, which runs done on the
+    // ThreadPool; compressed pack entries are decompressed first. Files that
+    // are not found complete with an error the same way.
+    void ReadAsync(const std::string& path, AsyncFileIO::Completion done, AsyncFileIO& io = AsyncFileIO::Get()) const;
+    // The same read for a Task, which continues on the worker that completed it.
+    auto ReadAsync(const std::string& path, AsyncFileIO& io = AsyncFileIO::Get()) const
+    {
+      struct Awaiter
+      {
+        const VirtualFileSystem& FileSystem;
+        std::string Path;
+        AsyncFileIO& IO;
+        VfsReadResult Result;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+          FileSystem.ReadAsync(Path, [this, handle](const FileReadResult& file)
+          {
+            if (file.Error.empty())
+              Result.Data.assign(file.Data, file.Data + file.Size);
+            else
+              Result.Error = file.Error;
+            handle.resume();
+          }, IO);
+        }
+        VfsReadResult await_resume() { return std::move(Result); }
+      };
+      return Awaiter{ *this, path, io, {} };
+    }
+
+    static VirtualFileSystem& Get();
+  private:
+    struct Mount
+    {
+      // One of the two.
+      std::string Directory;
+      Ref<AssetPack> Pack;
+    };
+
+    std::vector<Mount> m_Mounts;
+    mutable std::shared_mutex m_Mutex;
+  };
+
+}
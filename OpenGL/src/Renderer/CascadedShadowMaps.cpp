@@ -0,0 +1,260 @@
+#include "CascadedShadowMaps.h"
+
+#include <cfloat>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Mesh.h"
+
+namespace Hazel {
+
+  CascadedShadowMaps::CascadedShadowMaps()
+  {
+    m_DepthShader = CreateRef<Shader>("shaders/shadow_depth.glsl");
+
+    glGenTextures(1, &m_DepthArray);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_DepthArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, Resolution, Resolution, CascadeCount, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    // Hardware 2x2 PCF through sampler2DArrayShadow.
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    glGenFramebuffers(1, &m_Framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_DepthArray, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    HZ_CORE_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Shadow framebuffer is incomplete!");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    for (auto& viewProjection : m_ViewProjection)
+      viewProjection = glm::mat4(1.0f);
+  }
+
+  CascadedShadowMaps::~CascadedShadowMaps()
+  {
+    glDeleteFramebuffers(1, &m_Framebuffer);
+    glDeleteTextures(1, &m_DepthArray);
+  }
+
+  static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+  {
+    // FNV-1a
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++)
+      hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+  }
+
+  void CascadedShadowMaps::GatherCasters(Scene& scene)
+  {
+    TransformSystem& transforms = scene.GetTransforms();
+
+    m_Casters.clear();
+    m_CasterBounds = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+    uint64_t staticHash = 14695981039346656037ull;
+
+    auto query = scene.GetRegistry().GetQuery<TransformComponent, MeshRendererComponent, BoundsComponent>();
+    query.ForEachChunk([&](uint32_t count, const Entity* entities, TransformComponent* transform, MeshRendererComponent* mesh, BoundsComponent* bounds)
+    {
+      for (uint32_t i = 0; i < count; i++)
+      {
+        if (mesh[i].Emissive)
+          continue;
+
+        const glm::mat4& world = transforms.GetWorldMatrix(transform[i].Transform);
+        BoundsComponent worldBounds = TransformBounds(bounds[i], world);
+        BoundsComponent lightBounds = TransformBounds(worldBounds, m_LightView);
+
+        m_Casters.push_back({ { lightBounds.Min, lightBounds.Max }, world, mesh[i].DepthVertexArray ? mesh[i].DepthVertexArray : mesh[i].VertexArray, mesh[i].FirstVertex, mesh[i].VertexCount, mesh[i].IndexType, mesh[i].Static });
+        m_CasterBounds.Min = glm::min(m_CasterBounds.Min, lightBounds.Min);
+        m_CasterBounds.Max = glm::max(m_CasterBounds.Max, lightBounds.Max);
+
+        if (mesh[i].Static)
+        {
+          staticHash = HashBytes(staticHash, &entities[i], sizeof(Entity));
+          staticHash = HashBytes(staticHash, &worldBounds, sizeof(worldBounds));
+        }
+      }
+    });
+
+    if (staticHash != m_StaticCasterHash)
+    {
+      m_StaticCasterHash = staticHash;
+      m_CacheValid.fill(false);
+    }
+  }
+
+  CascadedShadowMaps::Box CascadedShadowMaps::FitCascade(const RenderCamera& camera, float splitNear, float splitFar) const
+  {
+    glm::mat4 viewToLight = m_LightView * glm::inverse(camera.View);
+
+    float tanY = std::tan(camera.FovY * 0.5f);
+    float tanX = tanY * camera.Aspect;
+
+    // Tight light-space bounds of the sub-frustum's eight corners.
+    Box box = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+    for (float depth : { splitNear, splitFar })
+    {
+      for (float x : { -1.0f, 1.0f })
+      {
+        for (float y : { -1.0f, 1.0f })
+        {
+          glm::vec3 corner(viewToLight * glm::vec4(x * tanX * depth, y * tanY * depth, -depth, 1.0f));
+          box.Min = glm::min(box.Min, corner);
+          box.Max = glm::max(box.Max, corner);
+        }
+      }
+    }
+
+    // Casters between the light and the frustum must still land in the map.
+    box.Max.z = std::max(box.Max.z, m_CasterBounds.Max.z);
+    return box;
+  }
+
+  static void SnapToTexels(glm::vec3& min, glm::vec3& max, uint32_t resolution)
+  {
+    // Moving only in whole texels keeps edges from shimmering as the camera moves.
+    for (int axis = 0; axis < 2; axis++)
+    {
+      float texel = (max[axis] - min[axis]) / resolution;
+      if (texel <= 0.0f)
+        continue;
+
+      min[axis] = std::floor(min[axis] / texel) * texel;
+      max[axis] = std::ceil(max[axis] / texel) * texel;
+    }
+  }
+
+  static bool Contains(const glm::vec3& outerMin, const glm::vec3& outerMax, const glm::vec3& innerMin, const glm::vec3& innerMax)
+  {
+    return innerMin.x >= outerMin.x && innerMin.y >= outerMin.y && innerMin.z >= outerMin.z
+      && innerMax.x <= outerMax.x && innerMax.y <= outerMax.y && innerMax.z <= outerMax.z;
+  }
+
+  void CascadedShadowMaps::Update(Scene& scene, const RenderCamera& camera, const glm::vec3& lightDirection)
+  {
+    glm::vec3 direction = glm::normalize(lightDirection);
+    if (glm::dot(direction, m_LightDirection) < 0.99999f)
+    {
+      m_LightDirection = direction;
+      glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+      m_LightView = glm::lookAt(glm::vec3(0.0f), direction, up);
+      m_CacheValid.fill(false);
+    }
+
+    GatherCasters(scene);
+
+    // Practical split scheme over the shadowed part of the view frustum.
+    float nearPlane = camera.Near;
+    float farPlane = std::min(camera.Far, m_Settings.ShadowDistance);
+    for (uint32_t i = 0; i < CascadeCount; i++)
+    {
+      float t = (float)(i + 1) / CascadeCount;
+      float logarithmic = nearPlane * std::pow(farPlane / nearPlane, t);
+      float uniform = nearPlane + (farPlane - nearPlane) * t;
+      m_SplitFar[i] = glm::mix(uniform, logarithmic, m_Settings.SplitLambda);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+    glViewport(0, 0, Resolution, Resolution);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+    m_DepthShader->Bind();
+
+    for (uint32_t i = 0; i < CascadeCount; i++)
+    {
+      float splitNear = i == 0 ? nearPlane : m_SplitFar[i - 1];
+      Box box = FitCascade(camera, splitNear, m_SplitFar[i]);
+
+      CascadeStats& stats = m_Stats[i];
+      stats.SplitFar = m_SplitFar[i];
+
+      if (i >= FirstCachedCascade)
+      {
+        Box& cached = m_CachedBoxes[i];
+        stats.Cached = m_CacheValid[i] && Contains(cached.Min, cached.Max, box.Min, box.Max);
+        if (stats.Cached)
+        {
+          stats.DrawCalls = 0;
+          stats.CulledCasters = 0;
+          stats.GpuMs = 0.0f;
+          continue;
+        }
+
+        glm::vec3 margin = (box.Max - box.Min) * m_Settings.CacheMargin;
+        box.Min -= margin;
+        box.Max += margin;
+        box.Max.z = std::max(box.Max.z, m_CasterBounds.Max.z);
+      }
+
+      SnapToTexels(box.Min, box.Max, Resolution);
+      glm::mat4 projection = glm::ortho(box.Min.x, box.Max.x, box.Min.y, box.Max.y, -box.Max.z, -box.Min.z);
+      m_ViewProjection[i] = projection * m_LightView;
+
+      m_Timers[i].Begin();
+      RenderCascade(i, box, i >= FirstCachedCascade);
+      m_Timers[i].End();
+      stats.GpuMs = m_Timers[i].GetMilliseconds();
+
+      if (i >= FirstCachedCascade)
+      {
+        m_CachedBoxes[i] = box;
+        m_CacheValid[i] = true;
+      }
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+
+  void CascadedShadowMaps::RenderCascade(uint32_t cascade, const Box& box, bool staticOnly)
+  {
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_DepthArray, 0, cascade);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    m_DepthShader->UploadUniformMat4("lightViewProjection", m_ViewProjection[cascade]);
+
+    CascadeStats& stats = m_Stats[cascade];
+    stats.DrawCalls = 0;
+    stats.CulledCasters = 0;
+    for (const Caster& caster : m_Casters)
+    {
+      if (staticOnly && !caster.Static)
+        continue;
+
+      // Casters beyond the far end of the cascade cannot shadow anything in it.
+      const Box& bounds = caster.LightBounds;
+      bool visible = bounds.Max.x >= box.Min.x && bounds.Min.x <= box.Max.x
+        && bounds.Max.y >= box.Min.y && bounds.Min.y <= box.Max.y
+        && bounds.Max.z >= box.Min.z;
+      if (!visible)
+      {
+        stats.CulledCasters++;
+        continue;
+      }
+
+      m_DepthShader->UploadUniformMat4("model", caster.World);
+      glBindVertexArray(caster.VertexArray);
+      DrawTriangles(caster.FirstVertex, caster.VertexCount, caster.IndexType);
+      stats.DrawCalls++;
+    }
+  }
+
+  void CascadedShadowMaps::Bind(Shader& shader, uint32_t unit) const
+  {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_DepthArray);
+
+    shader.UploadUniformInt("shadowMap", unit);
+    shader.UploadUniformFloat4("cascadeSplits", glm::vec4(m_SplitFar[0], m_SplitFar[1], m_SplitFar[2], m_SplitFar[3]));
+    for (uint32_t i = 0; i < CascadeCount; i++)
+      shader.UploadUniformMat4("cascadeViewProjection[" + std::to_string(i) + "]", m_ViewProjection[i]);
+  }
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "GpuTimer.h"
+#include "RenderCamera.h"
+#include "Scene/Scene.h"
+
+namespace Hazel {
+
+  // Cascaded shadow maps for the key directional light. Near cascades are
+  // re-rendered every frame with all casters. Far cascades only hold static
+  // casters and are cached: they are rendered with some margin around the
+  // fitted cascade and reused until the view leaves that margin, the light
+  // turns or the static caster set changes.
+  class CascadedShadowMaps
+  {
+  public:
+    static constexpr uint32_t CascadeCount = 4;
+    static constexpr uint32_t FirstCachedCascade = 2;
+    static constexpr uint32_t Resolution = 2048;
+
+    struct Settings
+    {
+      float ShadowDistance = 60.0f;
+      // Blend between uniform (0) and logarithmic (1) split distances.
+      float SplitLambda = 0.75f;
+      // Extra coverage around cached cascades, as a fraction of their size.
+      float CacheMargin = 0.25f;
+    };
+
+    struct CascadeStats
+    {
+      float SplitFar = 0.0f;
+      uint32_t DrawCalls = 0;
+      uint32_t CulledCasters = 0;
+      float GpuMs = 0.0f;
+      // Reused from an earlier frame, nothing was drawn.
+      bool Cached = false;
+    };
+
+    CascadedShadowMaps();
+    ~CascadedShadowMaps();
+
+    CascadedShadowMaps(const CascadedShadowMaps&) = delete;
+    CascadedShadowMaps& operator=(const CascadedShadowMaps&) = delete;
+
+    // Fits the cascades to the camera and renders those that need it.
+    // Changes the viewport; the caller restores its own.
+    void Update(Scene& scene, const RenderCamera& camera, const glm::vec3& lightDirection);
+    // Binds the shadow array to unit and uploads the cascade uniforms.
+    void Bind(Shader& shader, uint32_t unit) const;
+    void Invalidate() { m_StaticCasterHash = 0; }
+
+    Settings& GetSettings() { return m_Settings; }
+    const std::array<CascadeStats, CascadeCount>& GetStats() const { return m_Stats; }
+  private:
+    struct Box
+    {
+      glm::vec3 Min;
+      glm::vec3 Max;
+    };
+
+    struct Caster
+    {
+      Box LightBounds;
+      glm::mat4 World;
+      uint32_t VertexArray;
+      uint32_t FirstVertex;
+      uint32_t VertexCount;
+      uint32_t IndexType;
+      bool Static;
+    };
+
+    void GatherCasters(Scene& scene);
+    Box FitCascade(const RenderCamera& camera, float splitNear, float splitFar) const;
+    void RenderCascade(uint32_t cascade, const Box& box, bool staticOnly);
+  private:
+    Settings m_Settings;
+    Ref<Shader> m_DepthShader;
+
+    GLuint m_Framebuffer = 0;
+    GLuint m_DepthArray = 0;
+
+    glm::mat4 m_LightView{ 1.0f };
+    glm::vec3 m_LightDirection{ 0.0f };
+    std::vector<Caster> m_Casters;
+    Box m_CasterBounds;
+    uint64_t m_StaticCasterHash = 0;
+
+    std::array<float, CascadeCount> m_SplitFar{};
+    std::array<glm::mat4, CascadeCount> m_ViewProjection;
+    // Light-space box each cached cascade was last rendered with.
+    std::array<Box, CascadeCount> m_CachedBoxes;
+    std::array<bool, CascadeCount> m_CacheValid{};
+
+    std::array<GpuTimer, CascadeCount> m_Timers;
+    std::array<CascadeStats, CascadeCount> m_Stats;
+  };
+
+}
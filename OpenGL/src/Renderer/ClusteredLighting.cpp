@@ -0,0 +1,264 @@
+#include "ClusteredLighting.h"
+
+#include <cfloat>
+
+#include "Core/ThreadPool.h"
+#include "Core/Timer.h"
+
+namespace Hazel {
+
+  // Each light is packed into four RGBA32F texels: position/radius, ambient, diffuse, specular.
+  static constexpr uint32_t TexelsPerLight = 4;
+
+  ClusteredLighting::~ClusteredLighting()
+  {
+    if (m_LightBuffer)
+    {
+      GLuint textures[] = { m_LightTexture, m_ClusterTexture, m_IndexTexture };
+      GLuint buffers[] = { m_LightBuffer, m_ClusterBuffer, m_IndexBuffer };
+      glDeleteTextures(3, textures);
+      glDeleteBuffers(3, buffers);
+    }
+  }
+
+  static float SliceDepth(uint32_t slice, float nearPlane, float farPlane)
+  {
+    return nearPlane * std::pow(farPlane / nearPlane, (float)slice / ClusteredLighting::ClusterCountZ);
+  }
+
+  void ClusteredLighting::BuildClusterBounds()
+  {
+    m_ClusterBounds.resize(ClusterCount);
+
+    float tanY = std::tan(m_FovY * 0.5f);
+    float tanX = tanY * m_Aspect;
+    for (uint32_t z = 0; z < ClusterCountZ; z++)
+    {
+      float depths[2] = { SliceDepth(z, m_Near, m_Far), SliceDepth(z + 1, m_Near, m_Far) };
+      for (uint32_t y = 0; y < ClusterCountY; y++)
+      {
+        float ndcY[2] = { -1.0f + 2.0f * y / ClusterCountY, -1.0f + 2.0f * (y + 1) / ClusterCountY };
+        for (uint32_t x = 0; x < ClusterCountX; x++)
+        {
+          float ndcX[2] = { -1.0f + 2.0f * x / ClusterCountX, -1.0f + 2.0f * (x + 1) / ClusterCountX };
+
+          AABB& bounds = m_ClusterBounds[(z * ClusterCountY + y) * ClusterCountX + x];
+          bounds.Min = glm::vec3(FLT_MAX);
+          bounds.Max = glm::vec3(-FLT_MAX);
+          for (float depth : depths)
+          {
+            for (float nx : ndcX)
+            {
+              for (float ny : ndcY)
+              {
+                // View space looks down -Z.
+                glm::vec3 corner(nx * tanX * depth, ny * tanY * depth, -depth);
+                bounds.Min = glm::min(bounds.Min, corner);
+                bounds.Max = glm::max(bounds.Max, corner);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  void ClusteredLighting::Build(const std::vector<PointLight>& lights, const glm::mat4& view, float fovY, float aspect, float nearPlane, float farPlane)
+  {
+    Timer timer;
+
+    if (fovY != m_FovY || aspect != m_Aspect || nearPlane != m_Near || farPlane != m_Far)
+    {
+      m_FovY = fovY;
+      m_Aspect = aspect;
+      m_Near = nearPlane;
+      m_Far = farPlane;
+      BuildClusterBounds();
+    }
+
+    uint32_t lightCount = std::min((uint32_t)lights.size(), MaxLights);
+    HZ_CORE_ASSERT(lights.size() <= MaxLights, "Too many lights!");
+
+    // Pack the lights and find the conservative cluster range of each one.
+    struct LightRange
+    {
+      glm::vec3 Center;
+      float Radius;
+      uint32_t Min[3];
+      uint32_t Max[3];
+      bool Visible;
+    };
+    std::vector<LightRange> ranges(lightCount);
+    m_LightData.resize(lightCount * TexelsPerLight);
+
+    float tanY = std::tan(fovY * 0.5f);
+    float tanX = tanY * aspect;
+    float sliceScale = ClusterCountZ / std::log(farPlane / nearPlane);
+
+    ThreadPool::Get().ParallelFor(lightCount, 256, [&](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t i = begin; i < end; i++)
+      {
+        const PointLight& light = lights[i];
+        glm::vec4* texels = &m_LightData[i * TexelsPerLight];
+        texels[0] = glm::vec4(light.Position, light.Radius);
+        texels[1] = glm::vec4(light.Ambient, 0.0f);
+        texels[2] = glm::vec4(light.Diffuse, 0.0f);
+        texels[3] = glm::vec4(light.Specular, 0.0f);
+
+        LightRange& range = ranges[i];
+        range.Center = glm::vec3(view * glm::vec4(light.Position, 1.0f));
+        range.Radius = light.Radius;
+
+        float depthMin = std::max(-range.Center.z - light.Radius, nearPlane);
+        float depthMax = std::min(-range.Center.z + light.Radius, farPlane);
+        range.Visible = depthMin < depthMax;
+        if (!range.Visible)
+          continue;
+
+        // x / depth is monotonic in depth, so the extremes are at the depth bounds.
+        float extents[2][2];
+        for (int axis = 0; axis < 2; axis++)
+        {
+          float tanAxis = axis == 0 ? tanX : tanY;
+          float lo = range.Center[axis] - light.Radius;
+          float hi = range.Center[axis] + light.Radius;
+          extents[axis][0] = std::min(lo / (depthMin * tanAxis), lo / (depthMax * tanAxis));
+          extents[axis][1] = std::max(hi / (depthMin * tanAxis), hi / (depthMax * tanAxis));
+        }
+
+        uint32_t counts[2] = { ClusterCountX, ClusterCountY };
+        for (int axis = 0; axis < 2; axis++)
+        {
+          float lo = (extents[axis][0] * 0.5f + 0.5f) * counts[axis];
+          float hi = (extents[axis][1] * 0.5f + 0.5f) * counts[axis];
+          range.Visible &= hi >= 0.0f && lo < (float)counts[axis];
+          range.Min[axis] = (uint32_t)glm::clamp(lo, 0.0f, (float)counts[axis] - 1);
+          range.Max[axis] = (uint32_t)glm::clamp(hi, 0.0f, (float)counts[axis] - 1);
+        }
+
+        range.Min[2] = (uint32_t)glm::clamp(std::log(depthMin / nearPlane) * sliceScale, 0.0f, (float)ClusterCountZ - 1);
+        range.Max[2] = (uint32_t)glm::clamp(std::log(depthMax / nearPlane) * sliceScale, 0.0f, (float)ClusterCountZ - 1);
+      }
+    });
+
+    // Assign lights slice by slice; every slice owns its clusters, so no locking.
+    m_Scratch.resize(ClusterCount * MaxLightsPerCluster);
+    m_ScratchCounts.assign(ClusterCount, 0);
+
+    ThreadPool::Get().ParallelFor(ClusterCountZ, 1, [&](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t z = begin; z < end; z++)
+      {
+        for (uint32_t i = 0; i < lightCount; i++)
+        {
+          const LightRange& range = ranges[i];
+          if (!range.Visible || z < range.Min[2] || z > range.Max[2])
+            continue;
+
+          for (uint32_t y = range.Min[1]; y <= range.Max[1]; y++)
+          {
+            for (uint32_t x = range.Min[0]; x <= range.Max[0]; x++)
+            {
+              uint32_t cluster = (z * ClusterCountY + y) * ClusterCountX + x;
+              const AABB& bounds = m_ClusterBounds[cluster];
+
+              glm::vec3 closest = glm::clamp(range.Center, bounds.Min, bounds.Max);
+              glm::vec3 delta = closest - range.Center;
+              if (glm::dot(delta, delta) > range.Radius * range.Radius)
+                continue;
+
+              uint16_t& count = m_ScratchCounts[cluster];
+              if (count < MaxLightsPerCluster)
+                m_Scratch[cluster * MaxLightsPerCluster + count++] = (uint16_t)i;
+            }
+          }
+        }
+      }
+    });
+
+    // Compact the scratch lists into one index list.
+    m_Clusters.resize(ClusterCount);
+    uint32_t offset = 0;
+    uint32_t maxClusterLights = 0;
+    for (uint32_t cluster = 0; cluster < ClusterCount; cluster++)
+    {
+      uint32_t count = m_ScratchCounts[cluster];
+      m_Clusters[cluster] = glm::uvec2(offset, count);
+      offset += count;
+      maxClusterLights = std::max(maxClusterLights, count);
+    }
+
+    m_LightIndices.resize(offset);
+    ThreadPool::Get().ParallelFor(ClusterCount, 64, [&](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t cluster = begin; cluster < end; cluster++)
+      {
+        const glm::uvec2& entry = m_Clusters[cluster];
+        std::copy_n(&m_Scratch[cluster * MaxLightsPerCluster], entry.y, m_LightIndices.begin() + entry.x);
+      }
+    });
+
+    m_Stats.LightCount = lightCount;
+    m_Stats.VisibleLightCount = (uint32_t)std::count_if(ranges.begin(), ranges.end(), [](const LightRange& range) { return range.Visible; });
+    m_Stats.LightIndexCount = offset;
+    m_Stats.MaxClusterLights = maxClusterLights;
+    m_Stats.BuildMs = timer.ElapsedMillis();
+  }
+
+  void ClusteredLighting::CreateBuffers()
+  {
+    glGenBuffers(1, &m_LightBuffer);
+    glGenBuffers(1, &m_ClusterBuffer);
+    glGenBuffers(1, &m_IndexBuffer);
+    glGenTextures(1, &m_LightTexture);
+    glGenTextures(1, &m_ClusterTexture);
+    glGenTextures(1, &m_IndexTexture);
+  }
+
+  static void UploadBufferTexture(GLuint buffer, GLuint texture, GLenum format, const void* data, size_t size)
+  {
+    // Orphan the previous storage so we never wait on the GPU still reading it.
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, std::max(size, (size_t)16), nullptr, GL_STREAM_DRAW);
+    if (size)
+      glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+  }
+
+  void ClusteredLighting::Upload()
+  {
+    if (!m_LightBuffer)
+      CreateBuffers();
+
+    UploadBufferTexture(m_LightBuffer, m_LightTexture, GL_RGBA32F, m_LightData.data(), m_LightData.size() * sizeof(glm::vec4));
+    UploadBufferTexture(m_ClusterBuffer, m_ClusterTexture, GL_RG32UI, m_Clusters.data(), m_Clusters.size() * sizeof(glm::uvec2));
+    UploadBufferTexture(m_IndexBuffer, m_IndexTexture, GL_R16UI, m_LightIndices.data(), m_LightIndices.size() * sizeof(uint16_t));
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  }
+
+  void ClusteredLighting::Bind(Shader& shader, uint32_t firstUnit, const glm::vec2& viewportSize) const
+  {
+    GLuint textures[] = { m_LightTexture, m_ClusterTexture, m_IndexTexture };
+    for (uint32_t i = 0; i < 3; i++)
+    {
+      glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+      glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+    }
+
+    shader.UploadUniformInt("clusterLights", firstUnit);
+    shader.UploadUniformInt("clusterGrid", firstUnit + 1);
+    shader.UploadUniformInt("clusterLightIndices", firstUnit + 2);
+
+    float logRatio = std::log(m_Far / m_Near);
+    shader.UploadUniformFloat2("screenSize", viewportSize);
+    shader.UploadUniformFloat3("clusterCount", glm::vec3(ClusterCountX, ClusterCountY, ClusterCountZ));
+    // slice = log(depth) * scale - bias
+    shader.UploadUniformFloat2("clusterSliceScaleBias", glm::vec2(ClusterCountZ / logRatio, ClusterCountZ * std::log(m_Near) / logRatio));
+  }
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+
+namespace Hazel {
+
+  struct PointLight
+  {
+    glm::vec3 Position;
+    float Radius;
+    glm::vec3 Ambient;
+    glm::vec3 Diffuse;
+    glm::vec3 Specular;
+  };
+
+  // Clustered forward shading: the view frustum is split into a 3D grid of
+  // froxels (exponential in depth), every light sphere is assigned to the
+  // froxels it touches, and each fragment only loops over its froxel's lights.
+  class ClusteredLighting
+  {
+  public:
+    static constexpr uint32_t ClusterCountX = 16;
+    static constexpr uint32_t ClusterCountY = 9;
+    static constexpr uint32_t ClusterCountZ = 24;
+    static constexpr uint32_t ClusterCount = ClusterCountX * ClusterCountY * ClusterCountZ;
+    static constexpr uint32_t MaxLightsPerCluster = 256;
+    static constexpr uint32_t MaxLights = 65535;
+
+    struct Stats
+    {
+      uint32_t LightCount = 0;
+      uint32_t VisibleLightCount = 0;
+      uint32_t LightIndexCount = 0;
+      uint32_t MaxClusterLights = 0;
+      float BuildMs = 0.0f;
+    };
+
+    ClusteredLighting() = default;
+    ~ClusteredLighting();
+
+    ClusteredLighting(const ClusteredLighting&) = delete;
+    ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+    // CPU side only; usable without a GL context.
+    void Build(const std::vector<PointLight>& lights, const glm::mat4& view, float fovY, float aspect, float nearPlane, float farPlane);
+
+    // Uploads the last Build() through buffer textures.
+    void Upload();
+    // Binds the buffer textures to units [firstUnit, firstUnit + 3) and sets the cluster uniforms.
+    void Bind(Shader& shader, uint32_t firstUnit, const glm::vec2& viewportSize) const;
+
+    // (offset, count) into GetLightIndices() for every cluster, x fastest.
+    const std::vector<glm::uvec2>& GetClusters() const { return m_Clusters; }
+    const std::vector<uint16_t>& GetLightIndices() const { return m_LightIndices; }
+    const Stats& GetStats() const { return m_Stats; }
+  private:
+    struct AABB
+    {
+      glm::vec3 Min;
+      glm::vec3 Max;
+    };
+
+    void BuildClusterBounds();
+    void CreateBuffers();
+  private:
+    // Cluster bounds in view space, rebuilt only when the projection changes.
+    std::vector<AABB> m_ClusterBounds;
+    float m_FovY = 0.0f, m_Aspect = 0.0f, m_Near = 0.0f, m_Far = 0.0f;
+
+    // Per-cluster scratch lists, MaxLightsPerCluster entries each.
+    std::vector<uint16_t> m_Scratch;
+    std::vector<uint16_t> m_ScratchCounts;
+
+    std::vector<glm::vec4> m_LightData;
+    std::vector<glm::uvec2> m_Clusters;
+    std::vector<uint16_t> m_LightIndices;
+    Stats m_Stats;
+
+    GLuint m_LightBuffer = 0, m_ClusterBuffer = 0, m_IndexBuffer = 0;
+    GLuint m_LightTexture = 0, m_ClusterTexture = 0, m_IndexTexture = 0;
+  };
+
+}
@@ -0,0 +1,94 @@
+#include "GBuffer.h"
+
+namespace Hazel {
+
+  GBuffer::GBuffer(uint32_t width, uint32_t height)
+    : m_Width(width), m_Height(height)
+  {
+    Invalidate();
+  }
+
+  GBuffer::~GBuffer()
+  {
+    Release();
+  }
+
+  void GBuffer::Resize(uint32_t width, uint32_t height)
+  {
+    if (width == m_Width && height == m_Height)
+      return;
+
+    m_Width = width;
+    m_Height = height;
+    Invalidate();
+  }
+
+  static GLuint CreateTarget(GLenum internalFormat, GLenum format, GLenum type, uint32_t width, uint32_t height)
+  {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+  }
+
+  void GBuffer::Invalidate()
+  {
+    Release();
+
+    m_AlbedoSpecular = CreateTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, m_Width, m_Height);
+    m_NormalShininess = CreateTarget(GL_RGB10_A2, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, m_Width, m_Height);
+    // Same format as the default framebuffer's depth, so it can be blitted back.
+    m_Depth = CreateTarget(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, m_Width, m_Height);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &m_Framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_AlbedoSpecular, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_NormalShininess, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_Depth, 0);
+
+    GLenum buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, buffers);
+
+    HZ_CORE_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "G-buffer is incomplete!");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+
+  void GBuffer::Release()
+  {
+    if (!m_Framebuffer)
+      return;
+
+    GLuint textures[] = { m_AlbedoSpecular, m_NormalShininess, m_Depth };
+    glDeleteTextures(3, textures);
+    glDeleteFramebuffers(1, &m_Framebuffer);
+    m_Framebuffer = 0;
+  }
+
+  void GBuffer::Bind() const
+  {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+    glViewport(0, 0, m_Width, m_Height);
+  }
+
+  void GBuffer::UnBind() const
+  {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+
+  void GBuffer::BindTextures(uint32_t firstUnit) const
+  {
+    GLuint textures[] = { m_AlbedoSpecular, m_NormalShininess, m_Depth };
+    for (uint32_t i = 0; i < 3; i++)
+    {
+      glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+      glBindTexture(GL_TEXTURE_2D, textures[i]);
+    }
+  }
+
+}
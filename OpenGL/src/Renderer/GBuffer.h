@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glad/glad.h>
+
+namespace Hazel {
+
+  // Compact G-buffer, 8 bytes of color per pixel plus depth:
+  //   RT0 RGBA8    albedo.rgb, specular intensity
+  //   RT1 RGB10_A2 octahedral normal.xy, log2(shininess) / 8
+  // Positions are reconstructed from the depth buffer.
+  class GBuffer
+  {
+  public:
+    GBuffer(uint32_t width, uint32_t height);
+    ~GBuffer();
+
+    GBuffer(const GBuffer&) = delete;
+    GBuffer& operator=(const GBuffer&) = delete;
+
+    void Resize(uint32_t width, uint32_t height);
+
+    void Bind() const;
+    void UnBind() const;
+    // Binds albedo/specular, normal/shininess and depth to [firstUnit, firstUnit + 3).
+    void BindTextures(uint32_t firstUnit) const;
+
+    GLuint GetFramebuffer() const { return m_Framebuffer; }
+    uint32_t GetWidth() const { return m_Width; }
+    uint32_t GetHeight() const { return m_Height; }
+  private:
+    void Invalidate();
+    void Release();
+  private:
+    uint32_t m_Width, m_Height;
+    GLuint m_Framebuffer = 0;
+    GLuint m_AlbedoSpecular = 0, m_NormalShininess = 0, m_Depth = 0;
+  };
+
+}
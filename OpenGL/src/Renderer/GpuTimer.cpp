@@ -0,0 +1,46 @@
+#include "GpuTimer.h"
+
+namespace Hazel {
+
+  GpuTimer::GpuTimer()
+  {
+    glGenQueries(QueryCount, m_Queries);
+  }
+
+  GpuTimer::~GpuTimer()
+  {
+    glDeleteQueries(QueryCount, m_Queries);
+  }
+
+  void GpuTimer::Begin()
+  {
+    // Collect every finished query before reusing the slot.
+    for (uint32_t i = 1; i <= QueryCount; i++)
+    {
+      uint32_t index = (m_Current + i) % QueryCount;
+      if (!m_Pending[index])
+        continue;
+
+      GLint available = 0;
+      glGetQueryObjectiv(m_Queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+      if (!available && index != m_Current)
+        continue;
+
+      // Only blocks when the whole ring is still in flight.
+      GLuint64 nanoseconds = 0;
+      glGetQueryObjectui64v(m_Queries[index], GL_QUERY_RESULT, &nanoseconds);
+      m_Milliseconds = nanoseconds / 1.0e6f;
+      m_Pending[index] = false;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, m_Queries[m_Current]);
+  }
+
+  void GpuTimer::End()
+  {
+    glEndQuery(GL_TIME_ELAPSED);
+    m_Pending[m_Current] = true;
+    m_Current = (m_Current + 1) % QueryCount;
+  }
+
+}
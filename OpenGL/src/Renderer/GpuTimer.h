@@ -0,0 +1,32 @@
+#pragma once
+
+#include <glad/glad.h>
+
+namespace Hazel {
+
+  // GL_TIME_ELAPSED query ring. Results arrive a few frames late, so reading
+  // them never stalls the pipeline. Timers cannot be nested.
+  class GpuTimer
+  {
+  public:
+    GpuTimer();
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void Begin();
+    void End();
+
+    // Most recent completed measurement.
+    float GetMilliseconds() const { return m_Milliseconds; }
+  private:
+    static constexpr uint32_t QueryCount = 4;
+
+    GLuint m_Queries[QueryCount];
+    bool m_Pending[QueryCount] = {};
+    uint32_t m_Current = 0;
+    float m_Milliseconds = 0.0f;
+  };
+
+}
@@ -0,0 +1,205 @@
+#include "Mesh.h"
+
+#include <filesystem>
+
+#include "Asset/MeshImporter.h"
+#include "Core/RenderThread.h"
+#include "Core/ThreadPool.h"
+#include "Core/VirtualFileSystem.h"
+#include "UploadScheduler.h"
+
+namespace Hazel {
+
+  // Opens path through the VirtualFileSystem as a mesh file's sections:
+  // cooked files in place, with compressed sections decoded into storage,
+  // and source formats imported and written out to storage in the same
+  // layout the cooker uses.
+  static bool OpenMesh(const std::string& path, VfsFile& file, std::vector<uint8_t>& storage, MeshView& view, std::string& error)
+  {
+    if (!VirtualFileSystem::Get().Open(path, file))
+    {
+      error = "could not open file";
+      return false;
+    }
+
+    if (IsMeshFile(file.GetData(), file.GetSize()))
+    {
+      MeshView fileView;
+      return ReadMeshFile(file.GetData(), file.GetSize(), fileView, error) && DecodeMeshView(fileView, storage, view, error);
+    }
+
+    // External glTF buffers only resolve for loose files.
+    std::string directory = std::filesystem::path(file.GetDiskPath()).parent_path().string();
+    MeshData data;
+    if (!ImportMesh(path, file.GetData(), file.GetSize(), directory, data, error))
+      return false;
+    storage = WriteMeshFile(data);
+    return ReadMeshFile(storage.data(), storage.size(), view, error);
+  }
+
+  Ref<Mesh> Mesh::Load(const std::string& path)
+  {
+    VfsFile file;
+    std::vector<uint8_t> storage;
+    MeshView view;
+    std::string error;
+    if (OpenMesh(path, file, storage, view, error))
+      return CreateRef<Mesh>(path, view);
+
+    HZ_HAZEL_ERROR("Failed to load mesh {0}: {1}", path, error);
+    return nullptr;
+  }
+
+  Task<Ref<Mesh>> Mesh::LoadAsync(std::string path, CancellationToken cancellation, UploadScheduler* uploads)
+  {
+    co_await ThreadPool::Get().Schedule();
+    if (cancellation.IsCancelled())
+      co_return nullptr;
+
+    // The mapping and any decoded sections stay in the frame until the upload.
+    VfsFile file;
+    std::vector<uint8_t> storage;
+    MeshView view;
+    std::string error;
+    if (!OpenMesh(path, file, storage, view, error))
+    {
+      HZ_HAZEL_ERROR("Failed to load mesh {0}: {1}", path, error);
+      co_return nullptr;
+    }
+
+    co_await RenderThread::Get().Schedule();
+    if (cancellation.IsCancelled())
+      co_return nullptr;
+    Ref<Mesh> mesh = CreateRef<Mesh>(path, view, uploads);
+    if (uploads)
+      co_await uploads->WaitFor(mesh->GetUploadTicket());
+    co_return mesh;
+  }
+
+  void Mesh::GetSections(const MeshView& view, std::vector<std::pair<const void*, size_t>>& sections)
+  {
+    sections.clear();
+    for (size_t i = 0; i < view.Streams.size(); i++)
+      sections.push_back({ view.Streams[i], view.StreamSizes[i] });
+    if (view.Indices)
+      sections.push_back({ view.Indices, (size_t)view.IndexCount * view.IndexSize });
+  }
+
+  Mesh::Mesh(const std::string& path, const MeshView& view, UploadScheduler* uploads)
+    : m_Path(path), m_VertexCount(view.VertexCount), m_IndexCount(view.IndexCount)
+  {
+    // Meshes without an index section are drawn as plain triangle lists.
+    m_IndexType = !view.Indices ? 0 : view.IndexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    m_Submeshes.assign(view.Submeshes, view.Submeshes + view.SubmeshCount);
+    m_Lods.assign(view.Lods, view.Lods + view.LodCount);
+    m_Bounds.Min = glm::vec3(view.BoundsMin[0], view.BoundsMin[1], view.BoundsMin[2]);
+    m_Bounds.Max = glm::vec3(view.BoundsMax[0], view.BoundsMax[1], view.BoundsMax[2]);
+
+    std::vector<std::pair<const void*, size_t>> sections;
+    GetSections(view, sections);
+
+    // Absent streams get no buffer; the attribute then reads as (0, 0, 0, 1).
+    std::array<GLuint, (size_t)VertexSemantic::Count> streamBuffers{};
+    GLuint indexBuffer = 0;
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+      if (!sections[i].first)
+        continue;
+
+      GLuint buffer;
+      glGenBuffers(1, &buffer);
+      glBindBuffer(GL_ARRAY_BUFFER, buffer);
+      if (uploads)
+      {
+        glBufferData(GL_ARRAY_BUFFER, sections[i].second, nullptr, GL_STATIC_DRAW);
+        m_UploadTicket = uploads->UploadBuffer(buffer, 0, sections[i].first, sections[i].second);
+      }
+      else
+      {
+        glBufferData(GL_ARRAY_BUFFER, sections[i].second, sections[i].first, GL_STATIC_DRAW);
+      }
+      m_Buffers.push_back({ buffer, sections[i].second });
+      if (i < streamBuffers.size())
+        streamBuffers[i] = buffer;
+      else
+        indexBuffer = buffer;
+    }
+
+    glGenVertexArrays(1, &m_VertexArray);
+    glGenVertexArrays(1, &m_DepthVertexArray);
+    for (GLuint vertexArray : { m_VertexArray, m_DepthVertexArray })
+    {
+      glBindVertexArray(vertexArray);
+      for (uint32_t i = 0; i < (uint32_t)VertexSemantic::Count; i++)
+      {
+        if (!streamBuffers[i] || (vertexArray == m_DepthVertexArray && i != (uint32_t)VertexSemantic::Position))
+          continue;
+
+        glBindBuffer(GL_ARRAY_BUFFER, streamBuffers[i]);
+        glVertexAttribPointer(i, GetComponentCount((VertexSemantic)i), GL_FLOAT, GL_FALSE, 0, nullptr);
+        glEnableVertexAttribArray(i);
+      }
+      if (indexBuffer)
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  Mesh::~Mesh()
+  {
+    glDeleteVertexArrays(1, &m_VertexArray);
+    glDeleteVertexArrays(1, &m_DepthVertexArray);
+    for (const Buffer& buffer : m_Buffers)
+      glDeleteBuffers(1, &buffer.ID);
+  }
+
+  size_t Mesh::GetMemorySize() const
+  {
+    size_t size = 0;
+    for (const Buffer& buffer : m_Buffers)
+      size += buffer.Size;
+    return size;
+  }
+
+  bool Mesh::Refill(GLuint buffer) const
+  {
+    auto it = std::find_if(m_Buffers.begin(), m_Buffers.end(), [buffer](const Buffer& entry) { return entry.ID == buffer; });
+    if (it == m_Buffers.end())
+      return false;
+
+    // Sections without data have no buffer, so skip them to line up with m_Buffers.
+    std::string error;
+    VfsFile file;
+    std::vector<uint8_t> storage;
+    MeshView view;
+    bool read = OpenMesh(m_Path, file, storage, view, error);
+
+    std::vector<std::pair<const void*, size_t>> sections;
+    if (read)
+    {
+      GetSections(view, sections);
+      sections.erase(std::remove_if(sections.begin(), sections.end(), [](const auto& section) { return !section.first; }), sections.end());
+    }
+
+    size_t index = it - m_Buffers.begin();
+    if (!read || sections.size() != m_Buffers.size() || sections[index].second != it->Size)
+    {
+      HZ_HAZEL_ERROR("Failed to reload mesh {0}: {1}", m_Path, read ? "the file changed" : error);
+      return false;
+    }
+
+    glBufferData(GL_ARRAY_BUFFER, it->Size, sections[index].first, GL_STATIC_DRAW);
+    return true;
+  }
+
+  void Mesh::SetGeometry(MeshRendererComponent& component) const
+  {
+    component.VertexArray = m_VertexArray;
+    component.DepthVertexArray = m_DepthVertexArray;
+    component.FirstVertex = 0;
+    component.VertexCount = m_IndexType ? m_IndexCount : m_VertexCount;
+    component.IndexType = m_IndexType;
+  }
+
+}
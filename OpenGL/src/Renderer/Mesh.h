@@ -0,0 +1,99 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "Asset/MeshFile.h"
+#include "Core/Task.h"
+#include "Scene/Components.h"
+
+namespace Hazel {
+
+  class UploadScheduler;
+
+  // GPU copy of a mesh: one buffer per vertex stream plus the index buffer, a
+  // vertex array over every stream (position, normal and texcoord at
+  // attributes 0, 1 and 2, as the lit shaders expect) and one over positions
+  // only for depth passes. Cooked .hzmesh files are memory-mapped, loose or
+  // in a pack, and their sections handed to glBufferData as they are, or
+  // decoded first when compressed; OBJ and glTF files are imported first.
+  class Mesh
+  {
+  public:
+    struct Buffer
+    {
+      GLuint ID;
+      size_t Size;
+    };
+
+    // Null, with the reason logged, if the file cannot be read. path is
+    // resolved through the VirtualFileSystem.
+    static Ref<Mesh> Load(const std::string& path);
+    // The same as a Task: the file is opened and decoded on a worker and the
+    // buffers are created on the RenderThread. Null if cancelled before then.
+    // With uploads, the buffers are filled over frames by its Update and the
+    // task finishes once they are.
+    static Task<Ref<Mesh>> LoadAsync(std::string path, CancellationToken cancellation = {}, UploadScheduler* uploads = nullptr);
+
+    // With uploads, the buffers are only created here and their data queued
+    // on it; view must then stay valid until GetUploadTicket() completes.
+    Mesh(const std::string& path, const MeshView& view, UploadScheduler* uploads = nullptr);
+    ~Mesh();
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    const std::string& GetPath() const { return m_Path; }
+    GLuint GetVertexArray() const { return m_VertexArray; }
+    GLuint GetDepthVertexArray() const { return m_DepthVertexArray; }
+    uint32_t GetVertexCount() const { return m_VertexCount; }
+    uint32_t GetIndexCount() const { return m_IndexCount; }
+    // 0 for meshes drawn without indices.
+    GLenum GetIndexType() const { return m_IndexType; }
+    const std::vector<MeshSubmesh>& GetSubmeshes() const { return m_Submeshes; }
+    const std::vector<MeshLod>& GetLods() const { return m_Lods; }
+    const BoundsComponent& GetBounds() const { return m_Bounds; }
+    // Zero when the buffers were filled in the constructor.
+    uint64_t GetUploadTicket() const { return m_UploadTicket; }
+
+    // The stream buffers and the index buffer, e.g. for ResidencyManager.
+    const std::vector<Buffer>& GetBuffers() const { return m_Buffers; }
+    size_t GetMemorySize() const;
+    // Uploads one of GetBuffers() again from the file, after its storage was
+    // released. The buffer must be bound to GL_ARRAY_BUFFER.
+    bool Refill(GLuint buffer) const;
+
+    // Geometry fields of a MeshRendererComponent drawing the whole mesh;
+    // materials and flags are left as they are.
+    void SetGeometry(MeshRendererComponent& component) const;
+  private:
+    // Buffer data per stream, then the indices if there are any, in m_Buffers order.
+    static void GetSections(const MeshView& view, std::vector<std::pair<const void*, size_t>>& sections);
+  private:
+    std::string m_Path;
+    GLuint m_VertexArray = 0;
+    GLuint m_DepthVertexArray = 0;
+    uint32_t m_VertexCount = 0;
+    uint32_t m_IndexCount = 0;
+    GLenum m_IndexType = GL_UNSIGNED_INT;
+    std::vector<Buffer> m_Buffers;
+    std::vector<MeshSubmesh> m_Submeshes;
+    std::vector<MeshLod> m_Lods;
+    BoundsComponent m_Bounds;
+    uint64_t m_UploadTicket = 0;
+  };
+
+  // Draws count vertices from first, or count indices from index first when
+  // indexType is set, from the bound vertex array.
+  inline void DrawTriangles(uint32_t first, uint32_t count, uint32_t indexType)
+  {
+    if (indexType == 0)
+    {
+      glDrawArrays(GL_TRIANGLES, first, count);
+      return;
+    }
+
+    size_t indexSize = indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+    glDrawElements(GL_TRIANGLES, count, indexType, (const void*)(first * indexSize));
+  }
+
+}
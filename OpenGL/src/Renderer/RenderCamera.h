@@ -0,0 +1,18 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace Hazel {
+
+  struct RenderCamera
+  {
+    glm::mat4 View;
+    glm::mat4 Projection;
+    glm::vec3 Position;
+    float FovY;
+    float Aspect;
+    float Near;
+    float Far;
+  };
+
+}
@@ -0,0 +1,239 @@
+#include "ResidencyManager.h"
+
+#include "Core/Timer.h"
+
+namespace Hazel {
+
+  ResidencyManager::ResidencyManager(TextureLoader& loader)
+    : m_Loader(loader)
+  {
+  }
+
+  void ResidencyManager::Track(const Ref<Texture2D>& texture, bool flipVertically, bool pinned, uint32_t maxSize)
+  {
+    Resource& resource = m_Resources[GetKey(ResourceType::Texture, texture->GetRendererID())];
+    resource.Type = ResourceType::Texture;
+    resource.ID = texture->GetRendererID();
+    resource.Texture = texture;
+    resource.FlipVertically = flipVertically;
+    resource.MaxSize = maxSize;
+    resource.Pinned = pinned;
+    resource.LastUsedFrame = m_Frame;
+  }
+
+  void ResidencyManager::TrackBuffer(GLuint buffer, size_t size, BufferReloadFn reload, const std::vector<GLuint>& vertexArrays, bool pinned)
+  {
+    Resource& resource = m_Resources[GetKey(ResourceType::Buffer, buffer)];
+    resource.Type = ResourceType::Buffer;
+    resource.ID = buffer;
+    resource.Reload = std::move(reload);
+    resource.Size = size;
+    resource.Pinned = pinned;
+    resource.LastUsedFrame = m_Frame;
+
+    for (GLuint vertexArray : vertexArrays)
+      m_VertexArrayBuffers[vertexArray].push_back(buffer);
+  }
+
+  void ResidencyManager::Untrack(GLuint buffer)
+  {
+    m_Resources.erase(GetKey(ResourceType::Buffer, buffer));
+    for (auto it = m_VertexArrayBuffers.begin(); it != m_VertexArrayBuffers.end();)
+    {
+      std::vector<GLuint>& buffers = it->second;
+      buffers.erase(std::remove(buffers.begin(), buffers.end(), buffer), buffers.end());
+      it = buffers.empty() ? m_VertexArrayBuffers.erase(it) : std::next(it);
+    }
+  }
+
+  void ResidencyManager::SetTexturePinned(GLuint texture, bool pinned)
+  {
+    auto it = m_Resources.find(GetKey(ResourceType::Texture, texture));
+    if (it != m_Resources.end())
+      it->second.Pinned = pinned;
+  }
+
+  void ResidencyManager::SetBufferPinned(GLuint buffer, bool pinned)
+  {
+    auto it = m_Resources.find(GetKey(ResourceType::Buffer, buffer));
+    if (it != m_Resources.end())
+      it->second.Pinned = pinned;
+  }
+
+  void ResidencyManager::Touch(Resource& resource)
+  {
+    resource.LastUsedFrame = m_Frame;
+    if (resource.Resident)
+      return;
+
+    if (resource.Type == ResourceType::Texture)
+    {
+      Ref<Texture2D> texture = resource.Texture.lock();
+      if (!texture)
+        return;
+
+      // Sampled as the placeholder until the loader catches up.
+      m_Loader.Load(texture, texture->GetPath(), resource.FlipVertically, resource.MaxSize);
+      resource.Reloading = true;
+    }
+    else
+    {
+      // The draw follows right away, so buffers are refilled in place.
+      glBindBuffer(GL_ARRAY_BUFFER, resource.ID);
+      resource.Reload(resource.ID);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    resource.Resident = true;
+    m_Churn.Reloads++;
+    m_Churn.ReloadedBytes += resource.EvictedSize;
+  }
+
+  void ResidencyManager::TouchTexture(GLuint texture)
+  {
+    auto it = m_Resources.find(GetKey(ResourceType::Texture, texture));
+    if (it != m_Resources.end())
+      Touch(it->second);
+  }
+
+  void ResidencyManager::TouchVertexArray(GLuint vertexArray)
+  {
+    auto buffers = m_VertexArrayBuffers.find(vertexArray);
+    if (buffers == m_VertexArrayBuffers.end())
+      return;
+
+    for (GLuint buffer : buffers->second)
+    {
+      auto it = m_Resources.find(GetKey(ResourceType::Buffer, buffer));
+      if (it != m_Resources.end())
+        Touch(it->second);
+    }
+  }
+
+  void ResidencyManager::TouchMesh(const MeshRendererComponent& mesh, bool textureArrays)
+  {
+    TouchVertexArray(mesh.VertexArray);
+    if (mesh.DepthVertexArray)
+      TouchVertexArray(mesh.DepthVertexArray);
+
+    if (!textureArrays || !mesh.DiffuseRegion.Array || !mesh.SpecularRegion.Array)
+    {
+      TouchTexture(mesh.DiffuseMap);
+      TouchTexture(mesh.SpecularMap);
+    }
+  }
+
+  size_t ResidencyManager::GetSize(const Resource& resource) const
+  {
+    if (resource.Type == ResourceType::Buffer)
+      return resource.Resident ? resource.Size : 0;
+
+    Ref<Texture2D> texture = resource.Texture.lock();
+    return texture ? texture->GetMemorySize() : 0;
+  }
+
+  void ResidencyManager::Evict(Resource& resource)
+  {
+    resource.EvictedSize = GetSize(resource);
+    if (resource.Type == ResourceType::Texture)
+    {
+      resource.Texture.lock()->Unload();
+    }
+    else
+    {
+      // Respecifying the store as empty releases it; the VAOs keep referring to the buffer.
+      glBindBuffer(GL_ARRAY_BUFFER, resource.ID);
+      glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    resource.Resident = false;
+    m_Churn.Evictions++;
+    m_Churn.EvictedBytes += resource.EvictedSize;
+  }
+
+  void ResidencyManager::Update()
+  {
+    Timer timer;
+
+    for (auto it = m_Resources.begin(); it != m_Resources.end();)
+    {
+      Resource& resource = it->second;
+      it = resource.Type == ResourceType::Texture && resource.Texture.expired() ? m_Resources.erase(it) : std::next(it);
+    }
+
+    Stats stats;
+    std::vector<std::pair<size_t, Resource*>> candidates;
+    for (auto& [key, resource] : m_Resources)
+    {
+      Ref<Texture2D> texture = resource.Texture.lock();
+      if (resource.Reloading && texture->IsLoaded())
+        resource.Reloading = false;
+
+      size_t size = GetSize(resource);
+      bool used = resource.LastUsedFrame == m_Frame;
+      if (resource.Type == ResourceType::Texture)
+        stats.Textures++;
+      else
+        stats.Buffers++;
+      if (resource.Resident)
+      {
+        stats.Resident++;
+        stats.ResidentBytes += size;
+      }
+      if (resource.Pinned)
+      {
+        stats.Pinned++;
+        stats.PinnedBytes += size;
+      }
+      if (used)
+      {
+        stats.Used++;
+        stats.UsedBytes += size;
+      }
+
+      // Textures are only dropped between loads, never under a pending upload.
+      bool evictable = resource.Resident && !resource.Pinned && !used && size > 0;
+      if (texture)
+        evictable = evictable && texture->IsLoaded() && !texture->IsLevelRequestPending() && !resource.Reloading;
+      if (evictable)
+        candidates.push_back({ size, &resource });
+    }
+
+    if (stats.ResidentBytes > m_Settings.BudgetBytes)
+    {
+      // Least recently used first; of those, the largest.
+      std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b)
+      {
+        if (a.second->LastUsedFrame != b.second->LastUsedFrame)
+          return a.second->LastUsedFrame < b.second->LastUsedFrame;
+        return a.first > b.first;
+      });
+
+      for (auto& [size, resource] : candidates)
+      {
+        if (stats.ResidentBytes <= m_Settings.BudgetBytes)
+          break;
+
+        Evict(*resource);
+        stats.Resident--;
+        stats.ResidentBytes -= size;
+      }
+      stats.OverBudget = stats.ResidentBytes > m_Settings.BudgetBytes;
+    }
+
+    stats.Evictions = m_Churn.Evictions;
+    stats.Reloads = m_Churn.Reloads;
+    stats.EvictedBytes = m_Churn.EvictedBytes;
+    stats.ReloadedBytes = m_Churn.ReloadedBytes;
+    stats.TotalEvictions = m_Stats.TotalEvictions + stats.Evictions;
+    stats.TotalReloads = m_Stats.TotalReloads + stats.Reloads;
+    stats.TotalEvictedBytes = m_Stats.TotalEvictedBytes + stats.EvictedBytes;
+    stats.TotalReloadedBytes = m_Stats.TotalReloadedBytes + stats.ReloadedBytes;
+    stats.UpdateMs = timer.ElapsedMillis();
+    m_Stats = stats;
+    m_Churn = {};
+    m_Frame++;
+  }
+
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "Texture.h"
+#include "TextureLoader.h"
+#include "Scene/Components.h"
+
+namespace Hazel {
+
+  // Keeps the GPU memory held by textures and buffers under a hard budget.
+  // Every tracked resource carries an estimated size and the frame it was
+  // last used in; once per frame the least recently used unpinned ones are
+  // evicted until the rest fits. Touching an evicted resource brings it back:
+  // textures through the TextureLoader (they show their placeholder until the
+  // upload), buffers through the refill callback given when tracking them.
+  // Resources used in the current frame are never evicted; if they alone do
+  // not fit, the frame is reported as over budget instead.
+  class ResidencyManager
+  {
+  public:
+    struct Settings
+    {
+      size_t BudgetBytes = 256ull << 20;
+    };
+
+    struct Stats
+    {
+      uint32_t Textures = 0;
+      uint32_t Buffers = 0;
+      uint32_t Resident = 0;
+      uint32_t Pinned = 0;
+      size_t ResidentBytes = 0;
+      size_t PinnedBytes = 0;
+      // Touched this frame: the working set.
+      uint32_t Used = 0;
+      size_t UsedBytes = 0;
+      // The working set and pinned resources together exceed the budget.
+      bool OverBudget = false;
+      // Churn since the previous Update.
+      uint32_t Evictions = 0;
+      uint32_t Reloads = 0;
+      size_t EvictedBytes = 0;
+      size_t ReloadedBytes = 0;
+      // Churn since startup.
+      uint64_t TotalEvictions = 0;
+      uint64_t TotalReloads = 0;
+      uint64_t TotalEvictedBytes = 0;
+      uint64_t TotalReloadedBytes = 0;
+      float UpdateMs = 0.0f;
+    };
+
+    // Refills an evicted buffer, which is bound to GL_ARRAY_BUFFER when called.
+    using BufferReloadFn = std::function<void(GLuint buffer)>;
+
+    explicit ResidencyManager(TextureLoader& loader);
+
+    // The texture is reloaded from its path, with maxSize as the loader's size
+    // limit. Released textures drop out by themselves.
+    void Track(const Ref<Texture2D>& texture, bool flipVertically = true, bool pinned = false, uint32_t maxSize = 0);
+    // vertexArrays are the VAOs drawing from the buffer; touching one of them
+    // touches it. Call Untrack before deleting the buffer.
+    void TrackBuffer(GLuint buffer, size_t size, BufferReloadFn reload, const std::vector<GLuint>& vertexArrays, bool pinned = false);
+    void Untrack(GLuint buffer);
+    void SetTexturePinned(GLuint texture, bool pinned);
+    void SetBufferPinned(GLuint buffer, bool pinned);
+
+    // GL thread, for every resource a draw is about to use. Untracked names are ignored.
+    void TouchTexture(GLuint texture);
+    void TouchVertexArray(GLuint vertexArray);
+    // Touches what drawing the mesh uses: its vertex arrays and, unless it is
+    // drawn from texture arrays, its maps.
+    void TouchMesh(const MeshRendererComponent& mesh, bool textureArrays);
+
+    // GL thread, once per frame after the draws: evicts down to the budget and
+    // starts the next frame.
+    void Update();
+
+    Settings& GetSettings() { return m_Settings; }
+    const Stats& GetStats() const { return m_Stats; }
+  private:
+    enum class ResourceType : uint8_t
+    {
+      Texture,
+      Buffer
+    };
+
+    struct Resource
+    {
+      ResourceType Type;
+      GLuint ID = 0;
+      std::weak_ptr<Texture2D> Texture;
+      bool FlipVertically = true;
+      uint32_t MaxSize = 0;
+      BufferReloadFn Reload;
+      // Buffers only; textures report their own size.
+      size_t Size = 0;
+      // Size when last evicted, counted as reloaded bytes.
+      size_t EvictedSize = 0;
+      uint64_t LastUsedFrame = 0;
+      bool Pinned = false;
+      bool Resident = true;
+      // A texture reload has been requested but not uploaded yet.
+      bool Reloading = false;
+    };
+
+    static uint64_t GetKey(ResourceType type, GLuint id) { return ((uint64_t)type << 32) | id; }
+
+    void Touch(Resource& resource);
+    size_t GetSize(const Resource& resource) const;
+    void Evict(Resource& resource);
+  private:
+    TextureLoader& m_Loader;
+    Settings m_Settings;
+    std::unordered_map<uint64_t, Resource> m_Resources;
+    std::unordered_map<GLuint, std::vector<GLuint>> m_VertexArrayBuffers;
+    uint64_t m_Frame = 1;
+    // Churn since the last Update; only its churn fields are used.
+    Stats m_Churn;
+    Stats m_Stats;
+  };
+
+}
@@ -0,0 +1,366 @@
+#include "SceneRenderer.h"
+
+#include "Mesh.h"
+
+namespace Hazel {
+
+  // Texture units 0 and 1 hold the material maps (or G-buffer targets 0-2 in
+  // the deferred lighting pass); the cluster buffers and shadow map follow.
+  static constexpr uint32_t ClusterTextureUnit = 3;
+  static constexpr uint32_t ShadowTextureUnit = 6;
+
+  SceneRenderer::SceneRenderer(uint32_t width, uint32_t height)
+    : m_Width(width), m_Height(height)
+  {
+    m_LightingShader = CreateRef<Shader>("shaders/lighting.glsl");
+    m_LightingArrayShader = CreateRef<Shader>("shaders/lighting.glsl", std::vector<std::string>{ "TEXTURE_ARRAYS" });
+    m_LampShader = CreateRef<Shader>("shaders/lamp.glsl");
+    m_DepthPrepassShader = CreateRef<Shader>("shaders/depth_prepass.glsl");
+    m_GBufferShader = CreateRef<Shader>("shaders/gbuffer.glsl");
+    m_GBufferArrayShader = CreateRef<Shader>("shaders/gbuffer.glsl", std::vector<std::string>{ "TEXTURE_ARRAYS" });
+    m_DeferredLightingShader = CreateRef<Shader>("shaders/deferred_lighting.glsl");
+
+    for (auto& shader : { m_LightingShader, m_LightingArrayShader, m_GBufferShader, m_GBufferArrayShader })
+    {
+      shader->Bind();
+      shader->UploadUniformInt("material.diffuse", 0);
+      shader->UploadUniformInt("material.specular", 1);
+    }
+
+    m_DeferredLightingShader->Bind();
+    m_DeferredLightingShader->UploadUniformInt("gAlbedoSpecular", 0);
+    m_DeferredLightingShader->UploadUniformInt("gNormalShininess", 1);
+    m_DeferredLightingShader->UploadUniformInt("gDepth", 2);
+
+    // Keep the shadow sampler off the material units even when no light casts shadows.
+    for (auto& shader : { m_LightingShader, m_LightingArrayShader, m_DeferredLightingShader })
+    {
+      shader->Bind();
+      shader->UploadUniformInt("shadowMap", ShadowTextureUnit);
+    }
+
+    // Core profile needs a bound VAO even for attribute-less draws.
+    glGenVertexArrays(1, &m_FullscreenVertexArray);
+  }
+
+  SceneRenderer::~SceneRenderer()
+  {
+    glDeleteVertexArrays(1, &m_FullscreenVertexArray);
+  }
+
+  void SceneRenderer::SetViewportSize(uint32_t width, uint32_t height)
+  {
+    m_Width = width;
+    m_Height = height;
+    if (m_GBuffer)
+      m_GBuffer->Resize(width, height);
+  }
+
+  void SceneRenderer::GatherLights(Scene& scene)
+  {
+    TransformSystem& transforms = scene.GetTransforms();
+
+    m_Lights.clear();
+    scene.GetRegistry().GetQuery<TransformComponent, LightComponent>().ForEach([&](TransformComponent& transform, LightComponent& light)
+    {
+      glm::vec3 position(transforms.GetWorldMatrix(transform.Transform)[3]);
+      m_Lights.push_back({ position, light.Radius, light.Ambient, light.Diffuse, light.Specular });
+    });
+
+    m_HasDirectionalLight = false;
+    scene.GetRegistry().GetQuery<DirectionalLightComponent>().ForEach([&](DirectionalLightComponent& light)
+    {
+      if (m_HasDirectionalLight)
+        return;
+
+      m_HasDirectionalLight = true;
+      m_DirectionalLight = light;
+    });
+  }
+
+  void SceneRenderer::BindDirectionalLight(Shader& shader)
+  {
+    if (!m_HasDirectionalLight)
+    {
+      // The shaders normalize the direction before the colours zero the
+      // term, and a NaN stays one when multiplied by zero.
+      shader.UploadUniformFloat3("dirLight.direction", glm::vec3(0.0f, -1.0f, 0.0f));
+      shader.UploadUniformFloat3("dirLight.ambient", glm::vec3(0.0f));
+      shader.UploadUniformFloat3("dirLight.diffuse", glm::vec3(0.0f));
+      shader.UploadUniformFloat3("dirLight.specular", glm::vec3(0.0f));
+      shader.UploadUniformFloat4("cascadeSplits", glm::vec4(0.0f));
+      return;
+    }
+
+    shader.UploadUniformFloat3("dirLight.direction", glm::normalize(m_DirectionalLight.Direction));
+    shader.UploadUniformFloat3("dirLight.ambient", m_DirectionalLight.Ambient);
+    shader.UploadUniformFloat3("dirLight.diffuse", m_DirectionalLight.Diffuse);
+    shader.UploadUniformFloat3("dirLight.specular", m_DirectionalLight.Specular);
+
+    if (m_Stats.Shadows)
+      m_Shadows.Bind(shader, ShadowTextureUnit);
+    else
+      shader.UploadUniformFloat4("cascadeSplits", glm::vec4(0.0f));
+  }
+
+  void SceneRenderer::Render(Scene& scene, const RenderCamera& camera)
+  {
+    m_Stats.DrawCalls = 0;
+    m_Stats.TextureBinds = 0;
+    m_Stats.TextureArrays = m_TextureArrays;
+    m_Stats.Path = m_RenderPath;
+    m_Stats.DepthPrepass = m_DepthPrepass && m_RenderPath == RenderPath::Forward;
+
+    if (m_Residency)
+    {
+      // Every pass draws from the same meshes; reloads are issued before any of them.
+      scene.GetRegistry().GetQuery<MeshRendererComponent>().ForEach([&](MeshRendererComponent& mesh)
+      {
+        m_Residency->TouchMesh(mesh, m_TextureArrays);
+      });
+    }
+
+    GatherLights(scene);
+    m_ClusteredLighting.Build(m_Lights, camera.View, camera.FovY, camera.Aspect, camera.Near, camera.Far);
+    m_ClusteredLighting.Upload();
+
+    m_Stats.Shadows = m_HasDirectionalLight && m_DirectionalLight.CastShadows;
+    if (m_Stats.Shadows)
+    {
+      m_Shadows.Update(scene, camera, m_DirectionalLight.Direction);
+      m_Stats.Cascades = m_Shadows.GetStats();
+      glViewport(0, 0, m_Width, m_Height);
+    }
+
+    if (m_RenderPath == RenderPath::Deferred)
+      RenderDeferred(scene, camera);
+    else
+      RenderForward(scene, camera);
+
+    m_Stats.Lighting = m_ClusteredLighting.GetStats();
+  }
+
+  void SceneRenderer::RenderForward(Scene& scene, const RenderCamera& camera)
+  {
+    if (m_Stats.DepthPrepass)
+    {
+      m_DepthPrepassTimer.Begin();
+      glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+      DrawDepth(scene, camera);
+      glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+      m_DepthPrepassTimer.End();
+
+      // Only the front-most fragment of every pixel survives the equal test
+      glDepthFunc(GL_EQUAL);
+      glDepthMask(GL_FALSE);
+    }
+
+    for (auto& shader : { m_LightingShader, m_LightingArrayShader })
+    {
+      shader->Bind();
+      shader->UploadUniformFloat3("viewPos", camera.Position);
+      shader->UploadUniformMat4("view", camera.View);
+      shader->UploadUniformMat4("projection", camera.Projection);
+      m_ClusteredLighting.Bind(*shader, ClusterTextureUnit, glm::vec2((float)m_Width, (float)m_Height));
+      BindDirectionalLight(*shader);
+    }
+
+    m_LightingPassTimer.Begin();
+    DrawLit(scene, *m_LightingShader, *m_LightingArrayShader);
+    m_LightingPassTimer.End();
+
+    if (m_Stats.DepthPrepass)
+    {
+      glDepthFunc(GL_LESS);
+      glDepthMask(GL_TRUE);
+    }
+
+    DrawEmissive(scene, camera);
+
+    m_Stats.DepthPrepassGpuMs = m_Stats.DepthPrepass ? m_DepthPrepassTimer.GetMilliseconds() : 0.0f;
+    m_Stats.GeometryPassGpuMs = 0.0f;
+    m_Stats.LightingPassGpuMs = m_LightingPassTimer.GetMilliseconds();
+  }
+
+  void SceneRenderer::RenderDeferred(Scene& scene, const RenderCamera& camera)
+  {
+    if (!m_GBuffer)
+      m_GBuffer = CreateScope<GBuffer>(m_Width, m_Height);
+
+    // Geometry pass
+    m_GeometryPassTimer.Begin();
+    m_GBuffer->Bind();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    for (auto& shader : { m_GBufferShader, m_GBufferArrayShader })
+    {
+      shader->Bind();
+      shader->UploadUniformMat4("view", camera.View);
+      shader->UploadUniformMat4("projection", camera.Projection);
+    }
+    DrawLit(scene, *m_GBufferShader, *m_GBufferArrayShader);
+    m_GBuffer->UnBind();
+    m_GeometryPassTimer.End();
+
+    // Lighting pass: every covered pixel is shaded exactly once
+    m_LightingPassTimer.Begin();
+    glDisable(GL_DEPTH_TEST);
+    m_GBuffer->BindTextures(0);
+    m_DeferredLightingShader->Bind();
+    m_DeferredLightingShader->UploadUniformFloat3("viewPos", camera.Position);
+    m_DeferredLightingShader->UploadUniformMat4("view", camera.View);
+    m_DeferredLightingShader->UploadUniformMat4("inverseViewProjection", glm::inverse(camera.Projection * camera.View));
+    m_ClusteredLighting.Bind(*m_DeferredLightingShader, ClusterTextureUnit, glm::vec2((float)m_Width, (float)m_Height));
+    BindDirectionalLight(*m_DeferredLightingShader);
+
+    glBindVertexArray(m_FullscreenVertexArray);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    m_Stats.DrawCalls++;
+    glEnable(GL_DEPTH_TEST);
+    m_LightingPassTimer.End();
+
+    // Emissive meshes are drawn forward on top, depth-tested against the G-buffer
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_GBuffer->GetFramebuffer());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, m_Width, m_Height, 0, 0, m_Width, m_Height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    DrawEmissive(scene, camera);
+
+    m_Stats.DepthPrepassGpuMs = 0.0f;
+    m_Stats.GeometryPassGpuMs = m_GeometryPassTimer.GetMilliseconds();
+    m_Stats.LightingPassGpuMs = m_LightingPassTimer.GetMilliseconds();
+  }
+
+  void SceneRenderer::DrawLit(Scene& scene, Shader& shader, Shader& arrayShader)
+  {
+    TransformSystem& transforms = scene.GetTransforms();
+    auto query = scene.GetRegistry().GetQuery<TransformComponent, MeshRendererComponent>();
+
+    // Binds only what changed since the previous draw.
+    GLenum target = GL_TEXTURE_2D;
+    uint32_t bound[2] = { 0, 0 };
+    auto bindMaps = [&](uint32_t diffuse, uint32_t specular)
+    {
+      uint32_t maps[2] = { diffuse, specular };
+      for (uint32_t unit = 0; unit < 2; unit++)
+      {
+        if (bound[unit] == maps[unit])
+          continue;
+
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, maps[unit]);
+        bound[unit] = maps[unit];
+        m_Stats.TextureBinds++;
+      }
+    };
+    auto usesArrays = [this](const MeshRendererComponent& mesh)
+    {
+      return m_TextureArrays && mesh.DiffuseRegion.Array && mesh.SpecularRegion.Array;
+    };
+
+    shader.Bind();
+    query.ForEach([&](TransformComponent& transform, MeshRendererComponent& mesh)
+    {
+      if (mesh.Emissive || usesArrays(mesh))
+        return;
+
+      shader.UploadUniformFloat("material.shininess", mesh.Shininess);
+      shader.UploadUniformMat4("model", transforms.GetWorldMatrix(transform.Transform));
+      shader.UploadUniformMat3("normalMatrix", transforms.GetNormalMatrix(transform.Transform));
+      bindMaps(mesh.DiffuseMap, mesh.SpecularMap);
+
+      glBindVertexArray(mesh.VertexArray);
+      DrawTriangles(mesh.FirstVertex, mesh.VertexCount, mesh.IndexType);
+      m_Stats.DrawCalls++;
+    });
+
+    if (m_TextureArrays)
+    {
+      // Units now hold arrays; clear the 2D bindings so nothing is skipped wrongly.
+      for (uint32_t unit = 0; unit < 2; unit++)
+      {
+        if (bound[unit])
+        {
+          glActiveTexture(GL_TEXTURE0 + unit);
+          glBindTexture(GL_TEXTURE_2D, 0);
+        }
+      }
+      target = GL_TEXTURE_2D_ARRAY;
+      bound[0] = bound[1] = 0;
+
+      // Only the region uniforms change between materials sharing an array.
+      arrayShader.Bind();
+      query.ForEach([&](TransformComponent& transform, MeshRendererComponent& mesh)
+      {
+        if (mesh.Emissive || !usesArrays(mesh))
+          return;
+
+        arrayShader.UploadUniformFloat("material.shininess", mesh.Shininess);
+        arrayShader.UploadUniformFloat4("material.diffuseRect", mesh.DiffuseRegion.Rect);
+        arrayShader.UploadUniformFloat4("material.specularRect", mesh.SpecularRegion.Rect);
+        arrayShader.UploadUniformFloat("material.diffuseLayer", (float)mesh.DiffuseRegion.Layer);
+        arrayShader.UploadUniformFloat("material.specularLayer", (float)mesh.SpecularRegion.Layer);
+        arrayShader.UploadUniformMat4("model", transforms.GetWorldMatrix(transform.Transform));
+        arrayShader.UploadUniformMat3("normalMatrix", transforms.GetNormalMatrix(transform.Transform));
+        bindMaps(mesh.DiffuseRegion.Array, mesh.SpecularRegion.Array);
+
+        glBindVertexArray(mesh.VertexArray);
+        DrawTriangles(mesh.FirstVertex, mesh.VertexCount, mesh.IndexType);
+        m_Stats.DrawCalls++;
+      });
+
+      for (uint32_t unit = 0; unit < 2; unit++)
+      {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+      }
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(0);
+  }
+
+  void SceneRenderer::DrawDepth(Scene& scene, const RenderCamera& camera)
+  {
+    TransformSystem& transforms = scene.GetTransforms();
+
+    m_DepthPrepassShader->Bind();
+    m_DepthPrepassShader->UploadUniformMat4("view", camera.View);
+    m_DepthPrepassShader->UploadUniformMat4("projection", camera.Projection);
+
+    scene.GetRegistry().GetQuery<TransformComponent, MeshRendererComponent>().ForEach([&](TransformComponent& transform, MeshRendererComponent& mesh)
+    {
+      if (mesh.Emissive)
+        return;
+
+      m_DepthPrepassShader->UploadUniformMat4("model", transforms.GetWorldMatrix(transform.Transform));
+      glBindVertexArray(mesh.DepthVertexArray ? mesh.DepthVertexArray : mesh.VertexArray);
+      DrawTriangles(mesh.FirstVertex, mesh.VertexCount, mesh.IndexType);
+      m_Stats.DrawCalls++;
+    });
+    glBindVertexArray(0);
+  }
+
+  void SceneRenderer::DrawEmissive(Scene& scene, const RenderCamera& camera)
+  {
+    TransformSystem& transforms = scene.GetTransforms();
+
+    m_LampShader->Bind();
+    m_LampShader->UploadUniformMat4("view", camera.View);
+    m_LampShader->UploadUniformMat4("projection", camera.Projection);
+
+    scene.GetRegistry().GetQuery<TransformComponent, MeshRendererComponent>().ForEach([&](TransformComponent& transform, MeshRendererComponent& mesh)
+    {
+      if (!mesh.Emissive)
+        return;
+
+      m_LampShader->UploadUniformMat4("model", transforms.GetWorldMatrix(transform.Transform));
+      glBindVertexArray(mesh.VertexArray);
+      DrawTriangles(mesh.FirstVertex, mesh.VertexCount, mesh.IndexType);
+      m_Stats.DrawCalls++;
+    });
+    glBindVertexArray(0);
+  }
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "RenderCamera.h"
+#include "GpuTimer.h"
+#include "GBuffer.h"
+#include "ClusteredLighting.h"
+#include "CascadedShadowMaps.h"
+#include "ResidencyManager.h"
+#include "Scene/Scene.h"
+
+namespace Hazel {
+
+  enum class RenderPath
+  {
+    // Lit meshes shaded directly with clustered forward lighting.
+    Forward,
+    // G-buffer pass, then one full-screen pass over the clustered light lists.
+    Deferred
+  };
+
+  // Draws a Scene: gathers lights and renderables through ECS queries and
+  // shades lit meshes along the selected RenderPath.
+  class SceneRenderer
+  {
+  public:
+    struct Stats
+    {
+      RenderPath Path = RenderPath::Forward;
+      bool DepthPrepass = false;
+      uint32_t DrawCalls = 0;
+      // Material map binds in the lit pass; repeated binds are skipped.
+      uint32_t TextureBinds = 0;
+      bool TextureArrays = false;
+      // Forward only.
+      float DepthPrepassGpuMs = 0.0f;
+      // Deferred only.
+      float GeometryPassGpuMs = 0.0f;
+      float LightingPassGpuMs = 0.0f;
+      ClusteredLighting::Stats Lighting;
+      // Only meaningful while a shadow-casting directional light exists.
+      bool Shadows = false;
+      std::array<CascadedShadowMaps::CascadeStats, CascadedShadowMaps::CascadeCount> Cascades;
+    };
+
+    SceneRenderer(uint32_t width, uint32_t height);
+    ~SceneRenderer();
+
+    void SetViewportSize(uint32_t width, uint32_t height);
+    void Render(Scene& scene, const RenderCamera& camera);
+
+    void SetRenderPath(RenderPath path) { m_RenderPath = path; }
+    RenderPath GetRenderPath() const { return m_RenderPath; }
+
+    // Lays down depth for opaque meshes first so the forward pass shades every
+    // pixel once. Pays off with heavy fragment work and overdraw; the deferred
+    // path already shades once per pixel and ignores it.
+    void SetDepthPrepass(bool enabled) { m_DepthPrepass = enabled; }
+    bool GetDepthPrepass() const { return m_DepthPrepass; }
+
+    // Meshes whose maps were packed by TexturePacker sample them from texture
+    // arrays, so consecutive draws sharing an array bind nothing.
+    void SetTextureArrays(bool enabled) { m_TextureArrays = enabled; }
+    bool GetTextureArrays() const { return m_TextureArrays; }
+
+    // Every mesh is reported to the manager before it is drawn, so evicted
+    // maps and buffers come back. Not owned; null disables tracking.
+    void SetResidencyManager(ResidencyManager* residency) { m_Residency = residency; }
+
+    const Stats& GetStats() const { return m_Stats; }
+  private:
+    void GatherLights(Scene& scene);
+    // Uploads the key directional light and its shadow cascades.
+    void BindDirectionalLight(Shader& shader);
+
+    void RenderForward(Scene& scene, const RenderCamera& camera);
+    void RenderDeferred(Scene& scene, const RenderCamera& camera);
+
+    // Draws every non-emissive mesh: packed ones with arrayShader, the rest with
+    // shader. Both must already have their per-frame uniforms.
+    void DrawLit(Scene& scene, Shader& shader, Shader& arrayShader);
+    // Depth-only draw of every non-emissive mesh through its position-only stream.
+    void DrawDepth(Scene& scene, const RenderCamera& camera);
+    void DrawEmissive(Scene& scene, const RenderCamera& camera);
+  private:
+    uint32_t m_Width, m_Height;
+    RenderPath m_RenderPath = RenderPath::Forward;
+    bool m_DepthPrepass = false;
+    bool m_TextureArrays = false;
+    ResidencyManager* m_Residency = nullptr;
+
+    Ref<Shader> m_LightingShader;
+    Ref<Shader> m_LightingArrayShader;
+    Ref<Shader> m_LampShader;
+    Ref<Shader> m_DepthPrepassShader;
+    Ref<Shader> m_GBufferShader;
+    Ref<Shader> m_GBufferArrayShader;
+    Ref<Shader> m_DeferredLightingShader;
+
+    Scope<GBuffer> m_GBuffer;
+    GLuint m_FullscreenVertexArray = 0;
+
+    std::vector<PointLight> m_Lights;
+    ClusteredLighting m_ClusteredLighting;
+
+    // First DirectionalLightComponent found, if any.
+    bool m_HasDirectionalLight = false;
+    DirectionalLightComponent m_DirectionalLight;
+    CascadedShadowMaps m_Shadows;
+
+    GpuTimer m_DepthPrepassTimer;
+    GpuTimer m_GeometryPassTimer;
+    GpuTimer m_LightingPassTimer;
+
+    Stats m_Stats;
+  };
+
+}
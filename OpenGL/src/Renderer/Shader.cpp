@@ -1,8 +1,9 @@
 #include "Shader.h"
 
-#include <fstream>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "Core/VirtualFileSystem.h"
+
 static GLenum ShaderTypeFromString(const std::string& type)
 {
   if (type == "vertex")
@@ -14,10 +15,11 @@ static GLenum ShaderTypeFromString(const std::string& type)
   return 0;
 }
 
-Shader::Shader(const std::string& filepath)
+Shader::Shader(const std::string& filepath, const std::vector<std::string>& defines)
 {
   std::string source = ReadFile(filepath);
   auto shaderSources = PreProcess(source);
+  InsertDefines(shaderSources, defines);
   Compile(shaderSources);
 }
 
@@ -28,22 +30,11 @@ Shader::~Shader()
 
 std::string Shader::ReadFile(const std::string& filepath)
 {
-  std::string result;
-  std::ifstream in(filepath, std::ios::in | std::ios::binary);
-  if (in)
-  {
-    in.seekg(0, std::ios::end);
-    result.resize(in.tellg());
-    in.seekg(0, std::ios::beg);
-    in.read(&result[0], result.size());
-    in.close();
-  }
-  else
-  {
+  std::vector<uint8_t> data;
+  if (!Hazel::VirtualFileSystem::Get().Read(filepath, data))
     HZ_HAZEL_ERROR("Could not open file '{0}'", filepath);
-  }
 
-  return result;
+  return std::string(data.begin(), data.end());
 }
 
 std::unordered_map<GLenum, std::string> Shader::PreProcess(const std::string& source)
@@ -70,6 +61,28 @@ std::unordered_map<GLenum, std::string> Shader::PreProcess(const std::string& so
   return shaderSources;
 }
 
+void Shader::InsertDefines(std::unordered_map<GLenum, std::string>& shaderSources, const std::vector<std::string>& defines)
+{
+  if (defines.empty())
+    return;
+
+  std::string block;
+  for (const std::string& define : defines)
+    block += "#define " + define + "\n";
+
+  // #version has to stay the first directive.
+  for (auto& kv : shaderSources)
+  {
+    std::string& source = kv.second;
+    size_t insertAt = source.find("#version");
+    if (insertAt != std::string::npos)
+      insertAt = source.find_first_not_of("\r\n", source.find_first_of("\r\n", insertAt));
+    else
+      insertAt = 0;
+    source.insert(insertAt == std::string::npos ? source.size() : insertAt, block);
+  }
+}
+
 void Shader::Compile(std::unordered_map<GLenum, std::string>& shaderSources)
 {
   GLuint program = glCreateProgram();
@@ -6,7 +6,10 @@
 class Shader
 {
 public:
-  Shader(const std::string& filepath);
+  // filepath is resolved through the VirtualFileSystem.
+  // Each define is inserted as "#define <define>" after the #version line of
+  // every stage, so one file can hold several variants.
+  Shader(const std::string& filepath, const std::vector<std::string>& defines = {});
   ~Shader();
 
   void Bind() const;
@@ -24,6 +27,7 @@ public:
 private:
   std::string ReadFile(const std::string& filepath);
   std::unordered_map<GLenum, std::string> PreProcess(const std::string& source);
+  void InsertDefines(std::unordered_map<GLenum, std::string>& shaderSources, const std::vector<std::string>& defines);
   void Compile(std::unordered_map<GLenum, std::string>& shaderSources);
 private:
   uint32_t m_RendererID;
@@ -0,0 +1,104 @@
+#include "Texture.h"
+
+namespace Hazel {
+
+  uint32_t GetStoredChannelCount(uint32_t sourceChannels, TextureUsage usage)
+  {
+    switch (usage)
+    {
+      case TextureUsage::Mask:
+        return 1;
+      case TextureUsage::ColorSRGB:
+        // Core GL has no one or two channel sRGB formats.
+        return sourceChannels == 1 ? 3 : sourceChannels == 2 ? 4 : sourceChannels;
+      default:
+        return sourceChannels;
+    }
+  }
+
+  TextureFormat GetTextureFormat(uint32_t channels, TextureUsage usage)
+  {
+    bool srgb = usage == TextureUsage::ColorSRGB;
+    switch (channels)
+    {
+      case 1: return { GL_R8, GL_RED, 1 };
+      case 2: return { GL_RG8, GL_RG, 2 };
+      case 3: return { (GLenum)(srgb ? GL_SRGB8 : GL_RGB8), GL_RGB, 3 };
+      case 4: return { (GLenum)(srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8), GL_RGBA, 4 };
+    }
+
+    HZ_CORE_ASSERT(false, "Unsupported channel count!");
+    return { GL_RGBA8, GL_RGBA, 4 };
+  }
+
+  Texture2D::Texture2D(const std::string& path, TextureUsage usage, const glm::vec4& placeholder)
+    : m_Path(path), m_Usage(usage), m_Placeholder(placeholder)
+  {
+    glGenTextures(1, &m_RendererID);
+    glBindTexture(GL_TEXTURE_2D, m_RendererID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_FLOAT, &placeholder[0]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // The placeholder has no mip chain; keep it complete until the upload.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  Texture2D::~Texture2D()
+  {
+    glDeleteTextures(1, &m_RendererID);
+  }
+
+  void Texture2D::EvictLevels(uint32_t baseLevel)
+  {
+    baseLevel = std::min(baseLevel, GetMipLevelCount() - 1);
+    // Finer levels still on their way would be sampled past the new base.
+    if (!m_Loaded || m_LevelRequestPending || baseLevel <= m_BaseLevel)
+      return;
+
+    // Respecifying a level as 0x0 releases its storage; levels below the
+    // base do not count towards completeness.
+    glBindTexture(GL_TEXTURE_2D, m_RendererID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+    for (uint32_t level = m_BaseLevel; level < baseLevel; level++)
+    {
+      glTexImage2D(GL_TEXTURE_2D, level, m_InternalFormat, 0, 0, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+      m_MemorySize -= m_LevelSizes[level];
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_BaseLevel = baseLevel;
+  }
+
+  void Texture2D::Unload()
+  {
+    if (!m_Loaded)
+      return;
+
+    glBindTexture(GL_TEXTURE_2D, m_RendererID);
+    for (uint32_t level = GetMipLevelCount() - 1; level > 0; level--)
+      glTexImage2D(GL_TEXTURE_2D, level, m_InternalFormat, 0, 0, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_FLOAT, &m_Placeholder[0]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    // The placeholder is RGBA; drop the gray swizzle of the loaded image.
+    GLint swizzle[4] = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_InternalFormat = GL_RGBA8;
+    m_Width = m_Height = 1;
+    m_Loaded = false;
+    m_MemorySize = 4;
+    m_LevelSizes.clear();
+    m_BaseLevel = 0;
+  }
+
+  void Texture2D::Bind(uint32_t slot) const
+  {
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_2D, m_RendererID);
+  }
+
+}
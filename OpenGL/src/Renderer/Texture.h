@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+namespace Hazel {
+
+  // How a texture's contents are used; picks its storage format.
+  enum class TextureUsage
+  {
+    // Colors, kept at the decoded channel count. Gray images read back as gray.
+    Color,
+    // Colors authored in sRGB, decoded to linear by the sampler.
+    ColorSRGB,
+    // Non-color data such as normal maps, kept as decoded.
+    Data,
+    // One channel of data, e.g. a specular mask; stored as R8 and read back as gray.
+    Mask
+  };
+
+  struct TextureFormat
+  {
+    GLenum InternalFormat;
+    GLenum DataFormat;
+    uint32_t Channels;
+  };
+
+  // Channel count to decode an image with sourceChannels to, for the given usage.
+  uint32_t GetStoredChannelCount(uint32_t sourceChannels, TextureUsage usage);
+  TextureFormat GetTextureFormat(uint32_t channels, TextureUsage usage);
+
+  // Owns one GL texture; share it through Ref<Texture2D> and the GL object is
+  // released with the last handle. Starts out as a 1x1 texture of the given
+  // color until TextureLoader uploads the real image.
+  class Texture2D
+  {
+  public:
+    explicit Texture2D(const std::string& path = std::string(), TextureUsage usage = TextureUsage::Color, const glm::vec4& placeholder = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
+    ~Texture2D();
+
+    Texture2D(const Texture2D&) = delete;
+    Texture2D& operator=(const Texture2D&) = delete;
+
+    void Bind(uint32_t slot = 0) const;
+
+    GLuint GetRendererID() const { return m_RendererID; }
+    const std::string& GetPath() const { return m_Path; }
+    TextureUsage GetUsage() const { return m_Usage; }
+    GLenum GetInternalFormat() const { return m_InternalFormat; }
+    uint32_t GetWidth() const { return m_Width; }
+    uint32_t GetHeight() const { return m_Height; }
+    // False while the placeholder is bound.
+    bool IsLoaded() const { return m_Loaded; }
+
+    // Estimated GPU memory of the resident mip levels.
+    size_t GetMemorySize() const { return m_MemorySize; }
+
+    // Levels of the full chain, whether resident or not.
+    uint32_t GetMipLevelCount() const { return m_LevelSizes.empty() ? 1 : (uint32_t)m_LevelSizes.size(); }
+    // Finest resident level; sampling is clamped to it with GL_TEXTURE_BASE_LEVEL.
+    uint32_t GetBaseLevel() const { return m_BaseLevel; }
+    size_t GetLevelSize(uint32_t level) const { return m_LevelSizes[level]; }
+    // Set while TextureLoader is fetching finer levels.
+    bool IsLevelRequestPending() const { return m_LevelRequestPending; }
+
+    // Frees the levels finer than baseLevel and clamps sampling to it.
+    void EvictLevels(uint32_t baseLevel);
+    // Frees every level and goes back to the placeholder until the next load.
+    void Unload();
+  private:
+    friend class TextureLoader;
+
+    GLuint m_RendererID = 0;
+    std::string m_Path;
+    TextureUsage m_Usage;
+    glm::vec4 m_Placeholder;
+    GLenum m_InternalFormat = GL_RGBA8;
+    uint32_t m_Width = 1, m_Height = 1;
+    bool m_Loaded = false;
+    size_t m_MemorySize = 4;
+    std::vector<size_t> m_LevelSizes;
+    uint32_t m_BaseLevel = 0;
+    bool m_LevelRequestPending = false;
+  };
+
+}
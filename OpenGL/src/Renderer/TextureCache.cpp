@@ -0,0 +1,105 @@
+#include "TextureCache.h"
+
+#include "Core/Hash.h"
+#include "Core/RenderThread.h"
+#include "Core/VirtualFileSystem.h"
+
+namespace Hazel {
+
+  TextureCache::TextureCache(TextureLoader& loader)
+    : m_Loader(loader)
+  {
+  }
+
+  Ref<Texture2D> TextureCache::FindByPath(const std::string& key)
+  {
+    auto it = m_ByPath.find(key);
+    return it != m_ByPath.end() ? it->second.lock() : nullptr;
+  }
+
+  Task<Ref<Texture2D>> TextureCache::LoadAsync(std::string path, TextureUsage usage, glm::vec4 placeholder, uint32_t maxSize)
+  {
+    std::string key = std::to_string((int)usage) + ":" + path;
+    if (Ref<Texture2D> texture = FindByPath(key))
+    {
+      m_Stats.PathHits++;
+      co_return texture;
+    }
+
+    // Continues on the worker that completed the read.
+    VfsReadResult file = co_await VirtualFileSystem::Get().ReadAsync(path);
+    uint64_t hash = file.Error.empty() ? HashBytes(file.Data.data(), file.Data.size()) ^ ((uint64_t)usage * 0x9E3779B97F4A7C15ull) : 0;
+
+    co_await RenderThread::Get().Schedule();
+    if (!file.Error.empty())
+    {
+      HZ_HAZEL_ERROR("Could not open file '{0}': {1}", path, file.Error);
+      co_return CreateRef<Texture2D>(path, usage, placeholder);
+    }
+    // Another load of the same path may have finished meanwhile.
+    if (Ref<Texture2D> texture = FindByPath(key))
+    {
+      m_Stats.PathHits++;
+      co_return texture;
+    }
+
+    std::vector<std::pair<Ref<Texture2D>, std::string>> candidates;
+    auto [begin, end] = m_ByContent.equal_range(hash);
+    for (auto it = begin; it != end; ++it)
+    {
+      const ContentEntry& entry = it->second;
+      Ref<Texture2D> texture = entry.Texture.lock();
+      if (texture && entry.Size == file.Data.size() && entry.Usage == usage)
+        candidates.push_back({ texture, entry.Path });
+    }
+    for (auto& [texture, candidatePath] : candidates)
+    {
+      // Compared on the worker the read finishes on.
+      VfsReadResult candidate = co_await VirtualFileSystem::Get().ReadAsync(candidatePath);
+      bool same = candidate.Error.empty() && candidate.Data == file.Data;
+      co_await RenderThread::Get().Schedule();
+      if (same)
+      {
+        m_Stats.ContentHits++;
+        m_ByPath[key] = texture;
+        co_return texture;
+      }
+    }
+
+    m_Stats.Misses++;
+    Ref<Texture2D> texture = CreateRef<Texture2D>(path, usage, placeholder);
+    size_t size = file.Data.size();
+    m_Loader.LoadFromMemory(texture, std::move(file.Data), true, maxSize);
+    m_ByPath[key] = texture;
+    m_ByContent.insert({ hash, ContentEntry{ texture, path, size, usage } });
+    co_return texture;
+  }
+
+  const TextureCache::Stats& TextureCache::GetStats()
+  {
+    for (auto it = m_ByPath.begin(); it != m_ByPath.end();)
+      it = it->second.expired() ? m_ByPath.erase(it) : std::next(it);
+
+    m_Stats.ResidentCount = 0;
+    m_Stats.ResidentBytes = 0;
+    m_Stats.ResidentBytesAsRGBA8 = 0;
+    for (auto it = m_ByContent.begin(); it != m_ByContent.end();)
+    {
+      if (Ref<Texture2D> texture = it->second.Texture.lock())
+      {
+        m_Stats.ResidentCount++;
+        m_Stats.ResidentBytes += texture->GetMemorySize();
+        // Count only the levels from the base up; a streamed texture may not hold its finer levels yet.
+        for (uint32_t level = texture->GetBaseLevel(); level < texture->GetMipLevelCount(); level++)
+          m_Stats.ResidentBytesAsRGBA8 += (size_t)std::max(texture->GetWidth() >> level, 1u) * std::max(texture->GetHeight() >> level, 1u) * 4;
+        ++it;
+      }
+      else
+      {
+        it = m_ByContent.erase(it);
+      }
+    }
+    return m_Stats;
+  }
+
+}
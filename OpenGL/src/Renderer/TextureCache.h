@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Texture.h"
+#include "TextureLoader.h"
+#include "Core/Task.h"
+
+namespace Hazel {
+
+  // Hands out shared Texture2D handles. Requests are deduplicated by path and
+  // then by content, so the same image saved under several names is decoded
+  // and uploaded once. Files are read and hashed on a worker; a matching hash
+  // only counts once the size and bytes of the file it came from match too.
+  // The cache only keeps weak references: a texture goes away with its last
+  // handle.
+  class TextureCache
+  {
+  public:
+    struct Stats
+    {
+      uint32_t ResidentCount = 0;
+      size_t ResidentBytes = 0;
+      // What the resident levels would take if every texture were RGBA8.
+      size_t ResidentBytesAsRGBA8 = 0;
+      uint32_t PathHits = 0;
+      uint32_t ContentHits = 0;
+      uint32_t Misses = 0;
+    };
+
+    explicit TextureCache(TextureLoader& loader);
+
+    // Started on the RenderThread, where it finishes; decoding is left to the
+    // loader, so the texture holds its placeholder until that is done. The
+    // same file loaded with different usages gives separate textures. The
+    // cache must outlive the task. maxSize limits the levels uploaded, as for
+    // TextureLoader::Load; a path or content hit returns the texture as it
+    // was first loaded.
+    Task<Ref<Texture2D>> LoadAsync(std::string path, TextureUsage usage = TextureUsage::Color, glm::vec4 placeholder = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f),
+      uint32_t maxSize = 0);
+
+    // Also drops the entries of released textures.
+    const Stats& GetStats();
+  private:
+    struct ContentEntry
+    {
+      std::weak_ptr<Texture2D> Texture;
+      // Re-read to compare against on a hash match.
+      std::string Path;
+      size_t Size;
+      TextureUsage Usage;
+    };
+
+    Ref<Texture2D> FindByPath(const std::string& key);
+  private:
+    TextureLoader& m_Loader;
+    std::unordered_map<std::string, std::weak_ptr<Texture2D>> m_ByPath;
+    // Keyed by content hash; distinct files that collide share a key.
+    std::unordered_multimap<uint64_t, ContentEntry> m_ByContent;
+    Stats m_Stats;
+  };
+
+}
@@ -0,0 +1,337 @@
+#include "TextureLoader.h"
+
+#include "Asset/ImageDecoder.h"
+#include "Core/ThreadPool.h"
+#include "Core/VirtualFileSystem.h"
+
+// S3TC is an extension the generated loader does not define; every desktop driver exposes it.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+  #define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+  #define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+
+namespace Hazel {
+
+  static bool HasExtension(const char* name)
+  {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+      const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+      if (extension && strcmp(extension, name) == 0)
+        return true;
+    }
+    return false;
+  }
+
+  TextureLoader::TextureLoader(UploadScheduler& uploads)
+    : m_Uploads(uploads)
+  {
+    m_SupportsBPTC = GLAD_GL_VERSION_4_2 || HasExtension("GL_ARB_texture_compression_bptc");
+  }
+
+  TextureLoader::~TextureLoader()
+  {
+    // Workers still hold a pointer to the queue.
+    while (m_DecodesInFlight.load(std::memory_order_acquire) > 0)
+      std::this_thread::yield();
+  }
+
+  void TextureLoader::Load(const Ref<Texture2D>& texture, const std::string& path, bool flipVertically, uint32_t maxSize)
+  {
+    Enqueue(texture, path, {}, flipVertically, FirstLevelBySize, maxSize, false);
+  }
+
+  void TextureLoader::LoadFromMemory(const Ref<Texture2D>& texture, std::vector<uint8_t> data, bool flipVertically, uint32_t maxSize)
+  {
+    Enqueue(texture, texture->GetPath(), std::move(data), flipVertically, FirstLevelBySize, maxSize, false);
+  }
+
+  void TextureLoader::LoadLevels(const Ref<Texture2D>& texture, uint32_t firstLevel, bool flipVertically)
+  {
+    HZ_CORE_ASSERT(texture->IsLoaded(), "LoadLevels needs a loaded texture!");
+    if (texture->IsLevelRequestPending() || firstLevel >= texture->GetBaseLevel())
+      return;
+
+    texture->m_LevelRequestPending = true;
+    m_Stats.LevelRequests++;
+    Enqueue(texture, texture->GetPath(), {}, flipVertically, firstLevel, 0, true);
+  }
+
+  // Finest level no larger than maxSize on either side, or the last one.
+  static uint32_t GetFirstLevelWithin(const std::vector<MipLevel>& levels, uint32_t maxSize)
+  {
+    if (maxSize == 0)
+      return 0;
+
+    for (uint32_t i = 0; i < levels.size(); i++)
+    {
+      if (std::max(levels[i].Width, levels[i].Height) <= maxSize)
+        return i;
+    }
+    return (uint32_t)levels.size() - 1;
+  }
+
+  void TextureLoader::Enqueue(const Ref<Texture2D>& texture, std::string path, std::vector<uint8_t> data, bool flipVertically, uint32_t firstLevel, uint32_t maxSize, bool refine)
+  {
+    if (m_Pending == 0)
+      m_BatchTimer.Reset();
+    m_Pending++;
+    m_Stats.Requested++;
+
+    DecodedImage request;
+    request.Texture = texture;
+    request.Refine = refine;
+    TextureUsage usage = texture->GetUsage();
+    m_DecodesInFlight.fetch_add(1, std::memory_order_relaxed);
+    bool decompressBC7 = !m_SupportsBPTC;
+    auto decode = [this, request = std::move(request), usage, flipVertically, firstLevel, maxSize, decompressBC7](const uint8_t* data, size_t size,
+      const std::string& error) mutable
+    {
+      Decode(request, data, size, error, usage, flipVertically, firstLevel, maxSize, decompressBC7);
+      // Moved out so the texture is never released on a worker.
+      m_Decoded.Push(std::move(request));
+      m_DecodesInFlight.fetch_sub(1, std::memory_order_release);
+    };
+
+    if (!data.empty())
+    {
+      ThreadPool::Get().Enqueue([decode = std::move(decode), data = std::move(data)]() mutable { decode(data.data(), data.size(), {}); });
+      return;
+    }
+    // Files given by path are read without holding a worker, and decoded by
+    // the job their completion runs as.
+    VirtualFileSystem::Get().ReadAsync(path, [decode = std::move(decode)](const FileReadResult& file) mutable
+    {
+      decode(file.Data, file.Size, file.Error);
+    });
+  }
+
+  void TextureLoader::Decode(DecodedImage& image, const uint8_t* data, size_t size, const std::string& error, TextureUsage usage, bool flipVertically, uint32_t firstLevel,
+    uint32_t maxSize, bool decompressBC7)
+  {
+    Timer timer;
+    if (!error.empty())
+      image.Error = error;
+    else if (IsKtx2(data, size))
+    {
+      Ktx2Header header;
+      if (ReadKtx2(data, size, header, image.Error))
+      {
+        image.Width = header.Width;
+        image.Height = header.Height;
+        if (decompressBC7 && (header.Format == Ktx2Format::BC7_UNORM || header.Format == Ktx2Format::BC7_SRGB))
+        {
+          // The driver cannot sample BC7, so the levels go up as RGBA8.
+          image.Channels = 4;
+          for (const Ktx2Level& level : header.Levels)
+          {
+            size_t offset = image.Data.size(), levelSize = (size_t)level.Width * level.Height * 4;
+            image.Data.resize(offset + levelSize);
+            if (!DecompressBC7(data + level.Offset, level.Width, level.Height, image.Data.data() + offset))
+            {
+              image.Error = "BC7 block modes other than 6 need GL_ARB_texture_compression_bptc";
+              break;
+            }
+            image.Levels.push_back({ level.Width, level.Height, offset, levelSize });
+          }
+        }
+        else
+        {
+          image.CompressedFormat = header.Format;
+          for (const Ktx2Level& level : header.Levels)
+            image.Levels.push_back({ level.Width, level.Height, level.Offset, level.Size });
+          image.Data.assign(data, data + size);
+        }
+      }
+    }
+    else
+    {
+      // Decode straight to the channel count we store, never padding to RGBA,
+      // into a buffer each worker keeps for the next image.
+      thread_local ImageDecoder decoder;
+      thread_local std::vector<uint8_t> pixels;
+      ImageInfo info;
+      bool decoded = decoder.ReadInfo(data, size, info);
+      if (decoded)
+      {
+        image.Width = info.Width;
+        image.Height = info.Height;
+        image.Channels = GetStoredChannelCount(info.Channels, usage);
+        pixels.resize((size_t)info.Width * info.Height * image.Channels);
+        decoded = decoder.Decode(data, size, image.Channels, flipVertically, pixels.data());
+      }
+
+      if (decoded)
+      {
+        // Built here rather than by the driver on the GL thread, and colour
+        // is averaged in linear light.
+        Timer mipTimer;
+        MipSettings settings;
+        settings.GammaCorrect = usage == TextureUsage::Color || usage == TextureUsage::ColorSRGB;
+        MipChain chain;
+        GenerateMipChain(pixels.data(), image.Width, image.Height, image.Channels, settings, chain);
+
+        image.Data = std::move(chain.Data);
+        image.Levels = std::move(chain.Levels);
+        image.MipMs = mipTimer.ElapsedMillis();
+      }
+      else
+      {
+        image.Error = decoder.GetError();
+      }
+    }
+    if (image.Error.empty())
+      image.FirstLevel = firstLevel == FirstLevelBySize ? GetFirstLevelWithin(image.Levels, maxSize) : std::min(firstLevel, (uint32_t)image.Levels.size() - 1);
+    image.DecodeMs = timer.ElapsedMillis();
+  }
+
+  static GLenum GetCompressedInternalFormat(Ktx2Format format)
+  {
+    switch (format)
+    {
+      case Ktx2Format::BC1_RGB_UNORM: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+      case Ktx2Format::BC1_RGB_SRGB: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+      case Ktx2Format::BC4_UNORM: return GL_COMPRESSED_RED_RGTC1;
+      case Ktx2Format::BC5_UNORM: return GL_COMPRESSED_RG_RGTC2;
+      case Ktx2Format::BC7_UNORM: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+      case Ktx2Format::BC7_SRGB: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+      default: return 0;
+    }
+  }
+
+  void TextureLoader::Upload(DecodedImage& image)
+  {
+    Ref<Texture2D> texture = image.Texture;
+    TextureUpload upload;
+    upload.Texture = texture->GetRendererID();
+
+    uint32_t channels;
+    if (image.CompressedFormat == Ktx2Format::Undefined)
+    {
+      TextureFormat format = GetTextureFormat(image.Channels, texture->GetUsage());
+      upload.InternalFormat = format.InternalFormat;
+      upload.DataFormat = format.DataFormat;
+      channels = format.Channels;
+    }
+    else
+    {
+      // The cooker built the mip chain; nothing is decoded or generated here.
+      upload.InternalFormat = GetCompressedInternalFormat(image.CompressedFormat);
+      channels = image.CompressedFormat == Ktx2Format::BC4_UNORM ? 1 : image.CompressedFormat == Ktx2Format::BC5_UNORM ? 2 : 4;
+    }
+
+    uint32_t first = image.FirstLevel, last = image.LastLevel;
+    size_t size = 0;
+    for (uint32_t i = first; i < last; i++)
+      size += image.Levels[i].Size;
+    std::vector<size_t> levelSizes;
+    for (const MipLevel& level : image.Levels)
+      levelSizes.push_back(level.Size);
+
+    // A new image of a single level replaces the placeholder while the
+    // texture is sampled. Every other level is filled below the base, out
+    // of sight until it is complete.
+    bool refine = image.Refine;
+    if (!refine && image.Levels.size() == 1)
+      upload.WholeLevel = 0;
+
+    upload.Data = std::move(image.Data);
+    upload.Levels = std::move(image.Levels);
+    upload.FirstLevel = first;
+    upload.LastLevel = last;
+    upload.LevelDone = [this, texture, refine, first, last, size, channels, width = image.Width, height = image.Height,
+      internalFormat = upload.InternalFormat, levelSizes = std::move(levelSizes)](uint32_t level)
+    {
+      // Each level is sampled as soon as it is in.
+      glBindTexture(GL_TEXTURE_2D, texture->GetRendererID());
+      if (!refine && level == last - 1)
+      {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levelSizes.size() - 1);
+
+        // Gray data reads back as gray (and gray-alpha as such) instead of red.
+        if (texture->GetUsage() != TextureUsage::Data && channels <= 2)
+        {
+          GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, channels == 2 ? GL_GREEN : GL_ONE };
+          glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        }
+      }
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+      glBindTexture(GL_TEXTURE_2D, 0);
+      if (level != first)
+        return;
+
+      Texture2D& target = *texture;
+      if (!refine)
+      {
+        target.m_InternalFormat = internalFormat;
+        target.m_Width = width;
+        target.m_Height = height;
+        target.m_Loaded = true;
+        target.m_MemorySize = 0;
+        target.m_LevelSizes = levelSizes;
+      }
+      target.m_BaseLevel = first;
+      target.m_MemorySize += size;
+      Finish(target, refine);
+    };
+    m_Uploads.Upload(std::move(upload));
+    m_Stats.Uploaded++;
+  }
+
+  void TextureLoader::Finish(Texture2D& texture, bool refine)
+  {
+    if (refine)
+      texture.m_LevelRequestPending = false;
+    m_Pending--;
+    if (m_Pending == 0)
+      m_Stats.BatchMs = m_BatchTimer.ElapsedMillis();
+  }
+
+  void TextureLoader::Update()
+  {
+    DecodedImage image;
+    while (m_Decoded.Pop(image))
+    {
+      m_Stats.DecodeMsTotal += image.DecodeMs;
+      m_Stats.DecodeMsMax = std::max(m_Stats.DecodeMsMax, image.DecodeMs);
+      m_Stats.MipMsTotal += image.MipMs;
+
+      Texture2D& texture = *image.Texture;
+      if (!image.Error.empty())
+      {
+        HZ_HAZEL_ERROR("Failed to load texture {0}: {1}", texture.GetPath(), image.Error);
+        m_Stats.Failed++;
+      }
+      else
+      {
+        // Refinements stop at what is resident now; it may have changed since the request.
+        image.LastLevel = (uint32_t)image.Levels.size();
+        if (image.Refine)
+          image.LastLevel = texture.IsLoaded() ? std::min(image.LastLevel, texture.GetBaseLevel()) : 0;
+
+        if (image.FirstLevel < image.LastLevel)
+        {
+          Upload(image);
+          continue;
+        }
+        m_Stats.Uploaded++;
+      }
+      Finish(texture, image.Refine);
+    }
+  }
+
+  void TextureLoader::Flush()
+  {
+    while (m_Pending > 0)
+    {
+      Update();
+      m_Uploads.Flush();
+      std::this_thread::yield();
+    }
+  }
+
+}
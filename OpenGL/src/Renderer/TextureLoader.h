@@ -0,0 +1,111 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Texture.h"
+#include "Asset/Ktx2.h"
+#include "Asset/MipGenerator.h"
+#include "Core/MPSCQueue.h"
+#include "Core/Timer.h"
+#include "UploadScheduler.h"
+
+namespace Hazel {
+
+  // Streams image files into GL textures without blocking the render thread.
+  // Images are read through AsyncFileIO, decoded and given a full mip chain
+  // on the ThreadPool (block-compressed KTX2 files need neither and carry
+  // their own chain) and handed back through a lock-free queue; Update() on
+  // the GL thread queues them on an UploadScheduler, which spreads the
+  // transfer over frames, coarsest level first. The target texture keeps its
+  // placeholder until the coarsest level has arrived and sharpens as the
+  // finer ones follow. Loads given a size limit upload only the coarse levels
+  // and TextureStreamer asks for finer ones through LoadLevels.
+  class TextureLoader
+  {
+  public:
+    struct Stats
+    {
+      uint32_t Requested = 0;
+      uint32_t Uploaded = 0;
+      // Finer levels fetched for already loaded textures.
+      uint32_t LevelRequests = 0;
+      uint32_t Failed = 0;
+      // Worker time, summed and the slowest single file.
+      float DecodeMsTotal = 0.0f;
+      float DecodeMsMax = 0.0f;
+      // The part of DecodeMsTotal spent building mip chains.
+      float MipMsTotal = 0.0f;
+      // From the first request of a batch until its last level was uploaded.
+      float BatchMs = 0.0f;
+    };
+
+    // GL thread, with the context current: checks what it can upload.
+    explicit TextureLoader(UploadScheduler& uploads);
+    ~TextureLoader();
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // The loader holds a reference to the texture until its upload is issued.
+    // Paths are resolved through the VirtualFileSystem, as are re-reads. Only
+    // the levels no larger than maxSize on either side are uploaded; 0
+    // uploads every level.
+    void Load(const Ref<Texture2D>& texture, const std::string& path, bool flipVertically = true, uint32_t maxSize = 0);
+    // Decodes an encoded image that is already in memory, e.g. read by TextureCache.
+    void LoadFromMemory(const Ref<Texture2D>& texture, std::vector<uint8_t> data, bool flipVertically = true, uint32_t maxSize = 0);
+    // Re-reads the texture's file and uploads the levels from firstLevel up to
+    // the current base level. For loaded textures only.
+    void LoadLevels(const Ref<Texture2D>& texture, uint32_t firstLevel, bool flipVertically = true);
+
+    // GL thread, once per frame: queues whatever finished decoding for upload.
+    void Update();
+    // Blocks until every requested texture has been uploaded.
+    void Flush();
+
+    uint32_t GetPendingCount() const { return m_Pending; }
+    const Stats& GetStats() const { return m_Stats; }
+  private:
+    struct DecodedImage
+    {
+      Ref<Texture2D> Texture;
+      int Width = 0, Height = 0;
+      uint32_t Channels = 0;
+      // Undefined for images decoded here.
+      Ktx2Format CompressedFormat = Ktx2Format::Undefined;
+      // Every level, largest first, as byte ranges of Data: the generated
+      // chain for decoded images, the raw file for KTX2.
+      std::vector<uint8_t> Data;
+      std::vector<MipLevel> Levels;
+      // Uploaded range; LastLevel is settled on the GL thread.
+      uint32_t FirstLevel = 0, LastLevel = 0;
+      // Adds finer levels to a loaded texture instead of replacing it.
+      bool Refine = false;
+      // Empty on success.
+      std::string Error;
+      float DecodeMs = 0.0f;
+      float MipMs = 0.0f;
+    };
+
+    static constexpr uint32_t FirstLevelBySize = ~0u;
+
+    void Enqueue(const Ref<Texture2D>& texture, std::string path, std::vector<uint8_t> data, bool flipVertically, uint32_t firstLevel, uint32_t maxSize, bool refine);
+    // On a worker; error is the read's, if it failed.
+    static void Decode(DecodedImage& image, const uint8_t* data, size_t size, const std::string& error, TextureUsage usage, bool flipVertically, uint32_t firstLevel,
+      uint32_t maxSize, bool decompressBC7);
+    void Upload(DecodedImage& image);
+    // Once the last level of a load is in.
+    void Finish(Texture2D& texture, bool refine);
+  private:
+    UploadScheduler& m_Uploads;
+    MPSCQueue<DecodedImage> m_Decoded;
+    // BPTC is core from GL 4.2 only; without it BC7 files are decoded to RGBA8.
+    bool m_SupportsBPTC = false;
+
+    std::atomic<uint32_t> m_DecodesInFlight{ 0 };
+    uint32_t m_Pending = 0;
+    Timer m_BatchTimer;
+    Stats m_Stats;
+  };
+
+}
@@ -0,0 +1,233 @@
+#include "TexturePacker.h"
+
+#include "Asset/ImageDecoder.h"
+#include "Asset/MipGenerator.h"
+#include "Core/ThreadPool.h"
+#include "Core/Timer.h"
+#include "Core/VirtualFileSystem.h"
+
+namespace Hazel {
+
+  TexturePacker::~TexturePacker()
+  {
+    if (!m_Arrays.empty())
+      glDeleteTextures((GLsizei)m_Arrays.size(), m_Arrays.data());
+  }
+
+  uint32_t TexturePacker::Add(const std::string& path, TextureUsage usage, bool flipVertically)
+  {
+    HZ_CORE_ASSERT(!m_Built, "TexturePacker::Add after Build!");
+
+    Image image;
+    image.Path = path;
+    image.Usage = usage;
+    image.FlipVertically = flipVertically;
+    m_Images.push_back(std::move(image));
+    m_Regions.emplace_back();
+    return (uint32_t)m_Images.size() - 1;
+  }
+
+  void TexturePacker::Decode()
+  {
+    std::atomic<uint32_t> failed{ 0 };
+    ThreadPool::Get().ParallelFor((uint32_t)m_Images.size(), 1, [&](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t i = begin; i < end; i++)
+      {
+        Image& image = m_Images[i];
+        std::vector<uint8_t> data;
+        thread_local ImageDecoder decoder;
+        ImageInfo info;
+        bool decoded = false;
+        if (VirtualFileSystem::Get().Read(image.Path, data) && decoder.ReadInfo(data.data(), data.size(), info))
+        {
+          // Straight into the layer source, no intermediate copy.
+          image.Width = info.Width;
+          image.Height = info.Height;
+          image.Channels = GetStoredChannelCount(info.Channels, image.Usage);
+          image.Pixels.resize((size_t)image.Width * image.Height * image.Channels);
+          decoded = decoder.Decode(data.data(), data.size(), image.Channels, image.FlipVertically, image.Pixels.data());
+        }
+
+        if (!decoded)
+        {
+          // Keeps the handle valid: masks read as zero, everything else as grey.
+          HZ_HAZEL_ERROR("Failed to load texture {0}: {1}", image.Path, data.empty() ? "could not open file" : decoder.GetError());
+          image.Width = image.Height = 1;
+          image.Channels = GetStoredChannelCount(4, image.Usage);
+          image.Pixels.assign(image.Channels, image.Usage == TextureUsage::Mask ? 0 : 128);
+          failed.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+    m_Stats.Failed = failed.load();
+  }
+
+  void TexturePacker::PackAtlas(Group& group, std::vector<std::vector<uint8_t>>& layers)
+  {
+    const uint32_t size = m_Settings.AtlasSize, gutter = m_Settings.Gutter;
+    // Cells start on multiples of the last level's footprint so no texel of a
+    // coarser level mixes two cells.
+    const uint32_t alignment = 1u << (m_Settings.AtlasLevels - 1);
+    const uint32_t channels = group.Format.Channels;
+    auto align = [alignment](uint32_t value) { return (value + alignment - 1) / alignment * alignment; };
+
+    // Tallest first keeps shelves full.
+    std::sort(group.Images.begin(), group.Images.end(), [this](uint32_t a, uint32_t b)
+    {
+      return m_Images[a].Height > m_Images[b].Height;
+    });
+
+    uint32_t x = 0, y = 0, shelfHeight = 0;
+    for (uint32_t index : group.Images)
+    {
+      const Image& image = m_Images[index];
+      uint32_t cellWidth = align(image.Width + gutter * 2), cellHeight = align(image.Height + gutter * 2);
+      HZ_CORE_ASSERT(cellWidth <= size && cellHeight <= size, "Atlas threshold does not fit the atlas size!");
+
+      if (x + cellWidth > size)
+      {
+        x = 0;
+        y += shelfHeight;
+        shelfHeight = 0;
+      }
+      if (layers.empty() || y + cellHeight > size)
+      {
+        layers.emplace_back((size_t)size * size * channels, 0);
+        x = y = shelfHeight = 0;
+      }
+
+      // The image plus its edges repeated into the gutter.
+      std::vector<uint8_t>& layer = layers.back();
+      for (uint32_t cy = 0; cy < image.Height + gutter * 2; cy++)
+      {
+        uint32_t sy = (uint32_t)std::min(std::max((int)cy - (int)gutter, 0), (int)image.Height - 1);
+        for (uint32_t cx = 0; cx < image.Width + gutter * 2; cx++)
+        {
+          uint32_t sx = (uint32_t)std::min(std::max((int)cx - (int)gutter, 0), (int)image.Width - 1);
+          memcpy(&layer[((size_t)(y + cy) * size + x + cx) * channels], &image.Pixels[((size_t)sy * image.Width + sx) * channels], channels);
+        }
+      }
+
+      TextureRegion& region = m_Regions[index];
+      region.Layer = (uint32_t)layers.size() - 1;
+      region.Rect = glm::vec4((float)(x + gutter), (float)(y + gutter), (float)image.Width, (float)image.Height) / (float)size;
+
+      x += cellWidth;
+      shelfHeight = std::max(shelfHeight, cellHeight);
+      m_Stats.AtlasFill += (float)image.Width * image.Height;
+      m_Stats.AtlasedImages++;
+    }
+    m_Stats.AtlasLayers += (uint32_t)layers.size();
+  }
+
+  void TexturePacker::Upload(const Group& group, const std::vector<std::vector<uint8_t>>& layers)
+  {
+    // Atlas layers use the box filter: it never reaches past the aligned cell.
+    MipSettings settings;
+    settings.Filter = group.Atlas ? MipFilter::Box : MipFilter::Kaiser;
+    settings.GammaCorrect = group.Usage == TextureUsage::Color || group.Usage == TextureUsage::ColorSRGB;
+
+    std::vector<MipChain> chains(layers.size());
+    ThreadPool::Get().ParallelFor((uint32_t)layers.size(), 1, [&](uint32_t begin, uint32_t end)
+    {
+      for (uint32_t i = begin; i < end; i++)
+        GenerateMipChain(layers[i].data(), group.Width, group.Height, group.Format.Channels, settings, chains[i]);
+    });
+
+    uint32_t levels = (uint32_t)chains[0].Levels.size();
+    if (group.Atlas)
+      levels = std::min(levels, m_Settings.AtlasLevels);
+
+    GLuint array;
+    glGenTextures(1, &array);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (uint32_t level = 0; level < levels; level++)
+    {
+      const MipLevel& mip = chains[0].Levels[level];
+      glTexImage3D(GL_TEXTURE_2D_ARRAY, level, group.Format.InternalFormat, mip.Width, mip.Height, (GLsizei)layers.size(), 0, group.Format.DataFormat, GL_UNSIGNED_BYTE, nullptr);
+      for (uint32_t layer = 0; layer < layers.size(); layer++)
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, mip.Width, mip.Height, 1, group.Format.DataFormat, GL_UNSIGNED_BYTE, &chains[layer].Data[mip.Offset]);
+      m_Stats.MemorySize += mip.Size * layers.size();
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    GLint wrap = group.Atlas ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrap);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, (GLint)levels - 1);
+
+    // Gray data reads back as gray, the same as Texture2D.
+    if (group.Usage != TextureUsage::Data && group.Format.Channels <= 2)
+    {
+      GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, group.Format.Channels == 2 ? GL_GREEN : GL_ONE };
+      glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    for (uint32_t index : group.Images)
+      m_Regions[index].Array = array;
+    m_Arrays.push_back(array);
+    m_Stats.Layers += (uint32_t)layers.size();
+  }
+
+  void TexturePacker::Build()
+  {
+    HZ_CORE_ASSERT(!m_Built, "TexturePacker::Build called twice!");
+    m_Built = true;
+    if (m_Images.empty())
+      return;
+
+    Timer timer;
+    Decode();
+
+    std::vector<Group> groups;
+    for (uint32_t i = 0; i < m_Images.size(); i++)
+    {
+      const Image& image = m_Images[i];
+      TextureFormat format = GetTextureFormat(image.Channels, image.Usage);
+      bool atlas = std::max(image.Width, image.Height) <= m_Settings.AtlasThreshold;
+      uint32_t width = atlas ? m_Settings.AtlasSize : image.Width, height = atlas ? m_Settings.AtlasSize : image.Height;
+
+      auto group = std::find_if(groups.begin(), groups.end(), [&](const Group& group)
+      {
+        return group.Format.InternalFormat == format.InternalFormat && group.Usage == image.Usage
+          && group.Atlas == atlas && group.Width == width && group.Height == height;
+      });
+      if (group == groups.end())
+        group = groups.insert(groups.end(), { format, image.Usage, width, height, atlas, {} });
+      group->Images.push_back(i);
+    }
+
+    for (Group& group : groups)
+    {
+      std::vector<std::vector<uint8_t>> layers;
+      if (group.Atlas)
+      {
+        PackAtlas(group, layers);
+      }
+      else
+      {
+        for (uint32_t index : group.Images)
+        {
+          m_Regions[index].Layer = (uint32_t)layers.size();
+          layers.push_back(std::move(m_Images[index].Pixels));
+        }
+      }
+      Upload(group, layers);
+    }
+
+    for (Image& image : m_Images)
+      image.Pixels = {};
+
+    m_Stats.Images = (uint32_t)m_Images.size();
+    m_Stats.Arrays = (uint32_t)m_Arrays.size();
+    if (m_Stats.AtlasLayers > 0)
+      m_Stats.AtlasFill /= (float)m_Stats.AtlasLayers * m_Settings.AtlasSize * m_Settings.AtlasSize;
+    m_Stats.BuildMs = timer.ElapsedMillis();
+  }
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "Texture.h"
+#include "Scene/Components.h"
+
+namespace Hazel {
+
+  // Packs material maps into GL_TEXTURE_2D_ARRAYs so that draws using any of
+  // them need no texture binds in between. Maps of the same size and format
+  // become layers of one array. Maps no larger than AtlasThreshold are shelf
+  // packed into shared atlas layers instead and addressed through a UV rect;
+  // a gutter of repeated edge texels keeps filtering from bleeding across.
+  class TexturePacker
+  {
+  public:
+    struct Settings
+    {
+      uint32_t AtlasSize = 2048;
+      uint32_t AtlasThreshold = 256;
+      uint32_t Gutter = 8;
+      // Mip levels of atlas layers, limited so the gutter still covers a texel at the last one.
+      uint32_t AtlasLevels = 4;
+    };
+
+    struct Stats
+    {
+      uint32_t Images = 0;
+      uint32_t Failed = 0;
+      uint32_t Arrays = 0;
+      uint32_t Layers = 0;
+      uint32_t AtlasLayers = 0;
+      uint32_t AtlasedImages = 0;
+      // Share of atlas layer area covered by images, gutters excluded.
+      float AtlasFill = 0.0f;
+      size_t MemorySize = 0;
+      float BuildMs = 0.0f;
+    };
+
+    TexturePacker() = default;
+    explicit TexturePacker(const Settings& settings) : m_Settings(settings) {}
+    ~TexturePacker();
+
+    TexturePacker(const TexturePacker&) = delete;
+    TexturePacker& operator=(const TexturePacker&) = delete;
+
+    // Returns a handle for GetRegion. Files are only read by Build.
+    uint32_t Add(const std::string& path, TextureUsage usage = TextureUsage::Color, bool flipVertically = true);
+    // Decodes every added file on the ThreadPool, packs them and uploads the
+    // arrays with their full mip chains. Blocks; call once, at load time.
+    void Build();
+
+    const TextureRegion& GetRegion(uint32_t handle) const { return m_Regions[handle]; }
+    const Stats& GetStats() const { return m_Stats; }
+  private:
+    struct Image
+    {
+      std::string Path;
+      TextureUsage Usage;
+      bool FlipVertically;
+      uint32_t Width = 0, Height = 0, Channels = 0;
+      std::vector<uint8_t> Pixels;
+    };
+
+    // Images placed in one array, one layer (or a part of one) each.
+    struct Group
+    {
+      TextureFormat Format;
+      TextureUsage Usage;
+      uint32_t Width, Height;
+      bool Atlas;
+      std::vector<uint32_t> Images;
+    };
+
+    void Decode();
+    void PackAtlas(Group& group, std::vector<std::vector<uint8_t>>& layers);
+    void Upload(const Group& group, const std::vector<std::vector<uint8_t>>& layers);
+  private:
+    Settings m_Settings;
+    std::vector<Image> m_Images;
+    std::vector<TextureRegion> m_Regions;
+    std::vector<GLuint> m_Arrays;
+    bool m_Built = false;
+    Stats m_Stats;
+  };
+
+}
@@ -0,0 +1,185 @@
+#include "TextureStreamer.h"
+
+#include <queue>
+
+namespace Hazel {
+
+  void TextureStreamer::Load(const Ref<Texture2D>& texture, const std::string& path, bool flipVertically)
+  {
+    m_Loader.Load(texture, path, flipVertically, m_Settings.CoarseSize);
+    Register(texture, flipVertically);
+  }
+
+  void TextureStreamer::Register(const Ref<Texture2D>& texture, bool flipVertically)
+  {
+    Entry& entry = m_Entries[texture->GetRendererID()];
+    entry.Texture = texture;
+    entry.FlipVertically = flipVertically;
+  }
+
+  uint32_t TextureStreamer::GetCoarseLevel(const Texture2D& texture) const
+  {
+    uint32_t levels = texture.GetMipLevelCount();
+    for (uint32_t level = 0; level < levels; level++)
+    {
+      if (std::max(texture.GetWidth() >> level, texture.GetHeight() >> level) <= m_Settings.CoarseSize)
+        return level;
+    }
+    return levels - 1;
+  }
+
+  static size_t GetSizeFromLevel(const Texture2D& texture, uint32_t level)
+  {
+    size_t size = 0;
+    for (uint32_t i = level; i < texture.GetMipLevelCount(); i++)
+      size += texture.GetLevelSize(i);
+    return size;
+  }
+
+  void TextureStreamer::EstimateLevels(Scene& scene, const RenderCamera& camera, uint32_t viewportHeight)
+  {
+    // Textures no mesh uses only need their coarse levels.
+    for (auto& [id, entry] : m_Entries)
+    {
+      if (Ref<Texture2D> texture = entry.Texture.lock())
+        entry.WantedLevel = texture->IsLoaded() ? GetCoarseLevel(*texture) : 0;
+    }
+
+    TransformSystem& transforms = scene.GetTransforms();
+    float pixelsPerUnit = viewportHeight / std::tan(camera.FovY * 0.5f);
+    scene.GetRegistry().GetQuery<TransformComponent, MeshRendererComponent, BoundsComponent>().ForEach([&](TransformComponent& transform, MeshRendererComponent& mesh, BoundsComponent& bounds)
+    {
+      // Screen height of the bounding sphere; the maps are assumed to span the mesh once.
+      BoundsComponent world = TransformBounds(bounds, transforms.GetWorldMatrix(transform.Transform));
+      float radius = glm::length(world.Max - world.Min) * 0.5f;
+      float distance = std::max(glm::length((world.Min + world.Max) * 0.5f - camera.Position) - radius, camera.Near);
+      float pixels = std::max(radius / distance * pixelsPerUnit, 1.0f);
+
+      for (uint32_t map : { mesh.DiffuseMap, mesh.SpecularMap })
+      {
+        auto it = m_Entries.find(map);
+        if (it == m_Entries.end())
+          continue;
+
+        Entry& entry = it->second;
+        Ref<Texture2D> texture = entry.Texture.lock();
+        if (!texture || !texture->IsLoaded())
+          continue;
+
+        float texels = (float)std::max(texture->GetWidth(), texture->GetHeight());
+        int level = (int)std::floor(std::log2(texels / pixels) + m_Settings.LodBias);
+        entry.WantedLevel = std::min(entry.WantedLevel, (uint32_t)std::max(level, 0));
+      }
+    });
+  }
+
+  void TextureStreamer::FitBudget()
+  {
+    // Coarsen whichever texture has the largest finest level until the set fits.
+    using Candidate = std::pair<size_t, Entry*>;
+    std::priority_queue<Candidate> candidates;
+    size_t total = 0;
+    for (auto& [id, entry] : m_Entries)
+    {
+      Ref<Texture2D> texture = entry.Texture.lock();
+      if (!texture || !texture->IsLoaded())
+        continue;
+
+      total += GetSizeFromLevel(*texture, entry.WantedLevel);
+      if (entry.WantedLevel < GetCoarseLevel(*texture))
+        candidates.push({ texture->GetLevelSize(entry.WantedLevel), &entry });
+    }
+    m_Stats.RequestedBytes = total;
+
+    while (total > m_Settings.BudgetBytes && !candidates.empty())
+    {
+      Entry& entry = *candidates.top().second;
+      total -= candidates.top().first;
+      candidates.pop();
+
+      Ref<Texture2D> texture = entry.Texture.lock();
+      entry.WantedLevel++;
+      if (entry.WantedLevel < GetCoarseLevel(*texture))
+        candidates.push({ texture->GetLevelSize(entry.WantedLevel), &entry });
+    }
+    m_Stats.TargetBytes = total;
+  }
+
+  void TextureStreamer::Update(Scene& scene, const RenderCamera& camera, uint32_t viewportHeight)
+  {
+    Timer timer;
+
+    for (auto it = m_Entries.begin(); it != m_Entries.end();)
+      it = it->second.Texture.expired() ? m_Entries.erase(it) : std::next(it);
+
+    EstimateLevels(scene, camera, viewportHeight);
+    FitBudget();
+
+    size_t resident = 0;
+    uint32_t inFlight = 0;
+    for (auto& [id, entry] : m_Entries)
+    {
+      Ref<Texture2D> texture = entry.Texture.lock();
+      if (!texture->IsLoaded())
+        continue;
+
+      if (entry.InFlight && !texture->IsLevelRequestPending())
+      {
+        entry.InFlight = false;
+        if (texture->GetBaseLevel() > entry.RequestedLevel)
+        {
+          // The loader already logged why; do not ask again every frame.
+          entry.Failed = true;
+          HZ_HAZEL_ERROR("Stopped streaming {0}", texture->GetPath());
+        }
+      }
+      resident += texture->GetMemorySize();
+      inFlight += entry.InFlight;
+    }
+
+    // Finer levels stay while there is room; past the budget they go.
+    if (resident > m_Settings.BudgetBytes)
+    {
+      for (auto& [id, entry] : m_Entries)
+      {
+        Ref<Texture2D> texture = entry.Texture.lock();
+        if (!texture->IsLoaded() || texture->GetBaseLevel() >= entry.WantedLevel)
+          continue;
+
+        m_Stats.LevelsEvicted += entry.WantedLevel - texture->GetBaseLevel();
+        resident -= texture->GetMemorySize();
+        texture->EvictLevels(entry.WantedLevel);
+        resident += texture->GetMemorySize();
+      }
+    }
+
+    // Largest shortfall first.
+    std::vector<std::pair<uint32_t, Entry*>> requests;
+    for (auto& [id, entry] : m_Entries)
+    {
+      Ref<Texture2D> texture = entry.Texture.lock();
+      if (texture->IsLoaded() && !entry.InFlight && !entry.Failed && texture->GetBaseLevel() > entry.WantedLevel)
+        requests.push_back({ texture->GetBaseLevel() - entry.WantedLevel, &entry });
+    }
+    std::sort(requests.begin(), requests.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    for (auto& [shortfall, entry] : requests)
+    {
+      if (inFlight >= m_Settings.MaxRequestsInFlight)
+        break;
+
+      Ref<Texture2D> texture = entry->Texture.lock();
+      m_Loader.LoadLevels(texture, entry->WantedLevel, entry->FlipVertically);
+      entry->InFlight = true;
+      entry->RequestedLevel = entry->WantedLevel;
+      m_Stats.LevelsRequested += shortfall;
+      inFlight++;
+    }
+
+    m_Stats.Textures = (uint32_t)m_Entries.size();
+    m_Stats.RequestsInFlight = inFlight;
+    m_Stats.ResidentBytes = resident;
+    m_Stats.UpdateMs = timer.ElapsedMillis();
+  }
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Texture.h"
+#include "TextureLoader.h"
+#include "RenderCamera.h"
+#include "Scene/Scene.h"
+
+namespace Hazel {
+
+  // Keeps only the mip levels the view needs resident. Textures are loaded
+  // with their coarse levels only; every frame the finest useful level of each
+  // registered texture is estimated from the screen size of the meshes using
+  // it, the result is fitted to the memory budget, finer levels are requested
+  // from the loader and, when over budget, levels no longer needed are evicted.
+  class TextureStreamer
+  {
+  public:
+    struct Settings
+    {
+      size_t BudgetBytes = 64ull << 20;
+      // Levels up to this size on a side are loaded up front and never evicted.
+      uint32_t CoarseSize = 64;
+      // Added to the estimated level; positive values trade sharpness for memory.
+      float LodBias = 0.0f;
+      uint32_t MaxRequestsInFlight = 4;
+    };
+
+    struct Stats
+    {
+      uint32_t Textures = 0;
+      uint32_t RequestsInFlight = 0;
+      size_t ResidentBytes = 0;
+      // What the estimated levels would take without a budget.
+      size_t RequestedBytes = 0;
+      // What the levels fitted to the budget take.
+      size_t TargetBytes = 0;
+      uint32_t LevelsRequested = 0;
+      uint32_t LevelsEvicted = 0;
+      float UpdateMs = 0.0f;
+    };
+
+    explicit TextureStreamer(TextureLoader& loader) : m_Loader(loader) {}
+
+    // Loads the texture's coarse levels and registers it.
+    void Load(const Ref<Texture2D>& texture, const std::string& path, bool flipVertically = true);
+    // For textures loaded elsewhere, with Settings::CoarseSize as their size limit.
+    void Register(const Ref<Texture2D>& texture, bool flipVertically = true);
+    // GL thread, once per frame, after TextureLoader::Update.
+    void Update(Scene& scene, const RenderCamera& camera, uint32_t viewportHeight);
+
+    Settings& GetSettings() { return m_Settings; }
+    const Stats& GetStats() const { return m_Stats; }
+  private:
+    struct Entry
+    {
+      std::weak_ptr<Texture2D> Texture;
+      bool FlipVertically = true;
+      // Finest level worth having this frame.
+      uint32_t WantedLevel = 0;
+      // Level of the last request; a request that ends above it has failed.
+      uint32_t RequestedLevel = 0;
+      bool InFlight = false;
+      bool Failed = false;
+    };
+
+    uint32_t GetCoarseLevel(const Texture2D& texture) const;
+    void EstimateLevels(Scene& scene, const RenderCamera& camera, uint32_t viewportHeight);
+    void FitBudget();
+  private:
+    TextureLoader& m_Loader;
+    Settings m_Settings;
+    // Keyed by GL texture, which is what meshes reference.
+    std::unordered_map<uint32_t, Entry> m_Entries;
+    Stats m_Stats;
+  };
+
+}
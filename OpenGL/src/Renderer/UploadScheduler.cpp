@@ -0,0 +1,317 @@
+#include "UploadScheduler.h"
+
+namespace Hazel {
+
+  static constexpr size_t StagingAlignment = 64;
+
+  // What a level is cut along: pixel rows, or rows of 4x4 blocks when compressed.
+  static uint32_t GetRowCount(const TextureUpload& upload, const MipLevel& level)
+  {
+    return upload.DataFormat ? level.Height : (level.Height + 3) / 4;
+  }
+
+  UploadScheduler::UploadScheduler() = default;
+
+  UploadScheduler::~UploadScheduler()
+  {
+    for (const FrameFence& frame : m_Fences)
+      glDeleteSync(frame.Fence);
+    if (m_Ring)
+      glDeleteBuffers(1, &m_Ring);
+  }
+
+  uint64_t UploadScheduler::Upload(TextureUpload upload)
+  {
+    Job job;
+    job.Ticket = m_NextTicket++;
+    job.Texture = std::move(upload);
+    for (uint32_t i = job.Texture.FirstLevel; i < job.Texture.LastLevel; i++)
+      job.Remaining += job.Texture.Levels[i].Size;
+    job.Level = job.Texture.LastLevel - 1;
+    m_Stats.QueuedBytes += job.Remaining;
+    m_Jobs.push_back(std::move(job));
+    m_Stats.QueueDepth = (uint32_t)m_Jobs.size();
+    return m_Jobs.back().Ticket;
+  }
+
+  uint64_t UploadScheduler::UploadBuffer(GLuint buffer, size_t offset, const void* data, size_t size, std::function<void()> done)
+  {
+    Job job;
+    job.Ticket = m_NextTicket++;
+    job.Buffer = buffer;
+    job.BufferOffset = offset;
+    job.BufferData = (const uint8_t*)data;
+    job.Done = std::move(done);
+    job.Remaining = size;
+    m_Stats.QueuedBytes += size;
+    m_Jobs.push_back(std::move(job));
+    m_Stats.QueueDepth = (uint32_t)m_Jobs.size();
+    return m_Jobs.back().Ticket;
+  }
+
+  bool UploadScheduler::AllocateStaging(size_t size, size_t& offset)
+  {
+    if (!m_Ring)
+    {
+      glGenBuffers(1, &m_Ring);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_Ring);
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, RingSize, nullptr, GL_STREAM_DRAW);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    size_t staging = GetStagingSize(size);
+    if (m_RingUsed + staging > RingSize)
+      return false;
+
+    size_t aligned = (size + StagingAlignment - 1) & ~(StagingAlignment - 1);
+    offset = staging > aligned ? 0 : m_RingHead;
+    m_RingHead = (offset + aligned) % RingSize;
+    m_RingUsed += staging;
+    m_FrameRingBytes += staging;
+    return true;
+  }
+
+  size_t UploadScheduler::GetStagingSize(size_t size) const
+  {
+    // Pieces never wrap; the tail end of the ring is skipped instead.
+    size_t aligned = (size + StagingAlignment - 1) & ~(StagingAlignment - 1);
+    size_t skipped = m_RingHead + aligned > RingSize ? RingSize - m_RingHead : 0;
+    return skipped + aligned;
+  }
+
+  void UploadScheduler::RetireFrames()
+  {
+    while (!m_Fences.empty())
+    {
+      GLenum status = glClientWaitSync(m_Fences.front().Fence, 0, 0);
+      if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        break;
+
+      glDeleteSync(m_Fences.front().Fence);
+      m_RingUsed -= m_Fences.front().Size;
+      m_Fences.pop_front();
+    }
+    // A drained ring starts over, so no piece has to skip its tail.
+    if (m_RingUsed == 0)
+      m_RingHead = 0;
+  }
+
+  bool UploadScheduler::IssuePiece(Job& job, size_t maxSize, size_t& issued)
+  {
+    const uint8_t* source;
+    size_t size;
+    const TextureUpload& upload = job.Texture;
+    if (job.BufferData)
+    {
+      source = job.BufferData + job.Offset;
+      size = std::min(job.Remaining, maxSize);
+    }
+    else
+    {
+      // Whole rows, at least one.
+      const MipLevel& level = upload.Levels[job.Level];
+      size_t rowSize = level.Size / GetRowCount(upload, level);
+      source = upload.Data.data() + level.Offset + job.Offset;
+      size = level.Size - job.Offset;
+      if (job.Level != upload.WholeLevel && size > maxSize)
+        size = std::max(maxSize / rowSize, (size_t)1) * rowSize;
+    }
+
+    // Only a level that must go whole can be larger than the ring, or than
+    // what is left of it past the head; the driver copies that one from
+    // client memory instead, as waiting for space would not make it fit.
+    size_t offset = 0;
+    bool staged = GetStagingSize(size) <= RingSize;
+    if (staged)
+    {
+      if (!AllocateStaging(size, offset))
+        return false;
+
+      // The range is known to be free, so the map need not wait on the GPU.
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_Ring);
+      void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+      HZ_CORE_ASSERT(mapped, "Failed to map the staging ring!");
+      memcpy(mapped, source, size);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    if (job.BufferData)
+    {
+      glBindBuffer(GL_COPY_WRITE_BUFFER, job.Buffer);
+      if (staged)
+      {
+        glBindBuffer(GL_COPY_READ_BUFFER, m_Ring);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, job.BufferOffset + job.Offset, size);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+      }
+      else
+      {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, job.BufferOffset + job.Offset, size, source);
+      }
+      glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+      job.Offset += size;
+      job.Remaining -= size;
+      issued = size;
+      return true;
+    }
+
+    const MipLevel& level = upload.Levels[job.Level];
+    uint32_t rowCount = GetRowCount(upload, level);
+    size_t rowSize = level.Size / rowCount;
+    uint32_t firstRow = (uint32_t)(job.Offset / rowSize), rows = (uint32_t)(size / rowSize);
+
+    glBindTexture(GL_TEXTURE_2D, upload.Texture);
+    if (job.Offset == 0)
+    {
+      // Storage for the whole level first, with no unpack buffer bound.
+      if (upload.DataFormat)
+        glTexImage2D(GL_TEXTURE_2D, job.Level, upload.InternalFormat, level.Width, level.Height, 0, upload.DataFormat, GL_UNSIGNED_BYTE, nullptr);
+      else
+        glCompressedTexImage2D(GL_TEXTURE_2D, job.Level, upload.InternalFormat, level.Width, level.Height, 0, (GLsizei)level.Size, nullptr);
+    }
+
+    const void* pixels = source;
+    if (staged)
+    {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_Ring);
+      pixels = (const void*)offset;
+    }
+    if (upload.DataFormat)
+    {
+      // Rows of one and three channel images are tightly packed.
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      glTexSubImage2D(GL_TEXTURE_2D, job.Level, 0, firstRow, level.Width, rows, upload.DataFormat, GL_UNSIGNED_BYTE, pixels);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    else
+    {
+      // Block rows; the last band ends at the level's edge.
+      uint32_t y = firstRow * 4;
+      uint32_t height = std::min(rows * 4, level.Height - y);
+      glCompressedTexSubImage2D(GL_TEXTURE_2D, job.Level, 0, y, level.Width, height, upload.InternalFormat, (GLsizei)size, pixels);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    job.Offset += size;
+    job.Remaining -= size;
+    issued = size;
+    if (job.Offset == level.Size)
+    {
+      uint32_t finished = job.Level;
+      job.Level--;
+      job.Offset = 0;
+      if (upload.LevelDone)
+        upload.LevelDone(finished);
+    }
+    return true;
+  }
+
+  void UploadScheduler::Complete(Job& job)
+  {
+    m_CompletedTicket = job.Ticket;
+    m_Stats.Completed++;
+    if (job.Done)
+      job.Done();
+  }
+
+  bool UploadScheduler::Drain(bool budgeted)
+  {
+    Timer timer;
+    size_t bytes = 0;
+    uint32_t pieces = 0;
+    bool finished = true;
+    while (!m_Jobs.empty())
+    {
+      Job& job = m_Jobs.front();
+      if (job.Remaining > 0)
+      {
+        size_t maxSize = MaxPieceSize;
+        if (budgeted)
+        {
+          if (pieces > 0 && (bytes >= m_Settings.BytesPerFrame || timer.ElapsedMillis() >= m_Settings.MillisecondsPerFrame))
+          {
+            m_Stats.BudgetLimitedFrames++;
+            finished = false;
+            break;
+          }
+          maxSize = std::clamp(m_Settings.BytesPerFrame - std::min(bytes, m_Settings.BytesPerFrame), MinPieceSize, MaxPieceSize);
+        }
+
+        size_t issued = 0;
+        if (!IssuePiece(job, maxSize, issued))
+        {
+          m_Stats.StagingLimitedFrames++;
+          finished = false;
+          break;
+        }
+        bytes += issued;
+        pieces++;
+        m_Stats.QueuedBytes -= issued;
+        if (job.Remaining > 0)
+          continue;
+      }
+
+      // Callbacks may queue more; a deque keeps job valid meanwhile.
+      Complete(job);
+      m_Jobs.pop_front();
+    }
+
+    if (m_FrameRingBytes > 0)
+    {
+      m_Fences.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), m_FrameRingBytes });
+      m_FrameRingBytes = 0;
+    }
+
+    m_Stats.QueueDepth = (uint32_t)m_Jobs.size();
+    m_Stats.FramePieces = pieces;
+    m_Stats.FrameBytes = bytes;
+    m_Stats.FrameMs = timer.ElapsedMillis();
+    m_Stats.MaxFrameMs = std::max(m_Stats.MaxFrameMs, m_Stats.FrameMs);
+    m_Stats.TotalBytes += bytes;
+
+    // Resumed tasks may queue more uploads too.
+    std::vector<std::pair<uint64_t, std::coroutine_handle<>>> ready;
+    for (size_t i = 0; i < m_Waiters.size();)
+    {
+      if (IsComplete(m_Waiters[i].first))
+      {
+        ready.push_back(m_Waiters[i]);
+        m_Waiters[i] = m_Waiters.back();
+        m_Waiters.pop_back();
+      }
+      else
+      {
+        i++;
+      }
+    }
+    for (auto& [ticket, handle] : ready)
+      handle.resume();
+
+    return finished;
+  }
+
+  void UploadScheduler::Update()
+  {
+    RetireFrames();
+    Drain(true);
+  }
+
+  void UploadScheduler::Flush()
+  {
+    RetireFrames();
+    while (!Drain(false) || !m_Jobs.empty())
+    {
+      // Out of staging space: wait for the GPU to read the oldest frame's part.
+      if (!m_Fences.empty())
+      {
+        while (glClientWaitSync(m_Fences.front().Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+          ;
+      }
+      RetireFrames();
+    }
+  }
+
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <coroutine>
+#include <deque>
+#include <functional>
+
+#include <glad/glad.h>
+
+#include "Asset/MipGenerator.h"
+#include "Core/Timer.h"
+
+namespace Hazel {
+
+  // Mip levels of a texture, filled from the coarsest up so the texture can
+  // sample each finished level while the finer ones are still coming.
+  struct TextureUpload
+  {
+    GLuint Texture = 0;
+    GLenum InternalFormat = 0;
+    // Zero for block-compressed formats.
+    GLenum DataFormat = 0;
+    // Every level, largest first, as byte ranges of Data.
+    std::vector<uint8_t> Data;
+    std::vector<MipLevel> Levels;
+    // Levels [FirstLevel, LastLevel) are uploaded.
+    uint32_t FirstLevel = 0, LastLevel = 0;
+    // A level the texture samples while it is filled, which therefore goes
+    // in one piece rather than showing up half written.
+    uint32_t WholeLevel = ~0u;
+    // Render thread, as each level is complete; FirstLevel comes last.
+    std::function<void(uint32_t level)> LevelDone;
+  };
+
+  // Spreads texture and buffer uploads over frames so that many loads
+  // finishing at once cannot stall one. Uploads queue in order and Update()
+  // drains them until the frame's byte or time budget is spent, cutting
+  // texture levels into bands of rows (of 4x4 blocks when compressed) and
+  // buffers into ranges. Data goes through a staging ring buffer the GPU
+  // reads from asynchronously; a fence per frame tells when the space comes
+  // free again. At least one piece goes every frame, so a budget smaller
+  // than a piece still makes progress. Render thread only.
+  class UploadScheduler
+  {
+  public:
+    struct Settings
+    {
+      size_t BytesPerFrame = 4ull << 20;
+      // Time spent issuing uploads, i.e. copying into staging and the GL calls.
+      float MillisecondsPerFrame = 2.0f;
+    };
+
+    struct Stats
+    {
+      // Uploads waiting or partly done, and the bytes they have left.
+      uint32_t QueueDepth = 0;
+      size_t QueuedBytes = 0;
+      // The last Update.
+      uint32_t FramePieces = 0;
+      size_t FrameBytes = 0;
+      float FrameMs = 0.0f;
+      // Since creation.
+      uint32_t Completed = 0;
+      uint64_t TotalBytes = 0;
+      float MaxFrameMs = 0.0f;
+      // Updates that stopped at the budget, or for lack of staging space, with work left.
+      uint32_t BudgetLimitedFrames = 0;
+      uint32_t StagingLimitedFrames = 0;
+    };
+
+    UploadScheduler();
+    ~UploadScheduler();
+
+    UploadScheduler(const UploadScheduler&) = delete;
+    UploadScheduler& operator=(const UploadScheduler&) = delete;
+
+    // Both return a ticket that completes once the upload has been issued.
+    uint64_t Upload(TextureUpload upload);
+    // size bytes of data to buffer at offset, into storage the buffer has
+    // already. data must stay valid until the ticket completes.
+    uint64_t UploadBuffer(GLuint buffer, size_t offset, const void* data, size_t size, std::function<void()> done = {});
+
+    // Once per frame.
+    void Update();
+    // Everything queued, regardless of the budget.
+    void Flush();
+
+    bool IsComplete(uint64_t ticket) const { return ticket <= m_CompletedTicket; }
+    uint64_t GetLastTicket() const { return m_NextTicket - 1; }
+
+    // co_await uploads.WaitFor(ticket), on the render thread, continues a
+    // Task from Update once the ticket is complete.
+    auto WaitFor(uint64_t ticket)
+    {
+      struct Awaiter
+      {
+        UploadScheduler& Scheduler;
+        uint64_t Ticket;
+
+        bool await_ready() const noexcept { return Scheduler.IsComplete(Ticket); }
+        void await_suspend(std::coroutine_handle<> handle) { Scheduler.m_Waiters.push_back({ Ticket, handle }); }
+        void await_resume() const noexcept {}
+      };
+      return Awaiter{ *this, ticket };
+    }
+
+    Settings& GetSettings() { return m_Settings; }
+    const Stats& GetStats() const { return m_Stats; }
+  private:
+    struct Job
+    {
+      uint64_t Ticket = 0;
+      TextureUpload Texture;
+      // Buffer uploads only.
+      GLuint Buffer = 0;
+      size_t BufferOffset = 0;
+      const uint8_t* BufferData = nullptr;
+      std::function<void()> Done;
+      // Level being filled (counting down for textures) and bytes of it done.
+      uint32_t Level = 0;
+      size_t Offset = 0;
+      size_t Remaining = 0;
+    };
+
+    struct FrameFence
+    {
+      GLsync Fence;
+      // Ring bytes the frame used, including any skipped at the wrap.
+      size_t Size;
+    };
+
+    // Drains until budget or staging runs out; false if it stopped early.
+    bool Drain(bool budgeted);
+    // Issues up to maxSize bytes of the job; false if staging is full.
+    bool IssuePiece(Job& job, size_t maxSize, size_t& issued);
+    // Offset of size free bytes in the ring, or false.
+    bool AllocateStaging(size_t size, size_t& offset);
+    // Ring bytes a piece of size takes at the current head, with any skipped at the wrap.
+    size_t GetStagingSize(size_t size) const;
+    void RetireFrames();
+    void Complete(Job& job);
+  private:
+    static constexpr size_t RingSize = 16ull << 20;
+    // Smaller pieces would cost more in calls than they save in spikes.
+    static constexpr size_t MinPieceSize = 64ull << 10;
+    static constexpr size_t MaxPieceSize = 4ull << 20;
+
+    Settings m_Settings;
+    Stats m_Stats;
+    std::deque<Job> m_Jobs;
+    std::vector<std::pair<uint64_t, std::coroutine_handle<>>> m_Waiters;
+    uint64_t m_NextTicket = 1;
+    uint64_t m_CompletedTicket = 0;
+
+    GLuint m_Ring = 0;
+    size_t m_RingHead = 0;
+    size_t m_RingUsed = 0;
+    // Bytes written since the last fence.
+    size_t m_FrameRingBytes = 0;
+    std::deque<FrameFence> m_Fences;
+  };
+
+}
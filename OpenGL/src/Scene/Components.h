@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "TransformSystem.h"
+
+namespace Hazel {
+
+  // The entity's node in the scene's TransformSystem.
+  struct TransformComponent
+  {
+    TransformID Transform = NullTransform;
+  };
+
+  // A material map packed into a texture array: the layer, plus the part of
+  // it (offset xy, scale zw) the map occupies when it shares an atlas layer.
+  struct TextureRegion
+  {
+    // GL texture array; 0 when the map is not packed.
+    uint32_t Array = 0;
+    uint32_t Layer = 0;
+    glm::vec4 Rect{ 0.0f, 0.0f, 1.0f, 1.0f };
+  };
+
+  struct MeshRendererComponent
+  {
+    uint32_t VertexArray = 0;
+    uint32_t FirstVertex = 0;
+    uint32_t VertexCount = 0;
+    uint32_t DiffuseMap = 0;
+    uint32_t SpecularMap = 0;
+    float Shininess = 32.0f;
+    // Drawn unlit with the lamp shader.
+    bool Emissive = false;
+    // Never moves; may be baked into cached shadow cascades.
+    bool Static = false;
+    // Position-only view of the same vertices for depth-only passes; 0 uses VertexArray.
+    uint32_t DepthVertexArray = 0;
+    // Packed copies of both maps (see TexturePacker). Used instead of the
+    // maps above when the renderer has texture arrays enabled.
+    TextureRegion DiffuseRegion{};
+    TextureRegion SpecularRegion{};
+    // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT for indexed meshes (see Mesh), which
+    // draw VertexCount indices from index FirstVertex; 0 draws arrays.
+    uint32_t IndexType = 0;
+  };
+
+  struct LightComponent
+  {
+    glm::vec3 Ambient{ 0.2f };
+    glm::vec3 Diffuse{ 0.5f };
+    glm::vec3 Specular{ 1.0f };
+    float Radius = 10.0f;
+  };
+
+  // Key light; the renderer uses the first one it finds for cascaded shadows.
+  struct DirectionalLightComponent
+  {
+    glm::vec3 Direction{ -0.3f, -1.0f, -0.4f };
+    glm::vec3 Ambient{ 0.05f };
+    glm::vec3 Diffuse{ 0.4f };
+    glm::vec3 Specular{ 0.5f };
+    bool CastShadows = true;
+  };
+
+  // Local-space axis-aligned bounds.
+  struct BoundsComponent
+  {
+    glm::vec3 Min{ -0.5f };
+    glm::vec3 Max{ 0.5f };
+  };
+
+  // Conservative bounds of the transformed box.
+  inline BoundsComponent TransformBounds(const BoundsComponent& bounds, const glm::mat4& transform)
+  {
+    glm::vec3 center(transform * glm::vec4((bounds.Min + bounds.Max) * 0.5f, 1.0f));
+    glm::vec3 extents = (bounds.Max - bounds.Min) * 0.5f;
+
+    glm::vec3 worldExtents(0.0f);
+    for (int axis = 0; axis < 3; axis++)
+      worldExtents += glm::abs(glm::vec3(transform[axis])) * extents[axis];
+
+    return { center - worldExtents, center + worldExtents };
+  }
+
+}
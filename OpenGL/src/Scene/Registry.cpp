@@ -0,0 +1,281 @@
+#include "Registry.h"
+
+#include <cstring>
+
+namespace Hazel {
+
+  static constexpr size_t ChunkAlignment = 64;
+
+  static std::vector<ComponentInfo>& GetComponentInfos()
+  {
+    static std::vector<ComponentInfo> s_Infos;
+    return s_Infos;
+  }
+
+  ComponentTypeID RegisterComponentType(uint32_t size, uint32_t alignment, const char* name)
+  {
+    static std::mutex s_Mutex;
+    std::lock_guard<std::mutex> lock(s_Mutex);
+
+    auto& infos = GetComponentInfos();
+    HZ_CORE_ASSERT(infos.size() < MaxComponentTypes, "Too many component types!");
+    infos.push_back({ size, alignment, name });
+    return (ComponentTypeID)(infos.size() - 1);
+  }
+
+  const ComponentInfo& GetComponentInfo(ComponentTypeID type)
+  {
+    return GetComponentInfos()[type];
+  }
+
+  uint32_t GetComponentTypeCount()
+  {
+    return (uint32_t)GetComponentInfos().size();
+  }
+
+  void Chunk::Deleter::operator()(uint8_t* data) const
+  {
+    ::operator delete[](data, std::align_val_t(ChunkAlignment));
+  }
+
+  static uint32_t AlignUp(uint32_t value, uint32_t alignment)
+  {
+    return (value + alignment - 1) & ~(alignment - 1);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  // Archetype ///////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////////////
+
+  Archetype::Archetype(const ComponentMask& mask)
+    : m_Mask(mask)
+  {
+    m_ColumnOffsets.fill(~0u);
+
+    uint32_t bytesPerEntity = sizeof(Entity);
+    for (ComponentTypeID type = 0; type < MaxComponentTypes; type++)
+    {
+      if (!mask.test(type))
+        continue;
+
+      m_Types.push_back(type);
+      bytesPerEntity += GetComponentInfo(type).Size;
+    }
+
+    // Shrink the capacity until the aligned columns fit in one chunk.
+    for (m_Capacity = ChunkSize / bytesPerEntity; m_Capacity > 0; m_Capacity--)
+    {
+      uint32_t offset = m_EntityOffset + m_Capacity * (uint32_t)sizeof(Entity);
+      for (ComponentTypeID type : m_Types)
+      {
+        const ComponentInfo& info = GetComponentInfo(type);
+        offset = AlignUp(offset, info.Alignment);
+        m_ColumnOffsets[type] = offset;
+        offset += m_Capacity * info.Size;
+      }
+
+      if (offset <= ChunkSize)
+        break;
+    }
+    HZ_CORE_ASSERT(m_Capacity > 0, "Component set does not fit in a chunk!");
+  }
+
+  std::pair<uint32_t, uint32_t> Archetype::Allocate(Entity entity)
+  {
+    auto [chunkIndex, row, count] = AllocateRun(1);
+    GetEntities(m_Chunks[chunkIndex])[row] = entity;
+    return { chunkIndex, row };
+  }
+
+  std::tuple<uint32_t, uint32_t, uint32_t> Archetype::AllocateRun(uint32_t count)
+  {
+    if (m_Chunks.empty() || m_Chunks.back().Count == m_Capacity)
+    {
+      Chunk chunk;
+      chunk.Data.reset(new (std::align_val_t(ChunkAlignment)) uint8_t[ChunkSize]);
+      m_Chunks.push_back(std::move(chunk));
+    }
+
+    uint32_t chunkIndex = (uint32_t)m_Chunks.size() - 1;
+    Chunk& chunk = m_Chunks.back();
+    uint32_t row = chunk.Count;
+    uint32_t rows = std::min(count, m_Capacity - row);
+    chunk.Count += rows;
+    m_EntityCount += rows;
+
+    return { chunkIndex, row, rows };
+  }
+
+  Entity Archetype::Remove(uint32_t chunkIndex, uint32_t row)
+  {
+    Chunk& chunk = m_Chunks[chunkIndex];
+    Chunk& last = m_Chunks.back();
+    uint32_t lastRow = last.Count - 1;
+
+    // Keep every chunk but the last one full by moving the last entity into the hole.
+    Entity moved = NullEntity;
+    if (&chunk != &last || row != lastRow)
+    {
+      moved = GetEntities(last)[lastRow];
+      GetEntities(chunk)[row] = moved;
+      for (ComponentTypeID type : m_Types)
+      {
+        uint32_t size = GetComponentInfo(type).Size;
+        memcpy((uint8_t*)GetColumn(chunk, type) + row * size, (uint8_t*)GetColumn(last, type) + lastRow * size, size);
+      }
+    }
+
+    last.Count--;
+    m_EntityCount--;
+    if (last.Count == 0)
+      m_Chunks.pop_back();
+
+    return moved;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  // Registry ////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////////////
+
+  Registry::Registry()
+  {
+    // Entities without components live in the empty archetype.
+    GetOrCreateArchetype(ComponentMask());
+  }
+
+  Registry::~Registry() = default;
+
+  Entity Registry::AllocateEntity()
+  {
+    Entity entity;
+    if (!m_FreeIndices.empty())
+    {
+      entity.Index = m_FreeIndices.back();
+      m_FreeIndices.pop_back();
+    }
+    else
+    {
+      entity.Index = (uint32_t)m_Records.size();
+      m_Records.emplace_back();
+    }
+
+    entity.Generation = m_Records[entity.Index].Generation;
+    return entity;
+  }
+
+  Entity Registry::Create()
+  {
+    Entity entity = AllocateEntity();
+    EntityRecord& record = m_Records[entity.Index];
+    Archetype* empty = m_ArchetypeList.front();
+    record.Owner = empty;
+    std::tie(record.ChunkIndex, record.Row) = empty->Allocate(entity);
+
+    return entity;
+  }
+
+  void Registry::CreateMany(const ComponentMask& mask, uint32_t count, const FillFn& fill)
+  {
+    Archetype& archetype = GetOrCreateArchetype(mask);
+    size_t fresh = count - std::min((size_t)count, m_FreeIndices.size());
+    m_Records.reserve(m_Records.size() + fresh);
+
+    for (uint32_t first = 0; first < count;)
+    {
+      auto [chunkIndex, row, rows] = archetype.AllocateRun(count - first);
+      Chunk& chunk = archetype.GetChunks()[chunkIndex];
+      Entity* entities = archetype.GetEntities(chunk);
+      for (uint32_t i = 0; i < rows; i++)
+      {
+        Entity entity = AllocateEntity();
+        EntityRecord& record = m_Records[entity.Index];
+        record.Owner = &archetype;
+        record.ChunkIndex = chunkIndex;
+        record.Row = row + i;
+        entities[row + i] = entity;
+      }
+
+      fill(archetype, chunk, row, first, rows);
+      first += rows;
+    }
+  }
+
+  void Registry::Destroy(Entity entity)
+  {
+    HZ_CORE_ASSERT(IsAlive(entity), "Entity is not alive!");
+
+    EntityRecord& record = m_Records[entity.Index];
+    RemoveFromArchetype(record);
+    record.Owner = nullptr;
+    record.Generation++;
+    m_FreeIndices.push_back(entity.Index);
+  }
+
+  bool Registry::IsAlive(Entity entity) const
+  {
+    return entity.Index < m_Records.size()
+      && m_Records[entity.Index].Owner
+      && m_Records[entity.Index].Generation == entity.Generation;
+  }
+
+  Archetype& Registry::GetOrCreateArchetype(const ComponentMask& mask)
+  {
+    auto it = m_Archetypes.find(mask);
+    if (it != m_Archetypes.end())
+      return *it->second;
+
+    Archetype* archetype = new Archetype(mask);
+    m_Archetypes[mask] = Scope<Archetype>(archetype);
+    m_ArchetypeList.push_back(archetype);
+    return *archetype;
+  }
+
+  QueryCache* Registry::GetQueryCache(const ComponentMask& mask)
+  {
+    Scope<QueryCache>& cache = m_Queries[mask];
+    if (!cache)
+    {
+      cache = CreateScope<QueryCache>();
+      cache->Mask = mask;
+      cache->AllArchetypes = &m_ArchetypeList;
+    }
+
+    cache->Refresh();
+    return cache.get();
+  }
+
+  void Registry::MoveEntity(Entity entity, Archetype& destination)
+  {
+    EntityRecord& record = m_Records[entity.Index];
+    Archetype& source = *record.Owner;
+
+    auto [chunkIndex, row] = destination.Allocate(entity);
+    Chunk& from = source.GetChunks()[record.ChunkIndex];
+    Chunk& to = destination.GetChunks()[chunkIndex];
+    for (ComponentTypeID type : source.GetTypes())
+    {
+      if (!destination.GetMask().test(type))
+        continue;
+
+      uint32_t size = GetComponentInfo(type).Size;
+      memcpy((uint8_t*)destination.GetColumn(to, type) + row * size, (uint8_t*)source.GetColumn(from, type) + record.Row * size, size);
+    }
+
+    RemoveFromArchetype(record);
+    record.Owner = &destination;
+    record.ChunkIndex = chunkIndex;
+    record.Row = row;
+  }
+
+  void Registry::RemoveFromArchetype(const EntityRecord& record)
+  {
+    Entity moved = record.Owner->Remove(record.ChunkIndex, record.Row);
+    if (moved.IsValid())
+    {
+      EntityRecord& movedRecord = m_Records[moved.Index];
+      movedRecord.ChunkIndex = record.ChunkIndex;
+      movedRecord.Row = record.Row;
+    }
+  }
+
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <bitset>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+
+#include "Core/ThreadPool.h"
+
+namespace Hazel {
+
+  constexpr uint32_t MaxComponentTypes = 64;
+  // Chunks are fixed-size blocks; each component gets its own packed array inside.
+  constexpr uint32_t ChunkSize = 16 * 1024;
+
+  using ComponentTypeID = uint32_t;
+  using ComponentMask = std::bitset<MaxComponentTypes>;
+
+  struct Entity
+  {
+    uint32_t Index = ~0u;
+    uint32_t Generation = 0;
+
+    bool IsValid() const { return Index != ~0u; }
+    bool operator==(const Entity& other) const { return Index == other.Index && Generation == other.Generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+  };
+
+  constexpr Entity NullEntity{};
+
+  struct ComponentInfo
+  {
+    uint32_t Size;
+    uint32_t Alignment;
+    const char* Name;
+  };
+
+  ComponentTypeID RegisterComponentType(uint32_t size, uint32_t alignment, const char* name);
+  const ComponentInfo& GetComponentInfo(ComponentTypeID type);
+  // Types are registered on first use; ids run from 0 to this.
+  uint32_t GetComponentTypeCount();
+
+  // Components are plain data: chunks move them around with memcpy.
+  template<typename T>
+  ComponentTypeID GetComponentTypeID()
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "Components must be trivially copyable");
+    static const ComponentTypeID s_ID = RegisterComponentType(sizeof(T), alignof(T), typeid(T).name());
+    return s_ID;
+  }
+
+  template<typename... Ts>
+  ComponentMask MakeComponentMask()
+  {
+    ComponentMask mask;
+    (mask.set(GetComponentTypeID<Ts>()), ...);
+    return mask;
+  }
+
+  struct Chunk
+  {
+    struct Deleter
+    {
+      void operator()(uint8_t* data) const;
+    };
+
+    std::unique_ptr<uint8_t[], Deleter> Data;
+    uint32_t Count = 0;
+  };
+
+  // All entities with exactly the same component set, packed into chunks.
+  class Archetype
+  {
+  public:
+    Archetype(const ComponentMask& mask);
+
+    const ComponentMask& GetMask() const { return m_Mask; }
+    const std::vector<ComponentTypeID>& GetTypes() const { return m_Types; }
+    uint32_t GetChunkCapacity() const { return m_Capacity; }
+    uint32_t GetEntityCount() const { return m_EntityCount; }
+    std::vector<Chunk>& GetChunks() { return m_Chunks; }
+
+    Entity* GetEntities(Chunk& chunk) const { return (Entity*)(chunk.Data.get() + m_EntityOffset); }
+    void* GetColumn(Chunk& chunk, ComponentTypeID type) const { return chunk.Data.get() + m_ColumnOffsets[type]; }
+
+    template<typename T>
+    T* GetColumn(Chunk& chunk) const { return (T*)GetColumn(chunk, GetComponentTypeID<T>()); }
+
+    // Appends an entity with uninitialized components; returns its (chunk, row).
+    std::pair<uint32_t, uint32_t> Allocate(Entity entity);
+    // Appends up to count rows, entity slots included, left uninitialized:
+    // as many as fit in the last chunk, or a new one. Returns (chunk, row, rows).
+    std::tuple<uint32_t, uint32_t, uint32_t> AllocateRun(uint32_t count);
+    // Fills the hole with the last entity and returns it, or NullEntity if nothing moved.
+    Entity Remove(uint32_t chunkIndex, uint32_t row);
+  private:
+    ComponentMask m_Mask;
+    std::vector<ComponentTypeID> m_Types;
+    std::array<uint32_t, MaxComponentTypes> m_ColumnOffsets;
+    uint32_t m_EntityOffset = 0;
+    uint32_t m_Capacity = 0;
+    uint32_t m_EntityCount = 0;
+    std::vector<Chunk> m_Chunks;
+  };
+
+  // Archetypes matching a query, extended incrementally as new archetypes appear.
+  struct QueryCache
+  {
+    ComponentMask Mask;
+    std::vector<Archetype*> Archetypes;
+    const std::vector<Archetype*>* AllArchetypes = nullptr;
+    size_t SeenArchetypes = 0;
+
+    // Only archetypes created since the last refresh need to be tested.
+    void Refresh()
+    {
+      for (; SeenArchetypes < AllArchetypes->size(); SeenArchetypes++)
+      {
+        Archetype* archetype = (*AllArchetypes)[SeenArchetypes];
+        if ((archetype->GetMask() & Mask) == Mask)
+          Archetypes.push_back(archetype);
+      }
+    }
+  };
+
+  template<typename... Ts>
+  class Query
+  {
+  public:
+    Query(QueryCache* cache)
+      : m_Cache(cache) {}
+
+    // fn(uint32_t count, const Entity* entities, Ts*... columns)
+    template<typename F>
+    void ForEachChunk(F&& fn) const
+    {
+      m_Cache->Refresh();
+      for (Archetype* archetype : m_Cache->Archetypes)
+      {
+        for (Chunk& chunk : archetype->GetChunks())
+          fn(chunk.Count, (const Entity*)archetype->GetEntities(chunk), archetype->template GetColumn<Ts>(chunk)...);
+      }
+    }
+
+    // fn(Ts&... components)
+    template<typename F>
+    void ForEach(F&& fn) const
+    {
+      ForEachChunk([&fn](uint32_t count, const Entity*, Ts*... columns)
+      {
+        for (uint32_t i = 0; i < count; i++)
+          fn(columns[i]...);
+      });
+    }
+
+    // Hands whole chunks to the worker threads. No structural changes allowed inside fn.
+    template<typename F>
+    void ParallelForEachChunk(F&& fn) const
+    {
+      m_Cache->Refresh();
+      std::vector<std::pair<Archetype*, Chunk*>> chunks;
+      for (Archetype* archetype : m_Cache->Archetypes)
+      {
+        for (Chunk& chunk : archetype->GetChunks())
+          chunks.emplace_back(archetype, &chunk);
+      }
+
+      ThreadPool::Get().ParallelFor((uint32_t)chunks.size(), 1, [&](uint32_t begin, uint32_t end)
+      {
+        for (uint32_t c = begin; c < end; c++)
+        {
+          auto [archetype, chunk] = chunks[c];
+          fn(chunk->Count, (const Entity*)archetype->GetEntities(*chunk), archetype->template GetColumn<Ts>(*chunk)...);
+        }
+      });
+    }
+
+    template<typename F>
+    void ParallelForEach(F&& fn) const
+    {
+      ParallelForEachChunk([&fn](uint32_t count, const Entity*, Ts*... columns)
+      {
+        for (uint32_t i = 0; i < count; i++)
+          fn(columns[i]...);
+      });
+    }
+
+    uint32_t GetEntityCount() const
+    {
+      m_Cache->Refresh();
+      uint32_t count = 0;
+      for (Archetype* archetype : m_Cache->Archetypes)
+        count += archetype->GetEntityCount();
+      return count;
+    }
+  private:
+    QueryCache* m_Cache;
+  };
+
+  class Registry
+  {
+  public:
+    // Sets up rows [row, row + count) of the chunk, which hold entities
+    // [first, first + count) of a CreateMany batch; their Entity slots are set.
+    using FillFn = std::function<void(Archetype& archetype, Chunk& chunk, uint32_t row, uint32_t first, uint32_t count)>;
+
+    Registry();
+    ~Registry();
+
+    Entity Create();
+    // Creates count entities with the given component set in one go, filling
+    // the archetype's chunks a run of rows at a time instead of moving each
+    // entity in through the empty archetype.
+    void CreateMany(const ComponentMask& mask, uint32_t count, const FillFn& fill);
+
+    template<typename... Ts>
+    Entity Create(const Ts&... components)
+    {
+      Entity entity = Create();
+      Archetype& archetype = GetOrCreateArchetype(MakeComponentMask<Ts...>());
+      MoveEntity(entity, archetype);
+      (Construct<Ts>(entity, components), ...);
+      return entity;
+    }
+
+    void Destroy(Entity entity);
+    bool IsAlive(Entity entity) const;
+
+    template<typename T>
+    T& Add(Entity entity, const T& component = T())
+    {
+      HZ_CORE_ASSERT(IsAlive(entity), "Entity is not alive!");
+      EntityRecord& record = m_Records[entity.Index];
+      ComponentMask mask = record.Owner->GetMask();
+      mask.set(GetComponentTypeID<T>());
+      if (mask != record.Owner->GetMask())
+        MoveEntity(entity, GetOrCreateArchetype(mask));
+
+      return Construct<T>(entity, component);
+    }
+
+    template<typename T>
+    void Remove(Entity entity)
+    {
+      HZ_CORE_ASSERT(IsAlive(entity), "Entity is not alive!");
+      EntityRecord& record = m_Records[entity.Index];
+      ComponentMask mask = record.Owner->GetMask();
+      mask.reset(GetComponentTypeID<T>());
+      if (mask != record.Owner->GetMask())
+        MoveEntity(entity, GetOrCreateArchetype(mask));
+    }
+
+    template<typename T>
+    bool Has(Entity entity) const
+    {
+      return IsAlive(entity) && m_Records[entity.Index].Owner->GetMask().test(GetComponentTypeID<T>());
+    }
+
+    template<typename T>
+    T& Get(Entity entity)
+    {
+      HZ_CORE_ASSERT(Has<T>(entity), "Entity does not have component!");
+      EntityRecord& record = m_Records[entity.Index];
+      Chunk& chunk = record.Owner->GetChunks()[record.ChunkIndex];
+      return record.Owner->GetColumn<T>(chunk)[record.Row];
+    }
+
+    // Queries are cached per component set and pick up new archetypes on their
+    // own, so they can be kept for the lifetime of the registry.
+    template<typename... Ts>
+    Query<Ts...> GetQuery()
+    {
+      return Query<Ts...>(GetQueryCache(MakeComponentMask<Ts...>()));
+    }
+
+    uint32_t GetEntityCount() const { return (uint32_t)(m_Records.size() - m_FreeIndices.size()); }
+    const std::vector<Archetype*>& GetArchetypes() const { return m_ArchetypeList; }
+  private:
+    struct EntityRecord
+    {
+      Archetype* Owner = nullptr;
+      uint32_t ChunkIndex = 0;
+      uint32_t Row = 0;
+      uint32_t Generation = 0;
+    };
+
+    template<typename T>
+    T& Construct(Entity entity, const T& component)
+    {
+      T& slot = Get<T>(entity);
+      slot = component;
+      return slot;
+    }
+
+    // A live index and generation whose record is not placed in an archetype yet.
+    Entity AllocateEntity();
+    Archetype& GetOrCreateArchetype(const ComponentMask& mask);
+    QueryCache* GetQueryCache(const ComponentMask& mask);
+    // Moves the entity into another archetype, carrying over shared components.
+    void MoveEntity(Entity entity, Archetype& destination);
+    void RemoveFromArchetype(const EntityRecord& record);
+  private:
+    std::unordered_map<ComponentMask, Scope<Archetype>> m_Archetypes;
+    std::vector<Archetype*> m_ArchetypeList;
+    std::unordered_map<ComponentMask, Scope<QueryCache>> m_Queries;
+
+    std::vector<EntityRecord> m_Records;
+    std::vector<uint32_t> m_FreeIndices;
+  };
+
+}
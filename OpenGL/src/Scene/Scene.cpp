@@ -0,0 +1,44 @@
+#include "Scene.h"
+
+namespace Hazel {
+
+  Entity Scene::CreateEntity(const glm::vec3& position, Entity parent)
+  {
+    TransformID parentTransform = parent.IsValid() ? GetTransform(parent) : NullTransform;
+    TransformID transform = m_Transforms.Create(parentTransform);
+    m_Transforms.SetLocalPosition(transform, position);
+
+    return m_Registry.Create(TransformComponent{ transform });
+  }
+
+  void Scene::DestroyEntity(Entity entity)
+  {
+    std::vector<TransformID> destroyed;
+    m_Transforms.Destroy(GetTransform(entity), &destroyed);
+    m_Registry.Destroy(entity);
+    if (destroyed.size() == 1)
+      return;
+
+    // The entities of the child transforms go with them. Only entities know
+    // their transform, so they are found by scanning, collected first since
+    // destroying moves entities around in their chunks.
+    std::unordered_set<TransformID> subtree(destroyed.begin(), destroyed.end());
+    std::vector<Entity> children;
+    m_Registry.GetQuery<TransformComponent>().ForEachChunk([&](uint32_t count, const Entity* entities, TransformComponent* transforms)
+    {
+      for (uint32_t i = 0; i < count; i++)
+      {
+        if (subtree.count(transforms[i].Transform))
+          children.push_back(entities[i]);
+      }
+    });
+    for (Entity child : children)
+      m_Registry.Destroy(child);
+  }
+
+  void Scene::OnUpdate()
+  {
+    m_Transforms.Update();
+  }
+
+}
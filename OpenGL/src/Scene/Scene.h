@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Registry.h"
+#include "Components.h"
+
+namespace Hazel {
+
+  class Scene
+  {
+  public:
+    // Creates an entity with a TransformComponent, optionally parented to another entity.
+    Entity CreateEntity(const glm::vec3& position = glm::vec3(0.0f), Entity parent = NullEntity);
+    // Also destroys the entity's transform, and its children with theirs.
+    void DestroyEntity(Entity entity);
+
+    void OnUpdate();
+
+    Registry& GetRegistry() { return m_Registry; }
+    TransformSystem& GetTransforms() { return m_Transforms; }
+
+    TransformID GetTransform(Entity entity) { return m_Registry.Get<TransformComponent>(entity).Transform; }
+  private:
+    Registry m_Registry;
+    TransformSystem m_Transforms;
+  };
+
+}
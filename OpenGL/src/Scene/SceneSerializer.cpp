@@ -0,0 +1,456 @@
+#include "SceneSerializer.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include "Core/FileSystem.h"
+#include "Core/VirtualFileSystem.h"
+
+namespace Hazel {
+
+  static_assert(sizeof(glm::vec3) == 12 && sizeof(glm::quat) == 16, "Transforms are saved as they are laid out!");
+
+  // A component field holding a GL name.
+  struct HandleField
+  {
+    ComponentTypeID Type;
+    uint32_t Offset;
+    SceneResourceType ResourceType;
+  };
+
+  static const std::vector<HandleField>& GetHandleFields()
+  {
+    static const std::vector<HandleField> s_Fields = []()
+    {
+      ComponentTypeID meshRenderer = GetComponentTypeID<MeshRendererComponent>();
+      uint32_t array = (uint32_t)offsetof(TextureRegion, Array);
+      return std::vector<HandleField>{
+        { meshRenderer, (uint32_t)offsetof(MeshRendererComponent, VertexArray), SceneResourceType::VertexArray },
+        { meshRenderer, (uint32_t)offsetof(MeshRendererComponent, DepthVertexArray), SceneResourceType::VertexArray },
+        { meshRenderer, (uint32_t)offsetof(MeshRendererComponent, DiffuseMap), SceneResourceType::Texture },
+        { meshRenderer, (uint32_t)offsetof(MeshRendererComponent, SpecularMap), SceneResourceType::Texture },
+        { meshRenderer, (uint32_t)offsetof(MeshRendererComponent, DiffuseRegion) + array, SceneResourceType::Texture },
+        { meshRenderer, (uint32_t)offsetof(MeshRendererComponent, SpecularRegion) + array, SceneResourceType::Texture }
+      };
+    }();
+    return s_Fields;
+  }
+
+  static size_t AlignUp(size_t value)
+  {
+    return (value + SceneFileAlignment - 1) / SceneFileAlignment * SceneFileAlignment;
+  }
+
+  static bool IsRangeInside(uint64_t offset, uint64_t size, uint64_t fileSize)
+  {
+    return offset <= fileSize && size <= fileSize - offset;
+  }
+
+  static uint32_t AddString(std::string& strings, const std::string& value)
+  {
+    uint32_t offset = (uint32_t)strings.size();
+    strings += value;
+    return offset;
+  }
+
+  // Rewrites a uint32_t field of count components, stride bytes apart, in place.
+  template<typename F>
+  static void Relocate(uint8_t* field, uint32_t count, uint32_t stride, F&& relocate)
+  {
+    for (uint32_t i = 0; i < count; i++, field += stride)
+    {
+      uint32_t value;
+      memcpy(&value, field, sizeof(value));
+      value = relocate(value);
+      memcpy(field, &value, sizeof(value));
+    }
+  }
+
+  std::vector<uint8_t> SceneSerializer::Serialize()
+  {
+    Registry& registry = m_Scene.GetRegistry();
+    TransformSystem& transforms = m_Scene.GetTransforms();
+    // Parents then precede their children and dense indices are the file's.
+    if (transforms.m_NeedsSort)
+      transforms.Sort();
+
+    // Only the component types some entity has make it into the file.
+    std::string strings;
+    std::vector<SceneFileComponentType> types;
+    std::array<uint32_t, MaxComponentTypes> fileTypes;
+    fileTypes.fill(~0u);
+    std::vector<Archetype*> archetypes;
+    std::vector<SceneFileArchetype> fileArchetypes;
+    std::vector<SceneFileColumn> columns;
+    uint64_t entityCount = 0;
+    for (Archetype* archetype : registry.GetArchetypes())
+    {
+      if (archetype->GetEntityCount() == 0)
+        continue;
+
+      SceneFileArchetype fileArchetype = { 0, archetype->GetEntityCount(), (uint32_t)columns.size() };
+      for (ComponentTypeID type : archetype->GetTypes())
+      {
+        if (fileTypes[type] == ~0u)
+        {
+          const ComponentInfo& info = GetComponentInfo(type);
+          fileTypes[type] = (uint32_t)types.size();
+          types.push_back({ AddString(strings, info.Name), (uint32_t)strlen(info.Name), info.Size, info.Alignment });
+        }
+        fileArchetype.Mask |= 1ull << fileTypes[type];
+        columns.push_back({ fileTypes[type], 0, 0 });
+      }
+      archetypes.push_back(archetype);
+      fileArchetypes.push_back(fileArchetype);
+      entityCount += archetype->GetEntityCount();
+    }
+
+    uint32_t transformCount = transforms.GetCount();
+    SceneFileHeader header = {};
+    header.Magic = SceneFileMagic;
+    header.Version = SceneFileVersion;
+    header.ComponentTypeCount = (uint32_t)types.size();
+    header.ArchetypeCount = (uint32_t)archetypes.size();
+    header.ColumnCount = (uint32_t)columns.size();
+    header.TransformCount = transformCount;
+    header.EntityCount = entityCount;
+
+    // Tables first, then every data section on its own alignment boundary.
+    size_t offset = sizeof(SceneFileHeader) + types.size() * sizeof(SceneFileComponentType)
+      + archetypes.size() * sizeof(SceneFileArchetype) + columns.size() * sizeof(SceneFileColumn);
+    header.ParentOffset = offset = AlignUp(offset);
+    offset += (size_t)transformCount * sizeof(uint32_t);
+    header.PositionOffset = offset = AlignUp(offset);
+    offset += (size_t)transformCount * sizeof(glm::vec3);
+    header.RotationOffset = offset = AlignUp(offset);
+    offset += (size_t)transformCount * sizeof(glm::quat);
+    header.ScaleOffset = offset = AlignUp(offset);
+    offset += (size_t)transformCount * sizeof(glm::vec3);
+    for (size_t a = 0; a < archetypes.size(); a++)
+    {
+      for (size_t c = 0; c < archetypes[a]->GetTypes().size(); c++)
+      {
+        SceneFileColumn& column = columns[fileArchetypes[a].FirstColumn + c];
+        column.Offset = offset = AlignUp(offset);
+        offset += (size_t)archetypes[a]->GetEntityCount() * types[column.Type].Size;
+      }
+    }
+
+    std::vector<uint8_t> file(offset, 0);
+    memcpy(file.data() + header.ParentOffset, transforms.m_Parent.data(), (size_t)transformCount * sizeof(uint32_t));
+    memcpy(file.data() + header.PositionOffset, transforms.m_LocalPosition.data(), (size_t)transformCount * sizeof(glm::vec3));
+    memcpy(file.data() + header.RotationOffset, transforms.m_LocalRotation.data(), (size_t)transformCount * sizeof(glm::quat));
+    memcpy(file.data() + header.ScaleOffset, transforms.m_LocalScale.data(), (size_t)transformCount * sizeof(glm::vec3));
+
+    // GL handles are named once each, as the copies below come across them.
+    bool named = m_Resources && m_Resources->GetName;
+    header.HandleEncoding = named ? SceneHandleEncoding::Named : SceneHandleEncoding::Raw;
+    std::vector<SceneFileResource> resources;
+    std::unordered_map<uint64_t, uint32_t> resourceIndices;
+    auto getResource = [&](SceneResourceType type, uint32_t handle) -> uint32_t
+    {
+      if (handle == 0)
+        return 0;
+
+      auto [it, inserted] = resourceIndices.try_emplace(((uint64_t)type << 32) | handle, 0);
+      if (inserted)
+      {
+        std::string name = m_Resources->GetName(type, handle);
+        if (!name.empty())
+        {
+          resources.push_back({ AddString(strings, name), (uint32_t)name.size(), type, 0 });
+          it->second = (uint32_t)resources.size();
+        }
+      }
+      return it->second;
+    };
+
+    ComponentTypeID transformType = GetComponentTypeID<TransformComponent>();
+    for (size_t a = 0; a < archetypes.size(); a++)
+    {
+      Archetype& archetype = *archetypes[a];
+      for (size_t c = 0; c < archetype.GetTypes().size(); c++)
+      {
+        ComponentTypeID type = archetype.GetTypes()[c];
+        uint32_t size = GetComponentInfo(type).Size;
+        uint8_t* column = file.data() + columns[fileArchetypes[a].FirstColumn + c].Offset;
+        uint8_t* end = column;
+        for (Chunk& chunk : archetype.GetChunks())
+        {
+          memcpy(end, archetype.GetColumn(chunk, type), (size_t)chunk.Count * size);
+          end += (size_t)chunk.Count * size;
+        }
+
+        uint32_t count = archetype.GetEntityCount();
+        if (type == transformType)
+        {
+          Relocate(column + offsetof(TransformComponent, Transform), count, size, [&](uint32_t id)
+          {
+            return id == NullTransform ? NullTransform : transforms.m_Sparse[id];
+          });
+        }
+        for (const HandleField& field : GetHandleFields())
+        {
+          if (named && field.Type == type)
+            Relocate(column + field.Offset, count, size, [&](uint32_t handle) { return getResource(field.ResourceType, handle); });
+        }
+      }
+    }
+
+    header.ResourceCount = (uint32_t)resources.size();
+    header.ResourceOffset = AlignUp(file.size());
+    header.StringsOffset = header.ResourceOffset + resources.size() * sizeof(SceneFileResource);
+    header.StringsSize = strings.size();
+    header.FileSize = header.StringsOffset + strings.size();
+    file.resize((size_t)header.FileSize, 0);
+    memcpy(file.data() + header.ResourceOffset, resources.data(), resources.size() * sizeof(SceneFileResource));
+    memcpy(file.data() + header.StringsOffset, strings.data(), strings.size());
+
+    uint8_t* tables = file.data();
+    memcpy(tables, &header, sizeof(header));
+    tables += sizeof(header);
+    memcpy(tables, types.data(), types.size() * sizeof(SceneFileComponentType));
+    tables += types.size() * sizeof(SceneFileComponentType);
+    memcpy(tables, fileArchetypes.data(), fileArchetypes.size() * sizeof(SceneFileArchetype));
+    tables += fileArchetypes.size() * sizeof(SceneFileArchetype);
+    memcpy(tables, columns.data(), columns.size() * sizeof(SceneFileColumn));
+    return file;
+  }
+
+  bool SceneSerializer::Serialize(const std::string& path, std::string& error)
+  {
+    std::vector<uint8_t> file = Serialize();
+    if (!WriteFile(path, file.data(), file.size()))
+    {
+      error = "could not write file";
+      return false;
+    }
+    return true;
+  }
+
+  bool SceneSerializer::Deserialize(const uint8_t* data, size_t size, std::string& error)
+  {
+    uint32_t magic = 0;
+    if (size >= sizeof(SceneFileHeader))
+      memcpy(&magic, data, sizeof(magic));
+    if (magic != SceneFileMagic)
+    {
+      error = "not a scene file";
+      return false;
+    }
+
+    // The header and tables are read in place; mappings and vector storage are aligned enough.
+    const SceneFileHeader& header = *(const SceneFileHeader*)data;
+    if (header.Version != SceneFileVersion)
+    {
+      error = "unsupported scene file version " + std::to_string(header.Version);
+      return false;
+    }
+    if (header.FileSize != size)
+    {
+      error = "truncated scene file";
+      return false;
+    }
+
+    uint64_t transformCount = header.TransformCount;
+    uint64_t tables = sizeof(SceneFileHeader) + (uint64_t)header.ComponentTypeCount * sizeof(SceneFileComponentType)
+      + (uint64_t)header.ArchetypeCount * sizeof(SceneFileArchetype) + (uint64_t)header.ColumnCount * sizeof(SceneFileColumn);
+    if (tables > size || header.ComponentTypeCount > MaxComponentTypes || header.HandleEncoding > SceneHandleEncoding::Named
+      || !IsRangeInside(header.ParentOffset, transformCount * sizeof(uint32_t), size)
+      || !IsRangeInside(header.PositionOffset, transformCount * sizeof(glm::vec3), size)
+      || !IsRangeInside(header.RotationOffset, transformCount * sizeof(glm::quat), size)
+      || !IsRangeInside(header.ScaleOffset, transformCount * sizeof(glm::vec3), size)
+      || !IsRangeInside(header.ResourceOffset, (uint64_t)header.ResourceCount * sizeof(SceneFileResource), size)
+      || !IsRangeInside(header.StringsOffset, header.StringsSize, size))
+    {
+      error = "scene file sections out of range";
+      return false;
+    }
+
+    const SceneFileComponentType* fileTypes = (const SceneFileComponentType*)(data + sizeof(SceneFileHeader));
+    const SceneFileArchetype* archetypes = (const SceneFileArchetype*)(fileTypes + header.ComponentTypeCount);
+    const SceneFileColumn* columns = (const SceneFileColumn*)(archetypes + header.ArchetypeCount);
+    const SceneFileResource* resources = (const SceneFileResource*)(data + header.ResourceOffset);
+    const char* strings = (const char*)(data + header.StringsOffset);
+    auto getString = [&](uint32_t offset, uint32_t length, std::string& value)
+    {
+      if (!IsRangeInside(offset, length, header.StringsSize))
+        return false;
+      value.assign(strings + offset, length);
+      return true;
+    };
+
+    // The engine's own components may not have been used by this run yet.
+    MakeComponentMask<TransformComponent, MeshRendererComponent, LightComponent, DirectionalLightComponent, BoundsComponent>();
+    std::vector<ComponentTypeID> types(header.ComponentTypeCount);
+    for (uint32_t i = 0; i < header.ComponentTypeCount; i++)
+    {
+      std::string name;
+      if (!getString(fileTypes[i].NameOffset, fileTypes[i].NameSize, name))
+      {
+        error = "bad component type";
+        return false;
+      }
+
+      types[i] = ~0u;
+      for (ComponentTypeID type = 0; type < GetComponentTypeCount(); type++)
+      {
+        if (name == GetComponentInfo(type).Name)
+          types[i] = type;
+      }
+      if (types[i] == ~0u)
+      {
+        error = "unknown component type " + name;
+        return false;
+      }
+      const ComponentInfo& info = GetComponentInfo(types[i]);
+      if (info.Size != fileTypes[i].Size || info.Alignment != fileTypes[i].Alignment)
+      {
+        error = "component type " + name + " changed layout";
+        return false;
+      }
+    }
+
+    // Parents precede their children, and whatever refers to a transform or
+    // a resource refers to one in the file.
+    const uint32_t* parents = (const uint32_t*)(data + header.ParentOffset);
+    for (uint32_t i = 0; i < header.TransformCount; i++)
+    {
+      if (parents[i] != NullTransform && parents[i] >= i)
+      {
+        error = "bad transform parent";
+        return false;
+      }
+    }
+
+    bool named = header.HandleEncoding == SceneHandleEncoding::Named;
+    ComponentTypeID transformType = GetComponentTypeID<TransformComponent>();
+    auto isColumnValid = [&](const uint8_t* column, uint32_t count, uint32_t stride, ComponentTypeID type)
+    {
+      bool valid = true;
+      auto check = [&](uint32_t offset, uint32_t limit, uint32_t none)
+      {
+        for (uint32_t i = 0; i < count; i++)
+        {
+          uint32_t value;
+          memcpy(&value, column + (size_t)i * stride + offset, sizeof(value));
+          valid &= value < limit || value == none;
+        }
+      };
+      if (type == transformType)
+        check((uint32_t)offsetof(TransformComponent, Transform), header.TransformCount, NullTransform);
+      for (const HandleField& field : GetHandleFields())
+      {
+        if (named && field.Type == type)
+          check(field.Offset, header.ResourceCount + 1, 0);
+      }
+      return valid;
+    };
+
+    uint64_t entityCount = 0;
+    for (uint32_t a = 0; a < header.ArchetypeCount; a++)
+    {
+      const SceneFileArchetype& archetype = archetypes[a];
+      uint32_t columnCount = (uint32_t)std::bitset<64>(archetype.Mask).count();
+      bool maskValid = header.ComponentTypeCount == 64 || (archetype.Mask >> header.ComponentTypeCount) == 0;
+      if (!maskValid || archetype.FirstColumn > header.ColumnCount || columnCount > header.ColumnCount - archetype.FirstColumn)
+      {
+        error = "bad archetype";
+        return false;
+      }
+
+      // Exactly one column per type of the mask.
+      uint64_t seen = 0;
+      for (uint32_t c = archetype.FirstColumn; c < archetype.FirstColumn + columnCount; c++)
+      {
+        const SceneFileColumn& column = columns[c];
+        uint64_t bit = column.Type < header.ComponentTypeCount ? 1ull << column.Type : 0;
+        uint32_t stride = bit ? fileTypes[column.Type].Size : 0;
+        if (!(archetype.Mask & bit) || (seen & bit) || !IsRangeInside(column.Offset, (uint64_t)archetype.EntityCount * stride, size)
+          || !isColumnValid(data + column.Offset, archetype.EntityCount, stride, types[column.Type]))
+        {
+          error = "bad component column";
+          return false;
+        }
+        seen |= bit;
+      }
+      entityCount += archetype.EntityCount;
+    }
+    if (entityCount != header.EntityCount)
+    {
+      error = "entity count mismatch";
+      return false;
+    }
+
+    std::vector<uint32_t> handles(header.ResourceCount + 1, 0);
+    bool resolve = m_Resources && m_Resources->Resolve;
+    for (uint32_t i = 0; i < header.ResourceCount; i++)
+    {
+      std::string name;
+      if (!getString(resources[i].NameOffset, resources[i].NameSize, name))
+      {
+        error = "bad resource";
+        return false;
+      }
+      if (resolve)
+        handles[i + 1] = m_Resources->Resolve(resources[i].Type, name);
+    }
+    if (header.ResourceCount > 0 && !resolve)
+      HZ_HAZEL_WARN("Scene file names {0} resources but nothing resolves them", header.ResourceCount);
+
+    // Everything checks out: the transforms go in as a batch, then every
+    // archetype a chunk's worth of rows at a time.
+    std::vector<TransformID> ids(header.TransformCount);
+    m_Scene.GetTransforms().CreateMany(header.TransformCount, parents, (const glm::vec3*)(data + header.PositionOffset),
+      (const glm::quat*)(data + header.RotationOffset), (const glm::vec3*)(data + header.ScaleOffset), ids.data());
+
+    Registry& registry = m_Scene.GetRegistry();
+    for (uint32_t a = 0; a < header.ArchetypeCount; a++)
+    {
+      const SceneFileArchetype& archetype = archetypes[a];
+      const SceneFileColumn* archetypeColumns = columns + archetype.FirstColumn;
+      uint32_t columnCount = (uint32_t)std::bitset<64>(archetype.Mask).count();
+      ComponentMask mask;
+      for (uint32_t c = 0; c < columnCount; c++)
+        mask.set(types[archetypeColumns[c].Type]);
+
+      registry.CreateMany(mask, archetype.EntityCount, [&](Archetype& target, Chunk& chunk, uint32_t row, uint32_t first, uint32_t count)
+      {
+        for (uint32_t c = 0; c < columnCount; c++)
+        {
+          const SceneFileColumn& column = archetypeColumns[c];
+          ComponentTypeID type = types[column.Type];
+          uint32_t stride = fileTypes[column.Type].Size;
+          uint8_t* destination = (uint8_t*)target.GetColumn(chunk, type) + (size_t)row * stride;
+          memcpy(destination, data + column.Offset + (size_t)first * stride, (size_t)count * stride);
+
+          if (type == transformType)
+          {
+            Relocate(destination + offsetof(TransformComponent, Transform), count, stride, [&](uint32_t index)
+            {
+              return index == NullTransform ? NullTransform : ids[index];
+            });
+          }
+          for (const HandleField& field : GetHandleFields())
+          {
+            if (named && field.Type == type)
+              Relocate(destination + field.Offset, count, stride, [&](uint32_t index) { return handles[index]; });
+          }
+        }
+      });
+    }
+    return true;
+  }
+
+  bool SceneSerializer::Deserialize(const std::string& path, std::string& error)
+  {
+    VfsFile file;
+    if (!VirtualFileSystem::Get().Open(path, file))
+    {
+      error = "could not open file";
+      return false;
+    }
+    return Deserialize(file.GetData(), file.GetSize(), error);
+  }
+
+}
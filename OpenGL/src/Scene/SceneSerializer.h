@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Scene.h"
+
+namespace Hazel {
+
+  // Hazel's binary scene (.hzscene): a fixed header, tables of component
+  // types, archetypes and columns, then the transforms and every archetype's
+  // component columns, each one contiguous array aligned to
+  // SceneFileAlignment, and last the resource table and the strings. Nothing
+  // in the file is a pointer: transforms refer to their parents and
+  // TransformComponents to their transforms by index into the transform
+  // arrays, names are offsets into the string table, so the file is read in
+  // place from a mapping and a load is a validation pass plus one bulk copy
+  // per column and chunk.
+  //
+  // Components are stored as they are laid out in memory and types are
+  // matched by the compiler's name for them, so a file is only good for
+  // builds with the same component layouts.
+
+  constexpr uint32_t SceneFileMagic = 0x43535A48; // "HZSC"
+  constexpr uint32_t SceneFileVersion = 1;
+  constexpr uint32_t SceneFileAlignment = 64;
+
+  // What the GL handles in components (mesh vertex arrays and material maps) hold.
+  enum class SceneHandleEncoding : uint32_t
+  {
+    // The GL names of the process that saved the scene.
+    Raw = 0,
+    // 1 + an index into the resource table; 0 for none.
+    Named = 1
+  };
+
+  enum class SceneResourceType : uint32_t
+  {
+    VertexArray = 0,
+    Texture = 1
+  };
+
+  struct SceneFileHeader
+  {
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t ComponentTypeCount;
+    uint32_t ArchetypeCount;
+    uint32_t ColumnCount;
+    uint32_t ResourceCount;
+    uint32_t TransformCount;
+    SceneHandleEncoding HandleEncoding;
+    uint64_t EntityCount;
+    // The transforms, structure-of-arrays, parents before children: uint32
+    // parent index (~0u for roots), float3 position, float4 rotation
+    // (x, y, z, w) and float3 scale.
+    uint64_t ParentOffset;
+    uint64_t PositionOffset;
+    uint64_t RotationOffset;
+    uint64_t ScaleOffset;
+    uint64_t ResourceOffset;
+    uint64_t StringsOffset;
+    uint64_t StringsSize;
+    // Of the whole file, to catch truncation.
+    uint64_t FileSize;
+  };
+
+  struct SceneFileComponentType
+  {
+    // In the string table.
+    uint32_t NameOffset;
+    uint32_t NameSize;
+    uint32_t Size;
+    uint32_t Alignment;
+  };
+
+  struct SceneFileArchetype
+  {
+    // Bit i for component type i of the file.
+    uint64_t Mask;
+    uint32_t EntityCount;
+    // One column per type in the mask.
+    uint32_t FirstColumn;
+  };
+
+  struct SceneFileColumn
+  {
+    uint32_t Type;
+    uint32_t Reserved;
+    // EntityCount components of the type's size.
+    uint64_t Offset;
+  };
+
+  struct SceneFileResource
+  {
+    uint32_t NameOffset;
+    uint32_t NameSize;
+    SceneResourceType Type;
+    uint32_t Reserved;
+  };
+
+  static_assert(sizeof(SceneFileHeader) == 104 && sizeof(SceneFileComponentType) == 16 && sizeof(SceneFileArchetype) == 16
+    && sizeof(SceneFileColumn) == 16 && sizeof(SceneFileResource) == 16, "Scene file structures must match the on-disk layout!");
+
+  // Names for the GL objects components refer to, so that a scene saved by
+  // one run can be loaded by another, e.g. a mesh's path for its vertex array.
+  struct SceneResources
+  {
+    // Saving: empty stores the handle as none.
+    std::function<std::string(SceneResourceType type, uint32_t handle)> GetName;
+    // Loading: 0 for names it does not know.
+    std::function<uint32_t(SceneResourceType type, const std::string& name)> Resolve;
+  };
+
+  // Saves a scene's entities and transforms to a scene file and adds those of
+  // a scene file to a scene. Without resources GL handles are saved as they
+  // are, which only holds up within the process that saved them.
+  class SceneSerializer
+  {
+  public:
+    explicit SceneSerializer(Scene& scene, const SceneResources* resources = nullptr)
+      : m_Scene(scene), m_Resources(resources) {}
+
+    std::vector<uint8_t> Serialize();
+    bool Serialize(const std::string& path, std::string& error);
+
+    // The whole file is checked before anything is created, so a bad file
+    // leaves the scene as it was. Entities get new ids.
+    bool Deserialize(const uint8_t* data, size_t size, std::string& error);
+    // Resolved and mapped through the VirtualFileSystem.
+    bool Deserialize(const std::string& path, std::string& error);
+  private:
+    Scene& m_Scene;
+    const SceneResources* m_Resources;
+  };
+
+}
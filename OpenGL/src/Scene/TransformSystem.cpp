@@ -0,0 +1,292 @@
+#include "TransformSystem.h"
+
+#include "Core/ThreadPool.h"
+
+namespace Hazel {
+
+  static constexpr uint32_t NoParent = ~0u;
+  static constexpr uint32_t TransformChunkSize = 256;
+
+  TransformID TransformSystem::Create(TransformID parent)
+  {
+    TransformID id;
+    if (!m_FreeIDs.empty())
+    {
+      id = m_FreeIDs.back();
+      m_FreeIDs.pop_back();
+    }
+    else
+    {
+      id = (TransformID)m_Sparse.size();
+      m_Sparse.push_back(0);
+    }
+
+    uint32_t index = (uint32_t)m_Dense.size();
+    uint32_t parentIndex = parent == NullTransform ? NoParent : m_Sparse[parent];
+    uint32_t depth = parentIndex == NoParent ? 0 : m_Depth[parentIndex] + 1;
+
+    // Appending keeps parent-before-child, but may break the depth ordering.
+    uint32_t lastDepth = index == 0 ? 0 : m_Depth.back();
+    if (index == 0 || depth > lastDepth)
+      m_LevelOffsets.push_back(index);
+    else if (depth < lastDepth)
+      m_NeedsSort = true;
+
+    m_Sparse[id] = index;
+    m_Dense.push_back(id);
+    m_Parent.push_back(parentIndex);
+    m_Depth.push_back(depth);
+    m_LocalPosition.emplace_back(0.0f);
+    m_LocalRotation.emplace_back(1.0f, 0.0f, 0.0f, 0.0f);
+    m_LocalScale.emplace_back(1.0f);
+    m_Dirty.push_back(1);
+    m_World.emplace_back(1.0f);
+    m_Normal.emplace_back(1.0f);
+
+    return id;
+  }
+
+  void TransformSystem::CreateMany(uint32_t count, const uint32_t* parents, const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, TransformID* ids)
+  {
+    uint32_t base = GetCount();
+    m_LocalPosition.insert(m_LocalPosition.end(), positions, positions + count);
+    m_LocalRotation.insert(m_LocalRotation.end(), rotations, rotations + count);
+    m_LocalScale.insert(m_LocalScale.end(), scales, scales + count);
+    m_Dirty.resize(base + count, 1);
+    m_World.resize(base + count, glm::mat4(1.0f));
+    m_Normal.resize(base + count, glm::mat3(1.0f));
+    m_Dense.resize(base + count);
+    m_Parent.resize(base + count);
+    m_Depth.resize(base + count);
+    m_Sparse.reserve(m_Sparse.size() + count - std::min((size_t)count, m_FreeIDs.size()));
+
+    bool sorted = true;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      TransformID id;
+      if (!m_FreeIDs.empty())
+      {
+        id = m_FreeIDs.back();
+        m_FreeIDs.pop_back();
+      }
+      else
+      {
+        id = (TransformID)m_Sparse.size();
+        m_Sparse.push_back(0);
+      }
+
+      HZ_CORE_ASSERT(parents[i] == NullTransform || parents[i] < i, "A parent must precede its children!");
+      uint32_t index = base + i;
+      uint32_t parentIndex = parents[i] == NullTransform ? NoParent : base + parents[i];
+      m_Sparse[id] = index;
+      m_Dense[index] = id;
+      m_Parent[index] = parentIndex;
+      m_Depth[index] = parentIndex == NoParent ? 0 : m_Depth[parentIndex] + 1;
+      sorted &= index == 0 || m_Depth[index] >= m_Depth[index - 1];
+      ids[i] = id;
+    }
+
+    // Batches already in depth order, as saved scenes are, only need their levels found.
+    if (sorted)
+      RebuildLevels();
+    else
+      m_NeedsSort = true;
+  }
+
+  void TransformSystem::Destroy(TransformID id, std::vector<TransformID>* destroyed)
+  {
+    if (m_NeedsSort)
+      Sort();
+
+    // Descendants always follow their ancestors, so one forward scan finds the subtree.
+    uint32_t count = GetCount();
+    std::vector<uint8_t> removed(count, 0);
+    removed[m_Sparse[id]] = 1;
+    for (uint32_t i = m_Sparse[id] + 1; i < count; i++)
+    {
+      if (m_Parent[i] != NoParent && removed[m_Parent[i]])
+        removed[i] = 1;
+    }
+
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+      if (removed[i])
+      {
+        m_FreeIDs.push_back(m_Dense[i]);
+        if (destroyed)
+          destroyed->push_back(m_Dense[i]);
+      }
+      else
+        order.push_back(i);
+    }
+
+    Reorder(order);
+    RebuildLevels();
+  }
+
+  void TransformSystem::SetParent(TransformID id, TransformID parent)
+  {
+    uint32_t index = m_Sparse[id];
+    uint32_t parentIndex = parent == NullTransform ? NoParent : m_Sparse[parent];
+
+    for (uint32_t p = parentIndex; p != NoParent; p = m_Parent[p])
+      HZ_CORE_ASSERT(p != index, "Cannot parent a transform to its own descendant!");
+
+    m_Parent[index] = parentIndex;
+    MarkDirty(index);
+    m_NeedsSort = true;
+  }
+
+  void TransformSystem::SetLocalPosition(TransformID id, const glm::vec3& position)
+  {
+    uint32_t index = m_Sparse[id];
+    m_LocalPosition[index] = position;
+    MarkDirty(index);
+  }
+
+  void TransformSystem::SetLocalRotation(TransformID id, const glm::quat& rotation)
+  {
+    uint32_t index = m_Sparse[id];
+    m_LocalRotation[index] = rotation;
+    MarkDirty(index);
+  }
+
+  void TransformSystem::SetLocalScale(TransformID id, const glm::vec3& scale)
+  {
+    uint32_t index = m_Sparse[id];
+    m_LocalScale[index] = scale;
+    MarkDirty(index);
+  }
+
+  void TransformSystem::Update()
+  {
+    if (m_NeedsSort)
+      Sort();
+
+    // Parents precede children, so a single forward pass propagates dirtiness.
+    uint32_t count = GetCount();
+    for (uint32_t i = 0; i < count; i++)
+    {
+      uint32_t parent = m_Parent[i];
+      if (parent != NoParent)
+        m_Dirty[i] |= m_Dirty[parent];
+    }
+
+    std::atomic<uint32_t> updated{ 0 };
+    for (size_t level = 0; level < m_LevelOffsets.size(); level++)
+    {
+      uint32_t levelBegin = m_LevelOffsets[level];
+      uint32_t levelEnd = level + 1 < m_LevelOffsets.size() ? m_LevelOffsets[level + 1] : count;
+
+      // Every parent of this level was finished by the previous one.
+      ThreadPool::Get().ParallelFor(levelEnd - levelBegin, TransformChunkSize, [&](uint32_t begin, uint32_t end)
+      {
+        uint32_t chunkUpdated = 0;
+        for (uint32_t i = levelBegin + begin; i < levelBegin + end; i++)
+        {
+          if (!m_Dirty[i])
+            continue;
+
+          glm::mat3 rotation = glm::mat3_cast(m_LocalRotation[i]);
+          const glm::vec3& scale = m_LocalScale[i];
+          glm::mat4 local(
+            glm::vec4(rotation[0] * scale.x, 0.0f),
+            glm::vec4(rotation[1] * scale.y, 0.0f),
+            glm::vec4(rotation[2] * scale.z, 0.0f),
+            glm::vec4(m_LocalPosition[i], 1.0f));
+
+          uint32_t parent = m_Parent[i];
+          m_World[i] = parent == NoParent ? local : m_World[parent] * local;
+          m_Normal[i] = glm::transpose(glm::inverse(glm::mat3(m_World[i])));
+          chunkUpdated++;
+        }
+        updated.fetch_add(chunkUpdated, std::memory_order_relaxed);
+      });
+    }
+
+    std::fill(m_Dirty.begin(), m_Dirty.end(), 0);
+    m_UpdatedCount = updated.load();
+  }
+
+  void TransformSystem::Sort()
+  {
+    uint32_t count = GetCount();
+
+    // Reparenting may have put a parent after its child, so resolve depths by walking up.
+    std::vector<uint32_t> depth(count, NoParent);
+    std::vector<uint32_t> chain;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      uint32_t node = i;
+      while (node != NoParent && depth[node] == NoParent)
+      {
+        chain.push_back(node);
+        node = m_Parent[node];
+      }
+
+      uint32_t d = node == NoParent ? 0 : depth[node] + 1;
+      while (!chain.empty())
+      {
+        depth[chain.back()] = d++;
+        chain.pop_back();
+      }
+    }
+    m_Depth = std::move(depth);
+
+    std::vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < count; i++)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return m_Depth[a] < m_Depth[b]; });
+
+    Reorder(order);
+    RebuildLevels();
+    m_NeedsSort = false;
+  }
+
+  template<typename T>
+  static void Gather(std::vector<T>& values, const std::vector<uint32_t>& order)
+  {
+    std::vector<T> result;
+    result.reserve(order.size());
+    for (uint32_t oldIndex : order)
+      result.push_back(values[oldIndex]);
+    values = std::move(result);
+  }
+
+  void TransformSystem::Reorder(const std::vector<uint32_t>& order)
+  {
+    std::vector<uint32_t> newIndex(GetCount(), NoParent);
+    for (uint32_t i = 0; i < (uint32_t)order.size(); i++)
+      newIndex[order[i]] = i;
+
+    Gather(m_Dense, order);
+    Gather(m_Parent, order);
+    Gather(m_Depth, order);
+    Gather(m_LocalPosition, order);
+    Gather(m_LocalRotation, order);
+    Gather(m_LocalScale, order);
+    Gather(m_Dirty, order);
+    Gather(m_World, order);
+    Gather(m_Normal, order);
+
+    for (uint32_t i = 0; i < (uint32_t)m_Dense.size(); i++)
+    {
+      if (m_Parent[i] != NoParent)
+        m_Parent[i] = newIndex[m_Parent[i]];
+      m_Sparse[m_Dense[i]] = i;
+    }
+  }
+
+  void TransformSystem::RebuildLevels()
+  {
+    m_LevelOffsets.clear();
+    for (uint32_t i = 0; i < GetCount(); i++)
+    {
+      if (i == 0 || m_Depth[i] != m_Depth[i - 1])
+        m_LevelOffsets.push_back(i);
+    }
+  }
+
+}
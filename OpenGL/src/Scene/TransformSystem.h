@@ -0,0 +1,75 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace Hazel {
+
+  using TransformID = uint32_t;
+  constexpr TransformID NullTransform = ~0u;
+
+  // Local TRS for every transform, stored structure-of-arrays and kept sorted
+  // by hierarchy depth so that a parent always precedes its children. World and
+  // normal matrices are only recomputed for dirty subtrees.
+  class TransformSystem
+  {
+  public:
+    TransformID Create(TransformID parent = NullTransform);
+    // Appends count transforms in one go, e.g. from a scene file, and writes
+    // their ids to ids. parents[i] is the index within the batch of i's
+    // parent, which must come before i, or NullTransform for a root.
+    void CreateMany(uint32_t count, const uint32_t* parents, const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, TransformID* ids);
+    // Destroys the transform and its descendants; their ids are added to destroyed, if given.
+    void Destroy(TransformID id, std::vector<TransformID>* destroyed = nullptr);
+
+    void SetParent(TransformID id, TransformID parent);
+    void SetLocalPosition(TransformID id, const glm::vec3& position);
+    void SetLocalRotation(TransformID id, const glm::quat& rotation);
+    void SetLocalScale(TransformID id, const glm::vec3& scale);
+
+    const glm::vec3& GetLocalPosition(TransformID id) const { return m_LocalPosition[m_Sparse[id]]; }
+    const glm::quat& GetLocalRotation(TransformID id) const { return m_LocalRotation[m_Sparse[id]]; }
+    const glm::vec3& GetLocalScale(TransformID id) const { return m_LocalScale[m_Sparse[id]]; }
+
+    const glm::mat4& GetWorldMatrix(TransformID id) const { return m_World[m_Sparse[id]]; }
+    const glm::mat3& GetNormalMatrix(TransformID id) const { return m_Normal[m_Sparse[id]]; }
+
+    // Propagates dirty flags down the hierarchy and rebuilds world and normal
+    // matrices, one depth level at a time, in parallel chunks.
+    void Update();
+
+    uint32_t GetCount() const { return (uint32_t)m_Dense.size(); }
+    // Number of transforms recomputed by the last Update().
+    uint32_t GetUpdatedCount() const { return m_UpdatedCount; }
+  private:
+    void MarkDirty(uint32_t index) { m_Dirty[index] = 1; }
+    void Sort();
+    // Rebuilds every array as order[newIndex] = oldIndex, dropping the rest.
+    void Reorder(const std::vector<uint32_t>& order);
+    void RebuildLevels();
+  private:
+    // Dense, depth-sorted arrays.
+    std::vector<TransformID> m_Dense;
+    std::vector<uint32_t> m_Parent;   // dense index of the parent, or ~0u
+    std::vector<uint32_t> m_Depth;
+    std::vector<glm::vec3> m_LocalPosition;
+    std::vector<glm::quat> m_LocalRotation;
+    std::vector<glm::vec3> m_LocalScale;
+    std::vector<uint8_t> m_Dirty;
+    std::vector<glm::mat4> m_World;
+    std::vector<glm::mat3> m_Normal;
+
+    // Stable ids to dense indices.
+    std::vector<uint32_t> m_Sparse;
+    std::vector<TransformID> m_FreeIDs;
+
+    // m_LevelOffsets[d] is the first dense index at depth d.
+    std::vector<uint32_t> m_LevelOffsets;
+    bool m_NeedsSort = false;
+    uint32_t m_UpdatedCount = 0;
+
+    // Saves the dense arrays as they are.
+    friend class SceneSerializer;
+  };
+
+}
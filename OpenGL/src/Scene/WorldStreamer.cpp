@@ -0,0 +1,286 @@
+#include "WorldStreamer.h"
+
+#include "Core/RenderThread.h"
+#include "Core/ThreadPool.h"
+#include "Renderer/TextureLoader.h"
+#include "Renderer/TextureStreamer.h"
+#include "Renderer/UploadScheduler.h"
+
+namespace Hazel {
+
+  WorldStreamer::WorldStreamer(Scene& scene, TextureLoader& loader, UploadScheduler& uploads, CellProvider provider, TextureStreamer* textureStreamer)
+    : m_Scene(scene), m_Loader(loader), m_Uploads(uploads), m_TextureStreamer(textureStreamer), m_Provider(std::move(provider))
+  {
+  }
+
+  WorldStreamer::~WorldStreamer()
+  {
+    for (auto& [path, load] : m_MeshLoads)
+      load->Cancellation.Cancel();
+    for (auto& [key, cell] : m_Cells)
+    {
+      cell.Cancellation.Cancel();
+      RenderThread::Get().Wait(cell.Load, [this]() { m_Uploads.Update(); });
+      Unload(cell);
+    }
+  }
+
+  bool WorldStreamer::IsResident(CellCoord cell) const
+  {
+    auto it = m_Cells.find(GetKey(cell));
+    return it != m_Cells.end() && it->second.Resident;
+  }
+
+  float WorldStreamer::GetDistance(CellCoord cell, const glm::vec3& position) const
+  {
+    glm::vec2 min(cell.X * m_Settings.CellSize, cell.Z * m_Settings.CellSize);
+    glm::vec2 point(position.x, position.z);
+    return glm::length(point - glm::clamp(point, min, min + glm::vec2(m_Settings.CellSize)));
+  }
+
+  Ref<Texture2D> WorldStreamer::GetTexture(const std::string& path, TextureUsage usage)
+  {
+    std::weak_ptr<Texture2D>& cached = m_Textures[path + '|' + std::to_string((int)usage)];
+    if (Ref<Texture2D> texture = cached.lock())
+      return texture;
+
+    // Masks read as nothing until they arrive.
+    glm::vec4 placeholder = usage == TextureUsage::Mask ? glm::vec4(0.0f, 0.0f, 0.0f, 1.0f) : glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);
+    Ref<Texture2D> texture = CreateRef<Texture2D>(path, usage, placeholder);
+    if (m_TextureStreamer)
+      m_TextureStreamer->Load(texture, path);
+    else
+      m_Loader.Load(texture, path);
+    cached = texture;
+    return texture;
+  }
+
+  Task<> WorldStreamer::LoadCell(CellCoord coord, Cell& cell)
+  {
+    CancellationToken cancellation = cell.Cancellation;
+    co_await ThreadPool::Get().Schedule();
+    if (cancellation.IsCancelled())
+      co_return;
+
+    CellDesc desc;
+    m_Provider(coord, desc);
+
+    // Meshes some other cell holds or is loading are shared; the rest load
+    // side by side.
+    co_await RenderThread::Get().Schedule();
+    std::unordered_map<std::string, Ref<Mesh>> meshes;
+    std::vector<std::pair<std::string, Ref<MeshLoad>>> loads;
+    for (const CellObject& object : desc.Objects)
+    {
+      if (meshes.count(object.Mesh))
+        continue;
+
+      auto it = m_Meshes.find(object.Mesh);
+      Ref<Mesh> mesh = it != m_Meshes.end() ? it->second.lock() : nullptr;
+      if (!mesh)
+      {
+        Ref<MeshLoad>& load = m_MeshLoads[object.Mesh];
+        if (!load)
+        {
+          load = CreateRef<MeshLoad>();
+          load->Load = LoadMesh(object.Mesh, *load);
+          load->Load.Start();
+        }
+        load->Cells.push_back(cancellation);
+        loads.push_back({ object.Mesh, load });
+      }
+      meshes[object.Mesh] = mesh;
+    }
+
+    // Every load is already running, so waiting on them in turn takes as
+    // long as the slowest.
+    for (auto& [path, load] : loads)
+      co_await *load;
+    if (cancellation.IsCancelled())
+      co_return;
+
+    // Failures were logged by the load; their objects are left out.
+    for (auto& [path, load] : loads)
+      meshes[path] = load->Result;
+
+    Registry& registry = m_Scene.GetRegistry();
+    glm::vec3 origin(coord.X * m_Settings.CellSize, 0.0f, coord.Z * m_Settings.CellSize);
+    auto getMap = [&](const std::string& path, TextureUsage usage) -> uint32_t
+    {
+      if (path.empty())
+        return 0;
+
+      Ref<Texture2D> texture = GetTexture(path, usage);
+      if (std::find(cell.Textures.begin(), cell.Textures.end(), texture) == cell.Textures.end())
+        cell.Textures.push_back(texture);
+      return texture->GetRendererID();
+    };
+
+    for (const CellObject& object : desc.Objects)
+    {
+      const Ref<Mesh>& mesh = meshes[object.Mesh];
+      if (!mesh)
+        continue;
+
+      // Nothing in a cell moves, so it may go into the cached shadow cascades.
+      MeshRendererComponent component;
+      mesh->SetGeometry(component);
+      component.DiffuseMap = getMap(object.DiffuseMap, TextureUsage::Color);
+      component.SpecularMap = getMap(object.SpecularMap, TextureUsage::Mask);
+      component.Shininess = object.Shininess;
+      component.Static = true;
+
+      Entity entity = m_Scene.CreateEntity(origin + object.Position);
+      m_Scene.GetTransforms().SetLocalScale(m_Scene.GetTransform(entity), object.Scale);
+      registry.Add(entity, component);
+      registry.Add(entity, mesh->GetBounds());
+      cell.Entities.push_back(entity);
+    }
+    for (auto& [path, mesh] : meshes)
+    {
+      if (mesh)
+        cell.Meshes.push_back(mesh);
+    }
+
+    cell.Resident = true;
+    float loadMs = cell.LoadTimer.ElapsedMillis();
+    m_Stats.Loaded++;
+    m_Stats.LoadMsLast = loadMs;
+    m_Stats.LoadMsMax = std::max(m_Stats.LoadMsMax, loadMs);
+    m_LoadMsTotal += loadMs;
+    m_Stats.LoadMsAverage = m_LoadMsTotal / m_Stats.Loaded;
+  }
+
+  Task<> WorldStreamer::LoadMesh(std::string path, MeshLoad& load)
+  {
+    Ref<Mesh> mesh = co_await Mesh::LoadAsync(path, load.Cancellation, &m_Uploads);
+
+    // Loads that fail or are cancelled finish on a worker.
+    co_await RenderThread::Get().Schedule();
+    if (mesh)
+      m_Meshes[path] = mesh;
+    load.Result = std::move(mesh);
+    load.Done = true;
+    for (std::coroutine_handle<> waiter : load.Waiters)
+      RenderThread::Get().Post([waiter]() { waiter.resume(); });
+    load.Waiters.clear();
+  }
+
+  void WorldStreamer::Unload(Cell& cell)
+  {
+    for (Entity entity : cell.Entities)
+      m_Scene.DestroyEntity(entity);
+    cell.Entities.clear();
+    cell.Meshes.clear();
+    cell.Textures.clear();
+    cell.Resident = false;
+  }
+
+  void WorldStreamer::Update(const glm::vec3& position, const glm::vec3& forward)
+  {
+    Timer timer;
+
+    // Out of range: resident cells go now, loads are called off and go once
+    // they have stopped.
+    bool unloaded = false;
+    uint32_t loading = 0;
+    for (auto it = m_Cells.begin(); it != m_Cells.end();)
+    {
+      Cell& cell = it->second;
+      if (!cell.Resident && cell.Load.IsReady())
+      {
+        it = m_Cells.erase(it);
+        continue;
+      }
+
+      if (GetDistance(GetCoord(it->first), position) > m_Settings.UnloadRadius)
+      {
+        if (cell.Resident)
+        {
+          Unload(cell);
+          m_Stats.Unloaded++;
+          unloaded = true;
+          it = m_Cells.erase(it);
+          continue;
+        }
+        if (!cell.Cancellation.IsCancelled())
+        {
+          cell.Cancellation.Cancel();
+          m_Stats.Cancelled++;
+        }
+      }
+      loading += !cell.Resident;
+      ++it;
+    }
+
+    // Finished mesh loads go; loads every waiting cell has called off are
+    // called off too and left to the cells, which wait for them to stop.
+    for (auto it = m_MeshLoads.begin(); it != m_MeshLoads.end();)
+    {
+      MeshLoad& load = *it->second;
+      bool wanted = std::any_of(load.Cells.begin(), load.Cells.end(), [](const CancellationToken& cell) { return !cell.IsCancelled(); });
+      if (!load.Done && wanted)
+      {
+        ++it;
+        continue;
+      }
+      load.Cancellation.Cancel();
+      it = m_MeshLoads.erase(it);
+    }
+
+    if (unloaded)
+    {
+      for (auto it = m_Meshes.begin(); it != m_Meshes.end();)
+        it = it->second.expired() ? m_Meshes.erase(it) : std::next(it);
+      for (auto it = m_Textures.begin(); it != m_Textures.end();)
+        it = it->second.expired() ? m_Textures.erase(it) : std::next(it);
+    }
+
+    // Cells in range that are not there yet, nearest first, discounted by
+    // how far they are off the view direction.
+    float size = m_Settings.CellSize, radius = m_Settings.LoadRadius;
+    glm::vec2 ahead(forward.x, forward.z);
+    if (glm::length(ahead) > 0.0f)
+      ahead = glm::normalize(ahead);
+
+    std::vector<std::pair<float, CellCoord>> wanted;
+    int32_t minX = (int32_t)std::floor((position.x - radius) / size), maxX = (int32_t)std::floor((position.x + radius) / size);
+    int32_t minZ = (int32_t)std::floor((position.z - radius) / size), maxZ = (int32_t)std::floor((position.z + radius) / size);
+    for (int32_t z = minZ; z <= maxZ; z++)
+    {
+      for (int32_t x = minX; x <= maxX; x++)
+      {
+        CellCoord cell{ x, z };
+        float distance = GetDistance(cell, position);
+        if (distance > radius || m_Cells.count(GetKey(cell)))
+          continue;
+
+        glm::vec2 toCell((x + 0.5f) * size - position.x, (z + 0.5f) * size - position.z);
+        float facing = glm::length(toCell) > 0.0f ? glm::dot(glm::normalize(toCell), ahead) : 1.0f;
+        wanted.push_back({ distance * (1.0f + m_Settings.ViewWeight * (1.0f - facing)), cell });
+      }
+    }
+
+    size_t count = std::min(wanted.size(), (size_t)(m_Settings.MaxLoadsInFlight - std::min(loading, m_Settings.MaxLoadsInFlight)));
+    std::partial_sort(wanted.begin(), wanted.begin() + count, wanted.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (size_t i = 0; i < count; i++)
+    {
+      CellCoord coord = wanted[i].second;
+      Cell& cell = m_Cells[GetKey(coord)];
+      cell.Load = LoadCell(coord, cell);
+      cell.Load.Start();
+    }
+
+    m_Stats.ResidentCells = 0;
+    m_Stats.Entities = 0;
+    for (auto& [key, cell] : m_Cells)
+    {
+      m_Stats.ResidentCells += cell.Resident;
+      m_Stats.Entities += (uint32_t)cell.Entities.size();
+    }
+    m_Stats.LoadingCells = (uint32_t)m_Cells.size() - m_Stats.ResidentCells;
+    m_Stats.QueuedCells = (uint32_t)(wanted.size() - count);
+    m_Stats.UpdateMs = timer.ElapsedMillis();
+  }
+
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Scene.h"
+#include "Core/Task.h"
+#include "Core/Timer.h"
+#include "Renderer/Mesh.h"
+#include "Renderer/Texture.h"
+
+namespace Hazel {
+
+  class TextureLoader;
+  class TextureStreamer;
+  class UploadScheduler;
+
+  // A square of the world partition on the XZ plane, covering
+  // [X, X + 1) * CellSize by [Z, Z + 1) * CellSize.
+  struct CellCoord
+  {
+    int32_t X = 0, Z = 0;
+  };
+
+  // One mesh instance of a cell.
+  struct CellObject
+  {
+    // Resolved through the VirtualFileSystem.
+    std::string Mesh;
+    // Empty for none.
+    std::string DiffuseMap;
+    std::string SpecularMap;
+    // Relative to the cell's corner at (X, 0, Z) * CellSize.
+    glm::vec3 Position{ 0.0f };
+    glm::vec3 Scale{ 1.0f };
+    float Shininess = 32.0f;
+  };
+
+  struct CellDesc
+  {
+    std::vector<CellObject> Objects;
+  };
+
+  // Streams a world too large to keep around one cell at a time. Cells
+  // within the load radius of the camera are requested nearest first, those
+  // ahead of the camera before those behind, with a cap on the loads in
+  // flight; each load asks the provider what the cell holds on a worker,
+  // loads its meshes (as Mesh::LoadAsync tasks, through the UploadScheduler)
+  // and textures, then creates its entities in one go. Cells beyond the
+  // unload radius lose their entities, and with them their share of the
+  // meshes and textures, which are shared between cells by path; loads that
+  // drift out of range are cancelled.
+  class WorldStreamer
+  {
+  public:
+    // On a worker; must be safe to call for several cells at once.
+    using CellProvider = std::function<void(CellCoord cell, CellDesc& desc)>;
+
+    struct Settings
+    {
+      float CellSize = 16.0f;
+      float LoadRadius = 64.0f;
+      // Larger than LoadRadius so cells on the edge are not loaded and
+      // unloaded over and over as the camera moves back and forth.
+      float UnloadRadius = 96.0f;
+      uint32_t MaxLoadsInFlight = 4;
+      // How much later a cell behind the camera comes than one ahead at the
+      // same distance: its distance counts 1 + 2 * ViewWeight times.
+      float ViewWeight = 0.5f;
+    };
+
+    struct Stats
+    {
+      uint32_t ResidentCells = 0;
+      uint32_t LoadingCells = 0;
+      // Within the load radius but not requested yet.
+      uint32_t QueuedCells = 0;
+      uint32_t Entities = 0;
+      // Since creation.
+      uint32_t Loaded = 0;
+      uint32_t Unloaded = 0;
+      uint32_t Cancelled = 0;
+      // From the request until the cell's entities exist.
+      float LoadMsLast = 0.0f;
+      float LoadMsAverage = 0.0f;
+      float LoadMsMax = 0.0f;
+      float UpdateMs = 0.0f;
+    };
+
+    // Textures are loaded through the streamer, if given: coarse levels
+    // first, finer ones as the view needs them.
+    WorldStreamer(Scene& scene, TextureLoader& loader, UploadScheduler& uploads, CellProvider provider, TextureStreamer* textureStreamer = nullptr);
+    // Cancels and waits for the loads in flight, pumping uploads meanwhile,
+    // and destroys every cell's entities.
+    ~WorldStreamer();
+
+    WorldStreamer(const WorldStreamer&) = delete;
+    WorldStreamer& operator=(const WorldStreamer&) = delete;
+
+    // Render thread, once per frame, after RenderThread::Execute.
+    void Update(const glm::vec3& position, const glm::vec3& forward);
+
+    bool IsResident(CellCoord cell) const;
+
+    Settings& GetSettings() { return m_Settings; }
+    const Stats& GetStats() const { return m_Stats; }
+  private:
+    struct Cell
+    {
+      Task<> Load;
+      CancellationToken Cancellation;
+      Timer LoadTimer;
+      bool Resident = false;
+      std::vector<Entity> Entities;
+      // Held for the entities; shared with other cells.
+      std::vector<Ref<Mesh>> Meshes;
+      std::vector<Ref<Texture2D>> Textures;
+    };
+
+    // A mesh load in flight, shared by every cell that needs the mesh
+    // meanwhile. Render thread only; cells co_await it there.
+    struct MeshLoad
+    {
+      Task<> Load;
+      CancellationToken Cancellation;
+      // Of the cells waiting; the load is called off once all of them are.
+      std::vector<CancellationToken> Cells;
+      std::vector<std::coroutine_handle<>> Waiters;
+      // Null if the load failed or was called off.
+      Ref<Mesh> Result;
+      bool Done = false;
+
+      auto operator co_await() noexcept
+      {
+        struct Awaiter
+        {
+          MeshLoad& Load;
+
+          bool await_ready() const noexcept { return Load.Done; }
+          void await_suspend(std::coroutine_handle<> handle) { Load.Waiters.push_back(handle); }
+          void await_resume() const noexcept {}
+        };
+        return Awaiter{ *this };
+      }
+    };
+
+    static uint64_t GetKey(CellCoord cell) { return ((uint64_t)(uint32_t)cell.X << 32) | (uint32_t)cell.Z; }
+    static CellCoord GetCoord(uint64_t key) { return { (int32_t)(key >> 32), (int32_t)(uint32_t)key }; }
+    // Distance on the XZ plane from position to the nearest point of the cell.
+    float GetDistance(CellCoord cell, const glm::vec3& position) const;
+
+    Task<> LoadCell(CellCoord coord, Cell& cell);
+    // Owned by load, which keeps it until it has finished.
+    Task<> LoadMesh(std::string path, MeshLoad& load);
+    Ref<Texture2D> GetTexture(const std::string& path, TextureUsage usage);
+    void Unload(Cell& cell);
+  private:
+    Scene& m_Scene;
+    TextureLoader& m_Loader;
+    UploadScheduler& m_Uploads;
+    TextureStreamer* m_TextureStreamer;
+    CellProvider m_Provider;
+    Settings m_Settings;
+    Stats m_Stats;
+    // Cells loading, resident, or cancelled and waiting for their load to stop.
+    std::unordered_map<uint64_t, Cell> m_Cells;
+    // Keyed by path; textures also by usage.
+    std::unordered_map<std::string, std::weak_ptr<Mesh>> m_Meshes;
+    std::unordered_map<std::string, std::weak_ptr<Texture2D>> m_Textures;
+    // Keyed by path; cells hold on to the loads they wait for.
+    std::unordered_map<std::string, Ref<MeshLoad>> m_MeshLoads;
+    float m_LoadMsTotal = 0.0f;
+  };
+
+}